@@ -9,8 +9,10 @@
  * - Decoupled capture/playback devices with lock-free ring buffer
  * - IAudioClient3 for sub-10ms WASAPI shared mode (noAutoConvertSRC)
  * - MMCSS "Pro Audio" thread priority (ma_wasapi_usage_pro_audio)
- * - Manual clock drift compensation (skip/duplicate frames)
+ * - Manual clock drift compensation (skip/duplicate frames or adaptive
+ *   fractional resampling, see ta_drift.h)
  * - Variable callback size support (noFixedSizedCallback)
+ * - Multiple independent routes per process via ta_engine handles
  *
  * LATENCY BREAKDOWN:
  *   - Old: ~100ms (async resampler + intermediary buffers + OS buffer)
@@ -30,7 +32,12 @@
 #define MA_ENABLE_WASAPI
 #define MA_NO_DSOUND
 #define MA_NO_WINMM
-#define MA_NO_NULL
+#ifndef TA_ENABLE_NULL_BACKEND
+#define MA_NO_NULL      /* tools/ta_stress.c builds with it: simulated devices, no hardware */
+#endif
+#if defined(TA_ENABLE_RT_CHECKS) && !defined(_WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     /* dladdr, RTLD_NEXT (ta_rtcheck.h) */
+#endif
 
 /* 
  * CRITICAL: Do NOT define MA_WASAPI_USE_ASYNC_RESAMPLER!
@@ -40,15 +47,41 @@
 
 #include "TransparencyAudio.h"
 #include "miniaudio.h"
+#include "ta_ring.h"
+#include "ta_drift.h"
+#include "ta_timing.h"
+#include "ta_kernels.h"
+#include "ta_gain.h"
+#include "ta_channels.h"
+#include "ta_latency.h"
+#include "ta_fill.h"
+#include "ta_plc.h"
+#include "ta_splice.h"
+#include "ta_events.h"
+#include "ta_arena.h"
+#include "ta_rtcheck.h"
+#include "ta_probe.h"
+#include "ta_glitch.h"
+#include "ta_replay.h"
+#include "ta_trace.h"
 
-#include <windows.h>
-#include <avrt.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/*
+ * The engine core (ring, drift, simulator) also builds on non-Windows
+ * hosts for headless benchmarking; WASAPI, MMCSS and DllMain are Windows-only.
+ */
+#if defined(_WIN32)
+#include <windows.h>
+#include <avrt.h>
 
 #pragma comment(lib, "ole32.lib")
 #pragma comment(lib, "winmm.lib")
 #pragma comment(lib, "avrt.lib")
+#endif
 
 /* ==============================================================================
  * BARE METAL CONFIGURATION CONSTANTS
@@ -60,58 +93,265 @@
 /* Target fill level (50% of ring buffer) */
 #define TA_RING_BUFFER_TARGET_PERCENT   50
 
-/* Drift correction thresholds */
-#define TA_DRIFT_LOW_THRESHOLD_PERCENT  25   /* Below this: duplicate samples */
-#define TA_DRIFT_HIGH_THRESHOLD_PERCENT 75   /* Above this: skip samples */
+/* Drift correction bands (fill scaled so the target reads as TA_RING_BUFFER_TARGET_PERCENT) */
+#define TA_DRIFT_LOW_THRESHOLD_PERCENT  25   /* Below this: start duplicating frames */
+#define TA_DRIFT_LOW_RELEASE_PERCENT    45   /* ...until back above this */
+#define TA_DRIFT_HIGH_RELEASE_PERCENT   55   /* ...until back below this */
+#define TA_DRIFT_HIGH_THRESHOLD_PERCENT 75   /* Above this: start skipping frames */
+
+/* Adaptive target lower bound when ta_engine_config.minTargetLatencyMs is 0 */
+#define TA_DEFAULT_MIN_TARGET_LATENCY_MS 1.0f
 
 /* Minimum period size to request from IAudioClient3 */
 #define TA_MIN_PERIOD_SIZE_FRAMES       128  /* ~2.6ms @ 48kHz */
 
+/* Telemetry publish period when ta_engine_config.telemetryIntervalMs is 0 */
+#define TA_DEFAULT_TELEMETRY_INTERVAL_MS 50
+
+/* Peak meter release time constant (seconds) */
+#define TA_PEAK_RELEASE_SEC             0.3f
+
+/* Volume ramp / fade length when ta_engine_config.volumeRampMs is 0 */
+#define TA_DEFAULT_VOLUME_RAMP_MS       10
+
+/* Slack on the Stop fade-out wait beyond ramp + ring + device buffer */
+#define TA_FADE_OUT_MARGIN_MS           50
+
+/* Smallest float staging buffer for integer playback formats (larger callbacks run in chunks) */
+#define TA_CONVERT_SCRATCH_MIN_FRAMES   1024
+
+/* How often the dispatcher thread delivers queued callbacks */
+#define TA_EVENT_DISPATCH_INTERVAL_MS   5
+
+/* Latency measurement worker: poll period, and slack on its deadline beyond window + ring */
+#define TA_LATENCY_POLL_MS              5
+#define TA_LATENCY_TIMEOUT_MARGIN_MS    1000
+
+/* How often the glitch writer looks for finished dumps */
+#define TA_GLITCH_WRITER_INTERVAL_MS    20
+
+/* How often the callback trace writer drains the per-thread lanes */
+#define TA_CALLBACK_TRACE_INTERVAL_MS   20
+
+/*
+ * Engine lifecycle. Start and Stop claim STARTING/STOPPING with one CAS, so
+ * one transition runs at a time whatever thread calls; the audio callbacks
+ * process in RUNNING and STOPPING (the Stop fade-out) and output silence
+ * otherwise.
+ */
+typedef enum {
+    TA_ENGINE_UNINITIALIZED = 0,
+    TA_ENGINE_INITIALIZED,
+    TA_ENGINE_STARTING,
+    TA_ENGINE_RUNNING,
+    TA_ENGINE_STOPPING
+} ta_engine_state;
+
 /* ==============================================================================
  * INTERNAL STATE - "BARE METAL" ARCHITECTURE
+ * One ta_engine per capture->playback route. The AudioEngine_* exports operate
+ * on g_defaultEngine; ta_engine_create() hands out additional instances.
  * ============================================================================== */
 
-typedef struct {
-    /* Decoupled devices (instead of single duplex device) */
+/*
+ * Per-thread private state. Each audio thread only writes to its own
+ * cache line, so the callbacks never false-share with each other.
+ */
+typedef struct TA_ALIGN(TA_CACHE_LINE_SIZE) {
+    volatile ma_uint64 overrunCount;
+    volatile float peakLevel;   /* Post-volume peak with TA_PEAK_RELEASE_SEC release */
+    ta_callback_timer timer;
+    
+    /* Volume ramps, applied where input enters the route (ring or duplex output) */
+    ta_gain gain;
+    volatile ma_uint32 fadedOut;        /* Set once the Stop fade-out reached 0 */
+    volatile ma_uint64 fadedOutWritePos; /* Ring write position at that point */
+    
+    /* Clock time of the last ring commit, for the playback fill estimate */
+    volatile ma_uint64 commitTimeNs;
+    
+    volatile ma_uint64 pageFaults;      /* countPageFaults: taken inside this callback */
+} ta_capture_state;
+
+typedef struct TA_ALIGN(TA_CACHE_LINE_SIZE) {
+    volatile ma_uint64 underrunCount;
+    volatile ma_uint64 driftCorrectionCount;  /* Times we skipped/duplicated */
+    
+    /* Last played frame for single-frame duplication (channels wide) */
+    float* lastSample;
+    
+    /* Underrun concealment: output history and gap state */
+    ta_plc plc;
+    
+    /* TA_DRIFT_MODE_SKIP_DUPLICATE: phase-compensated fill estimate, splice overlap */
+    ta_fill_estimator fill;
+    ma_uint32 spliceFrames;
+    
+    /* TA_DRIFT_MODE_RESAMPLE: PI-steered Farrow resampler */
+    ta_drift drift;
+    volatile float driftPpm;    /* Published copy of drift.integralPpm */
+    
+    /* Adaptive ring target (adaptiveLatency) */
+    ta_latency latency;
+    volatile ma_uint32 latencyFloorFrames;  /* Published copy of latency.floorFrames */
+    
+    ta_callback_timer timer;
+    
+    /* TPDF dither generators for S16/S24 output */
+    ta_dither dither;
+    
+    /* Telemetry publishing (playback thread is the single seqlock writer) */
+    float peakLevel;
+    ma_uint32 framesSincePublish;
+    
+    volatile ma_uint64 pageFaults;      /* countPageFaults: taken inside this callback */
+} ta_playback_state;
+
+struct TA_ALIGN(TA_CACHE_LINE_SIZE) ta_engine {
+    /* Decoupled devices (default), or one duplex device on a shared clock */
     ma_device captureDevice;
     ma_device playbackDevice;
+    ma_device duplexDevice;
     ma_device_config captureConfig;
     ma_device_config playbackConfig;
+    ma_device_config duplexConfig;
     ma_context context;
+    int duplex;                 /* 1 = duplexDevice in use, no ring buffer */
+    
+    /* Sample loops for this CPU (picked at Initialize) */
+    ta_kernels kernels;
+    
+    /*
+     * Locked, pre-faulted memory for everything the callbacks touch: the
+     * route buffers are allocated from it, this struct and a mirrored ring
+     * are locked in place (lock_route_memory). countPageFaults = test mode.
+     */
+    ta_arena arena;
+    int countPageFaults;
+    
+    /* TA_ENABLE_RT_CHECKS: allocations/locks/blocking calls made inside the callbacks */
+    ta_rt_monitor rtMonitor;
+    
+    /*
+     * Round-trip latency measurement (ta_probe.h). The probe buffers come
+     * from the heap at the first measurement (pre-faulted, not locked: it
+     * is a test mode) and live until Uninitialize. latencyRunning is the
+     * claim; latencyResult is written under latencyLock.
+     */
+    ta_probe probe;
+    volatile ma_uint32 latencyRunning;
+    volatile ma_uint32 latencyCancel;
+    ma_uint32 latencyTimeoutMs;
+    ma_thread latencyThread;
+    int latencyThreadStarted;
+    ma_spinlock latencyLock;
+    ta_latency_measurement latencyResult;
+    
+    /*
+     * Glitch forensics (ta_glitch.h, glitchCaptureMs): history slots from
+     * the arena, dumped by the writer thread (first Start to Uninitialize).
+     */
+    ta_glitch glitch;
+    wchar_t glitchDirectory[260];
+    ma_thread glitchThread;
+    volatile ma_uint32 glitchWriterRunning;
+    int glitchWriterStarted;
+    
+    /*
+     * Callback trace (ta_replay.h). Lanes come from the heap at the first
+     * trace and live until Uninitialize; traceState claims start/stop
+     * (0 idle, 1 recording, 2 stopping).
+     */
+    ta_replay_recorder trace;
+    volatile ma_uint32 traceState;
+    ma_thread traceThread;
+    int traceThreadStarted;
+    
+    /*
+     * Device bring-up (open_devices/start_devices) and time to first
+     * sample. Initialize and Start write startupTiming under startupLock;
+     * after a Start each callback stamps its first run once (0 = not yet).
+     * Captured audio begins at ring position firstSampleFrame, the end of
+     * the pre-fill.
+     */
+    int parallelStartup;
+    ma_spinlock startupLock;
+    ta_startup_timing startupTiming;
+    ma_uint64 startBeginNs;
+    volatile ma_uint64 firstCaptureNs;
+    volatile ma_uint64 firstPlaybackNs;
+    volatile ma_uint64 firstSampleNs;
+    ma_uint64 firstSampleFrame;
+    
+    /*
+     * DEVICE SAMPLE FORMATS
+     * The route runs in f32. Integer capture is converted straight into the
+     * ring (or duplex output); integer playback is rendered into
+     * pConvertScratch and converted once into the device buffer.
+     * NULL conversion = the device side is f32. Capture frames are rebuilt
+     * in the route channel layout by channelMap (via pCaptureScratch when
+     * they also need converting).
+     */
+    ma_format captureFormat;
+    ma_format playbackFormat;
+    ma_uint32 captureFrameBytes;
+    ma_uint32 playbackFrameBytes;
+    void (*captureToFloat)(float* pDst, const void* pSrc, ma_uint32 count);
+    void (*playbackFromFloat)(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither);
+    int ditherPlayback;
+    float* pConvertScratch;
+    ma_uint32 convertScratchFrames;
+    ta_channel_map channelMap;
+    float* pCaptureScratch;
+    ma_uint32 captureScratchFrames;
     
     /* 
      * ELASTIC RING BUFFER 
      * This is the core of the "Bare Metal" architecture.
      * Capture writes to it, playback reads from it.
      * Manual drift compensation adjusts read pointer.
+     * Physical capacity is a power of two >= ringBufferSizeInFrames;
+     * all fill/threshold math uses the requested (logical) size.
      */
-    ma_pcm_rb ringBuffer;
-    void* ringBufferMemory;
+    ta_ring ring;
     ma_uint32 ringBufferSizeInFrames;
-    ma_uint32 ringBufferTargetFrames;  /* 50% fill target */
-    ma_uint32 channels;
-    
-    int initialized;
-    int running;
-    
-    float volume;
-    
-    /* Statistics */
-    volatile ma_uint32 underrunCount;
-    volatile ma_uint32 overrunCount;
-    volatile ma_uint32 driftCorrectionCount;  /* Times we skipped/duplicated */
-    
-    /* Last sample for duplication during underflow */
-    float lastSample[8];  /* Support up to 8 channels */
+    volatile ma_uint32 ringBufferTargetFrames;  /* Fill target: 50%, or learned (adaptiveLatency) */
+    int adaptiveLatency;
+    float minTargetLatencyMs;
+    float maxTargetLatencyMs;
+    ma_uint32 channels;                /* Route (= playback) channels */
+    ma_uint32 captureChannels;
+    ta_drift_mode driftMode;
+    
+    /* ta_engine_state; transitions are acquire/release (see claim_transition) */
+    volatile ma_uint32 state;
+    
+    /* Target volume; capture.gain ramps toward it (or 0 while fadingOut) */
+    volatile float volume;
+    volatile ma_uint32 fadingOut;
+    ma_uint32 volumeRampMs;
+    ta_gain_curve volumeRampCurve;
+    
+    /* Statistics, split by owning thread */
+    ta_capture_state capture;
+    ta_playback_state playback;
     
     /* Callbacks */
     ta_error_callback errorCallback;
     ta_device_disconnected_callback deviceDisconnectedCallback;
     ta_state_changed_callback stateChangedCallback;
     
-    /* Error state */
+    /* Callback delivery: posted from any thread, invoked on the dispatcher (first Start to Uninitialize) */
+    ta_event_queue events;
+    ma_thread dispatcherThread;
+    volatile ma_uint32 dispatcherRunning;
+    int dispatcherStarted;
+    volatile ma_uint32 deviceLost;  /* Unrequested stop: the dispatcher runs the teardown */
+    
+    /* Error state (writers serialized by errorLock) */
+    ma_spinlock errorLock;
     wchar_t lastErrorMessage[512];
-    ta_result lastError;
+    volatile ma_uint32 lastError;   /* ta_result */
     
     /* Device info cache */
     ma_device_info* captureDevices;
@@ -119,43 +359,330 @@ typedef struct {
     ma_device_info* playbackDevices;
     uint32_t playbackDeviceCount;
     
+#if defined(_WIN32)
     /* MMCSS handle */
     HANDLE mmcssHandle;
     DWORD mmcssTaskIndex;
+#endif
+    
+    /* 1 if allocated by ta_engine_create (freed by ta_engine_destroy) */
+    int ownsMemory;
+    
+    /* ta_sim_run: callbacks read the virtual clock instead of the system clock */
+    int simulated;
+    ma_uint64 simTimeNs;
     
-} ta_engine;
+    /* Telemetry cadence and the latency inputs, fixed at Start */
+    ma_uint32 telemetryIntervalMs;
+    ma_uint32 telemetryIntervalFrames;
+    ma_uint32 sampleRate;
+    ma_uint32 capturePeriodFrames;
+    ma_uint32 playbackPeriodFrames;
+    
+    /*
+     * Published telemetry. Must stay the LAST member: reset_engine_state()
+     * clears everything before it and rewrites this block under the
+     * seqlock, so a reader holding the pointer never sees it torn.
+     */
+    TA_ALIGN(TA_CACHE_LINE_SIZE) ta_telemetry telemetry;
+};
 
-static ta_engine g_engine = {0};
+/* Default instance backing the legacy AudioEngine_* exports */
+static ta_engine g_defaultEngine = {0};
 
 /* ==============================================================================
  * INTERNAL HELPERS
  * ============================================================================== */
 
-static void set_last_error(ta_result result, const wchar_t* message) {
-    g_engine.lastError = result;
+/* Any thread may fail a call; the lock keeps code and message from two failures apart */
+static void set_last_error(ta_engine* pEngine, ta_result result, const wchar_t* message) {
+    ta_rt_check(TA_RT_VIOLATION_LOCK, "set_last_error");
+    ma_spinlock_lock(&pEngine->errorLock);
     if (message) {
-        wcsncpy(g_engine.lastErrorMessage, message, 511);
-        g_engine.lastErrorMessage[511] = L'\0';
+        wcsncpy(pEngine->lastErrorMessage, message, 511);
+        pEngine->lastErrorMessage[511] = L'\0';
     } else {
-        g_engine.lastErrorMessage[0] = L'\0';
+        pEngine->lastErrorMessage[0] = L'\0';
+    }
+    ma_atomic_store_explicit_32(&pEngine->lastError, (ma_uint32)result, ma_atomic_memory_order_release);
+    ma_spinlock_unlock(&pEngine->errorLock);
+}
+
+static MA_INLINE ta_engine_state engine_state(const ta_engine* pEngine) {
+    return (ta_engine_state)ma_atomic_load_explicit_32(&pEngine->state, ma_atomic_memory_order_acquire);
+}
+
+/* Publish a state, and with it everything written before (devices, ring, priming) */
+static MA_INLINE void set_engine_state(ta_engine* pEngine, ta_engine_state state) {
+    ma_atomic_store_explicit_32(&pEngine->state, (ma_uint32)state, ma_atomic_memory_order_release);
+}
+
+/* One CAS, no waiting: 1 if the engine was in from and is now in to */
+static MA_INLINE int try_transition(ta_engine* pEngine, ta_engine_state from, ta_engine_state to) {
+    ma_uint32 expected = (ma_uint32)from;
+    return ma_atomic_compare_exchange_strong_explicit_32(&pEngine->state, &expected, (ma_uint32)to,
+        ma_atomic_memory_order_acq_rel, ma_atomic_memory_order_acquire) ? 1 : 0;
+}
+
+/* Callbacks process audio: running, or fading out for Stop */
+static MA_INLINE int engine_streaming(const ta_engine* pEngine) {
+    ta_engine_state state = engine_state(pEngine);
+    return state == TA_ENGINE_RUNNING || state == TA_ENGINE_STOPPING;
+}
+
+/*
+ * Move from -> to. While another Start or Stop is mid-transition, wait for
+ * it to finish and look again. Returns 1 if this caller made the move,
+ * 0 if the engine settled in some other state (*pState).
+ */
+static int claim_transition(ta_engine* pEngine, ta_engine_state from, ta_engine_state to, ta_engine_state* pState) {
+    for (;;) {
+        if (try_transition(pEngine, from, to)) {
+            return 1;
+        }
+        ta_engine_state state = engine_state(pEngine);
+        if (state != TA_ENGINE_STARTING && state != TA_ENGINE_STOPPING) {
+            if (state == from) {
+                continue;   /* Settled back into from since the CAS */
+            }
+            *pState = state;
+            return 0;
+        }
+        ma_sleep(1);
+    }
+}
+
+/*
+ * Statistics counters: 64-bit, written by one audio thread, read from any.
+ * The owner needs no read-modify-write, only a load and an untorn store.
+ */
+static MA_INLINE void count_events(volatile ma_uint64* pCounter, ma_uint64 count) {
+    ma_uint64 total = ma_atomic_load_explicit_64(pCounter, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_64(pCounter, total + count, ma_atomic_memory_order_relaxed);
+}
+
+static MA_INLINE void count_event(volatile ma_uint64* pCounter) {
+    count_events(pCounter, 1);
+}
+
+static MA_INLINE ma_uint64 read_count(const volatile ma_uint64* pCounter) {
+    return ma_atomic_load_explicit_64(pCounter, ma_atomic_memory_order_relaxed);
+}
+
+static MA_INLINE float engine_volume(const ta_engine* pEngine) {
+    return ma_atomic_load_explicit_f32(&pEngine->volume, ma_atomic_memory_order_relaxed);
+}
+
+/* Queue an error for errorCallback. Safe on any thread, never blocks. */
+static void notify_error(ta_engine* pEngine, ta_result result, const wchar_t* message) {
+    ta_event_post(&pEngine->events, TA_EVENT_ERROR, result, 0, message);
+}
+
+/* Queue a start/stop for stateChangedCallback. Safe on any thread, never blocks. */
+static void notify_state_changed(ta_engine* pEngine, int isRunning) {
+    ta_event_post(&pEngine->events, TA_EVENT_STATE_CHANGED, TA_SUCCESS, isRunning, NULL);
+}
+
+/* ==============================================================================
+ * EVENT DISPATCHER
+ * Drains the event queue every TA_EVENT_DISPATCH_INTERVAL_MS and invokes
+ * the registered callbacks on its own thread. Polling keeps producers down
+ * to a few stores: waking the thread would mean a mutex on POSIX.
+ * ============================================================================== */
+
+static void dispatch_events(ta_engine* pEngine) {
+    ta_event event;
+    
+    while (ta_event_take(&pEngine->events, &event)) {
+        switch (event.type) {
+            case TA_EVENT_ERROR: {
+                ta_error_callback callback = pEngine->errorCallback;
+                if (callback) {
+                    callback(event.result, event.message);
+                }
+            } break;
+            
+            case TA_EVENT_STATE_CHANGED: {
+                ta_state_changed_callback callback = pEngine->stateChangedCallback;
+                if (callback) {
+                    callback(event.value);
+                }
+            } break;
+            
+            default:
+                break;
+        }
+    }
+}
+
+static void handle_device_lost(ta_engine* pEngine);   /* ENGINE LIFECYCLE, with stop_engine */
+
+/* A device thread saw an unrequested stop: tear down here, before invoking any callback */
+static void dispatch_device_lost(ta_engine* pEngine) {
+    if (ma_atomic_exchange_explicit_32(&pEngine->deviceLost, 0, ma_atomic_memory_order_acquire)) {
+        handle_device_lost(pEngine);
+    }
+}
+
+static ma_thread_result MA_THREADCALL event_dispatcher_thread(void* pData) {
+    ta_engine* pEngine = (ta_engine*)pData;
+    
+    while (ma_atomic_load_explicit_32(&pEngine->dispatcherRunning, ma_atomic_memory_order_acquire)) {
+        dispatch_device_lost(pEngine);
+        dispatch_events(pEngine);
+        ma_sleep(TA_EVENT_DISPATCH_INTERVAL_MS);
+    }
+    
+    /* Deliver whatever was posted before the stop request */
+    dispatch_device_lost(pEngine);
+    dispatch_events(pEngine);
+    return (ma_thread_result)0;
+}
+
+static ta_result start_event_dispatcher(ta_engine* pEngine) {
+    if (pEngine->dispatcherStarted) {
+        return TA_SUCCESS;
+    }
+    
+    ma_atomic_store_explicit_32(&pEngine->dispatcherRunning, 1, ma_atomic_memory_order_release);
+    if (ma_thread_create(&pEngine->dispatcherThread, ma_thread_priority_default, 0,
+            event_dispatcher_thread, pEngine, NULL) != MA_SUCCESS) {
+        pEngine->dispatcherRunning = 0;
+        set_last_error(pEngine, TA_ERROR, L"Failed to start event dispatcher thread");
+        return TA_ERROR;
+    }
+    
+    pEngine->dispatcherStarted = 1;
+    return TA_SUCCESS;
+}
+
+/* Join the dispatcher after it delivered everything queued so far */
+static void stop_event_dispatcher(ta_engine* pEngine) {
+    if (!pEngine->dispatcherStarted) {
+        return;
+    }
+    
+    ma_atomic_store_explicit_32(&pEngine->dispatcherRunning, 0, ma_atomic_memory_order_release);
+    ma_thread_wait(&pEngine->dispatcherThread);
+    pEngine->dispatcherStarted = 0;
+}
+
+/* ==============================================================================
+ * TELEMETRY (SEQLOCK)
+ * One writer at a time: the playback callback while running, the control
+ * thread otherwise. Readers retry while the sequence is odd or changes.
+ * ============================================================================== */
+
+static void telemetry_write_begin(ta_telemetry* pTelemetry) {
+    ma_uint32 sequence = ma_atomic_load_explicit_32(&pTelemetry->sequence, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_32(&pTelemetry->sequence, sequence + 1, ma_atomic_memory_order_relaxed);
+    ma_atomic_thread_fence(ma_atomic_memory_order_release);
+}
+
+static void telemetry_write_end(ta_telemetry* pTelemetry) {
+    ma_uint32 sequence = ma_atomic_load_explicit_32(&pTelemetry->sequence, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_32(&pTelemetry->sequence, sequence + 1, ma_atomic_memory_order_release);
+}
+
+/* Publish a snapshot. Latency comes from the period sizes cached at Start. */
+static void publish_telemetry(ta_engine* pEngine) {
+    ta_telemetry* pTelemetry = &pEngine->telemetry;
+    ma_uint32 fill = (pEngine->ring.layout.pBuffer != NULL) ? ta_ring_fill(&pEngine->ring) : 0;
+    float msPerFrame = (pEngine->sampleRate > 0) ? 1000.0f / (float)pEngine->sampleRate : 0.0f;
+    
+    telemetry_write_begin(pTelemetry);
+    
+    pTelemetry->version = TA_TELEMETRY_VERSION;
+    pTelemetry->size = (uint32_t)sizeof(ta_telemetry);
+    pTelemetry->isRunning = (engine_state(pEngine) == TA_ENGINE_RUNNING) ? 1 : 0;
+    pTelemetry->updateCount++;
+    pTelemetry->ringBufferFillLevel = (pEngine->ringBufferSizeInFrames > 0)
+        ? (float)fill / (float)pEngine->ringBufferSizeInFrames
+        : 0.0f;
+    pTelemetry->captureLatencyMs = (float)pEngine->capturePeriodFrames * msPerFrame;
+    pTelemetry->playbackLatencyMs = (float)pEngine->playbackPeriodFrames * msPerFrame;
+    pTelemetry->actualLatencyMs = (float)fill * msPerFrame + pTelemetry->playbackLatencyMs;
+    pTelemetry->driftPpm = ma_atomic_load_explicit_f32(&pEngine->playback.driftPpm, ma_atomic_memory_order_relaxed);
+    pTelemetry->capturePeakLevel = pEngine->capture.peakLevel;
+    pTelemetry->playbackPeakLevel = pEngine->playback.peakLevel;
+    pTelemetry->currentVolume = engine_volume(pEngine);
+    pTelemetry->underrunCount = (uint32_t)read_count(&pEngine->playback.underrunCount);
+    pTelemetry->overrunCount = (uint32_t)read_count(&pEngine->capture.overrunCount);
+    pTelemetry->driftCorrectionCount = (uint32_t)read_count(&pEngine->playback.driftCorrectionCount);
+    
+    telemetry_write_end(pTelemetry);
+}
+
+/* Clear per-route state, keeping callback registrations and ownership */
+static void reset_engine_state(ta_engine* pEngine) {
+    ta_error_callback errorCallback = pEngine->errorCallback;
+    ta_device_disconnected_callback deviceDisconnectedCallback = pEngine->deviceDisconnectedCallback;
+    ta_state_changed_callback stateChangedCallback = pEngine->stateChangedCallback;
+    int ownsMemory = pEngine->ownsMemory;
+    
+    /* Everything up to the telemetry block; that is rewritten under the seqlock */
+    memset(pEngine, 0, offsetof(ta_engine, telemetry));
+    pEngine->errorCallback = errorCallback;
+    pEngine->deviceDisconnectedCallback = deviceDisconnectedCallback;
+    pEngine->stateChangedCallback = stateChangedCallback;
+    pEngine->ownsMemory = ownsMemory;
+    ta_event_queue_init(&pEngine->events);
+    ta_arena_init(&pEngine->arena);
+    
+    ma_uint64 updateCount = pEngine->telemetry.updateCount;
+    telemetry_write_begin(&pEngine->telemetry);
+    memset((ma_uint8*)&pEngine->telemetry + sizeof(pEngine->telemetry.sequence), 0,
+        sizeof(ta_telemetry) - sizeof(pEngine->telemetry.sequence));
+    pEngine->telemetry.updateCount = updateCount;
+    telemetry_write_end(&pEngine->telemetry);
+    publish_telemetry(pEngine);
+}
+
+/* Device ID as a wide string (WASAPI endpoint ID; empty on other backends) */
+static void get_device_id_string(const ma_device_info* device, wchar_t* out, size_t outLength) {
+#if defined(_WIN32)
+    wcsncpy(out, device->id.wasapi, outLength - 1);
+    out[outLength - 1] = L'\0';
+#else
+    (void)device;
+    (void)outLength;
+    out[0] = L'\0';
+#endif
+}
+
+/* Register the calling thread for MMCSS "Pro Audio" scheduling (Windows only) */
+static void begin_pro_audio_priority(ta_engine* pEngine) {
+#if defined(_WIN32)
+    pEngine->mmcssTaskIndex = 0;
+    pEngine->mmcssHandle = AvSetMmThreadCharacteristicsW(L"Pro Audio", &pEngine->mmcssTaskIndex);
+    if (!pEngine->mmcssHandle) {
+        /* Non-fatal - continue without MMCSS boost */
+        notify_error(pEngine, TA_ERROR, L"Warning: Failed to set Pro Audio MMCSS priority");
     }
+#else
+    (void)pEngine;
+#endif
 }
 
-static void notify_error(ta_result result, const wchar_t* message) {
-    set_last_error(result, message);
-    if (g_engine.errorCallback) {
-        g_engine.errorCallback(result, message);
+static void end_pro_audio_priority(ta_engine* pEngine) {
+#if defined(_WIN32)
+    if (pEngine->mmcssHandle) {
+        AvRevertMmThreadCharacteristics(pEngine->mmcssHandle);
+        pEngine->mmcssHandle = NULL;
     }
+#else
+    (void)pEngine;
+#endif
 }
 
 /* Convert Windows device ID to ma_device_id */
-static int find_device_by_id(const wchar_t* deviceId, ma_device_type type, ma_device_id* outId) {
+static int find_device_by_id(ta_engine* pEngine, const wchar_t* deviceId, ma_device_type type, ma_device_id* outId) {
     ma_device_info* devices = (type == ma_device_type_capture) 
-        ? g_engine.captureDevices 
-        : g_engine.playbackDevices;
+        ? pEngine->captureDevices 
+        : pEngine->playbackDevices;
     uint32_t count = (type == ma_device_type_capture) 
-        ? g_engine.captureDeviceCount 
-        : g_engine.playbackDeviceCount;
+        ? pEngine->captureDeviceCount 
+        : pEngine->playbackDeviceCount;
     
     if (!devices || count == 0) {
         return 0;
@@ -163,7 +690,9 @@ static int find_device_by_id(const wchar_t* deviceId, ma_device_type type, ma_de
     
     for (uint32_t i = 0; i < count; i++) {
         /* Compare the WASAPI device ID string */
-        if (wcscmp(devices[i].id.wasapi, deviceId) == 0) {
+        wchar_t id[256];
+        get_device_id_string(&devices[i], id, 256);
+        if (id[0] != L'\0' && wcscmp(id, deviceId) == 0) {
             *outId = devices[i].id;
             return 1;
         }
@@ -172,185 +701,722 @@ static int find_device_by_id(const wchar_t* deviceId, ma_device_type type, ma_de
     return 0;
 }
 
+#if defined(MA_HAS_WASAPI)
+/* PKEY_Device_ContainerId: one GUID per physical device, shared by its endpoints */
+static const PROPERTYKEY TA_PKEY_Device_ContainerId = {{0x8C7ED206, 0x3F8A, 0x4827, {0xB3, 0xAB, 0xAE, 0x9E, 0x1F, 0x0F, 0xAE, 0x9B}}, 2};
+#define TA_VT_CLSID 72
+
+/* Container ID of an endpoint (NULL pId = default endpoint). Returns 1 on success. */
+static int get_endpoint_container_id(ta_engine* pEngine, ma_device_type type, const ma_device_id* pId, GUID* pContainerId) {
+    ma_IMMDevice* pMMDevice;
+    ma_IPropertyStore* pProperties;
+    int found = 0;
+    
+    if (ma_context_get_MMDevice__wasapi(&pEngine->context, type, pId, &pMMDevice) != MA_SUCCESS) {
+        return 0;
+    }
+    
+    if (SUCCEEDED(ma_IMMDevice_OpenPropertyStore(pMMDevice, STGM_READ, &pProperties))) {
+        MA_PROPVARIANT var;
+        ma_PropVariantInit(&var);
+        if (SUCCEEDED(ma_IPropertyStore_GetValue(pProperties, &TA_PKEY_Device_ContainerId, &var))) {
+            /* VT_CLSID stores a GUID pointer where the string pointer lives */
+            if (var.vt == TA_VT_CLSID && var.pwszVal != NULL) {
+                *pContainerId = *(const GUID*)var.pwszVal;
+                found = 1;
+            }
+            ma_PropVariantClear(&pEngine->context, &var);
+        }
+        ma_IPropertyStore_Release(pProperties);
+    }
+    
+    ma_IMMDevice_Release(pMMDevice);
+    return found;
+}
+#endif
+
+/*
+ * Can capture and playback run as one duplex device? True when both
+ * endpoints belong to the same physical interface, which then drives them
+ * from one clock. On WASAPI that is a matching container ID; elsewhere the
+ * backend must name both directions with the same device ID (e.g. ALSA hw:N,M).
+ */
+static int endpoints_share_clock(ta_engine* pEngine, const ma_device_id* pCaptureId, const ma_device_id* pPlaybackId) {
+#if defined(MA_HAS_WASAPI)
+    GUID captureContainer;
+    GUID playbackContainer;
+    
+    if (!get_endpoint_container_id(pEngine, ma_device_type_capture, pCaptureId, &captureContainer) ||
+        !get_endpoint_container_id(pEngine, ma_device_type_playback, pPlaybackId, &playbackContainer)) {
+        return 0;
+    }
+    return memcmp(&captureContainer, &playbackContainer, sizeof(GUID)) == 0;
+#else
+    (void)pEngine;
+    if (pCaptureId == NULL || pPlaybackId == NULL) {
+        return 0;
+    }
+    return memcmp(pCaptureId, pPlaybackId, sizeof(ma_device_id)) == 0;
+#endif
+}
+
 /* ==============================================================================
  * AUDIO DATA CALLBACKS - "BARE METAL" DECOUPLED ARCHITECTURE
  * These run on separate audio threads - must be fast, no allocations!
+ * (Checked in TA_ENABLE_RT_CHECKS builds: see ta_rtcheck.h.)
  * ============================================================================== */
 
+/* Clock the route's timestamps use (virtual under ta_sim_run) */
+static MA_INLINE ma_uint64 engine_now_ns(const ta_engine* pEngine) {
+    return pEngine->simulated ? pEngine->simTimeNs : ta_timing_now_ns();
+}
+
+/* Gain the capture side ramps toward: the set volume, or silence while stopping */
+static MA_INLINE float volume_target(ta_engine* pEngine) {
+    if (ma_atomic_load_explicit_32(&pEngine->fadingOut, ma_atomic_memory_order_acquire)) {
+        return 0.0f;
+    }
+    return engine_volume(pEngine);
+}
+
+/* Once a Stop fade-out has settled at 0, tell the control thread where silence begins */
+static MA_INLINE void note_fade_out(ta_engine* pEngine, float target) {
+    if (target != 0.0f || pEngine->capture.fadedOut || !pEngine->fadingOut ||
+        !ta_gain_is_settled(&pEngine->capture.gain, 0.0f)) {
+        return;
+    }
+    ma_uint64 writePos = (pEngine->ring.layout.pBuffer != NULL)
+        ? ma_atomic_load_explicit_64(&pEngine->ring.producer.writePos, ma_atomic_memory_order_relaxed)
+        : 0;
+    ma_atomic_store_explicit_64(&pEngine->capture.fadedOutWritePos, writePos, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_32(&pEngine->capture.fadedOut, 1, ma_atomic_memory_order_release);
+}
+
+/* Peak-hold meter: jump to new peaks, release exponentially over frameCount */
+static float update_peak_meter(float meter, float peak, ma_uint32 frameCount, ma_uint32 sampleRate) {
+    if (sampleRate > 0) {
+        meter *= expf(-(float)frameCount / (TA_PEAK_RELEASE_SEC * (float)sampleRate));
+    }
+    return (peak > meter) ? peak : meter;
+}
+
+/* 1 unless capture frames are already f32 in the route channel layout */
+static MA_INLINE int capture_needs_conversion(const ta_engine* pEngine) {
+    return pEngine->captureToFloat != NULL || !pEngine->channelMap.identity;
+}
+
+/*
+ * Capture device frames -> route frames (f32, route channel count) at pDst.
+ * Converted and remapped input goes through pCaptureScratch in chunks.
+ */
+static void capture_to_route(ta_engine* pEngine, float* pDst, const void* pSrc, ma_uint32 frameCount) {
+    const ta_channel_map* pMap = &pEngine->channelMap;
+    
+    if (pMap->identity) {
+        pEngine->captureToFloat(pDst, pSrc, frameCount * pEngine->channels);
+        return;
+    }
+    if (!pEngine->captureToFloat) {
+        pMap->remap(pMap, pDst, (const float*)pSrc, frameCount);
+        return;
+    }
+    
+    ma_uint32 done = 0;
+    while (done < frameCount) {
+        ma_uint32 frames = frameCount - done;
+        if (frames > pEngine->captureScratchFrames) {
+            frames = pEngine->captureScratchFrames;
+        }
+        pEngine->captureToFloat(pEngine->pCaptureScratch,
+            (const ma_uint8*)pSrc + (size_t)done * pEngine->captureFrameBytes, frames * pEngine->captureChannels);
+        pMap->remap(pMap, pDst + (size_t)done * pEngine->channels, pEngine->pCaptureScratch, frames);
+        done += frames;
+    }
+}
+
 /**
- * CAPTURE CALLBACK
+ * CAPTURE PATH
  * Writes captured audio directly into the elastic ring buffer.
  * Handles variable frameCount from the OS (noFixedSizedCallback mode).
+ * Input is in the capture device format and channel count.
  */
-static void capture_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
-    (void)pOutput;  /* Capture-only device, no output */
-    (void)pDevice;
-    
-    if (!g_engine.running || !pInput) {
+static void capture_process(ta_engine* pEngine, const void* input, ma_uint32 frameCount) {
+    if (!engine_streaming(pEngine) || !input) {
         return;
     }
     
-    const float* input = (const float*)pInput;
     ma_uint32 framesToWrite = frameCount;
     
     /* Check for overflow before writing */
-    ma_uint32 availableWrite = ma_pcm_rb_available_write(&g_engine.ringBuffer);
+    ma_uint32 fill = ta_ring_fill(&pEngine->ring);
+    ma_uint32 availableWrite = (fill < pEngine->ringBufferSizeInFrames) 
+        ? pEngine->ringBufferSizeInFrames - fill 
+        : 0;
     
     if (framesToWrite > availableWrite) {
         /* OVERFLOW: Ring buffer is full, hardware is consuming slower than producing */
-        g_engine.overrunCount++;
+        count_event(&pEngine->capture.overrunCount);
         framesToWrite = availableWrite;  /* Write what we can */
     }
     
+    float peak = 0.0f;
+    
     if (framesToWrite > 0) {
-        /* Write to ring buffer with volume applied */
-        void* pWriteBuffer;
-        ma_uint32 writeAvailable = framesToWrite;
+        /* Write to ring buffer with volume applied (one span if mirrored, else at most two) */
+        float volume = volume_target(pEngine);
+        ma_uint32 channels = pEngine->channels;
+        ma_uint32 written = 0;
         
-        if (ma_pcm_rb_acquire_write(&g_engine.ringBuffer, &writeAvailable, &pWriteBuffer) == MA_SUCCESS) {
-            float* writePtr = (float*)pWriteBuffer;
-            const float* readPtr = input;
-            float volume = g_engine.volume;
-            ma_uint32 sampleCount = writeAvailable * g_engine.channels;
+        while (written < framesToWrite) {
+            ma_uint32 contiguous;
+            float* writePtr = ta_ring_write_span(&pEngine->ring, written, &contiguous);
+            const void* readPtr = (const ma_uint8*)input + (size_t)written * pEngine->captureFrameBytes;
+            ma_uint32 spanFrames = framesToWrite - written;
+            if (spanFrames > contiguous) {
+                spanFrames = contiguous;
+            }
             
-            /* Apply volume during copy (saves one pass later) */
-            for (ma_uint32 i = 0; i < sampleCount; i++) {
-                writePtr[i] = readPtr[i] * volume;
+            /*
+             * Apply (ramped) volume during copy (saves one pass later). Integer
+             * or remapped input is written straight into the ring first; the
+             * gain stage then runs in place and costs nothing at unity.
+             */
+            ma_uint32 sampleCount = spanFrames * channels;
+            if (capture_needs_conversion(pEngine)) {
+                capture_to_route(pEngine, writePtr, readPtr, spanFrames);
+                ta_gain_process(&pEngine->capture.gain, &pEngine->kernels, writePtr, writePtr, channels, spanFrames, volume);
+            } else {
+                ta_gain_process(&pEngine->capture.gain, &pEngine->kernels, writePtr, (const float*)readPtr, channels, spanFrames, volume);
             }
             
-            /* Store last samples for potential duplication during underflow */
-            if (writeAvailable > 0) {
-                ma_uint32 lastFrameOffset = (writeAvailable - 1) * g_engine.channels;
-                for (ma_uint32 ch = 0; ch < g_engine.channels; ch++) {
-                    g_engine.lastSample[ch] = writePtr[lastFrameOffset + ch];
-                }
+            /* Meter what went into the ring (still in cache) */
+            float spanPeak = pEngine->kernels.peak(writePtr, sampleCount);
+            if (spanPeak > peak) {
+                peak = spanPeak;
             }
             
-            ma_pcm_rb_commit_write(&g_engine.ringBuffer, writeAvailable);
+            written += spanFrames;
         }
+        
+        ma_atomic_store_explicit_64(&pEngine->capture.commitTimeNs, engine_now_ns(pEngine), ma_atomic_memory_order_relaxed);
+        ta_ring_commit_write(&pEngine->ring, framesToWrite);
+        note_fade_out(pEngine, volume);
+    }
+    
+    pEngine->capture.peakLevel = update_peak_meter(pEngine->capture.peakLevel, peak, frameCount, pEngine->sampleRate);
+}
+
+/* Meter the output and publish telemetry every telemetryIntervalFrames */
+static void update_playback_telemetry(ta_engine* pEngine, const float* output, ma_uint32 frameCount) {
+    if (!engine_streaming(pEngine)) {
+        return;
+    }
+    
+    float peak = pEngine->kernels.peak(output, frameCount * pEngine->channels);
+    pEngine->playback.peakLevel = update_peak_meter(pEngine->playback.peakLevel, peak, frameCount, pEngine->sampleRate);
+    
+    pEngine->playback.framesSincePublish += frameCount;
+    if (pEngine->playback.framesSincePublish >= pEngine->telemetryIntervalFrames) {
+        pEngine->playback.framesSincePublish = 0;
+        publish_telemetry(pEngine);
+    }
+}
+
+/* Latency measurement: the probe replaces the route output (not during the Stop fade) */
+static MA_INLINE void render_probe(ta_engine* pEngine, float* output, ma_uint32 frameCount) {
+    if (engine_state(pEngine) == TA_ENGINE_RUNNING) {
+        ta_probe_render(&pEngine->probe, output, frameCount, pEngine->channels);
+    }
+}
+
+/* Every output path ends here: probe, glitch history, then the meters see the final signal */
+static MA_INLINE void finish_output(ta_engine* pEngine, float* output, ma_uint32 frameCount) {
+    render_probe(pEngine, output, frameCount);
+    if (pEngine->glitch.enabled) {
+        ta_glitch_record_audio(&pEngine->glitch, output, frameCount);
+    }
+    update_playback_telemetry(pEngine, output, frameCount);
+}
+
+/* Repeat the last played frame over output[startFrame..frameCount) */
+static void fill_with_last_sample(ta_engine* pEngine, float* output, ma_uint32 startFrame, ma_uint32 frameCount) {
+    ma_uint32 channels = pEngine->channels;
+    
+    if (startFrame < frameCount) {
+        pEngine->kernels.fill_frame(output + (size_t)startFrame * channels, pEngine->playback.lastSample,
+            channels, frameCount - startFrame);
+    }
+}
+
+/*
+ * output[0..producedFrames) holds ring data; conceal the rest (ta_plc.h).
+ * Also crossfades out of a previous gap and records the history, so every
+ * drift stage ends here.
+ */
+static void conceal_underrun(ta_engine* pEngine, float* output, ma_uint32 producedFrames, ma_uint32 frameCount) {
+    ta_plc_process(&pEngine->playback.plc, output, producedFrames, frameCount);
+}
+
+/* Phase-compensated fill (see ta_fill.h) from the fill read at callback start */
+static double playback_fill_estimate(ta_engine* pEngine, ma_uint32 availableRead) {
+    /*
+     * The stamp is stored before the commit it belongs to, so a fill that
+     * includes a commit never pairs with an older stamp.
+     */
+    ma_uint64 commitNs = ma_atomic_load_explicit_64(&pEngine->capture.commitTimeNs, ma_atomic_memory_order_relaxed);
+    ma_uint64 nowNs = engine_now_ns(pEngine);
+    
+    return ta_fill_compensate(&pEngine->playback.fill, availableRead,
+        (nowNs > commitNs) ? nowNs - commitNs : 0, pEngine->capturePeriodFrames);
+}
+
+/**
+ * PLAYBACK PATH - ADAPTIVE FRACTIONAL RESAMPLING (TA_DRIFT_MODE_RESAMPLE)
+ * Reads (1 + ppm * 1e-6) input frames per output frame, with ppm steered
+ * by a PI controller on the smoothed, phase-compensated fill level. The
+ * ring converges on ringBufferTargetFrames without dropping or repeating
+ * frames.
+ */
+static void playback_resample(ta_engine* pEngine, float* output, ma_uint32 frameCount, ma_uint32 availableRead) {
+    ta_drift* pDrift = &pEngine->playback.drift;
+    ma_uint32 channels = pEngine->channels;
+    
+    double step = ta_drift_update(pDrift, playback_fill_estimate(pEngine, availableRead),
+        pEngine->ringBufferTargetFrames, frameCount);
+    ma_atomic_store_explicit_f32(&pEngine->playback.driftPpm, (float)pDrift->integralPpm, ma_atomic_memory_order_relaxed);
+    TA_TRACE_COUNTER("drift ppm", pDrift->integralPpm);
+    
+    ma_uint32 inputFrames = ta_drift_input_frames(pDrift, step, frameCount);
+    if (inputFrames > pDrift->scratchCapacityFrames - TA_DRIFT_HISTORY_FRAMES) {
+        inputFrames = pDrift->scratchCapacityFrames - TA_DRIFT_HISTORY_FRAMES;
+    }
+    if (inputFrames > availableRead) {
+        /* UNDERRUN: resample what is there, conceal the rest */
+        count_event(&pEngine->playback.underrunCount);
+        inputFrames = availableRead;
+    }
+    
+    /* Append new input behind the resampler history (one copy when mirrored) */
+    ta_ring_read(&pEngine->ring, pDrift->pScratch + (size_t)TA_DRIFT_HISTORY_FRAMES * channels, inputFrames);
+    
+    ma_uint32 produced = ta_drift_process(pDrift, output, frameCount, inputFrames, step);
+    
+    if (produced > 0) {
+        pEngine->kernels.copy(pEngine->playback.lastSample, output + (size_t)(produced - 1) * channels, channels);
     }
+    
+    conceal_underrun(pEngine, output, produced, frameCount);
 }
 
 /**
- * PLAYBACK CALLBACK - "BARE METAL" WITH MANUAL DRIFT COMPENSATION
+ * PLAYBACK PATH - "BARE METAL" WITH MANUAL DRIFT COMPENSATION
  * Reads from elastic ring buffer with drift correction.
  * 
  * DRIFT COMPENSATION LOGIC (Section 5.2 of Tuning Guide):
- * - If buffer < 25% full: UNDERFLOW RISK → duplicate last sample (stretch)
- * - If buffer > 75% full: OVERFLOW RISK → skip one sample (compress)
+ * - Buffer short of this callback: UNDERRUN → conceal the gap (ta_plc.h)
+ * - Estimate < 25% full: UNDERFLOW RISK → insert one frame per
+ *   correction interval until back above 45%
+ * - Estimate > 75% full: OVERFLOW RISK → remove one frame per correction
+ *   interval until back below 55% (both lower if a capture commit would
+ *   overrun the ring first)
+ * Corrections are crossfaded splices at the most self-similar point of the
+ * callback (ta_splice.h), not hard drops or repeats.
  * - Otherwise: direct copy
+ * The estimate is the smoothed, capture-phase-compensated fill (ta_fill.h),
+ * scaled so the target reads as 50%: an adaptive target moves the bands
+ * with it.
  *
  * This replaces the MA_WASAPI_USE_ASYNC_RESAMPLER with zero latency overhead.
  */
-static void playback_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
-    (void)pInput;   /* Playback-only device, no input */
-    (void)pDevice;
-    
-    float* output = (float*)pOutput;
-    
-    if (!g_engine.running) {
-        /* Output silence if not running */
-        memset(output, 0, frameCount * g_engine.channels * sizeof(float));
-        return;
-    }
+static void playback_skip_duplicate(ta_engine* pEngine, float* output, ma_uint32 frameCount, ma_uint32 availableRead) {
+    ta_fill_estimator* pFill = &pEngine->playback.fill;
+    double framesPerPercent = (double)pEngine->ringBufferTargetFrames / TA_RING_BUFFER_TARGET_PERCENT;
+    ta_fill_bands bands;
+    bands.lowEnter = framesPerPercent * TA_DRIFT_LOW_THRESHOLD_PERCENT;
+    bands.lowRelease = framesPerPercent * TA_DRIFT_LOW_RELEASE_PERCENT;
+    bands.highRelease = framesPerPercent * TA_DRIFT_HIGH_RELEASE_PERCENT;
+    bands.highEnter = framesPerPercent * TA_DRIFT_HIGH_THRESHOLD_PERCENT;
     
-    ma_uint32 availableRead = ma_pcm_rb_available_read(&g_engine.ringBuffer);
-    ma_uint32 ringBufferCapacity = g_engine.ringBufferSizeInFrames;
+    /*
+     * A commit overruns once the period-averaged fill passes ring - period/2,
+     * a callback underruns below period/2 + its frames; a callback of
+     * headroom on each for jitter.
+     */
+    double halfPeriod = 0.5 * (double)pEngine->capturePeriodFrames;
+    double overrunCeiling = (double)pEngine->ringBufferSizeInFrames - halfPeriod - (double)frameCount;
+    double underrunFloor = halfPeriod + 2.0 * (double)frameCount;
+    ta_fill_limit_high_bands(&bands, overrunCeiling, underrunFloor, (double)pEngine->ringBufferTargetFrames);
     
-    /* Calculate fill percentage */
-    ma_uint32 fillPercent = (ringBufferCapacity > 0) 
-        ? (availableRead * 100) / ringBufferCapacity 
-        : 0;
+    double estimate = playback_fill_estimate(pEngine, availableRead);
+    ta_fill_action action = ta_fill_update(pFill, estimate, frameCount, &bands);
+    TA_TRACE_COUNTER("fill estimate", estimate);
     
     ma_uint32 framesToRead = frameCount;
-    ma_uint32 outputOffset = 0;
+    ma_uint32 removedFrames = 0;
+    ma_uint32 heldFrames = 0;
+    ma_uint32 channels = pEngine->channels;
     
     /* ==== DRIFT COMPENSATION LOGIC ==== */
     
-    if (fillPercent < TA_DRIFT_LOW_THRESHOLD_PERCENT) {
+    if (availableRead < frameCount) {
         /* 
-         * UNDERFLOW RISK: Buffer running dry
-         * Strategy: Duplicate last known sample to "stretch" time
-         * This allows the capture side to catch up.
+         * UNDERRUN: Buffer ran dry
+         * Strategy: Play what is there and conceal the rest, which
+         * "stretches" time so the capture side can catch up.
          */
-        if (availableRead < frameCount) {
-            g_engine.underrunCount++;
-            g_engine.driftCorrectionCount++;
-            
-            if (availableRead == 0) {
-                /* Complete underrun - output last known samples or silence */
-                for (ma_uint32 i = 0; i < frameCount; i++) {
-                    for (ma_uint32 ch = 0; ch < g_engine.channels; ch++) {
-                        output[i * g_engine.channels + ch] = g_engine.lastSample[ch];
-                    }
-                }
-                return;
-            }
-            
-            /* Partial data available - read what we have, duplicate the rest */
-            framesToRead = availableRead;
-        }
-    } else if (fillPercent > TA_DRIFT_HIGH_THRESHOLD_PERCENT && availableRead > frameCount + 1) {
+        count_event(&pEngine->playback.underrunCount);
+        count_event(&pEngine->playback.driftCorrectionCount);
+        ta_fill_note_correction(pFill);
+        
+        framesToRead = availableRead;
+    } else if (action == TA_FILL_SKIP && availableRead > frameCount + 1) {
         /* 
          * OVERFLOW RISK: Buffer filling up
-         * Strategy: Skip one frame to "compress" time
+         * Strategy: Splice one frame out to "compress" time
          * This allows the playback side to catch up.
          */
-        g_engine.driftCorrectionCount++;
-        
-        /* Skip one frame by reading and discarding it */
-        void* pSkipBuffer;
-        ma_uint32 skipFrames = 1;
-        if (ma_pcm_rb_acquire_read(&g_engine.ringBuffer, &skipFrames, &pSkipBuffer) == MA_SUCCESS) {
-            ma_pcm_rb_commit_read(&g_engine.ringBuffer, skipFrames);
-        }
-        
-        /* Update available count after skip */
-        availableRead = ma_pcm_rb_available_read(&g_engine.ringBuffer);
+        count_event(&pEngine->playback.driftCorrectionCount);
+        removedFrames = 1;
+    } else if (action == TA_FILL_DUPLICATE) {
+        /* 
+         * UNDERFLOW RISK: Buffer running low
+         * Strategy: Read one frame less and splice one in
+         */
+        count_event(&pEngine->playback.driftCorrectionCount);
+        framesToRead = frameCount - 1;
+        heldFrames = 1;
     }
     
+    TA_TRACE_COUNTER("drift correction", (int)removedFrames - (int)heldFrames);
+    
     /* ==== READ FROM RING BUFFER ==== */
     
-    void* pReadBuffer;
-    ma_uint32 actualRead = framesToRead;
+    ma_uint32 actualRead = (framesToRead < availableRead) ? framesToRead : availableRead;
     
-    if (ma_pcm_rb_acquire_read(&g_engine.ringBuffer, &actualRead, &pReadBuffer) == MA_SUCCESS && actualRead > 0) {
-        /* Copy audio data to output */
-        memcpy(output, pReadBuffer, actualRead * g_engine.channels * sizeof(float));
-        outputOffset = actualRead * g_engine.channels;
-        
-        /* Store last samples for potential future underflow */
-        ma_uint32 lastFrameOffset = (actualRead - 1) * g_engine.channels;
-        float* readPtr = (float*)pReadBuffer;
-        for (ma_uint32 ch = 0; ch < g_engine.channels; ch++) {
-            g_engine.lastSample[ch] = readPtr[lastFrameOffset + ch];
+    if (actualRead > 0) {
+        /* Copy audio data to output (single memcpy when mirrored) */
+        ta_ring_read(&pEngine->ring, output, actualRead);
+    }
+    
+    if (removedFrames) {
+        /* The frame after the callback's, through lastSample (it ends up last) */
+        ta_ring_read(&pEngine->ring, pEngine->playback.lastSample, 1);
+        ta_splice_remove(&pEngine->kernels, output, pEngine->playback.lastSample, channels, actualRead,
+            pEngine->playback.spliceFrames);
+    } else if (heldFrames && actualRead > 0) {
+        ta_splice_insert(&pEngine->kernels, output, channels, actualRead + heldFrames, pEngine->playback.spliceFrames);
+        actualRead += heldFrames;
+        heldFrames = 0;
+    }
+    
+    if (actualRead > 0) {
+        /* Store last samples for single-frame repeats */
+        pEngine->kernels.copy(pEngine->playback.lastSample, output + (size_t)(actualRead - 1) * channels, channels);
+    }
+    
+    /* Duplicate correction with nothing to splice into: repeat the last frame */
+    fill_with_last_sample(pEngine, output, actualRead, actualRead + heldFrames);
+    
+    /* Anything still missing is an underrun gap */
+    conceal_underrun(pEngine, output, actualRead + heldFrames, frameCount);
+}
+
+/**
+ * PLAYBACK PATH
+ * Runs the configured drift stage on the current fill, then
+ * (adaptiveLatency) feeds that fill to the target controller.
+ */
+static void playback_process(ta_engine* pEngine, float* output, ma_uint32 frameCount) {
+    if (!engine_streaming(pEngine)) {
+        /* Output silence if not running */
+        memset(output, 0, frameCount * pEngine->channels * sizeof(float));
+        return;
+    }
+    
+    ma_uint32 availableRead = ta_ring_fill(&pEngine->ring);
+    ma_uint64 underrunCount = pEngine->playback.underrunCount;
+    TA_TRACE_COUNTER("ring fill", availableRead);
+    
+    if (pEngine->driftMode == TA_DRIFT_MODE_RESAMPLE) {
+        playback_resample(pEngine, output, frameCount, availableRead);
+    } else {
+        playback_skip_duplicate(pEngine, output, frameCount, availableRead);
+    }
+    
+    if (pEngine->adaptiveLatency) {
+        ta_latency* pLatency = &pEngine->playback.latency;
+        ma_uint32 targetFrames = ta_latency_update(pLatency, availableRead, frameCount,
+            pEngine->playback.underrunCount != underrunCount);
+        ma_atomic_store_explicit_32(&pEngine->ringBufferTargetFrames, targetFrames, ma_atomic_memory_order_relaxed);
+        ma_atomic_store_explicit_32(&pEngine->playback.latencyFloorFrames, pLatency->floorFrames, ma_atomic_memory_order_relaxed);
+        TA_TRACE_COUNTER("target frames", targetFrames);
+    }
+}
+
+/* Dither for this route's output conversion, if enabled */
+static MA_INLINE ta_dither* playback_dither(ta_engine* pEngine) {
+    return pEngine->ditherPlayback ? &pEngine->playback.dither : NULL;
+}
+
+/**
+ * PLAYBACK PATH - INTEGER DEVICE FORMAT
+ * Renders float into pConvertScratch (chunked if the callback is larger),
+ * meters it, then does one f32 -> device conversion per chunk.
+ */
+static void playback_process_converted(ta_engine* pEngine, void* output, ma_uint32 frameCount) {
+    ma_uint32 done = 0;
+    
+    while (done < frameCount) {
+        ma_uint32 frames = frameCount - done;
+        if (frames > pEngine->convertScratchFrames) {
+            frames = pEngine->convertScratchFrames;
         }
         
-        ma_pcm_rb_commit_read(&g_engine.ringBuffer, actualRead);
+        playback_process(pEngine, pEngine->pConvertScratch, frames);
+        finish_output(pEngine, pEngine->pConvertScratch, frames);
+        pEngine->playbackFromFloat((ma_uint8*)output + (size_t)done * pEngine->playbackFrameBytes,
+            pEngine->pConvertScratch, frames * pEngine->channels, playback_dither(pEngine));
+        
+        done += frames;
+    }
+}
+
+/**
+ * DEVICE CALLBACKS
+ * Time each pass (execution, interval, frames, DSP load) around the work.
+ * The thread is flagged real-time for the whole pass (ta_rtcheck.h).
+ */
+/* Callback start on the route clock: the timer's reading, or virtual time under ta_sim_run */
+static MA_INLINE ma_uint64 callback_time_ns(const ta_engine* pEngine, ma_uint64 timerStartNs) {
+    return pEngine->simulated ? pEngine->simTimeNs : timerStartNs;
+}
+
+/* Time to first sample: keep the first callback time after a Start */
+static MA_INLINE void stamp_first_callback(volatile ma_uint64* pStamp, ma_uint64 timerStartNs) {
+    if (ma_atomic_load_explicit_64(pStamp, ma_atomic_memory_order_relaxed) == 0) {
+        ma_atomic_store_explicit_64(pStamp, timerStartNs, ma_atomic_memory_order_relaxed);
+    }
+}
+
+
+/* Fault test mode (countPageFaults): sample the fault counter around a callback */
+static MA_INLINE ma_uint64 page_faults_begin(const ta_engine* pEngine) {
+    return pEngine->countPageFaults ? ta_arena_page_faults() : 0;
+}
+
+static MA_INLINE void page_faults_end(const ta_engine* pEngine, volatile ma_uint64* pCounter, ma_uint64 before) {
+    if (pEngine->countPageFaults) {
+        ma_uint64 after = ta_arena_page_faults();
+        if (after > before) {
+            count_events(pCounter, after - before);
+        }
+    }
+}
+
+/* Playback (or duplex) timing record; new counter values trigger a glitch dump */
+static MA_INLINE void record_glitch_timing(ta_engine* pEngine, ma_uint64 timeNs, ma_uint64 executionNs, ma_uint32 frameCount) {
+    if (pEngine->glitch.enabled) {
+        ta_glitch_playback_callback(&pEngine->glitch, timeNs, executionNs, frameCount,
+            pEngine->duplex ? 0 : ta_ring_fill(&pEngine->ring),
+            read_count(&pEngine->playback.underrunCount), read_count(&pEngine->capture.overrunCount),
+            read_count(&pEngine->playback.driftCorrectionCount));
+    }
+}
+
+static void capture_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
+    (void)pOutput;  /* Capture-only device, no output */
+    
+    ta_engine* pEngine = (ta_engine*)pDevice->pUserData;
+    ta_rt_enter(&pEngine->rtMonitor, TA_RT_THREAD_CAPTURE);
+    TA_TRACE_THREAD("capture", pEngine);
+    TA_TRACE_BEGIN("capture");
+    ma_uint64 faults = page_faults_begin(pEngine);
+    ma_uint64 startNs = ta_callback_timer_begin(&pEngine->capture.timer);
+    ma_uint64 ringStart = ma_atomic_load_explicit_64(&pEngine->ring.producer.writePos, ma_atomic_memory_order_relaxed);
+    ta_replay_note(&pEngine->trace, TA_REPLAY_LANE_CAPTURE, callback_time_ns(pEngine, startNs), frameCount, ringStart);
+    stamp_first_callback(&pEngine->firstCaptureNs, startNs);
+    
+    capture_process(pEngine, pInput, frameCount);
+    ta_probe_capture(&pEngine->probe, pInput, frameCount, pEngine->captureFormat, pEngine->captureFrameBytes,
+        callback_time_ns(pEngine, startNs), ringStart,
+        ma_atomic_load_explicit_64(&pEngine->ring.producer.writePos, ma_atomic_memory_order_relaxed));
+    
+    ma_uint64 executionNs = ta_callback_timer_end(&pEngine->capture.timer, startNs, frameCount, pDevice->sampleRate);
+    if (pEngine->glitch.enabled) {
+        ta_glitch_capture_callback(&pEngine->glitch, callback_time_ns(pEngine, startNs), executionNs, frameCount,
+            ta_ring_fill(&pEngine->ring), read_count(&pEngine->capture.overrunCount));
+    }
+    page_faults_end(pEngine, &pEngine->capture.pageFaults, faults);
+    TA_TRACE_END();
+    ta_rt_leave();
+}
+
+static void playback_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
+    (void)pInput;   /* Playback-only device, no input */
+    
+    ta_engine* pEngine = (ta_engine*)pDevice->pUserData;
+    ta_rt_enter(&pEngine->rtMonitor, TA_RT_THREAD_PLAYBACK);
+    TA_TRACE_THREAD("playback", pEngine);
+    TA_TRACE_BEGIN("playback");
+    ma_uint64 faults = page_faults_begin(pEngine);
+    ma_uint64 startNs = ta_callback_timer_begin(&pEngine->playback.timer);
+    ma_uint64 timeNs = callback_time_ns(pEngine, startNs);
+    ma_uint64 readStart = ma_atomic_load_explicit_64(&pEngine->ring.consumer.readPos, ma_atomic_memory_order_relaxed);
+    ta_replay_note(&pEngine->trace, TA_REPLAY_LANE_PLAYBACK, timeNs, frameCount, readStart);
+    ta_probe_playback_begin(&pEngine->probe, timeNs, readStart, frameCount);
+    stamp_first_callback(&pEngine->firstPlaybackNs, startNs);
+    
+    if (pEngine->playbackFromFloat) {
+        playback_process_converted(pEngine, pOutput, frameCount);
+    } else {
+        playback_process(pEngine, (float*)pOutput, frameCount);
+        finish_output(pEngine, (float*)pOutput, frameCount);
+    }
+    
+    ma_uint64 readEnd = ma_atomic_load_explicit_64(&pEngine->ring.consumer.readPos, ma_atomic_memory_order_relaxed);
+    ta_probe_playback_end(&pEngine->probe, readEnd);
+    if (readEnd > pEngine->firstSampleFrame) {
+        stamp_first_callback(&pEngine->firstSampleNs, startNs);
+    }
+    
+    ma_uint64 executionNs = ta_callback_timer_end(&pEngine->playback.timer, startNs, frameCount, pDevice->sampleRate);
+    record_glitch_timing(pEngine, timeNs, executionNs, frameCount);
+    page_faults_end(pEngine, &pEngine->playback.pageFaults, faults);
+    TA_TRACE_END();
+    ta_rt_leave();
+}
+
+/**
+ * DUPLEX PATH
+ * Capture and playback share one device and one clock: input is processed
+ * straight into the output buffer. No ring, no pre-fill, no drift handling.
+ */
+static void duplex_process(ta_engine* pEngine, float* output, const float* input, ma_uint32 frameCount) {
+    ma_uint32 sampleCount = frameCount * pEngine->channels;
+    
+    if (!engine_streaming(pEngine) || !input) {
+        memset(output, 0, (size_t)sampleCount * sizeof(float));
+        return;
     }
     
-    /* Fill remaining output with last sample (stretch) if we didn't get enough */
-    if (actualRead < frameCount) {
-        for (ma_uint32 i = actualRead; i < frameCount; i++) {
-            for (ma_uint32 ch = 0; ch < g_engine.channels; ch++) {
-                output[i * g_engine.channels + ch] = g_engine.lastSample[ch];
+    float volume = volume_target(pEngine);
+    ta_gain_process(&pEngine->capture.gain, &pEngine->kernels, output, input, pEngine->channels, frameCount, volume);
+    note_fade_out(pEngine, volume);
+}
+
+/*
+ * Duplex with an integer format or a channel map: input is brought into the
+ * float work buffer (the output itself when playback is f32, else
+ * pConvertScratch), processed in place, and converted out if needed.
+ */
+static void duplex_process_converted(ta_engine* pEngine, void* output, const void* input, ma_uint32 frameCount) {
+    ma_uint32 channels = pEngine->channels;
+    ma_uint32 done = 0;
+    
+    while (done < frameCount) {
+        ma_uint32 frames = frameCount - done;
+        float* work;
+        if (pEngine->playbackFromFloat) {
+            if (frames > pEngine->convertScratchFrames) {
+                frames = pEngine->convertScratchFrames;
+            }
+            work = pEngine->pConvertScratch;
+        } else {
+            work = (float*)output + (size_t)done * channels;
+        }
+        
+        const float* in = NULL;
+        if (input) {
+            const void* readPtr = (const ma_uint8*)input + (size_t)done * pEngine->captureFrameBytes;
+            if (capture_needs_conversion(pEngine)) {
+                capture_to_route(pEngine, work, readPtr, frames);
+                in = work;
+            } else {
+                in = (const float*)readPtr;
             }
         }
+        
+        duplex_process(pEngine, work, in, frames);
+        finish_output(pEngine, work, frames);
+        
+        if (pEngine->playbackFromFloat) {
+            pEngine->playbackFromFloat((ma_uint8*)output + (size_t)done * pEngine->playbackFrameBytes,
+                work, frames * channels, playback_dither(pEngine));
+        }
+        
+        done += frames;
+    }
+}
+
+static void duplex_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
+    ta_engine* pEngine = (ta_engine*)pDevice->pUserData;
+    ta_rt_enter(&pEngine->rtMonitor, TA_RT_THREAD_PLAYBACK);
+    TA_TRACE_THREAD("duplex", pEngine);
+    TA_TRACE_BEGIN("duplex");
+    ma_uint64 faults = page_faults_begin(pEngine);
+    ma_uint64 startNs = ta_callback_timer_begin(&pEngine->playback.timer);
+    
+    /* No ring: the probe logs count frames through this callback instead */
+    ma_uint64 timeNs = callback_time_ns(pEngine, startNs);
+    ma_uint64 position = pEngine->probe.duplexPos;
+    pEngine->probe.duplexPos += frameCount;
+    ta_probe_capture(&pEngine->probe, pInput, frameCount, pEngine->captureFormat, pEngine->captureFrameBytes,
+        timeNs, position, position + frameCount);
+    ta_probe_playback_begin(&pEngine->probe, timeNs, position, frameCount);
+    stamp_first_callback(&pEngine->firstPlaybackNs, startNs);
+    if (pInput) {
+        stamp_first_callback(&pEngine->firstCaptureNs, startNs);
+        stamp_first_callback(&pEngine->firstSampleNs, startNs);
+    }
+    
+    if (capture_needs_conversion(pEngine) || pEngine->playbackFromFloat) {
+        duplex_process_converted(pEngine, pOutput, pInput, frameCount);
+    } else {
+        duplex_process(pEngine, (float*)pOutput, (const float*)pInput, frameCount);
+        finish_output(pEngine, (float*)pOutput, frameCount);
     }
+    
+    ta_probe_playback_end(&pEngine->probe, position + frameCount);
+    
+    /* The output is the post-volume input */
+    pEngine->capture.peakLevel = pEngine->playback.peakLevel;
+    
+    ma_uint64 executionNs = ta_callback_timer_end(&pEngine->playback.timer, startNs, frameCount, pDevice->sampleRate);
+    record_glitch_timing(pEngine, timeNs, executionNs, frameCount);
+    page_faults_end(pEngine, &pEngine->playback.pageFaults, faults);
+    TA_TRACE_END();
+    ta_rt_leave();
 }
 
 /* ==============================================================================
  * DEVICE NOTIFICATION CALLBACKS (Separate for capture/playback)
  * ============================================================================== */
 
+/*
+ * A device stopped without Stop (unplugged, disabled, taken by an
+ * exclusive-mode client). The peer device may still be streaming and
+ * MMCSS is still registered, but a device thread must not stop another
+ * device: hold the engine in STOPPING and leave the teardown to the
+ * dispatcher (handle_device_lost). Start, Stop and Uninitialize wait for
+ * STOPPING to settle, so none of them can re-prime the ring under a
+ * running producer. A requested Stop is already in STOPPING and skips this.
+ */
+static void note_unrequested_stop(ta_engine* pEngine) {
+    if (try_transition(pEngine, TA_ENGINE_RUNNING, TA_ENGINE_STOPPING)) {
+        ma_atomic_store_explicit_32(&pEngine->deviceLost, 1, ma_atomic_memory_order_release);
+    }
+}
+
 static void capture_notification_callback(const ma_device_notification* pNotification) {
+    ta_engine* pEngine = (ta_engine*)pNotification->pDevice->pUserData;
+    
     switch (pNotification->type) {
         case ma_device_notification_type_started:
             /* Capture started */
             break;
             
         case ma_device_notification_type_stopped:
-            /* Capture stopped */
+            note_unrequested_stop(pEngine);
             break;
             
         case ma_device_notification_type_rerouted:
@@ -367,19 +1433,15 @@ static void capture_notification_callback(const ma_device_notification* pNotific
 }
 
 static void playback_notification_callback(const ma_device_notification* pNotification) {
+    ta_engine* pEngine = (ta_engine*)pNotification->pDevice->pUserData;
+    
     switch (pNotification->type) {
         case ma_device_notification_type_started:
-            g_engine.running = 1;
-            if (g_engine.stateChangedCallback) {
-                g_engine.stateChangedCallback(1);
-            }
+            /* Start publishes RUNNING once both devices are up */
             break;
             
         case ma_device_notification_type_stopped:
-            g_engine.running = 0;
-            if (g_engine.stateChangedCallback) {
-                g_engine.stateChangedCallback(0);
-            }
+            note_unrequested_stop(pEngine);
             break;
             
         case ma_device_notification_type_rerouted:
@@ -445,8 +1507,9 @@ static void apply_bare_metal_config(ma_device_config* config, const ta_engine_co
     
     /*
      * FORMAT STRICTNESS
-     * Use float32 to avoid conversion overhead.
-     * WASAPI natively supports f32.
+     * The device format itself is picked by the caller (see
+     * device_format_from_config): Miniaudio's converter stays out of the
+     * path either way, integer formats go through our own kernels.
      */
     config->sampleRate = userConfig->sampleRate;
     
@@ -457,317 +1520,1412 @@ static void apply_bare_metal_config(ma_device_config* config, const ta_engine_co
 }
 
 /* ==============================================================================
- * PUBLIC API IMPLEMENTATION - "BARE METAL" EDITION
+ * DEVICE SAMPLE FORMATS
  * ============================================================================== */
 
-TA_API ta_result TA_CALL AudioEngine_Initialize(const ta_engine_config* config) {
-    ma_result result;
-    
-    if (!config) {
-        set_last_error(TA_INVALID_ARGS, L"Config is NULL");
-        return TA_INVALID_ARGS;
+/* Device format to request: UNKNOWN = native, integer formats as given, else f32 */
+static ma_format device_format_from_config(ta_format format) {
+    switch (format) {
+        case TA_FORMAT_UNKNOWN: return ma_format_unknown;
+        case TA_FORMAT_S16:     return ma_format_s16;
+        case TA_FORMAT_S24:     return ma_format_s24;
+        case TA_FORMAT_S32:     return ma_format_s32;
+        default:                return ma_format_f32;
     }
-    
-    if (g_engine.initialized) {
-        set_last_error(TA_DEVICE_ALREADY_INITIALIZED, L"Engine already initialized");
-        return TA_DEVICE_ALREADY_INITIALIZED;
+}
+
+static ta_format ta_format_from_device(ma_format format) {
+    switch (format) {
+        case ma_format_u8:      return TA_FORMAT_U8;
+        case ma_format_s16:     return TA_FORMAT_S16;
+        case ma_format_s24:     return TA_FORMAT_S24;
+        case ma_format_s32:     return TA_FORMAT_S32;
+        case ma_format_f32:     return TA_FORMAT_F32;
+        default:                return TA_FORMAT_UNKNOWN;
     }
-    
-    memset(&g_engine, 0, sizeof(ta_engine));
-    g_engine.volume = config->volume;
-    g_engine.channels = config->channels > 0 ? config->channels : 2;
-    
-    /* ==== INITIALIZE CONTEXT ==== */
-    
-    ma_context_config contextConfig = ma_context_config_init();
-    
-    ma_backend backends[] = { ma_backend_wasapi };
-    result = ma_context_init(backends, 1, &contextConfig, &g_engine.context);
+}
+
+/* Formats the route handles without Miniaudio's converter */
+static int is_route_format(ma_format format) {
+    return format == ma_format_f32 || format == ma_format_s16 ||
+           format == ma_format_s24 || format == ma_format_s32;
+}
+
+/*
+ * ma_device_init, reopened as f32 on any side whose native format has no
+ * conversion kernel (U8).
+ */
+static ma_result init_device_in_route_format(ma_context* pContext, ma_device_config* pConfig, ma_device* pDevice) {
+    ma_result result = ma_device_init(pContext, pConfig, pDevice);
     if (result != MA_SUCCESS) {
-        set_last_error(TA_FAILED_TO_INIT_BACKEND, L"Failed to initialize WASAPI backend");
-        return TA_FAILED_TO_INIT_BACKEND;
+        return result;
     }
     
-    /* ==== ENUMERATE DEVICES ==== */
+    int reopen = 0;
+    if (pConfig->deviceType != ma_device_type_playback && !is_route_format(pDevice->capture.format)) {
+        pConfig->capture.format = ma_format_f32;
+        reopen = 1;
+    }
+    if (pConfig->deviceType != ma_device_type_capture && !is_route_format(pDevice->playback.format)) {
+        pConfig->playback.format = ma_format_f32;
+        reopen = 1;
+    }
+    if (!reopen) {
+        return MA_SUCCESS;
+    }
     
-    result = ma_context_get_devices(&g_engine.context, 
-        &g_engine.playbackDevices, &g_engine.playbackDeviceCount,
-        &g_engine.captureDevices, &g_engine.captureDeviceCount);
-    if (result != MA_SUCCESS) {
-        ma_context_uninit(&g_engine.context);
-        set_last_error(TA_ERROR, L"Failed to enumerate devices");
-        return TA_ERROR;
+    ma_device_uninit(pDevice);
+    return ma_device_init(pContext, pConfig, pDevice);
+}
+
+/*
+ * PARALLEL BRING-UP
+ * A WASAPI device open or start takes tens of milliseconds, and the
+ * decoupled capture and playback devices do not depend on each other: the
+ * capture side runs on a short-lived worker while the calling thread does
+ * the playback side. Miniaudio does not promise concurrent ma_device_init
+ * on every backend, so only where it is known to be safe: WASAPI
+ * serializes its shared work on the context's command thread, the null
+ * backend keeps everything per device.
+ */
+typedef struct {
+    ta_engine* pEngine;
+    ma_device_type side;        /* capture or playback */
+    int start;                  /* 0 = open the device, 1 = start it */
+    ma_result result;
+    ma_uint64 elapsedNs;
+} ta_device_job;
+
+static int backend_opens_devices_concurrently(const ma_context* pContext) {
+    return pContext->backend == ma_backend_wasapi || pContext->backend == ma_backend_null;
+}
+
+static void run_device_job(ta_device_job* pJob) {
+    ta_engine* pEngine = pJob->pEngine;
+    int capture = (pJob->side == ma_device_type_capture);
+    ma_device* pDevice = capture ? &pEngine->captureDevice : &pEngine->playbackDevice;
+    ma_uint64 startNs = ta_timing_now_ns();
+    
+    if (pJob->start) {
+        pJob->result = ma_device_start(pDevice);
+    } else {
+        pJob->result = init_device_in_route_format(&pEngine->context,
+            capture ? &pEngine->captureConfig : &pEngine->playbackConfig, pDevice);
+    }
+    pJob->elapsedNs = ta_timing_now_ns() - startNs;
+}
+
+static ma_thread_result MA_THREADCALL device_job_thread(void* pData) {
+    ta_device_job* pJob = (ta_device_job*)pData;
+    
+    /* No trace probes here: a slot per short-lived thread would run the pool dry */
+#if defined(_WIN32)
+    HRESULT com = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+#endif
+    run_device_job(pJob);
+#if defined(_WIN32)
+    if (SUCCEEDED(com)) {
+        CoUninitialize();
+    }
+#endif
+    return (ma_thread_result)0;
+}
+
+typedef struct {
+    ta_device_job capture;
+    ta_device_job playback;
+    int parallel;               /* 1 if the two jobs overlapped */
+    ma_uint64 elapsedNs;        /* Wall time for both */
+} ta_device_jobs;
+
+/*
+ * Open (start = 0) or start both decoupled devices: concurrently when
+ * parallelStartup is set and the worker comes up, else capture first and
+ * playback only if capture succeeded (MA_CANCELLED otherwise). The caller
+ * releases whichever side succeeded if the other failed.
+ */
+static void run_device_jobs(ta_engine* pEngine, int start, ta_device_jobs* pJobs) {
+    ta_device_job capture = { pEngine, ma_device_type_capture, start, MA_SUCCESS, 0 };
+    ta_device_job playback = { pEngine, ma_device_type_playback, start, MA_SUCCESS, 0 };
+    ma_uint64 startNs = ta_timing_now_ns();
+    ma_thread worker;
+    
+    pJobs->capture = capture;
+    pJobs->playback = playback;
+    pJobs->parallel = pEngine->parallelStartup &&
+        ma_thread_create(&worker, ma_thread_priority_default, 0, device_job_thread, &pJobs->capture, NULL) == MA_SUCCESS;
+    
+    if (pJobs->parallel) {
+        TA_TRACE_BEGIN(start ? "start playback device" : "playback device init");
+        run_device_job(&pJobs->playback);
+        TA_TRACE_END();
+        TA_TRACE_BEGIN(start ? "wait for capture start" : "wait for capture init");
+        ma_thread_wait(&worker);
+        TA_TRACE_END();
+    } else {
+        TA_TRACE_BEGIN(start ? "start capture device" : "capture device init");
+        run_device_job(&pJobs->capture);
+        TA_TRACE_END();
+        if (pJobs->capture.result == MA_SUCCESS) {
+            TA_TRACE_BEGIN(start ? "start playback device" : "playback device init");
+            run_device_job(&pJobs->playback);
+            TA_TRACE_END();
+        } else {
+            pJobs->playback.result = MA_CANCELLED;
+        }
+    }
+    pJobs->elapsedNs = ta_timing_now_ns() - startNs;
+}
+
+static MA_INLINE float ns_to_ms(ma_uint64 ns) {
+    return (float)((double)ns * 1e-6);
+}
+
+/* Time to first sample: every phase -1 until it happens */
+static void clear_startup_timing(ta_startup_timing* pTiming) {
+    pTiming->parallel = 0;
+    pTiming->initializeMs = -1.0f;
+    pTiming->contextInitMs = -1.0f;
+    pTiming->enumerateMs = -1.0f;
+    pTiming->deviceInitMs = -1.0f;
+    pTiming->captureInitMs = -1.0f;
+    pTiming->playbackInitMs = -1.0f;
+    pTiming->startMs = -1.0f;
+    pTiming->deviceStartMs = -1.0f;
+    pTiming->captureStartMs = -1.0f;
+    pTiming->playbackStartMs = -1.0f;
+    pTiming->firstCaptureMs = -1.0f;
+    pTiming->firstPlaybackMs = -1.0f;
+    pTiming->firstSampleMs = -1.0f;
+}
+
+static void publish_startup_timing(ta_engine* pEngine, const ta_startup_timing* pTiming) {
+    ma_spinlock_lock(&pEngine->startupLock);
+    pEngine->startupTiming = *pTiming;
+    ma_spinlock_unlock(&pEngine->startupLock);
+}
+
+/* Start (devices stopped): forget the last run's start phases and first callbacks */
+static ma_uint64 begin_start_timing(ta_engine* pEngine) {
+    ma_uint64 nowNs = ta_timing_now_ns();
+    
+    ma_atomic_store_explicit_64(&pEngine->firstCaptureNs, 0, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_64(&pEngine->firstPlaybackNs, 0, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_64(&pEngine->firstSampleNs, 0, ma_atomic_memory_order_relaxed);
+    
+    ma_spinlock_lock(&pEngine->startupLock);
+    pEngine->startBeginNs = nowNs;
+    pEngine->startupTiming.startMs = -1.0f;
+    pEngine->startupTiming.deviceStartMs = -1.0f;
+    pEngine->startupTiming.captureStartMs = -1.0f;
+    pEngine->startupTiming.playbackStartMs = -1.0f;
+    ma_spinlock_unlock(&pEngine->startupLock);
+    return nowNs;
+}
+
+/* Start succeeded: pStarts = the decoupled device starts, NULL for duplex */
+static void finish_start_timing(ta_engine* pEngine, ma_uint64 startBeginNs, ma_uint64 deviceStartNs, const ta_device_jobs* pStarts) {
+    ma_uint64 nowNs = ta_timing_now_ns();
+    
+    ma_spinlock_lock(&pEngine->startupLock);
+    pEngine->startupTiming.startMs = ns_to_ms(nowNs - startBeginNs);
+    pEngine->startupTiming.deviceStartMs = ns_to_ms(deviceStartNs);
+    if (pStarts) {
+        pEngine->startupTiming.parallel = pStarts->parallel;
+        pEngine->startupTiming.captureStartMs = ns_to_ms(pStarts->capture.elapsedNs);
+        pEngine->startupTiming.playbackStartMs = ns_to_ms(pStarts->playback.elapsedNs);
     }
+    ma_spinlock_unlock(&pEngine->startupLock);
+}
+
+/*
+ * Channel counts from the config: the route runs at the playback count,
+ * captureChannels 0 / playbackChannels 0 fall back to channels (default
+ * stereo). Checks the channel map against the capture count. Sets the last
+ * error on failure.
+ */
+static ta_result init_channel_counts(ta_engine* pEngine, const ta_engine_config* config) {
+    ma_uint32 channels = config->channels > 0 ? config->channels : 2;
     
-    /* ==== FIND REQUESTED DEVICES ==== */
+    pEngine->captureChannels = config->captureChannels > 0 ? config->captureChannels : channels;
+    pEngine->channels = config->playbackChannels > 0 ? config->playbackChannels : channels;
     
-    ma_device_id captureId, playbackId;
-    int foundCapture = 0, foundPlayback = 0;
+    if (pEngine->captureChannels > MA_MAX_CHANNELS || pEngine->channels > MA_MAX_CHANNELS) {
+        set_last_error(pEngine, TA_INVALID_ARGS, L"Channel count exceeds the supported maximum");
+        return TA_INVALID_ARGS;
+    }
     
-    if (wcslen(config->inputDeviceId) > 0) {
-        foundCapture = find_device_by_id(config->inputDeviceId, ma_device_type_capture, &captureId);
+    if (config->useChannelMap) {
+        for (ma_uint32 ch = 0; ch < pEngine->channels && ch < TA_MAX_CHANNEL_MAP; ch++) {
+            if (config->channelMap[ch] >= (int32_t)pEngine->captureChannels) {
+                set_last_error(pEngine, TA_INVALID_ARGS, L"Channel map names a capture channel that does not exist");
+                return TA_INVALID_ARGS;
+            }
+        }
     }
-    if (wcslen(config->outputDeviceId) > 0) {
-        foundPlayback = find_device_by_id(config->outputDeviceId, ma_device_type_playback, &playbackId);
+    
+    return TA_SUCCESS;
+}
+
+/*
+ * Set up the edges of the route for the formats the devices opened with:
+ * the conversion kernels, the capture channel map and the float staging
+ * buffers (integer playback, and integer capture that also needs
+ * remapping; at least one full device buffer each). Sets the last error
+ * on failure.
+ */
+static ta_result init_route_conversion(ta_engine* pEngine, const ta_engine_config* config,
+    ma_format captureFormat, ma_format playbackFormat, ma_uint32 maxCaptureFrames, ma_uint32 maxPlaybackFrames) {
+    const ta_kernels* pKernels = &pEngine->kernels;
+    
+    pEngine->captureFormat = captureFormat;
+    pEngine->playbackFormat = playbackFormat;
+    pEngine->captureFrameBytes = ma_get_bytes_per_frame(captureFormat, pEngine->captureChannels);
+    pEngine->playbackFrameBytes = ma_get_bytes_per_frame(playbackFormat, pEngine->channels);
+    
+    switch (captureFormat) {
+        case ma_format_s16: pEngine->captureToFloat = pKernels->s16_to_f32; break;
+        case ma_format_s24: pEngine->captureToFloat = pKernels->s24_to_f32; break;
+        case ma_format_s32: pEngine->captureToFloat = pKernels->s32_to_f32; break;
+        default:            pEngine->captureToFloat = NULL; break;
+    }
+    switch (playbackFormat) {
+        case ma_format_s16: pEngine->playbackFromFloat = pKernels->f32_to_s16; break;
+        case ma_format_s24: pEngine->playbackFromFloat = pKernels->f32_to_s24; break;
+        case ma_format_s32: pEngine->playbackFromFloat = pKernels->f32_to_s32; break;
+        default:            pEngine->playbackFromFloat = NULL; break;
     }
     
-    /* ==== INITIALIZE ELASTIC RING BUFFER ==== */
+    /* At 32 bits dither would sit far below the converter's own float precision */
+    pEngine->ditherPlayback = config->enableDither && (playbackFormat == ma_format_s16 || playbackFormat == ma_format_s24);
+    ta_dither_init(&pEngine->playback.dither, 1);
     
-    g_engine.ringBufferSizeInFrames = config->ringBufferSizeFrames > 0 
-        ? config->ringBufferSizeFrames 
-        : TA_DEFAULT_RING_BUFFER_FRAMES;
-    g_engine.ringBufferTargetFrames = (g_engine.ringBufferSizeInFrames * TA_RING_BUFFER_TARGET_PERCENT) / 100;
-    
-    /* Allocate memory for ring buffer (f32 format) */
-    size_t ringBufferBytes = g_engine.ringBufferSizeInFrames * g_engine.channels * sizeof(float);
-    g_engine.ringBufferMemory = malloc(ringBufferBytes);
-    if (!g_engine.ringBufferMemory) {
-        ma_context_uninit(&g_engine.context);
-        set_last_error(TA_OUT_OF_MEMORY, L"Failed to allocate ring buffer");
+    ma_result result = ta_channel_map_init(&pEngine->channelMap, pEngine->captureChannels, pEngine->channels,
+        config->useChannelMap ? config->channelMap : NULL, TA_MAX_CHANNEL_MAP, &pEngine->arena.callbacks);
+    if (result != MA_SUCCESS) {
+        set_last_error(pEngine, TA_OUT_OF_MEMORY, L"Failed to allocate channel map");
         return TA_OUT_OF_MEMORY;
     }
     
-    result = ma_pcm_rb_init(ma_format_f32, g_engine.channels, 
-        g_engine.ringBufferSizeInFrames, g_engine.ringBufferMemory, NULL, &g_engine.ringBuffer);
-    if (result != MA_SUCCESS) {
-        free(g_engine.ringBufferMemory);
-        ma_context_uninit(&g_engine.context);
-        set_last_error(TA_ERROR, L"Failed to initialize ring buffer");
-        return TA_ERROR;
+    if (pEngine->playbackFromFloat) {
+        pEngine->convertScratchFrames = (maxPlaybackFrames > TA_CONVERT_SCRATCH_MIN_FRAMES)
+            ? maxPlaybackFrames
+            : TA_CONVERT_SCRATCH_MIN_FRAMES;
+        pEngine->pConvertScratch = (float*)ma_aligned_malloc(
+            (size_t)pEngine->convertScratchFrames * pEngine->channels * sizeof(float), TA_CACHE_LINE_SIZE, &pEngine->arena.callbacks);
+        if (!pEngine->pConvertScratch) {
+            ta_channel_map_uninit(&pEngine->channelMap, &pEngine->arena.callbacks);
+            set_last_error(pEngine, TA_OUT_OF_MEMORY, L"Failed to allocate format conversion buffer");
+            return TA_OUT_OF_MEMORY;
+        }
     }
     
-    /* ==== CONFIGURE CAPTURE DEVICE (Separate device #1) ==== */
+    if (pEngine->captureToFloat && !pEngine->channelMap.identity) {
+        pEngine->captureScratchFrames = (maxCaptureFrames > TA_CONVERT_SCRATCH_MIN_FRAMES)
+            ? maxCaptureFrames
+            : TA_CONVERT_SCRATCH_MIN_FRAMES;
+        pEngine->pCaptureScratch = (float*)ma_aligned_malloc(
+            (size_t)pEngine->captureScratchFrames * pEngine->captureChannels * sizeof(float), TA_CACHE_LINE_SIZE, &pEngine->arena.callbacks);
+        if (!pEngine->pCaptureScratch) {
+            if (pEngine->pConvertScratch) {
+                ma_aligned_free(pEngine->pConvertScratch, &pEngine->arena.callbacks);
+                pEngine->pConvertScratch = NULL;
+            }
+            ta_channel_map_uninit(&pEngine->channelMap, &pEngine->arena.callbacks);
+            set_last_error(pEngine, TA_OUT_OF_MEMORY, L"Failed to allocate capture conversion buffer");
+            return TA_OUT_OF_MEMORY;
+        }
+    }
     
-    g_engine.captureConfig = ma_device_config_init(ma_device_type_capture);
-    g_engine.captureConfig.capture.pDeviceID = foundCapture ? &captureId : NULL;
-    g_engine.captureConfig.capture.format = ma_format_f32;
-    g_engine.captureConfig.capture.channels = g_engine.channels;
-    g_engine.captureConfig.capture.shareMode = (config->shareMode == TA_SHARE_MODE_EXCLUSIVE) 
+    return TA_SUCCESS;
+}
+
+static void uninit_route_conversion(ta_engine* pEngine) {
+    if (pEngine->pConvertScratch) {
+        ma_aligned_free(pEngine->pConvertScratch, &pEngine->arena.callbacks);
+        pEngine->pConvertScratch = NULL;
+    }
+    if (pEngine->pCaptureScratch) {
+        ma_aligned_free(pEngine->pCaptureScratch, &pEngine->arena.callbacks);
+        pEngine->pCaptureScratch = NULL;
+    }
+    ta_channel_map_uninit(&pEngine->channelMap, &pEngine->arena.callbacks);
+}
+
+/* ==============================================================================
+ * DUPLEX DEVICE
+ * ============================================================================== */
+
+/* Open one duplex device for both endpoints. Sets the last error on failure. */
+static ta_result init_duplex_device(ta_engine* pEngine, const ta_engine_config* config,
+    const ma_device_id* pCaptureId, const ma_device_id* pPlaybackId) {
+    ma_share_mode shareMode = (config->shareMode == TA_SHARE_MODE_EXCLUSIVE) 
         ? ma_share_mode_exclusive 
         : ma_share_mode_shared;
     
-    g_engine.captureConfig.dataCallback = capture_callback;
-    g_engine.captureConfig.notificationCallback = capture_notification_callback;
-    g_engine.captureConfig.pUserData = &g_engine;
+    pEngine->duplexConfig = ma_device_config_init(ma_device_type_duplex);
+    pEngine->duplexConfig.capture.pDeviceID = pCaptureId;
+    pEngine->duplexConfig.capture.format = device_format_from_config(config->format);
+    pEngine->duplexConfig.capture.channels = pEngine->captureChannels;
+    pEngine->duplexConfig.capture.shareMode = shareMode;
+    pEngine->duplexConfig.playback.pDeviceID = pPlaybackId;
+    pEngine->duplexConfig.playback.format = device_format_from_config(config->format);
+    pEngine->duplexConfig.playback.channels = pEngine->channels;
+    pEngine->duplexConfig.playback.shareMode = shareMode;
+    
+    pEngine->duplexConfig.dataCallback = duplex_callback;
+    pEngine->duplexConfig.notificationCallback = playback_notification_callback;
+    pEngine->duplexConfig.pUserData = pEngine;
     
     /* Apply "Bare Metal" flags */
-    apply_bare_metal_config(&g_engine.captureConfig, config);
+    apply_bare_metal_config(&pEngine->duplexConfig, config);
     
-    /* Initialize capture device */
-    result = ma_device_init(&g_engine.context, &g_engine.captureConfig, &g_engine.captureDevice);
+    ma_result result = init_device_in_route_format(&pEngine->context, &pEngine->duplexConfig, &pEngine->duplexDevice);
     if (result != MA_SUCCESS) {
-        ma_pcm_rb_uninit(&g_engine.ringBuffer);
-        free(g_engine.ringBufferMemory);
-        ma_context_uninit(&g_engine.context);
-        set_last_error(TA_FAILED_TO_OPEN_BACKEND_DEVICE, L"Failed to initialize capture device");
+        set_last_error(pEngine, TA_FAILED_TO_OPEN_BACKEND_DEVICE, L"Failed to initialize duplex device");
         return TA_FAILED_TO_OPEN_BACKEND_DEVICE;
     }
     
-    /* ==== CONFIGURE PLAYBACK DEVICE (Separate device #2) ==== */
-    
-    g_engine.playbackConfig = ma_device_config_init(ma_device_type_playback);
-    g_engine.playbackConfig.playback.pDeviceID = foundPlayback ? &playbackId : NULL;
-    g_engine.playbackConfig.playback.format = ma_format_f32;
-    g_engine.playbackConfig.playback.channels = g_engine.channels;
-    g_engine.playbackConfig.playback.shareMode = (config->shareMode == TA_SHARE_MODE_EXCLUSIVE) 
-        ? ma_share_mode_exclusive 
-        : ma_share_mode_shared;
-    
-    g_engine.playbackConfig.dataCallback = playback_callback;
-    g_engine.playbackConfig.notificationCallback = playback_notification_callback;
-    g_engine.playbackConfig.pUserData = &g_engine;
-    
-    /* Apply "Bare Metal" flags */
-    apply_bare_metal_config(&g_engine.playbackConfig, config);
-    
-    /* Initialize playback device */
-    result = ma_device_init(&g_engine.context, &g_engine.playbackConfig, &g_engine.playbackDevice);
-    if (result != MA_SUCCESS) {
-        ma_device_uninit(&g_engine.captureDevice);
-        ma_pcm_rb_uninit(&g_engine.ringBuffer);
-        free(g_engine.ringBufferMemory);
-        ma_context_uninit(&g_engine.context);
-        set_last_error(TA_FAILED_TO_OPEN_BACKEND_DEVICE, L"Failed to initialize playback device");
+    /*
+     * Different native rates mean Miniaudio converts one side; the clocks
+     * may then differ too. Only accept that when resampling is enabled.
+     */
+    if (!config->enableResampling &&
+        pEngine->duplexDevice.capture.internalSampleRate != pEngine->duplexDevice.playback.internalSampleRate) {
+        ma_device_uninit(&pEngine->duplexDevice);
+        set_last_error(pEngine, TA_FAILED_TO_OPEN_BACKEND_DEVICE, L"Duplex endpoints run at different sample rates");
         return TA_FAILED_TO_OPEN_BACKEND_DEVICE;
     }
     
-    g_engine.initialized = 1;
-    set_last_error(TA_SUCCESS, NULL);
+    ta_result taResult = init_route_conversion(pEngine, config,
+        pEngine->duplexDevice.capture.format, pEngine->duplexDevice.playback.format,
+        pEngine->duplexDevice.capture.internalPeriodSizeInFrames * pEngine->duplexDevice.capture.internalPeriods,
+        pEngine->duplexDevice.playback.internalPeriodSizeInFrames * pEngine->duplexDevice.playback.internalPeriods);
+    if (taResult != TA_SUCCESS) {
+        ma_device_uninit(&pEngine->duplexDevice);
+        return taResult;
+    }
     
+    pEngine->duplex = 1;
     return TA_SUCCESS;
 }
 
-TA_API ta_result TA_CALL AudioEngine_Start(void) {
-    if (!g_engine.initialized) {
-        set_last_error(TA_DEVICE_NOT_INITIALIZED, L"Engine not initialized");
-        return TA_DEVICE_NOT_INITIALIZED;
-    }
-    
-    if (g_engine.running) {
-        return TA_SUCCESS;  /* Already running */
-    }
-    
-    /* Register for MMCSS "Pro Audio" scheduling */
-    g_engine.mmcssTaskIndex = 0;
-    g_engine.mmcssHandle = AvSetMmThreadCharacteristicsW(L"Pro Audio", &g_engine.mmcssTaskIndex);
-    if (!g_engine.mmcssHandle) {
-        /* Non-fatal - continue without MMCSS boost */
-        notify_error(TA_ERROR, L"Warning: Failed to set Pro Audio MMCSS priority");
-    }
-    
-    /* Reset statistics */
-    g_engine.underrunCount = 0;
-    g_engine.overrunCount = 0;
-    g_engine.driftCorrectionCount = 0;
+/* ==============================================================================
+ * ELASTIC BUFFER LIFETIME
+ * Shared by the WASAPI devices and the virtual-clock simulator.
+ * ============================================================================== */
+
+/* Allocate the ring (and resampler scratch). Sets the last error on failure. */
+static ta_result init_elastic_buffer(ta_engine* pEngine, const ta_engine_config* config) {
+    ma_result result;
     
-    /* Reset ring buffer and pre-fill to target level */
-    ma_pcm_rb_reset(&g_engine.ringBuffer);
+    pEngine->ringBufferSizeInFrames = config->ringBufferSizeFrames > 0 
+        ? config->ringBufferSizeFrames 
+        : TA_DEFAULT_RING_BUFFER_FRAMES;
+    pEngine->ringBufferTargetFrames = (pEngine->ringBufferSizeInFrames * TA_RING_BUFFER_TARGET_PERCENT) / 100;
     
-    /* Initialize lastSample to silence */
-    memset(g_engine.lastSample, 0, sizeof(g_engine.lastSample));
+    /* Adaptive target: bounds are resolved against the sample rate at Start */
+    pEngine->adaptiveLatency = config->adaptiveLatency ? 1 : 0;
+    pEngine->minTargetLatencyMs = config->minTargetLatencyMs > 0.0f
+        ? config->minTargetLatencyMs
+        : TA_DEFAULT_MIN_TARGET_LATENCY_MS;
+    pEngine->maxTargetLatencyMs = config->maxTargetLatencyMs;
+    ta_latency_init(&pEngine->playback.latency);
+    pEngine->playback.latencyFloorFrames = 0;
     
     /*
-     * PRE-FILL RING BUFFER TO 50% (Section 5.2 of Tuning Guide)
-     * This provides initial headroom for both underflow and overflow compensation.
-     * We fill with silence - actual audio will replace it within milliseconds.
+     * Allocate the SPSC ring (f32 format, power-of-two capacity).
+     * Prefer the mirrored mapping: every callback then does one straight
+     * copy, with no split at the end of the buffer.
      */
-    ma_uint32 preFillFrames = g_engine.ringBufferTargetFrames;
-    void* pWriteBuffer;
-    ma_uint32 writeAvailable = preFillFrames;
-    
-    if (ma_pcm_rb_acquire_write(&g_engine.ringBuffer, &writeAvailable, &pWriteBuffer) == MA_SUCCESS) {
-        memset(pWriteBuffer, 0, writeAvailable * g_engine.channels * sizeof(float));
-        ma_pcm_rb_commit_write(&g_engine.ringBuffer, writeAvailable);
+    result = MA_NOT_IMPLEMENTED;
+    if (config->ringBufferMode != TA_RING_BUFFER_MODE_WRAPPED) {
+        result = ta_ring_init_mirrored(&pEngine->ring, pEngine->channels, pEngine->ringBufferSizeInFrames);
     }
-    
-    /* Start CAPTURE device first (producer) */
-    ma_result result = ma_device_start(&g_engine.captureDevice);
-    if (result != MA_SUCCESS) {
-        if (g_engine.mmcssHandle) {
-            AvRevertMmThreadCharacteristics(g_engine.mmcssHandle);
-            g_engine.mmcssHandle = NULL;
-        }
-        set_last_error(TA_FAILED_TO_START_BACKEND_DEVICE, L"Failed to start capture device");
-        return TA_FAILED_TO_START_BACKEND_DEVICE;
+    if (result == MA_NOT_IMPLEMENTED && config->ringBufferMode == TA_RING_BUFFER_MODE_MIRRORED) {
+        set_last_error(pEngine, TA_ERROR, L"Mirrored ring buffer not supported on this system");
+        return TA_ERROR;
+    }
+    if (result == MA_NOT_IMPLEMENTED) {
+        result = ta_ring_init(&pEngine->ring, pEngine->channels, pEngine->ringBufferSizeInFrames, &pEngine->arena.callbacks);
     }
-    
-    /* Start PLAYBACK device second (consumer) */
-    result = ma_device_start(&g_engine.playbackDevice);
     if (result != MA_SUCCESS) {
-        ma_device_stop(&g_engine.captureDevice);
-        if (g_engine.mmcssHandle) {
-            AvRevertMmThreadCharacteristics(g_engine.mmcssHandle);
-            g_engine.mmcssHandle = NULL;
+        if (result == MA_OUT_OF_MEMORY) {
+            set_last_error(pEngine, TA_OUT_OF_MEMORY, L"Failed to allocate ring buffer");
+            return TA_OUT_OF_MEMORY;
         }
-        set_last_error(TA_FAILED_TO_START_BACKEND_DEVICE, L"Failed to start playback device");
-        return TA_FAILED_TO_START_BACKEND_DEVICE;
+        set_last_error(pEngine, TA_ERROR, L"Failed to initialize ring buffer");
+        return TA_ERROR;
     }
     
-    g_engine.running = 1;
+    /* One frame, held for duplication on underflow */
+    pEngine->playback.lastSample = (float*)ma_malloc((size_t)pEngine->channels * sizeof(float), &pEngine->arena.callbacks);
+    if (!pEngine->playback.lastSample) {
+        ta_ring_uninit(&pEngine->ring, &pEngine->arena.callbacks);
+        set_last_error(pEngine, TA_OUT_OF_MEMORY, L"Failed to allocate ring buffer");
+        return TA_OUT_OF_MEMORY;
+    }
+    
+    /* Resampler scratch: a callback never needs more input than the ring holds */
+    if (pEngine->driftMode == TA_DRIFT_MODE_RESAMPLE) {
+        result = ta_drift_init(&pEngine->playback.drift, pEngine->channels, pEngine->ringBufferSizeInFrames, &pEngine->arena.callbacks);
+        if (result != MA_SUCCESS) {
+            ma_free(pEngine->playback.lastSample, &pEngine->arena.callbacks);
+            pEngine->playback.lastSample = NULL;
+            ta_ring_uninit(&pEngine->ring, &pEngine->arena.callbacks);
+            set_last_error(pEngine, TA_OUT_OF_MEMORY, L"Failed to allocate resampler buffer");
+            return TA_OUT_OF_MEMORY;
+        }
+    }
     
-    if (g_engine.stateChangedCallback) {
-        g_engine.stateChangedCallback(1);
+    /* Concealment history: sized for the requested rate, or the highest one if native */
+    result = ta_plc_init(&pEngine->playback.plc, pEngine->channels,
+        config->sampleRate > 0 ? config->sampleRate : TA_PLC_MAX_SAMPLE_RATE, &pEngine->arena.callbacks);
+    if (result != MA_SUCCESS) {
+        ta_drift_uninit(&pEngine->playback.drift, &pEngine->arena.callbacks);
+        ma_free(pEngine->playback.lastSample, &pEngine->arena.callbacks);
+        pEngine->playback.lastSample = NULL;
+        ta_ring_uninit(&pEngine->ring, &pEngine->arena.callbacks);
+        set_last_error(pEngine, TA_OUT_OF_MEMORY, L"Failed to allocate concealment buffer");
+        return TA_OUT_OF_MEMORY;
     }
     
-    set_last_error(TA_SUCCESS, NULL);
     return TA_SUCCESS;
 }
 
-TA_API ta_result TA_CALL AudioEngine_Stop(void) {
-    if (!g_engine.initialized) {
-        set_last_error(TA_DEVICE_NOT_INITIALIZED, L"Engine not initialized");
+static void uninit_elastic_buffer(ta_engine* pEngine) {
+    ta_plc_uninit(&pEngine->playback.plc, &pEngine->arena.callbacks);
+    ta_drift_uninit(&pEngine->playback.drift, &pEngine->arena.callbacks);
+    if (pEngine->playback.lastSample) {
+        ma_free(pEngine->playback.lastSample, &pEngine->arena.callbacks);
+        pEngine->playback.lastSample = NULL;
+    }
+    ta_ring_uninit(&pEngine->ring, &pEngine->arena.callbacks);
+}
+
+/* Zero the counters and timing histograms before the callbacks start */
+static void reset_stream_statistics(ta_engine* pEngine) {
+    /* GetStatus may be reading them from another thread */
+    ma_atomic_store_explicit_64(&pEngine->playback.underrunCount, 0, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_64(&pEngine->capture.overrunCount, 0, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_64(&pEngine->playback.driftCorrectionCount, 0, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_64(&pEngine->capture.pageFaults, 0, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_64(&pEngine->playback.pageFaults, 0, ma_atomic_memory_order_relaxed);
+    ta_callback_timer_clear(&pEngine->capture.timer);
+    ta_callback_timer_clear(&pEngine->playback.timer);
+    ta_rt_monitor_reset(&pEngine->rtMonitor);
+    ta_glitch_prime(&pEngine->glitch);
+}
+
+/*
+ * Adaptive target bounds for this run: [minTargetLatencyMs,
+ * maxTargetLatencyMs], never above the fixed half-ring target so the skip
+ * threshold stays inside the ring. Keeps what was learned on earlier runs.
+ */
+static void prime_latency_target(ta_engine* pEngine, ma_uint32 sampleRate) {
+    ma_uint32 ringTarget = (pEngine->ringBufferSizeInFrames * TA_RING_BUFFER_TARGET_PERCENT) / 100;
+    ma_uint32 maxFrames = ringTarget;
+    
+    if (!pEngine->adaptiveLatency) {
+        ma_atomic_store_explicit_32(&pEngine->ringBufferTargetFrames, ringTarget, ma_atomic_memory_order_relaxed);
+        return;
+    }
+    
+    if (pEngine->maxTargetLatencyMs > 0.0f) {
+        float frames = pEngine->maxTargetLatencyMs * (float)sampleRate / 1000.0f;
+        if (frames < (float)ringTarget) {
+            maxFrames = (ma_uint32)frames;
+        }
+    }
+    float minFrames = pEngine->minTargetLatencyMs * (float)sampleRate / 1000.0f;
+    
+    ta_latency_configure(&pEngine->playback.latency, sampleRate,
+        (minFrames < (float)maxFrames) ? (ma_uint32)minFrames : maxFrames, maxFrames);
+    ma_atomic_store_explicit_32(&pEngine->ringBufferTargetFrames, pEngine->playback.latency.targetFrames, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_32(&pEngine->playback.latencyFloorFrames, pEngine->playback.latency.floorFrames, ma_atomic_memory_order_relaxed);
+}
+
+/* Reset statistics and pre-fill the ring before the callbacks start */
+static void prime_elastic_buffer(ta_engine* pEngine, ma_uint32 sampleRate) {
+    reset_stream_statistics(pEngine);
+    prime_latency_target(pEngine, sampleRate);
+    
+    /* Reset ring buffer and pre-fill to target level */
+    ta_ring_reset(&pEngine->ring);
+    
+    /* Initialize lastSample to silence */
+    memset(pEngine->playback.lastSample, 0, (size_t)pEngine->channels * sizeof(float));
+    
+    /*
+     * PRE-FILL RING BUFFER TO THE TARGET (Section 5.2 of Tuning Guide)
+     * This provides initial headroom for both underflow and overflow compensation.
+     * We fill with silence - actual audio will replace it within milliseconds.
+     */
+    ma_uint32 preFillFrames = pEngine->ringBufferTargetFrames;
+    ma_uint32 preFilled = 0;
+    
+    while (preFilled < preFillFrames) {
+        ma_uint32 contiguous;
+        float* pWriteBuffer = ta_ring_write_span(&pEngine->ring, preFilled, &contiguous);
+        ma_uint32 spanFrames = preFillFrames - preFilled;
+        if (spanFrames > contiguous) {
+            spanFrames = contiguous;
+        }
+        memset(pWriteBuffer, 0, (size_t)spanFrames * pEngine->channels * sizeof(float));
+        preFilled += spanFrames;
+    }
+    ta_ring_commit_write(&pEngine->ring, preFillFrames);
+    pEngine->firstSampleFrame = preFillFrames;  /* Captured audio follows the silence */
+    
+    /* Fill estimate and resampler loop start settled at the pre-fill level */
+    pEngine->capture.commitTimeNs = engine_now_ns(pEngine);
+    ta_fill_reset(&pEngine->playback.fill, sampleRate, preFillFrames);
+    pEngine->playback.spliceFrames = ta_splice_overlap_frames(sampleRate);
+    ta_plc_reset(&pEngine->playback.plc, sampleRate);
+    ma_atomic_store_explicit_f32(&pEngine->playback.driftPpm, 0.0f, ma_atomic_memory_order_relaxed);
+    if (pEngine->driftMode == TA_DRIFT_MODE_RESAMPLE) {
+        ta_drift_reset(&pEngine->playback.drift, sampleRate, preFillFrames);
+    }
+}
+
+/* Fix the telemetry cadence and latency inputs, then publish the start state */
+static void prime_telemetry(ta_engine* pEngine, ma_uint32 sampleRate, ma_uint32 capturePeriodFrames, ma_uint32 playbackPeriodFrames) {
+    pEngine->sampleRate = sampleRate;
+    pEngine->capturePeriodFrames = capturePeriodFrames;
+    pEngine->playbackPeriodFrames = playbackPeriodFrames;
+    pEngine->telemetryIntervalFrames = (ma_uint32)(((ma_uint64)sampleRate * pEngine->telemetryIntervalMs) / 1000);
+    pEngine->capture.peakLevel = 0.0f;
+    pEngine->playback.peakLevel = 0.0f;
+    pEngine->playback.framesSincePublish = 0;
+    
+    /* Devices are not started yet, so the control thread is the only writer */
+    publish_telemetry(pEngine);
+}
+
+/* Arm the Start fade-in: the gain stage settles at 0 and ramps to the volume */
+static void prime_volume(ta_engine* pEngine, ma_uint32 sampleRate) {
+    ma_uint32 rampFrames = (ma_uint32)(((ma_uint64)sampleRate * pEngine->volumeRampMs) / 1000);
+    
+    ta_gain_reset(&pEngine->capture.gain, rampFrames, pEngine->volumeRampCurve == TA_GAIN_CURVE_EXPONENTIAL, 0.0f);
+    pEngine->capture.fadedOut = 0;
+    pEngine->capture.fadedOutWritePos = 0;
+    pEngine->fadingOut = 0;
+}
+
+/*
+ * Ramp the output to silence and wait until it has been played, so Stop
+ * never cuts the signal mid-waveform. Silence must cross the ring (if any)
+ * and the device buffer (2 periods). Bounded: a stalled device costs at
+ * most ramp + ring + device buffer + TA_FADE_OUT_MARGIN_MS.
+ */
+static void fade_out_before_stop(ta_engine* pEngine) {
+    if (pEngine->sampleRate == 0) {
+        return;
+    }
+    
+    ma_uint32 periodMs = (ma_uint32)(((ma_uint64)pEngine->playbackPeriodFrames * 1000) / pEngine->sampleRate) + 1;
+    ma_uint32 ringMs = pEngine->duplex ? 0 : (ma_uint32)(((ma_uint64)pEngine->ringBufferSizeInFrames * 1000) / pEngine->sampleRate);
+    ma_uint32 timeoutMs = pEngine->volumeRampMs + ringMs + 2 * periodMs + TA_FADE_OUT_MARGIN_MS;
+    ma_device* pPlaybackSide = pEngine->duplex ? &pEngine->duplexDevice : &pEngine->playbackDevice;
+    
+    ma_atomic_store_explicit_32(&pEngine->fadingOut, 1, ma_atomic_memory_order_release);
+    
+    for (ma_uint32 waitedMs = 0; waitedMs < timeoutMs && ma_device_is_started(pPlaybackSide); waitedMs++) {
+        if (ma_atomic_load_explicit_32(&pEngine->capture.fadedOut, ma_atomic_memory_order_acquire)) {
+            ma_uint64 silentFrom = ma_atomic_load_explicit_64(&pEngine->capture.fadedOutWritePos, ma_atomic_memory_order_relaxed);
+            if (pEngine->duplex ||
+                ma_atomic_load_explicit_64(&pEngine->ring.consumer.readPos, ma_atomic_memory_order_acquire) >= silentFrom) {
+                /* Last audible frame has left the ring; let the device buffer drain */
+                ma_sleep(2 * periodMs);
+                return;
+            }
+        }
+        ma_sleep(1);
+    }
+}
+
+/*
+ * Pre-fault and lock what the arena does not own: this struct (device state,
+ * DSP state, telemetry) and a mirrored ring's two views. Last step of a
+ * successful Initialize, so failure paths have no regions to undo.
+ */
+static void lock_route_memory(ta_engine* pEngine) {
+    ta_arena_lock_region(&pEngine->arena, pEngine, sizeof(ta_engine));
+    if (pEngine->ring.layout.isMirrored) {
+        ta_arena_lock_region(&pEngine->arena, pEngine->ring.layout.pBuffer, 2 * pEngine->ring.layout.mappedBytes);
+    }
+}
+
+/* Initialize failed after the context came up: release it and the arena blocks */
+static void abandon_initialize(ta_engine* pEngine) {
+    ma_context_uninit(&pEngine->context);
+    ta_arena_uninit(&pEngine->arena);
+}
+
+/*
+ * LATENCY MEASUREMENT
+ * Arm the probe (control thread), then analyse once the callbacks moved it
+ * to CAPTURED/LOGGED: on a worker thread for a live engine, inline at the
+ * end of ta_sim_run.
+ */
+static ta_result arm_latency_measurement(ta_engine* pEngine, const ta_latency_probe_config* config) {
+    ma_uint32 sampleRate = pEngine->duplex ? pEngine->duplexDevice.sampleRate : pEngine->playbackDevice.sampleRate;
+    ta_latency_probe_config defaults;
+    if (!config) {
+        memset(&defaults, 0, sizeof(defaults));
+        config = &defaults;
+    }
+    
+    if (!pEngine->probe.pRecord && ta_probe_alloc(&pEngine->probe, sampleRate) != MA_SUCCESS) {
+        set_last_error(pEngine, TA_OUT_OF_MEMORY, L"Failed to allocate latency probe buffers");
+        return TA_OUT_OF_MEMORY;
+    }
+    
+    /* Deadline: lead-in, search window and probe, then the ring draining past the recording */
+    ma_uint32 maxRoundTripMs = config->maxRoundTripMs > 0 ? config->maxRoundTripMs : TA_PROBE_DEFAULT_MAX_ROUND_TRIP_MS;
+    if (maxRoundTripMs > TA_PROBE_MAX_ROUND_TRIP_MS) {
+        maxRoundTripMs = TA_PROBE_MAX_ROUND_TRIP_MS;
+    }
+    pEngine->latencyTimeoutMs = TA_PROBE_LEAD_IN_MS + maxRoundTripMs + TA_LATENCY_TIMEOUT_MARGIN_MS
+        + (ma_uint32)(((ma_uint64)TA_PROBE_FRAMES + pEngine->ringBufferSizeInFrames) * 1000 / sampleRate);
+    
+    /* What the engine reports right now (publish_telemetry's actualLatencyMs) */
+    ma_uint32 fill = pEngine->duplex ? 0 : ta_ring_fill(&pEngine->ring);
+    float estimatedMs = (float)((ma_uint64)fill + pEngine->playbackPeriodFrames) * 1000.0f / (float)sampleRate;
+    
+    ma_spinlock_lock(&pEngine->latencyLock);
+    memset(&pEngine->latencyResult, 0, sizeof(pEngine->latencyResult));
+    pEngine->latencyResult.state = TA_LATENCY_MEASUREMENT_RUNNING;
+    pEngine->latencyResult.engineInternalMs = -1.0f;
+    pEngine->latencyResult.estimatedMs = estimatedMs;
+    pEngine->latencyResult.probeFrames = TA_PROBE_FRAMES;
+    ma_spinlock_unlock(&pEngine->latencyLock);
+    
+    ta_probe_arm(&pEngine->probe, (ta_probe_signal)config->signal, config->level, maxRoundTripMs);
+    return TA_SUCCESS;
+}
+
+/* The callbacks no longer touch the probe (disarmed, or stopped on their own) */
+static void finish_latency_measurement(ta_engine* pEngine, ta_probe_phase phase) {
+    ta_probe_result probeResult;
+    ta_result error = TA_SUCCESS;
+    
+    if (phase == TA_PROBE_CAPTURED || phase == TA_PROBE_LOGGED) {
+        if (ta_probe_analyze(&pEngine->probe, &probeResult) != MA_SUCCESS) {
+            error = TA_ERROR;   /* Probe not heard: no loopback, or buried in noise */
+        }
+    } else {
+        /* Recording never filled: the devices stopped, or Uninitialize cancelled */
+        memset(&probeResult, 0, sizeof(probeResult));
+        error = (engine_state(pEngine) == TA_ENGINE_RUNNING) ? TA_ERROR : TA_DEVICE_NOT_STARTED;
+    }
+    
+    ma_spinlock_lock(&pEngine->latencyLock);
+    ta_latency_measurement* pResult = &pEngine->latencyResult;
+    pResult->state = (error == TA_SUCCESS) ? TA_LATENCY_MEASUREMENT_DONE : TA_LATENCY_MEASUREMENT_FAILED;
+    pResult->error = error;
+    pResult->peakToNoiseDb = (float)probeResult.peakToNoiseDb;
+    if (error == TA_SUCCESS) {
+        pResult->roundTripMs = (float)probeResult.roundTripMs;
+        if (probeResult.internalMs >= 0.0) {
+            pResult->engineInternalMs = (float)probeResult.internalMs;
+            pResult->totalMs = (float)(probeResult.roundTripMs + probeResult.internalMs);
+        }
+    }
+    ma_spinlock_unlock(&pEngine->latencyLock);
+}
+
+static ma_thread_result MA_THREADCALL latency_measurement_thread(void* pData) {
+    ta_engine* pEngine = (ta_engine*)pData;
+    ma_uint32 waitedMs = 0;
+    
+    while (ta_probe_get_phase(&pEngine->probe) != TA_PROBE_LOGGED && waitedMs < pEngine->latencyTimeoutMs &&
+           !ma_atomic_load_explicit_32(&pEngine->latencyCancel, ma_atomic_memory_order_acquire)) {
+        ma_sleep(TA_LATENCY_POLL_MS);
+        waitedMs += TA_LATENCY_POLL_MS;
+    }
+    
+    /* Past LOGGED the callbacks are done; otherwise let one still inside a hook leave */
+    ta_probe_phase phase = ta_probe_get_phase(&pEngine->probe);
+    ta_probe_disarm(&pEngine->probe);
+    if (phase != TA_PROBE_LOGGED) {
+        ma_sleep(TA_LATENCY_POLL_MS);
+    }
+    
+    finish_latency_measurement(pEngine, phase);
+    ma_atomic_store_explicit_32(&pEngine->latencyRunning, 0, ma_atomic_memory_order_release);
+    return (ma_thread_result)0;
+}
+
+/* Cancel and join the worker, release the probe buffers (Uninitialize) */
+static void stop_latency_measurement(ta_engine* pEngine) {
+    if (pEngine->latencyThreadStarted) {
+        ma_atomic_store_explicit_32(&pEngine->latencyCancel, 1, ma_atomic_memory_order_release);
+        ma_thread_wait(&pEngine->latencyThread);
+        pEngine->latencyThreadStarted = 0;
+    }
+    ta_probe_free(&pEngine->probe);
+}
+
+/*
+ * GLITCH FORENSICS
+ * History is allocated with the route (arena, locked with it); the writer
+ * thread runs from the first Start to Uninitialize. ta_sim_run services
+ * the slots inline instead.
+ */
+static ta_result init_glitch_capture(ta_engine* pEngine, const ta_engine_config* config, ma_uint32 sampleRate) {
+    if (ta_glitch_alloc(&pEngine->glitch, config->glitchCaptureMs, config->glitchMaxDumps, sampleRate,
+            pEngine->channels, &pEngine->arena.callbacks) != MA_SUCCESS) {
+        memset(&pEngine->glitch, 0, sizeof(pEngine->glitch));
+        set_last_error(pEngine, TA_OUT_OF_MEMORY, L"Failed to allocate glitch capture history");
+        return TA_OUT_OF_MEMORY;
+    }
+    
+    wcsncpy(pEngine->glitchDirectory, config->glitchDirectory, 259);
+    pEngine->glitchDirectory[259] = L'\0';
+    return TA_SUCCESS;
+}
+
+static ma_thread_result MA_THREADCALL glitch_writer_thread(void* pData) {
+    ta_engine* pEngine = (ta_engine*)pData;
+    
+    while (ma_atomic_load_explicit_32(&pEngine->glitchWriterRunning, ma_atomic_memory_order_acquire)) {
+        ta_glitch_service(&pEngine->glitch, pEngine->glitchDirectory);
+        ma_sleep(TA_GLITCH_WRITER_INTERVAL_MS);
+    }
+    
+    /* Write whatever was handed over before the stop request */
+    ta_glitch_service(&pEngine->glitch, pEngine->glitchDirectory);
+    return (ma_thread_result)0;
+}
+
+/* Non-fatal: without a writer the engine runs with glitch capture off */
+static void start_glitch_writer(ta_engine* pEngine) {
+    if (pEngine->glitchWriterStarted || !pEngine->glitch.enabled) {
+        return;
+    }
+    
+    ma_atomic_store_explicit_32(&pEngine->glitchWriterRunning, 1, ma_atomic_memory_order_release);
+    if (ma_thread_create(&pEngine->glitchThread, ma_thread_priority_default, 0,
+            glitch_writer_thread, pEngine, NULL) != MA_SUCCESS) {
+        pEngine->glitchWriterRunning = 0;
+        pEngine->glitch.enabled = 0;    /* Callbacks are not running yet */
+        notify_error(pEngine, TA_ERROR, L"Warning: Failed to start glitch writer thread, glitch capture disabled");
+        return;
+    }
+    
+    pEngine->glitchWriterStarted = 1;
+}
+
+/* Join the writer after it wrote every dump handed over so far (callbacks stopped) */
+static void stop_glitch_writer(ta_engine* pEngine) {
+    if (!pEngine->glitchWriterStarted) {
+        return;
+    }
+    
+    ma_atomic_store_explicit_32(&pEngine->glitchWriterRunning, 0, ma_atomic_memory_order_release);
+    ma_thread_wait(&pEngine->glitchThread);
+    pEngine->glitchWriterStarted = 0;
+}
+
+/*
+ * CALLBACK TRACE
+ * Recorded on the decoupled route only: the replay drives the ring. Written
+ * by a worker thread for a live engine, drained inline by ta_sim_run.
+ */
+static ta_result begin_callback_trace(ta_engine* pEngine, const wchar_t* path, ma_uint32 sampleRate,
+    ma_uint32 capturePeriodFrames, ma_uint32 playbackPeriodFrames) {
+    if (ta_replay_alloc(&pEngine->trace) != MA_SUCCESS) {
+        set_last_error(pEngine, TA_OUT_OF_MEMORY, L"Failed to allocate callback trace buffers");
+        return TA_OUT_OF_MEMORY;
+    }
+    
+    ta_replay_header header;
+    memset(&header, 0, sizeof(header));
+    header.sampleRate = sampleRate;
+    header.channels = pEngine->channels;
+    header.captureChannels = pEngine->captureChannels;
+    header.ringBufferFrames = pEngine->ringBufferSizeInFrames;
+    header.ringTargetFrames = ma_atomic_load_explicit_32(&pEngine->ringBufferTargetFrames, ma_atomic_memory_order_relaxed);
+    header.driftMode = (ma_uint32)pEngine->driftMode;
+    header.capturePeriodFrames = capturePeriodFrames;
+    header.playbackPeriodFrames = playbackPeriodFrames;
+    header.startNs = engine_now_ns(pEngine);
+    
+    if (ta_replay_open(&pEngine->trace, path, &header) != MA_SUCCESS) {
+        set_last_error(pEngine, TA_ERROR, L"Failed to create callback trace file");
+        return TA_ERROR;
+    }
+    return TA_SUCCESS;
+}
+
+static ma_thread_result MA_THREADCALL callback_trace_thread(void* pData) {
+    ta_engine* pEngine = (ta_engine*)pData;
+    
+    while (ma_atomic_load_explicit_32(&pEngine->traceState, ma_atomic_memory_order_acquire) == 1) {
+        ta_replay_drain(&pEngine->trace);
+        ma_sleep(TA_CALLBACK_TRACE_INTERVAL_MS);
+    }
+    return (ma_thread_result)0;
+}
+
+/* ==============================================================================
+ * PUBLIC API IMPLEMENTATION - "BARE METAL" EDITION
+ * ============================================================================== */
+
+TA_API ta_result TA_CALL ta_engine_create(ta_engine** ppEngine) {
+    if (!ppEngine) {
+        return TA_INVALID_ARGS;
+    }
+    
+    *ppEngine = NULL;
+    
+    /* ta_engine is cache-line aligned (see ta_capture_state/ta_playback_state) */
+    ta_engine* pEngine = (ta_engine*)ma_aligned_malloc(sizeof(ta_engine), TA_CACHE_LINE_SIZE, NULL);
+    if (!pEngine) {
+        return TA_OUT_OF_MEMORY;
+    }
+    memset(pEngine, 0, sizeof(ta_engine));
+    
+    pEngine->ownsMemory = 1;
+    reset_engine_state(pEngine);    /* Publishes the first (idle) telemetry snapshot */
+    *ppEngine = pEngine;
+    return TA_SUCCESS;
+}
+
+TA_API void TA_CALL ta_engine_destroy(ta_engine* pEngine) {
+    if (!pEngine) {
+        return;
+    }
+    
+    ta_engine_uninitialize(pEngine);
+    ta_arena_uninit(&pEngine->arena);   /* ta_sim_run allocates without Initialize */
+    ta_probe_free(&pEngine->probe);     /* ...and measures without a worker */
+    ta_replay_free(&pEngine->trace);    /* ...and records without one */
+    
+    /* The default instance is static storage and is never freed */
+    if (pEngine->ownsMemory) {
+        ma_aligned_free(pEngine, NULL);
+    }
+}
+
+static ta_result initialize_engine(ta_engine* pEngine, const ta_engine_config* config) {
+    ma_result result;
+    ta_result taResult;
+    ma_uint64 initializeBeginNs = ta_timing_now_ns();
+    ma_uint64 phaseNs;
+    ta_startup_timing timing;
+    
+    if (!pEngine) {
+        return TA_INVALID_ARGS;
+    }
+    
+    if (!config) {
+        set_last_error(pEngine, TA_INVALID_ARGS, L"Config is NULL");
+        return TA_INVALID_ARGS;
+    }
+    
+    if (engine_state(pEngine) != TA_ENGINE_UNINITIALIZED) {
+        set_last_error(pEngine, TA_DEVICE_ALREADY_INITIALIZED, L"Engine already initialized");
+        return TA_DEVICE_ALREADY_INITIALIZED;
+    }
+    
+    /* Callbacks registered before Initialize must survive the reset */
+    reset_engine_state(pEngine);
+    clear_startup_timing(&timing);
+    publish_startup_timing(pEngine, &timing);
+    
+    pEngine->volume = config->volume;
+    pEngine->driftMode = config->driftMode;
+    pEngine->telemetryIntervalMs = config->telemetryIntervalMs > 0
+        ? config->telemetryIntervalMs
+        : TA_DEFAULT_TELEMETRY_INTERVAL_MS;
+    pEngine->volumeRampMs = config->volumeRampMs > 0
+        ? config->volumeRampMs
+        : TA_DEFAULT_VOLUME_RAMP_MS;
+    pEngine->volumeRampCurve = config->volumeRampCurve;
+    pEngine->countPageFaults = config->countPageFaults ? 1 : 0;
+    ta_kernels_init(&pEngine->kernels);
+    ta_rt_install();
+    
+    taResult = init_channel_counts(pEngine, config);
+    if (taResult != TA_SUCCESS) {
+        return taResult;
+    }
+    
+    /* ==== INITIALIZE CONTEXT ==== */
+    
+    ma_context_config contextConfig = ma_context_config_init();
+    
+    TA_TRACE_BEGIN("context init");
+    phaseNs = ta_timing_now_ns();
+#if defined(_WIN32)
+    ma_backend backends[] = { ma_backend_wasapi };
+    result = ma_context_init(backends, 1, &contextConfig, &pEngine->context);
+#else
+    result = ma_context_init(NULL, 0, &contextConfig, &pEngine->context);
+#endif
+    timing.contextInitMs = ns_to_ms(ta_timing_now_ns() - phaseNs);
+    TA_TRACE_END();
+    if (result != MA_SUCCESS) {
+        set_last_error(pEngine, TA_FAILED_TO_INIT_BACKEND, L"Failed to initialize WASAPI backend");
+        return TA_FAILED_TO_INIT_BACKEND;
+    }
+    pEngine->parallelStartup = !config->sequentialStartup && backend_opens_devices_concurrently(&pEngine->context);
+    
+    /* ==== ENUMERATE DEVICES ==== */
+    
+    TA_TRACE_BEGIN("enumerate devices");
+    phaseNs = ta_timing_now_ns();
+    result = ma_context_get_devices(&pEngine->context, 
+        &pEngine->playbackDevices, &pEngine->playbackDeviceCount,
+        &pEngine->captureDevices, &pEngine->captureDeviceCount);
+    timing.enumerateMs = ns_to_ms(ta_timing_now_ns() - phaseNs);
+    TA_TRACE_END();
+    if (result != MA_SUCCESS) {
+        abandon_initialize(pEngine);
+        set_last_error(pEngine, TA_ERROR, L"Failed to enumerate devices");
+        return TA_ERROR;
+    }
+    
+    /* ==== FIND REQUESTED DEVICES ==== */
+    
+    ma_device_id captureId, playbackId;
+    int foundCapture = 0, foundPlayback = 0;
+    
+    if (wcslen(config->inputDeviceId) > 0) {
+        foundCapture = find_device_by_id(pEngine, config->inputDeviceId, ma_device_type_capture, &captureId);
+    }
+    if (wcslen(config->outputDeviceId) > 0) {
+        foundPlayback = find_device_by_id(pEngine, config->outputDeviceId, ma_device_type_playback, &playbackId);
+    }
+    
+    /* ==== DUPLEX FAST PATH (one device, one clock, no ring) ==== */
+    
+    int32_t topology = config->useDecoupledDevices;
+    
+    if (topology == TA_DEVICE_TOPOLOGY_DUPLEX ||
+        (topology == TA_DEVICE_TOPOLOGY_AUTO &&
+         endpoints_share_clock(pEngine, foundCapture ? &captureId : NULL, foundPlayback ? &playbackId : NULL))) {
+        TA_TRACE_BEGIN("duplex device init");
+        phaseNs = ta_timing_now_ns();
+        taResult = init_duplex_device(pEngine, config, foundCapture ? &captureId : NULL, foundPlayback ? &playbackId : NULL);
+        timing.deviceInitMs = ns_to_ms(ta_timing_now_ns() - phaseNs);
+        TA_TRACE_END();
+        if (taResult == TA_SUCCESS) {
+            taResult = init_glitch_capture(pEngine, config, pEngine->duplexDevice.sampleRate);
+            if (taResult != TA_SUCCESS) {
+                ma_device_uninit(&pEngine->duplexDevice);
+                uninit_route_conversion(pEngine);
+                abandon_initialize(pEngine);
+                return taResult;
+            }
+            lock_route_memory(pEngine);
+            timing.initializeMs = ns_to_ms(ta_timing_now_ns() - initializeBeginNs);
+            publish_startup_timing(pEngine, &timing);
+            set_last_error(pEngine, TA_SUCCESS, NULL);
+            set_engine_state(pEngine, TA_ENGINE_INITIALIZED);
+            return TA_SUCCESS;
+        }
+        if (topology == TA_DEVICE_TOPOLOGY_DUPLEX) {
+            abandon_initialize(pEngine);
+            return taResult;
+        }
+        /* AUTO: fall back to decoupled devices, reusing the arena blocks */
+        ta_arena_rewind(&pEngine->arena);
+    }
+    
+    /* ==== INITIALIZE ELASTIC RING BUFFER ==== */
+    
+    taResult = init_elastic_buffer(pEngine, config);
+    if (taResult != TA_SUCCESS) {
+        abandon_initialize(pEngine);
+        return taResult;
+    }
+    
+    /* ==== CONFIGURE CAPTURE DEVICE (Separate device #1) ==== */
+    
+    pEngine->captureConfig = ma_device_config_init(ma_device_type_capture);
+    pEngine->captureConfig.capture.pDeviceID = foundCapture ? &captureId : NULL;
+    pEngine->captureConfig.capture.format = device_format_from_config(config->format);
+    pEngine->captureConfig.capture.channels = pEngine->captureChannels;
+    pEngine->captureConfig.capture.shareMode = (config->shareMode == TA_SHARE_MODE_EXCLUSIVE) 
+        ? ma_share_mode_exclusive 
+        : ma_share_mode_shared;
+    
+    pEngine->captureConfig.dataCallback = capture_callback;
+    pEngine->captureConfig.notificationCallback = capture_notification_callback;
+    pEngine->captureConfig.pUserData = pEngine;
+    
+    /* Apply "Bare Metal" flags */
+    apply_bare_metal_config(&pEngine->captureConfig, config);
+    
+    /* ==== CONFIGURE PLAYBACK DEVICE (Separate device #2) ==== */
+    
+    pEngine->playbackConfig = ma_device_config_init(ma_device_type_playback);
+    pEngine->playbackConfig.playback.pDeviceID = foundPlayback ? &playbackId : NULL;
+    pEngine->playbackConfig.playback.format = device_format_from_config(config->format);
+    pEngine->playbackConfig.playback.channels = pEngine->channels;
+    pEngine->playbackConfig.playback.shareMode = (config->shareMode == TA_SHARE_MODE_EXCLUSIVE) 
+        ? ma_share_mode_exclusive 
+        : ma_share_mode_shared;
+    
+    pEngine->playbackConfig.dataCallback = playback_callback;
+    pEngine->playbackConfig.notificationCallback = playback_notification_callback;
+    pEngine->playbackConfig.pUserData = pEngine;
+    
+    /* Apply "Bare Metal" flags */
+    apply_bare_metal_config(&pEngine->playbackConfig, config);
+    
+    /* ==== OPEN BOTH DEVICES (concurrently when parallelStartup) ==== */
+    
+    ta_device_jobs opens;
+    run_device_jobs(pEngine, 0, &opens);
+    if (opens.capture.result != MA_SUCCESS || opens.playback.result != MA_SUCCESS) {
+        if (opens.capture.result == MA_SUCCESS) {
+            ma_device_uninit(&pEngine->captureDevice);
+        }
+        if (opens.playback.result == MA_SUCCESS) {
+            ma_device_uninit(&pEngine->playbackDevice);
+        }
+        uninit_elastic_buffer(pEngine);
+        abandon_initialize(pEngine);
+        set_last_error(pEngine, TA_FAILED_TO_OPEN_BACKEND_DEVICE, opens.capture.result != MA_SUCCESS
+            ? L"Failed to initialize capture device"
+            : L"Failed to initialize playback device");
+        return TA_FAILED_TO_OPEN_BACKEND_DEVICE;
+    }
+    timing.parallel = opens.parallel;
+    timing.deviceInitMs = ns_to_ms(opens.elapsedNs);
+    timing.captureInitMs = ns_to_ms(opens.capture.elapsedNs);
+    timing.playbackInitMs = ns_to_ms(opens.playback.elapsedNs);
+    
+    /* ==== FORMAT CONVERSION AND CHANNEL MAP ==== */
+    
+    taResult = init_route_conversion(pEngine, config,
+        pEngine->captureDevice.capture.format, pEngine->playbackDevice.playback.format,
+        pEngine->captureDevice.capture.internalPeriodSizeInFrames * pEngine->captureDevice.capture.internalPeriods,
+        pEngine->playbackDevice.playback.internalPeriodSizeInFrames * pEngine->playbackDevice.playback.internalPeriods);
+    if (taResult != TA_SUCCESS) {
+        ma_device_uninit(&pEngine->playbackDevice);
+        ma_device_uninit(&pEngine->captureDevice);
+        uninit_elastic_buffer(pEngine);
+        abandon_initialize(pEngine);
+        return taResult;
+    }
+    
+    taResult = init_glitch_capture(pEngine, config, pEngine->playbackDevice.sampleRate);
+    if (taResult != TA_SUCCESS) {
+        ma_device_uninit(&pEngine->playbackDevice);
+        ma_device_uninit(&pEngine->captureDevice);
+        uninit_route_conversion(pEngine);
+        uninit_elastic_buffer(pEngine);
+        abandon_initialize(pEngine);
+        return taResult;
+    }
+    
+    lock_route_memory(pEngine);
+    timing.initializeMs = ns_to_ms(ta_timing_now_ns() - initializeBeginNs);
+    publish_startup_timing(pEngine, &timing);
+    set_last_error(pEngine, TA_SUCCESS, NULL);
+    set_engine_state(pEngine, TA_ENGINE_INITIALIZED);
+    
+    return TA_SUCCESS;
+}
+
+TA_API ta_result TA_CALL ta_engine_initialize(ta_engine* pEngine, const ta_engine_config* config) {
+    TA_TRACE_INIT();
+    TA_TRACE_BEGIN("Initialize");
+    ta_result result = initialize_engine(pEngine, config);
+    TA_TRACE_END();
+    return result;
+}
+
+static ta_result start_engine(ta_engine* pEngine) {
+    if (!pEngine) {
+        return TA_INVALID_ARGS;
+    }
+    
+    ta_engine_state state;
+    if (!claim_transition(pEngine, TA_ENGINE_INITIALIZED, TA_ENGINE_STARTING, &state)) {
+        if (state == TA_ENGINE_RUNNING) {
+            return TA_SUCCESS;  /* Already running */
+        }
+        set_last_error(pEngine, TA_DEVICE_NOT_INITIALIZED, L"Engine not initialized");
         return TA_DEVICE_NOT_INITIALIZED;
     }
+    ma_uint64 startBeginNs = begin_start_timing(pEngine);
     
-    if (!g_engine.running) {
-        return TA_SUCCESS;  /* Already stopped */
+    /* Callbacks are delivered from here on (until Uninitialize) */
+    if (start_event_dispatcher(pEngine) != TA_SUCCESS) {
+        set_engine_state(pEngine, TA_ENGINE_INITIALIZED);
+        return TA_ERROR;
     }
+    start_glitch_writer(pEngine);
     
-    /* Stop playback first (consumer), then capture (producer) */
-    ma_device_stop(&g_engine.playbackDevice);
-    ma_device_stop(&g_engine.captureDevice);
+    /* Register for MMCSS "Pro Audio" scheduling */
+    begin_pro_audio_priority(pEngine);
     
-    /* Revert MMCSS */
-    if (g_engine.mmcssHandle) {
-        AvRevertMmThreadCharacteristics(g_engine.mmcssHandle);
-        g_engine.mmcssHandle = NULL;
+    ma_result result;
+    
+    if (pEngine->duplex) {
+        /* No ring to prime; input reaches the output in the same callback */
+        reset_stream_statistics(pEngine);
+        prime_volume(pEngine, pEngine->duplexDevice.sampleRate);
+        prime_telemetry(pEngine, pEngine->duplexDevice.playback.internalSampleRate,
+            pEngine->duplexDevice.capture.internalPeriodSizeInFrames,
+            pEngine->duplexDevice.playback.internalPeriodSizeInFrames);
+        
+        TA_TRACE_BEGIN("start duplex device");
+        ma_uint64 deviceStartNs = ta_timing_now_ns();
+        result = ma_device_start(&pEngine->duplexDevice);
+        deviceStartNs = ta_timing_now_ns() - deviceStartNs;
+        TA_TRACE_END();
+        if (result != MA_SUCCESS) {
+            end_pro_audio_priority(pEngine);
+            set_last_error(pEngine, TA_FAILED_TO_START_BACKEND_DEVICE, L"Failed to start duplex device");
+            set_engine_state(pEngine, TA_ENGINE_INITIALIZED);
+            return TA_FAILED_TO_START_BACKEND_DEVICE;
+        }
+        
+        finish_start_timing(pEngine, startBeginNs, deviceStartNs, NULL);
+        notify_state_changed(pEngine, 1);
+        set_last_error(pEngine, TA_SUCCESS, NULL);
+        set_engine_state(pEngine, TA_ENGINE_RUNNING);
+        return TA_SUCCESS;
     }
     
-    g_engine.running = 0;
+    /* Reset statistics, pre-fill the ring and settle the drift loop */
+    TA_TRACE_BEGIN("prime");
+    prime_elastic_buffer(pEngine, pEngine->playbackDevice.sampleRate);
+    prime_volume(pEngine, pEngine->captureDevice.sampleRate);
+    prime_telemetry(pEngine, pEngine->playbackDevice.playback.internalSampleRate,
+        pEngine->captureDevice.capture.internalPeriodSizeInFrames,
+        pEngine->playbackDevice.playback.internalPeriodSizeInFrames);
+    TA_TRACE_END();
     
-    if (g_engine.stateChangedCallback) {
-        g_engine.stateChangedCallback(0);
+    /*
+     * Start both devices (concurrently when parallelStartup). Either may
+     * come up first: the pre-fill covers playback until capture delivers,
+     * and capture has the ring's free half before it could overrun.
+     */
+    ta_device_jobs starts;
+    run_device_jobs(pEngine, 1, &starts);
+    if (starts.capture.result != MA_SUCCESS || starts.playback.result != MA_SUCCESS) {
+        if (starts.playback.result == MA_SUCCESS) {
+            ma_device_stop(&pEngine->playbackDevice);
+        }
+        if (starts.capture.result == MA_SUCCESS) {
+            ma_device_stop(&pEngine->captureDevice);
+        }
+        end_pro_audio_priority(pEngine);
+        set_last_error(pEngine, TA_FAILED_TO_START_BACKEND_DEVICE, starts.capture.result != MA_SUCCESS
+            ? L"Failed to start capture device"
+            : L"Failed to start playback device");
+        set_engine_state(pEngine, TA_ENGINE_INITIALIZED);
+        return TA_FAILED_TO_START_BACKEND_DEVICE;
     }
+    finish_start_timing(pEngine, startBeginNs, starts.elapsedNs, &starts);
     
-    set_last_error(TA_SUCCESS, NULL);
+    notify_state_changed(pEngine, 1);
+    set_last_error(pEngine, TA_SUCCESS, NULL);
+    
+    /* Last: callbacks stream, and the next Stop may begin, once this is visible */
+    set_engine_state(pEngine, TA_ENGINE_RUNNING);
     return TA_SUCCESS;
 }
 
-TA_API ta_result TA_CALL AudioEngine_Uninitialize(void) {
-    if (!g_engine.initialized) {
-        return TA_SUCCESS;  /* Nothing to uninitialize */
+TA_API ta_result TA_CALL ta_engine_start(ta_engine* pEngine) {
+    TA_TRACE_BEGIN("Start");
+    ta_result result = start_engine(pEngine);
+    TA_TRACE_END();
+    return result;
+}
+
+/*
+ * Stop path shared by Stop and a lost device (STOPPING held by the
+ * caller): both devices down, MMCSS reverted, final counters published.
+ */
+static void stop_devices(ta_engine* pEngine) {
+    if (pEngine->duplex) {
+        ma_device_stop(&pEngine->duplexDevice);
+    } else {
+        /* Stop playback first (consumer), then capture (producer) */
+        ma_device_stop(&pEngine->playbackDevice);
+        ma_device_stop(&pEngine->captureDevice);
     }
     
-    if (g_engine.running) {
-        AudioEngine_Stop();
+    /* Revert MMCSS */
+    end_pro_audio_priority(pEngine);
+    
+    /* A dump still recording its tail goes to the writer as it is */
+    ta_glitch_flush(&pEngine->glitch);
+    
+    /* Callbacks have stopped; publish the final counters as not running */
+    publish_telemetry(pEngine);
+    
+    notify_state_changed(pEngine, 0);
+}
+
+static ta_result stop_engine(ta_engine* pEngine) {
+    if (!pEngine) {
+        return TA_INVALID_ARGS;
     }
     
-    /* Uninitialize both devices */
-    ma_device_uninit(&g_engine.playbackDevice);
-    ma_device_uninit(&g_engine.captureDevice);
+    ta_engine_state state;
+    if (!claim_transition(pEngine, TA_ENGINE_RUNNING, TA_ENGINE_STOPPING, &state)) {
+        if (state == TA_ENGINE_INITIALIZED) {
+            return TA_SUCCESS;  /* Already stopped */
+        }
+        set_last_error(pEngine, TA_DEVICE_NOT_INITIALIZED, L"Engine not initialized");
+        return TA_DEVICE_NOT_INITIALIZED;
+    }
     
-    /* Free ring buffer */
-    ma_pcm_rb_uninit(&g_engine.ringBuffer);
-    if (g_engine.ringBufferMemory) {
-        free(g_engine.ringBufferMemory);
-        g_engine.ringBufferMemory = NULL;
+    /* Fade to silence first so stopping never clicks */
+    fade_out_before_stop(pEngine);
+    
+    stop_devices(pEngine);
+    set_last_error(pEngine, TA_SUCCESS, NULL);
+    
+    /* Last: the next Start may begin as soon as this is visible */
+    set_engine_state(pEngine, TA_ENGINE_INITIALIZED);
+    return TA_SUCCESS;
+}
+
+/* Dispatcher thread, engine held in STOPPING by note_unrequested_stop */
+static void handle_device_lost(ta_engine* pEngine) {
+    /* The lost device has stopped already; no fade, its side is silent */
+    stop_devices(pEngine);
+    set_engine_state(pEngine, TA_ENGINE_INITIALIZED);
+}
+
+TA_API ta_result TA_CALL ta_engine_stop(ta_engine* pEngine) {
+    TA_TRACE_BEGIN("Stop");
+    ta_result result = stop_engine(pEngine);
+    TA_TRACE_END();
+    return result;
+}
+
+TA_API ta_result TA_CALL ta_engine_uninitialize(ta_engine* pEngine) {
+    if (!pEngine || engine_state(pEngine) == TA_ENGINE_UNINITIALIZED) {
+        return TA_SUCCESS;  /* Nothing to uninitialize */
     }
     
-    ma_context_uninit(&g_engine.context);
+    /* No-op unless running; lets a Start or Stop still in flight finish first */
+    ta_engine_stop(pEngine);
+    stop_latency_measurement(pEngine);
+    stop_glitch_writer(pEngine);
+    ta_engine_stop_callback_trace(pEngine);
+    ta_replay_free(&pEngine->trace);
+    
+    /* Unlock this struct and a mirrored ring while both still exist */
+    ta_arena_unlock_regions(&pEngine->arena);
+    
+    if (pEngine->duplex) {
+        ma_device_uninit(&pEngine->duplexDevice);
+    } else {
+        /* Uninitialize both devices */
+        ma_device_uninit(&pEngine->playbackDevice);
+        ma_device_uninit(&pEngine->captureDevice);
+        
+        /* Free ring buffer and resampler scratch */
+        uninit_elastic_buffer(pEngine);
+    }
+    uninit_route_conversion(pEngine);
+    TA_TRACE_RETIRE(pEngine);   /* Device threads have been joined */
     
-    g_engine.initialized = 0;
-    memset(&g_engine, 0, sizeof(ta_engine));
+    ma_context_uninit(&pEngine->context);
+    
+    /* Devices are gone: deliver their last notifications, then join */
+    stop_event_dispatcher(pEngine);
+    
+    /* Everything allocated from the arena has been released above */
+    ta_arena_uninit(&pEngine->arena);
+    
+    set_engine_state(pEngine, TA_ENGINE_UNINITIALIZED);
+    
+    reset_engine_state(pEngine);
     
     return TA_SUCCESS;
 }
 
-TA_API ta_result TA_CALL AudioEngine_SetVolume(float volume) {
+TA_API ta_result TA_CALL ta_engine_set_volume(ta_engine* pEngine, float volume) {
+    if (!pEngine) {
+        return TA_INVALID_ARGS;
+    }
+    
     if (volume < 0.0f) volume = 0.0f;
     if (volume > 1.0f) volume = 1.0f;
     
-    g_engine.volume = volume;
+    /* The capture side ramps to it over volumeRampMs */
+    ma_atomic_store_explicit_f32(&pEngine->volume, volume, ma_atomic_memory_order_relaxed);
     return TA_SUCCESS;
 }
 
-TA_API float TA_CALL AudioEngine_GetVolume(void) {
-    return g_engine.volume;
+TA_API float TA_CALL ta_engine_get_volume(ta_engine* pEngine) {
+    if (!pEngine) {
+        return 0.0f;
+    }
+    
+    return engine_volume(pEngine);
 }
 
-TA_API ta_result TA_CALL AudioEngine_GetStatus(ta_engine_status* status) {
-    if (!status) {
+TA_API ta_result TA_CALL ta_engine_get_status(ta_engine* pEngine, ta_engine_status* status) {
+    if (!pEngine || !status) {
         return TA_INVALID_ARGS;
     }
     
-    status->isRunning = g_engine.running ? 1 : 0;
-    status->currentVolume = g_engine.volume;
-    status->underrunCount = g_engine.underrunCount;
-    status->overrunCount = g_engine.overrunCount;
-    status->lastError = g_engine.lastError;
-    status->driftCorrectionCount = g_engine.driftCorrectionCount;
-    
-    if (g_engine.initialized) {
+    ta_engine_state state = engine_state(pEngine);
+    int initialized = (state != TA_ENGINE_UNINITIALIZED);
+    ma_uint64 underrunCount = read_count(&pEngine->playback.underrunCount);
+    ma_uint64 overrunCount = read_count(&pEngine->capture.overrunCount);
+    ma_uint64 driftCorrectionCount = read_count(&pEngine->playback.driftCorrectionCount);
+    
+    status->isRunning = (state == TA_ENGINE_RUNNING) ? 1 : 0;
+    status->currentVolume = engine_volume(pEngine);
+    status->underrunCount = (uint32_t)underrunCount;
+    status->overrunCount = (uint32_t)overrunCount;
+    status->lastError = (ta_result)ma_atomic_load_explicit_32(&pEngine->lastError, ma_atomic_memory_order_acquire);
+    status->driftCorrectionCount = (uint32_t)driftCorrectionCount;
+    status->ringBufferMirrored = (initialized && pEngine->ring.layout.isMirrored) ? 1 : 0;
+    status->driftPpm = ma_atomic_load_explicit_f32(&pEngine->playback.driftPpm, ma_atomic_memory_order_relaxed);
+    status->duplex = pEngine->duplex;
+    status->captureFormat = initialized ? ta_format_from_device(pEngine->captureFormat) : TA_FORMAT_UNKNOWN;
+    status->playbackFormat = initialized ? ta_format_from_device(pEngine->playbackFormat) : TA_FORMAT_UNKNOWN;
+    status->targetLatencyMs = 0.0f;
+    status->learnedFloorLatencyMs = 0.0f;
+    status->droppedEventCount = pEngine->events.droppedCount;
+    status->reserved = 0;
+    status->underrunCount64 = underrunCount;
+    status->overrunCount64 = overrunCount;
+    status->driftCorrectionCount64 = driftCorrectionCount;
+    status->arenaBytes = (uint64_t)pEngine->arena.residentBytes;
+    status->capturePageFaults = read_count(&pEngine->capture.pageFaults);
+    status->playbackPageFaults = read_count(&pEngine->playback.pageFaults);
+    status->arenaLocked = ta_arena_is_locked(&pEngine->arena);
+    status->countingPageFaults = pEngine->countPageFaults;
+    status->glitchDumpCount = ma_atomic_load_explicit_32(&pEngine->glitch.dumpCount, ma_atomic_memory_order_relaxed);
+    status->glitchDroppedCount = ma_atomic_load_explicit_32(&pEngine->glitch.droppedCount, ma_atomic_memory_order_relaxed);
+    status->callbackTraceActive = ma_atomic_load_explicit_32(&pEngine->traceState, ma_atomic_memory_order_relaxed) == 1;
+    status->callbackTraceDropped = ma_atomic_load_explicit_32(&pEngine->trace.droppedCount, ma_atomic_memory_order_relaxed);
+    status->callbackTraceRecords = ma_atomic_load_explicit_64(&pEngine->trace.writtenCount, ma_atomic_memory_order_relaxed);
+    
+    if (initialized) {
+        ma_device* pCaptureSide = pEngine->duplex ? &pEngine->duplexDevice : &pEngine->captureDevice;
+        ma_device* pPlaybackSide = pEngine->duplex ? &pEngine->duplexDevice : &pEngine->playbackDevice;
+        
         /* Calculate ring buffer fill level */
-        ma_uint32 availableRead = ma_pcm_rb_available_read(&g_engine.ringBuffer);
-        if (g_engine.ringBufferSizeInFrames > 0) {
-            status->ringBufferFillLevel = (float)availableRead / (float)g_engine.ringBufferSizeInFrames;
+        ma_uint32 availableRead = ta_ring_fill(&pEngine->ring);
+        if (pEngine->ringBufferSizeInFrames > 0) {
+            status->ringBufferFillLevel = (float)availableRead / (float)pEngine->ringBufferSizeInFrames;
         } else {
             status->ringBufferFillLevel = 0.0f;
         }
         status->bufferFillLevel = status->ringBufferFillLevel;
         
         /* Calculate approximate latency from playback device */
-        ma_uint32 periodSize = g_engine.playbackDevice.playback.internalPeriodSizeInFrames;
-        ma_uint32 sampleRate = g_engine.playbackDevice.playback.internalSampleRate;
+        ma_uint32 periodSize = pPlaybackSide->playback.internalPeriodSizeInFrames;
+        ma_uint32 sampleRate = pPlaybackSide->playback.internalSampleRate;
         if (sampleRate > 0) {
             /* Total latency = ring buffer fill + playback period */
             float ringBufferLatencyMs = (float)(availableRead * 1000) / sampleRate;
@@ -775,8 +2933,15 @@ TA_API ta_result TA_CALL AudioEngine_GetStatus(ta_engine_status* status) {
             status->actualLatencyMs = ringBufferLatencyMs + periodLatencyMs;
             
             /* Separate latency components */
-            status->captureLatencyMs = (float)(g_engine.captureDevice.capture.internalPeriodSizeInFrames * 1000) / sampleRate;
+            status->captureLatencyMs = (float)(pCaptureSide->capture.internalPeriodSizeInFrames * 1000) / sampleRate;
             status->playbackLatencyMs = periodLatencyMs;
+            
+            if (!pEngine->duplex) {
+                ma_uint32 targetFrames = ma_atomic_load_explicit_32(&pEngine->ringBufferTargetFrames, ma_atomic_memory_order_relaxed);
+                ma_uint32 floorFrames = ma_atomic_load_explicit_32(&pEngine->playback.latencyFloorFrames, ma_atomic_memory_order_relaxed);
+                status->targetLatencyMs = (float)targetFrames * 1000.0f / sampleRate;
+                status->learnedFloorLatencyMs = (float)floorFrames * 1000.0f / sampleRate;
+            }
         } else {
             status->actualLatencyMs = 0.0f;
             status->captureLatencyMs = 0.0f;
@@ -793,47 +2958,323 @@ TA_API ta_result TA_CALL AudioEngine_GetStatus(ta_engine_status* status) {
     return TA_SUCCESS;
 }
 
-TA_API int32_t TA_CALL AudioEngine_IsRunning(void) {
-    return g_engine.running ? 1 : 0;
+TA_API int32_t TA_CALL ta_engine_is_running(ta_engine* pEngine) {
+    if (!pEngine) {
+        return 0;
+    }
+    
+    return (engine_state(pEngine) == TA_ENGINE_RUNNING) ? 1 : 0;
+}
+
+/* Snapshot one callback timer (zeros while a reset is still pending) */
+static void get_callback_timing(ta_callback_timer* pTimer, ta_callback_timing* pTiming) {
+    memset(pTiming, 0, sizeof(ta_callback_timing));
+    
+    if (pTimer->resetRequest != pTimer->resetAck) {
+        return;
+    }
+    
+    const ta_histogram* histograms[3] = { &pTimer->executionNs, &pTimer->intervalNs, &pTimer->frames };
+    ta_timing_percentiles* outputs[3] = { &pTiming->executionUs, &pTiming->intervalUs, &pTiming->frames };
+    const float scales[3] = { 1e-3f, 1e-3f, 1.0f };   /* ns -> us, frames as-is */
+    
+    for (int i = 0; i < 3; i++) {
+        ma_uint64 count;
+        ma_uint32 p50, p99, p999, maxValue;
+        ta_histogram_percentiles(histograms[i], &count, &p50, &p99, &p999, &maxValue);
+        outputs[i]->count = count;
+        outputs[i]->p50 = (float)p50 * scales[i];
+        outputs[i]->p99 = (float)p99 * scales[i];
+        outputs[i]->p999 = (float)p999 * scales[i];
+        outputs[i]->max = (float)maxValue * scales[i];
+    }
+    
+    pTiming->dspLoadPercent = pTimer->dspLoad * 100.0f;
+    pTiming->dspLoadPeakPercent = pTimer->dspLoadPeak * 100.0f;
+}
+
+TA_API ta_result TA_CALL ta_engine_get_timing_stats(ta_engine* pEngine, ta_timing_stats* stats) {
+    if (!pEngine || !stats) {
+        return TA_INVALID_ARGS;
+    }
+    
+    get_callback_timing(&pEngine->capture.timer, &stats->capture);
+    get_callback_timing(&pEngine->playback.timer, &stats->playback);
+    
+    return TA_SUCCESS;
+}
+
+TA_API ta_result TA_CALL ta_engine_reset_timing_stats(ta_engine* pEngine) {
+    if (!pEngine) {
+        return TA_INVALID_ARGS;
+    }
+    
+    /* The callbacks own the histograms; they clear on their next run */
+    ta_callback_timer_request_reset(&pEngine->capture.timer);
+    ta_callback_timer_request_reset(&pEngine->playback.timer);
+    
+    return TA_SUCCESS;
+}
+
+TA_API ta_result TA_CALL ta_engine_get_rt_violations(ta_engine* pEngine, ta_rt_report* report) {
+    if (!pEngine || !report) {
+        return TA_INVALID_ARGS;
+    }
+    
+    memset(report, 0, sizeof(ta_rt_report));
+#if defined(TA_ENABLE_RT_CHECKS)
+    report->enabled = 1;
+#endif
+    report->violationCount = ma_atomic_load_explicit_64(&pEngine->rtMonitor.violationCount, ma_atomic_memory_order_relaxed);
+    
+    /* A slot still being filled by a callback is skipped, not waited for */
+    for (ma_uint32 i = 0; i < TA_RT_MAX_RECORDS; i++) {
+        const ta_rt_record* pRecord = &pEngine->rtMonitor.records[i];
+        if (!ma_atomic_load_explicit_32(&pRecord->ready, ma_atomic_memory_order_acquire)) {
+            continue;
+        }
+        ta_rt_violation* pViolation = &report->violations[report->recordedCount++];
+        pViolation->kind = (int32_t)pRecord->kind;
+        pViolation->thread = (int32_t)pRecord->thread;
+        snprintf(pViolation->call, sizeof(pViolation->call), "%s", pRecord->call);
+        ta_rt_format_stack(pRecord, pViolation->stack, sizeof(pViolation->stack));
+    }
+    
+    return TA_SUCCESS;
+}
+
+TA_API ta_result TA_CALL ta_engine_start_latency_measurement(ta_engine* pEngine, const ta_latency_probe_config* config) {
+    if (!pEngine) {
+        return TA_INVALID_ARGS;
+    }
+    
+    ma_uint32 idle = 0;
+    if (!ma_atomic_compare_exchange_strong_explicit_32(&pEngine->latencyRunning, &idle, 1,
+            ma_atomic_memory_order_acquire, ma_atomic_memory_order_relaxed)) {
+        set_last_error(pEngine, TA_INVALID_OPERATION, L"Latency measurement already running");
+        return TA_INVALID_OPERATION;
+    }
+    
+    if (engine_state(pEngine) != TA_ENGINE_RUNNING) {
+        ma_atomic_store_explicit_32(&pEngine->latencyRunning, 0, ma_atomic_memory_order_release);
+        set_last_error(pEngine, TA_DEVICE_NOT_STARTED, L"Engine not running");
+        return TA_DEVICE_NOT_STARTED;
+    }
+    
+    /* The previous worker cleared latencyRunning as its last step */
+    if (pEngine->latencyThreadStarted) {
+        ma_thread_wait(&pEngine->latencyThread);
+        pEngine->latencyThreadStarted = 0;
+    }
+    
+    ta_result result = arm_latency_measurement(pEngine, config);
+    if (result != TA_SUCCESS) {
+        ma_atomic_store_explicit_32(&pEngine->latencyRunning, 0, ma_atomic_memory_order_release);
+        return result;
+    }
+    
+    if (ma_thread_create(&pEngine->latencyThread, ma_thread_priority_default, 0,
+            latency_measurement_thread, pEngine, NULL) != MA_SUCCESS) {
+        ta_probe_disarm(&pEngine->probe);
+        ma_spinlock_lock(&pEngine->latencyLock);
+        pEngine->latencyResult.state = TA_LATENCY_MEASUREMENT_FAILED;
+        pEngine->latencyResult.error = TA_ERROR;
+        ma_spinlock_unlock(&pEngine->latencyLock);
+        ma_atomic_store_explicit_32(&pEngine->latencyRunning, 0, ma_atomic_memory_order_release);
+        set_last_error(pEngine, TA_ERROR, L"Failed to start latency measurement thread");
+        return TA_ERROR;
+    }
+    pEngine->latencyThreadStarted = 1;
+    return TA_SUCCESS;
+}
+
+TA_API ta_result TA_CALL ta_engine_get_latency_measurement(ta_engine* pEngine, ta_latency_measurement* measurement) {
+    if (!pEngine || !measurement) {
+        return TA_INVALID_ARGS;
+    }
+    
+    ma_spinlock_lock(&pEngine->latencyLock);
+    *measurement = pEngine->latencyResult;
+    ma_spinlock_unlock(&pEngine->latencyLock);
+    return TA_SUCCESS;
+}
+
+#ifdef TA_ENABLE_NULL_BACKEND
+TA_API ta_result TA_CALL ta_engine_simulate_device_loss(ta_engine* pEngine, int32_t device) {
+    if (!pEngine || (device != TA_SIM_DEVICE_CAPTURE && device != TA_SIM_DEVICE_PLAYBACK)) {
+        return TA_INVALID_ARGS;
+    }
+    
+    if (engine_state(pEngine) != TA_ENGINE_RUNNING) {
+        set_last_error(pEngine, TA_DEVICE_NOT_STARTED, L"Engine not running");
+        return TA_DEVICE_NOT_STARTED;
+    }
+    
+    ma_device* pDevice = &pEngine->duplexDevice;
+    if (!pEngine->duplex) {
+        pDevice = (device == TA_SIM_DEVICE_CAPTURE) ? &pEngine->captureDevice : &pEngine->playbackDevice;
+    }
+    
+    /* The stopped notification takes it from here, as for a real loss */
+    return (ma_device_stop(pDevice) == MA_SUCCESS) ? TA_SUCCESS : TA_ERROR;
+}
+#endif
+
+static float first_callback_ms(const volatile ma_uint64* pStamp, ma_uint64 startBeginNs) {
+    ma_uint64 stampNs = ma_atomic_load_explicit_64(pStamp, ma_atomic_memory_order_relaxed);
+    return (stampNs != 0 && stampNs >= startBeginNs) ? ns_to_ms(stampNs - startBeginNs) : -1.0f;
+}
+
+TA_API ta_result TA_CALL ta_engine_get_startup_timing(ta_engine* pEngine, ta_startup_timing* timing) {
+    if (!pEngine || !timing) {
+        return TA_INVALID_ARGS;
+    }
+    
+    ma_spinlock_lock(&pEngine->startupLock);
+    *timing = pEngine->startupTiming;
+    ma_uint64 startBeginNs = pEngine->startBeginNs;
+    ma_spinlock_unlock(&pEngine->startupLock);
+    
+    if (startBeginNs != 0) {
+        timing->firstCaptureMs = first_callback_ms(&pEngine->firstCaptureNs, startBeginNs);
+        timing->firstPlaybackMs = first_callback_ms(&pEngine->firstPlaybackNs, startBeginNs);
+        timing->firstSampleMs = first_callback_ms(&pEngine->firstSampleNs, startBeginNs);
+    }
+    return TA_SUCCESS;
+}
+
+TA_API ta_result TA_CALL ta_engine_start_callback_trace(ta_engine* pEngine, const wchar_t* path) {
+    if (!pEngine || !path || !path[0]) {
+        return TA_INVALID_ARGS;
+    }
+    
+    if (engine_state(pEngine) == TA_ENGINE_UNINITIALIZED) {
+        set_last_error(pEngine, TA_DEVICE_NOT_INITIALIZED, L"Engine not initialized");
+        return TA_DEVICE_NOT_INITIALIZED;
+    }
+    if (pEngine->duplex) {
+        set_last_error(pEngine, TA_INVALID_OPERATION, L"Callback traces need the decoupled topology (duplex has no ring)");
+        return TA_INVALID_OPERATION;
+    }
+    
+    ma_uint32 idle = 0;
+    if (!ma_atomic_compare_exchange_strong_explicit_32(&pEngine->traceState, &idle, 1,
+            ma_atomic_memory_order_acquire, ma_atomic_memory_order_relaxed)) {
+        set_last_error(pEngine, TA_INVALID_OPERATION, L"Callback trace already recording");
+        return TA_INVALID_OPERATION;
+    }
+    
+    ta_result result = begin_callback_trace(pEngine, path, pEngine->playbackDevice.sampleRate,
+        pEngine->captureDevice.capture.internalPeriodSizeInFrames,
+        pEngine->playbackDevice.playback.internalPeriodSizeInFrames);
+    if (result != TA_SUCCESS) {
+        ma_atomic_store_explicit_32(&pEngine->traceState, 0, ma_atomic_memory_order_release);
+        return result;
+    }
+    
+    if (ma_thread_create(&pEngine->traceThread, ma_thread_priority_default, 0,
+            callback_trace_thread, pEngine, NULL) != MA_SUCCESS) {
+        ta_replay_close(&pEngine->trace);
+        ma_atomic_store_explicit_32(&pEngine->traceState, 0, ma_atomic_memory_order_release);
+        set_last_error(pEngine, TA_ERROR, L"Failed to start callback trace thread");
+        return TA_ERROR;
+    }
+    pEngine->traceThreadStarted = 1;
+    return TA_SUCCESS;
+}
+
+TA_API ta_result TA_CALL ta_engine_stop_callback_trace(ta_engine* pEngine) {
+    if (!pEngine) {
+        return TA_INVALID_ARGS;
+    }
+    
+    ma_uint32 recording = 1;
+    if (!ma_atomic_compare_exchange_strong_explicit_32(&pEngine->traceState, &recording, 2,
+            ma_atomic_memory_order_acquire, ma_atomic_memory_order_relaxed)) {
+        return TA_SUCCESS;  /* Not recording (or another thread is stopping it) */
+    }
+    
+    /* Callbacks stop appending first; joining the writer gives one still appending time to leave */
+    ma_atomic_store_explicit_32(&pEngine->trace.active, 0, ma_atomic_memory_order_release);
+    if (pEngine->traceThreadStarted) {
+        ma_thread_wait(&pEngine->traceThread);
+        pEngine->traceThreadStarted = 0;
+    }
+    
+    ta_result result = TA_SUCCESS;
+    if (ta_replay_close(&pEngine->trace) != MA_SUCCESS) {
+        set_last_error(pEngine, TA_ERROR, L"Failed to complete callback trace file");
+        result = TA_ERROR;
+    }
+    ma_atomic_store_explicit_32(&pEngine->traceState, 0, ma_atomic_memory_order_release);
+    return result;
+}
+
+TA_API const ta_telemetry* TA_CALL ta_engine_get_telemetry(ta_engine* pEngine) {
+    if (!pEngine) {
+        return NULL;
+    }
+    
+    /* Lives as long as the engine; valid across Initialize/Uninitialize */
+    return &pEngine->telemetry;
 }
 
 /* ==============================================================================
  * CALLBACK REGISTRATION
  * ============================================================================== */
 
-TA_API void TA_CALL AudioEngine_SetErrorCallback(ta_error_callback callback) {
-    g_engine.errorCallback = callback;
+TA_API void TA_CALL ta_engine_set_error_callback(ta_engine* pEngine, ta_error_callback callback) {
+    if (!pEngine) {
+        return;
+    }
+    
+    pEngine->errorCallback = callback;
 }
 
-TA_API void TA_CALL AudioEngine_SetDeviceDisconnectedCallback(ta_device_disconnected_callback callback) {
-    g_engine.deviceDisconnectedCallback = callback;
+TA_API void TA_CALL ta_engine_set_device_disconnected_callback(ta_engine* pEngine, ta_device_disconnected_callback callback) {
+    if (!pEngine) {
+        return;
+    }
+    
+    pEngine->deviceDisconnectedCallback = callback;
 }
 
-TA_API void TA_CALL AudioEngine_SetStateChangedCallback(ta_state_changed_callback callback) {
-    g_engine.stateChangedCallback = callback;
+TA_API void TA_CALL ta_engine_set_state_changed_callback(ta_engine* pEngine, ta_state_changed_callback callback) {
+    if (!pEngine) {
+        return;
+    }
+    
+    pEngine->stateChangedCallback = callback;
 }
 
 /* ==============================================================================
  * DEVICE ENUMERATION
  * ============================================================================== */
 
-TA_API int32_t TA_CALL AudioEngine_GetCaptureDeviceCount(void) {
-    return (int32_t)g_engine.captureDeviceCount;
+TA_API int32_t TA_CALL ta_engine_get_capture_device_count(ta_engine* pEngine) {
+    if (!pEngine) {
+        return 0;
+    }
+    
+    return (int32_t)pEngine->captureDeviceCount;
 }
 
-TA_API int32_t TA_CALL AudioEngine_GetPlaybackDeviceCount(void) {
-    return (int32_t)g_engine.playbackDeviceCount;
+TA_API int32_t TA_CALL ta_engine_get_playback_device_count(ta_engine* pEngine) {
+    if (!pEngine) {
+        return 0;
+    }
+    
+    return (int32_t)pEngine->playbackDeviceCount;
 }
 
-TA_API ta_result TA_CALL AudioEngine_GetCaptureDeviceInfo(int32_t index, ta_device_info* info) {
-    if (!info || index < 0 || index >= (int32_t)g_engine.captureDeviceCount) {
+TA_API ta_result TA_CALL ta_engine_get_capture_device_info(ta_engine* pEngine, int32_t index, ta_device_info* info) {
+    if (!pEngine || !info || index < 0 || index >= (int32_t)pEngine->captureDeviceCount) {
         return TA_INVALID_ARGS;
     }
     
-    ma_device_info* device = &g_engine.captureDevices[index];
+    ma_device_info* device = &pEngine->captureDevices[index];
     
-    wcsncpy(info->id, device->id.wasapi, 255);
-    info->id[255] = L'\0';
+    get_device_id_string(device, info->id, 256);
     
     /* Convert name from char to wchar_t */
     mbstowcs(info->name, device->name, 255);
@@ -846,15 +3287,14 @@ TA_API ta_result TA_CALL AudioEngine_GetCaptureDeviceInfo(int32_t index, ta_devi
     return TA_SUCCESS;
 }
 
-TA_API ta_result TA_CALL AudioEngine_GetPlaybackDeviceInfo(int32_t index, ta_device_info* info) {
-    if (!info || index < 0 || index >= (int32_t)g_engine.playbackDeviceCount) {
+TA_API ta_result TA_CALL ta_engine_get_playback_device_info(ta_engine* pEngine, int32_t index, ta_device_info* info) {
+    if (!pEngine || !info || index < 0 || index >= (int32_t)pEngine->playbackDeviceCount) {
         return TA_INVALID_ARGS;
     }
     
-    ma_device_info* device = &g_engine.playbackDevices[index];
+    ma_device_info* device = &pEngine->playbackDevices[index];
     
-    wcsncpy(info->id, device->id.wasapi, 255);
-    info->id[255] = L'\0';
+    get_device_id_string(device, info->id, 256);
     
     /* Convert name from char to wchar_t */
     mbstowcs(info->name, device->name, 255);
@@ -867,15 +3307,15 @@ TA_API ta_result TA_CALL AudioEngine_GetPlaybackDeviceInfo(int32_t index, ta_dev
     return TA_SUCCESS;
 }
 
-TA_API ta_result TA_CALL AudioEngine_RefreshDevices(void) {
-    if (!g_engine.initialized) {
+TA_API ta_result TA_CALL ta_engine_refresh_devices(ta_engine* pEngine) {
+    if (!pEngine || engine_state(pEngine) == TA_ENGINE_UNINITIALIZED) {
         /* Need at least a context to enumerate */
         return TA_DEVICE_NOT_INITIALIZED;
     }
     
-    ma_result result = ma_context_get_devices(&g_engine.context,
-        &g_engine.playbackDevices, &g_engine.playbackDeviceCount,
-        &g_engine.captureDevices, &g_engine.captureDeviceCount);
+    ma_result result = ma_context_get_devices(&pEngine->context,
+        &pEngine->playbackDevices, &pEngine->playbackDeviceCount,
+        &pEngine->captureDevices, &pEngine->captureDeviceCount);
     
     return (result == MA_SUCCESS) ? TA_SUCCESS : TA_ERROR;
 }
@@ -884,8 +3324,12 @@ TA_API ta_result TA_CALL AudioEngine_RefreshDevices(void) {
  * DIAGNOSTICS
  * ============================================================================== */
 
-TA_API const wchar_t* TA_CALL AudioEngine_GetLastErrorMessage(void) {
-    return g_engine.lastErrorMessage;
+TA_API const wchar_t* TA_CALL ta_engine_get_last_error_message(ta_engine* pEngine) {
+    if (!pEngine) {
+        return L"";
+    }
+    
+    return pEngine->lastErrorMessage;
 }
 
 TA_API const char* TA_CALL AudioEngine_ResultToString(ta_result result) {
@@ -906,10 +3350,660 @@ TA_API const char* TA_CALL AudioEngine_ResultToString(ta_result result) {
     }
 }
 
+/* ==============================================================================
+ * VIRTUAL-CLOCK SIMULATOR
+ * Drives capture_callback/playback_callback from a discrete-event loop. Each
+ * simulated device has its own clock (nominal rate * (1 + ppm)), callback
+ * size and wake-up jitter. Virtual time jumps to the next due callback, so
+ * nothing ever sleeps and a session runs as fast as the callbacks do.
+ * ============================================================================== */
+
+#define TA_SIM_DEFAULT_SEED         0x9E3779B9u
+#define TA_SIM_COMMIT_HISTORY       1024    /* Capture commits kept for latency lookup (power of two) */
+#define TA_SIM_LOOPBACK_HISTORY     (1u << 17)  /* Played frames the loopback can reach back (power of two) */
+#define TA_SIM_DEFAULT_MEASURE_AT   1.0f    /* Loopback measurement start when measureAtSeconds is 0 */
+
+typedef struct {
+    ta_sim_device device;
+    double rate;                /* Frames per second of this device's clock */
+    double nominalTime;         /* Virtual time the pending period ends */
+    double fireTime;            /* Virtual time the callback actually runs */
+    ma_uint32 periodFrames;
+    ma_uint32 frames;           /* Size of the pending callback */
+    const ta_replay_record* pReplay;    /* Replay: this device's recorded callbacks */
+    ma_uint64 replayCount;
+    ma_uint64 replayNext;
+    ma_uint64 fireNs;           /* Replay: recorded callback time, relative to the trace start */
+    ma_uint32 position;         /* Replay: recorded ring position of the pending callback */
+} ta_sim_clock;
+
+/* A loaded callback trace (ta_sim_config.replayPath) */
+typedef struct {
+    ta_replay_header header;
+    ta_replay_record* pRecords[TA_REPLAY_LANE_COUNT];
+    ma_uint64 counts[TA_REPLAY_LANE_COUNT];
+} ta_sim_replay;
+
+typedef struct {
+    ma_uint64 writePos;         /* Ring write position after the commit */
+    double time;                /* Virtual time of the capture callback */
+} ta_sim_commit;
+
+/* xorshift32 - fixed sequence per seed, so runs are reproducible */
+static ma_uint32 sim_random(ma_uint32* pState) {
+    ma_uint32 x = *pState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *pState = x;
+    return x;
+}
+
+/* Uniform in [-1, 1] */
+static double sim_random_signed(ma_uint32* pState) {
+    return ((double)sim_random(pState) / 4294967295.0) * 2.0 - 1.0;
+}
+
+/* Pick the size and firing time of the clock's next callback */
+static void sim_schedule(ta_sim_clock* pClock, const ta_sim_config* simConfig, ma_uint32* pRng) {
+    ma_int32 frames = (ma_int32)pClock->periodFrames;
+    
+    /* Variable callback sizes (noFixedSizedCallback) */
+    if (simConfig->periodVariationFrames > 0) {
+        ma_uint32 span = simConfig->periodVariationFrames * 2 + 1;
+        frames += (ma_int32)(sim_random(pRng) % span) - (ma_int32)simConfig->periodVariationFrames;
+        if (frames < 1) {
+            frames = 1;
+        }
+    }
+    
+    double previousFire = pClock->fireTime;
+    
+    pClock->frames = (ma_uint32)frames;
+    pClock->nominalTime += (double)frames / pClock->rate;
+    
+    double fire = pClock->nominalTime + sim_random_signed(pRng) * (double)simConfig->callbackJitterUs * 1e-6;
+    
+    /* A stalled thread runs its backlog back-to-back once the stall ends */
+    for (ma_uint32 i = 0; i < simConfig->stallCount && i < TA_SIM_MAX_STALLS; i++) {
+        const ta_sim_stall* pStall = &simConfig->stalls[i];
+        double stallEnd = (double)pStall->atSeconds + (double)pStall->durationMs * 1e-3;
+        if (pStall->device == pClock->device && fire >= (double)pStall->atSeconds && fire < stallEnd) {
+            fire = stallEnd;
+        }
+    }
+    
+    /* Jitter never reorders callbacks of one device */
+    if (fire < previousFire) {
+        fire = previousFire;
+    }
+    pClock->fireTime = fire;
+}
+
+/* Replay: the clock's next callback is the next one recorded, at its recorded time and size */
+static void sim_schedule_replay(ta_sim_clock* pClock, ma_uint64 startNs) {
+    if (pClock->replayNext >= pClock->replayCount) {
+        pClock->fireTime = INFINITY;
+        return;
+    }
+    
+    const ta_replay_record* pRecord = &pClock->pReplay[pClock->replayNext++];
+    ma_uint64 fireNs = pRecord->timeNs > startNs ? pRecord->timeNs - startNs : 0;
+    
+    /* Same rule as sim_schedule: never reorder callbacks of one device */
+    if (fireNs < pClock->fireNs) {
+        fireNs = pClock->fireNs;
+    }
+    pClock->fireNs = fireNs;
+    pClock->fireTime = (double)fireNs * 1e-9;
+    pClock->frames = pRecord->frames > 0 ? pRecord->frames : 1;
+    pClock->position = pRecord->position;
+}
+
+static ta_result run_simulation(const ta_engine_config* config, const ta_sim_config* simConfig,
+    const ta_sim_replay* pReplay, ta_sim_report* report) {
+    memset(report, 0, sizeof(ta_sim_report));
+    
+    ma_uint32 sampleRate = config->sampleRate > 0 ? config->sampleRate : 48000;
+    ma_uint32 defaultPeriod = config->bufferSizeFrames > 0 ? config->bufferSizeFrames : TA_MIN_PERIOD_SIZE_FRAMES;
+    
+    if (!pReplay && simConfig->durationSeconds <= 0.0f) {
+        return TA_INVALID_ARGS;
+    }
+    
+    /* ==== ENGINE WITH VIRTUAL DEVICES ==== */
+    
+    ta_engine* pEngine;
+    ta_result result = ta_engine_create(&pEngine);
+    if (result != TA_SUCCESS) {
+        return result;
+    }
+    
+    pEngine->simulated = 1;
+    TA_TRACE_INIT();
+    TA_TRACE_THREAD("ta_sim_run", NULL);    /* Not the engine's: the callbacks run on this thread */
+    pEngine->volume = config->volume;
+    pEngine->driftMode = config->driftMode;
+    pEngine->telemetryIntervalMs = config->telemetryIntervalMs > 0
+        ? config->telemetryIntervalMs
+        : TA_DEFAULT_TELEMETRY_INTERVAL_MS;
+    pEngine->volumeRampMs = config->volumeRampMs > 0
+        ? config->volumeRampMs
+        : TA_DEFAULT_VOLUME_RAMP_MS;
+    pEngine->volumeRampCurve = config->volumeRampCurve;
+    ta_kernels_init(&pEngine->kernels);
+    ta_rt_install();
+    
+    result = init_channel_counts(pEngine, config);
+    if (result != TA_SUCCESS) {
+        ta_engine_destroy(pEngine);
+        return result;
+    }
+    ma_uint32 captureChannels = pEngine->captureChannels;
+    
+    result = init_elastic_buffer(pEngine, config);
+    if (result != TA_SUCCESS) {
+        ta_engine_destroy(pEngine);
+        return result;
+    }
+    
+    /* The callbacks only read pUserData and sampleRate from the device */
+    pEngine->captureDevice.pUserData = pEngine;
+    pEngine->playbackDevice.pUserData = pEngine;
+    pEngine->captureDevice.sampleRate = sampleRate;
+    pEngine->playbackDevice.sampleRate = sampleRate;
+    
+    ta_sim_clock capture;
+    ta_sim_clock playback;
+    memset(&capture, 0, sizeof(capture));
+    memset(&playback, 0, sizeof(playback));
+    
+    capture.device = TA_SIM_DEVICE_CAPTURE;
+    capture.rate = (double)sampleRate * (1.0 + (double)simConfig->captureClockPpm * 1e-6);
+    capture.periodFrames = simConfig->capturePeriodFrames > 0 ? simConfig->capturePeriodFrames : defaultPeriod;
+    
+    playback.device = TA_SIM_DEVICE_PLAYBACK;
+    playback.rate = (double)sampleRate * (1.0 + (double)simConfig->playbackClockPpm * 1e-6);
+    playback.periodFrames = simConfig->playbackPeriodFrames > 0 ? simConfig->playbackPeriodFrames : defaultPeriod;
+    
+    /* Replay: the recorded devices' clocks and periods */
+    if (pReplay) {
+        capture.rate = (double)sampleRate;
+        playback.rate = (double)sampleRate;
+        capture.pReplay = pReplay->pRecords[TA_REPLAY_LANE_CAPTURE];
+        capture.replayCount = pReplay->counts[TA_REPLAY_LANE_CAPTURE];
+        playback.pReplay = pReplay->pRecords[TA_REPLAY_LANE_PLAYBACK];
+        playback.replayCount = pReplay->counts[TA_REPLAY_LANE_PLAYBACK];
+        if (pReplay->header.capturePeriodFrames > 0) {
+            capture.periodFrames = pReplay->header.capturePeriodFrames;
+        }
+        if (pReplay->header.playbackPeriodFrames > 0) {
+            playback.periodFrames = pReplay->header.playbackPeriodFrames;
+        }
+    }
+    
+    /* Callback buffers, sized for the largest callback either device can issue */
+    ma_uint32 maxFrames = (capture.periodFrames > playback.periodFrames ? capture.periodFrames : playback.periodFrames)
+        + (pReplay ? 0 : simConfig->periodVariationFrames);
+    for (ma_uint32 lane = 0; pReplay && lane < TA_REPLAY_LANE_COUNT; lane++) {
+        for (ma_uint64 i = 0; i < pReplay->counts[lane]; i++) {
+            if (pReplay->pRecords[lane][i].frames > maxFrames) {
+                maxFrames = pReplay->pRecords[lane][i].frames;
+            }
+        }
+    }
+    
+    /* Both virtual devices run in the configured format */
+    ma_format format = device_format_from_config(config->format);
+    if (!is_route_format(format)) {
+        format = ma_format_f32;
+    }
+    result = init_route_conversion(pEngine, config, format, format, maxFrames, maxFrames);
+    if (result != TA_SUCCESS) {
+        uninit_elastic_buffer(pEngine);
+        ta_engine_destroy(pEngine);
+        return result;
+    }
+    
+    result = init_glitch_capture(pEngine, config, sampleRate);
+    if (result != TA_SUCCESS) {
+        uninit_route_conversion(pEngine);
+        uninit_elastic_buffer(pEngine);
+        ta_engine_destroy(pEngine);
+        return result;
+    }
+    
+    size_t inputBytes = (size_t)maxFrames * ma_get_bytes_per_frame(format, captureChannels);
+    float* pTone = (float*)ma_malloc((size_t)maxFrames * captureChannels * sizeof(float), NULL);
+    void* pInput = ma_malloc(inputBytes, NULL);
+    void* pOutput = ma_malloc((size_t)maxFrames * ma_get_bytes_per_frame(format, pEngine->channels), NULL);
+    ta_sim_commit* pCommits = (ta_sim_commit*)ma_malloc(TA_SIM_COMMIT_HISTORY * sizeof(ta_sim_commit), NULL);
+    float* pPlayed = simConfig->loopback ? (float*)ma_calloc(TA_SIM_LOOPBACK_HISTORY * sizeof(float), NULL) : NULL;
+    if (!pTone || !pInput || !pOutput || !pCommits || (simConfig->loopback && !pPlayed)) {
+        result = TA_OUT_OF_MEMORY;
+    } else if (simConfig->recordPath[0]) {
+        /* simTimeNs is 0, so the trace's times are virtual time */
+        result = begin_callback_trace(pEngine, simConfig->recordPath, sampleRate, capture.periodFrames, playback.periodFrames);
+        if (result == TA_SUCCESS) {
+            ma_atomic_store_explicit_32(&pEngine->traceState, 1, ma_atomic_memory_order_release);
+        }
+    }
+    if (result != TA_SUCCESS) {
+        ma_free(pTone, NULL);
+        ma_free(pInput, NULL);
+        ma_free(pOutput, NULL);
+        ma_free(pCommits, NULL);
+        ma_free(pPlayed, NULL);
+        uninit_route_conversion(pEngine);
+        uninit_elastic_buffer(pEngine);
+        ta_engine_destroy(pEngine);
+        return result;
+    }
+    
+    /* Capture delivers a -20dBFS 997Hz tone so the callbacks move real data */
+    for (ma_uint32 i = 0; i < maxFrames; i++) {
+        float sample = 0.1f * (float)sin(2.0 * MA_PI_D * 997.0 * (double)i / (double)sampleRate);
+        for (ma_uint32 ch = 0; ch < captureChannels; ch++) {
+            pTone[i * captureChannels + ch] = sample;
+        }
+    }
+    if (pEngine->playbackFromFloat) {
+        pEngine->playbackFromFloat(pInput, pTone, maxFrames * captureChannels, NULL);
+    } else {
+        memcpy(pInput, pTone, inputBytes);
+    }
+    
+    /*
+     * LOOPBACK: capture hears channel 0 of the output instead. Played frame
+     * F leaves the device one period after its callback, at (F + 2 periods)
+     * / rate, and reaches the input loopbackLatencyMs later; pTone is then
+     * the float staging buffer for each capture callback.
+     */
+    ma_uint64 framesPlayed = 0;
+    ma_uint64 framesCaptured = 0;
+    double loopbackDelay = (double)simConfig->loopbackLatencyMs * 1e-3;
+    double measureAt = simConfig->measureAtSeconds > 0.0f ? (double)simConfig->measureAtSeconds : TA_SIM_DEFAULT_MEASURE_AT;
+    int measuring = 0;
+    
+    /* ==== RUN ==== */
+    
+    ma_uint32 rng = simConfig->seed != 0 ? simConfig->seed : TA_SIM_DEFAULT_SEED;
+    ma_uint64 commitCount = 0;
+    ma_uint64 commitCursor = 0;     /* Oldest commit that may hold the next frame played */
+    ma_uint64 latencySamples = 0;
+    double latencySum = 0.0;
+    double latencyMin = 0.0;
+    double latencyMax = 0.0;
+    double endTime = pReplay ? INFINITY : (double)simConfig->durationSeconds;
+    ma_uint64 replayStartNs = pReplay ? pReplay->header.startNs : 0;
+    ma_uint64 replayFirstFrame = 0;     /* Engine and recorded read positions of the first playback callback */
+    ma_uint32 replayFirstPosition = 0;
+    ma_uint32 replayDivergence = 0;
+    
+    prime_elastic_buffer(pEngine, sampleRate);
+    prime_volume(pEngine, sampleRate);
+    prime_telemetry(pEngine, sampleRate, capture.periodFrames, playback.periodFrames);
+    ma_uint64 firstCapturedFrame = pEngine->ringBufferTargetFrames;  /* Frames before this are pre-fill silence */
+    set_engine_state(pEngine, TA_ENGINE_RUNNING);
+    
+    if (pReplay) {
+        sim_schedule_replay(&capture, replayStartNs);
+        sim_schedule_replay(&playback, replayStartNs);
+    } else {
+        sim_schedule(&capture, simConfig, &rng);
+        sim_schedule(&playback, simConfig, &rng);
+    }
+    
+    ma_timer timer;
+    ma_timer_init(&timer);
+    double wallStart = ma_timer_get_time_in_seconds(&timer);
+    
+    for (;;) {
+        int captureNext = pReplay
+            ? capture.fireTime != INFINITY && (playback.fireTime == INFINITY || capture.fireNs <= playback.fireNs)
+            : capture.fireTime <= playback.fireTime;
+        double now = captureNext ? capture.fireTime : playback.fireTime;
+        if (now >= endTime) {
+            break;
+        }
+        pEngine->simTimeNs = pReplay ? (captureNext ? capture.fireNs : playback.fireNs) : (ma_uint64)(now * 1e9);
+        
+        if (simConfig->loopback && !measuring && now >= measureAt) {
+            measuring = (arm_latency_measurement(pEngine, &simConfig->probe) == TA_SUCCESS) ? 1 : -1;
+        }
+        
+        if (captureNext) {
+            if (simConfig->loopback) {
+                for (ma_uint32 i = 0; i < capture.frames; i++) {
+                    double heardAt = (double)(framesCaptured + i) / capture.rate - loopbackDelay;
+                    double played = floor(heardAt * playback.rate + 0.5) - 2.0 * (double)playback.periodFrames;
+                    float sample = 0.0f;
+                    if (played >= 0.0 && (ma_uint64)played < framesPlayed &&
+                        framesPlayed - (ma_uint64)played <= TA_SIM_LOOPBACK_HISTORY) {
+                        sample = pPlayed[(ma_uint64)played & (TA_SIM_LOOPBACK_HISTORY - 1)];
+                    }
+                    for (ma_uint32 ch = 0; ch < captureChannels; ch++) {
+                        pTone[i * captureChannels + ch] = sample;
+                    }
+                }
+                if (pEngine->playbackFromFloat) {
+                    pEngine->playbackFromFloat(pInput, pTone, capture.frames * captureChannels, NULL);
+                } else {
+                    memcpy(pInput, pTone, (size_t)capture.frames * captureChannels * sizeof(float));
+                }
+                framesCaptured += capture.frames;
+            }
+            
+            capture_callback(&pEngine->captureDevice, NULL, pInput, capture.frames);
+            
+            ta_sim_commit* pCommit = &pCommits[commitCount & (TA_SIM_COMMIT_HISTORY - 1)];
+            pCommit->writePos = pEngine->ring.producer.writePos;
+            pCommit->time = now;
+            commitCount++;
+            
+            report->captureCallbacks++;
+            report->framesCaptured += capture.frames;
+            if (pReplay) {
+                sim_schedule_replay(&capture, replayStartNs);
+            } else {
+                sim_schedule(&capture, simConfig, &rng);
+            }
+        } else {
+            ma_uint64 frame = pEngine->ring.consumer.readPos;
+            
+            playback_callback(&pEngine->playbackDevice, pOutput, NULL, playback.frames);
+            ta_glitch_service(&pEngine->glitch, pEngine->glitchDirectory);   /* No writer thread */
+            ta_replay_drain(&pEngine->trace);
+            
+            /* Replay: how far the ring's read position has moved from where the recording engine's was */
+            if (pReplay) {
+                if (report->playbackCallbacks == 0) {
+                    replayFirstFrame = frame;
+                    replayFirstPosition = playback.position;
+                }
+                ma_int32 gap = (ma_int32)((ma_uint32)(frame - replayFirstFrame) - (playback.position - replayFirstPosition));
+                ma_uint32 distance = gap < 0 ? (ma_uint32)(-(ma_int64)gap) : (ma_uint32)gap;
+                if (distance > replayDivergence) {
+                    replayDivergence = distance;
+                }
+            }
+            
+            if (simConfig->loopback) {
+                ma_uint32 frameBytes = ma_get_bytes_per_frame(format, pEngine->channels);
+                for (ma_uint32 i = 0; i < playback.frames; i++) {
+                    pPlayed[(framesPlayed + i) & (TA_SIM_LOOPBACK_HISTORY - 1)] =
+                        ta_probe_sample((const ma_uint8*)pOutput + (size_t)i * frameBytes, format);
+                }
+                framesPlayed += playback.frames;
+            }
+            
+            /*
+             * LATENCY: find the capture commit that carried the first frame of
+             * this period. Its capture time is the commit time minus the
+             * frames that followed it in that callback.
+             */
+            if (frame >= firstCapturedFrame) {
+                if (commitCount - commitCursor > TA_SIM_COMMIT_HISTORY) {
+                    commitCursor = commitCount - TA_SIM_COMMIT_HISTORY;
+                }
+                while (commitCursor < commitCount && pCommits[commitCursor & (TA_SIM_COMMIT_HISTORY - 1)].writePos <= frame) {
+                    commitCursor++;
+                }
+                if (commitCursor < commitCount) {
+                    const ta_sim_commit* pCommit = &pCommits[commitCursor & (TA_SIM_COMMIT_HISTORY - 1)];
+                    double capturedAt = pCommit->time - (double)(pCommit->writePos - frame) / capture.rate;
+                    double playedAt = now + (double)playback.frames / playback.rate;
+                    double latency = playedAt - capturedAt;
+                    
+                    if (latencySamples == 0 || latency < latencyMin) latencyMin = latency;
+                    if (latencySamples == 0 || latency > latencyMax) latencyMax = latency;
+                    latencySum += latency;
+                    latencySamples++;
+                }
+            }
+            
+            report->playbackCallbacks++;
+            report->framesPlayed += playback.frames;
+            if (pReplay) {
+                sim_schedule_replay(&playback, replayStartNs);
+            } else {
+                sim_schedule(&playback, simConfig, &rng);
+            }
+        }
+    }
+    
+    report->wallSeconds = ma_timer_get_time_in_seconds(&timer) - wallStart;
+    
+    /* No worker: the callbacks have stopped, analyse whatever phase the probe reached */
+    if (measuring > 0) {
+        ta_probe_phase phase = ta_probe_get_phase(&pEngine->probe);
+        ta_probe_disarm(&pEngine->probe);
+        finish_latency_measurement(pEngine, phase);
+    }
+    ta_engine_get_latency_measurement(pEngine, &report->latencyMeasurement);
+    ta_glitch_flush(&pEngine->glitch);
+    ta_glitch_service(&pEngine->glitch, pEngine->glitchDirectory);
+    set_engine_state(pEngine, TA_ENGINE_UNINITIALIZED);
+    
+    ta_result traceResult = TA_SUCCESS;
+    if (simConfig->recordPath[0] && ta_replay_close(&pEngine->trace) != MA_SUCCESS) {
+        traceResult = TA_ERROR;
+    }
+    ma_atomic_store_explicit_32(&pEngine->traceState, 0, ma_atomic_memory_order_relaxed);
+    
+    /* ==== REPORT ==== */
+    
+    report->simulatedSeconds = pReplay ? (double)pEngine->simTimeNs * 1e-9 : endTime;
+    report->underrunCount = (uint32_t)pEngine->playback.underrunCount;
+    report->overrunCount = (uint32_t)pEngine->capture.overrunCount;
+    report->driftCorrectionCount = (uint32_t)pEngine->playback.driftCorrectionCount;
+    report->driftPpm = pEngine->playback.driftPpm;
+    report->finalFillLevel = (float)ta_ring_fill(&pEngine->ring) / (float)pEngine->ringBufferSizeInFrames;
+    report->targetLatencyMs = (float)pEngine->ringBufferTargetFrames * 1000.0f / (float)sampleRate;
+    report->learnedFloorLatencyMs = (float)pEngine->playback.latencyFloorFrames * 1000.0f / (float)sampleRate;
+    ta_engine_get_timing_stats(pEngine, &report->timing);
+    ta_engine_get_rt_violations(pEngine, &report->rtViolations);
+    report->telemetry = pEngine->telemetry;
+    report->glitchDumpCount = pEngine->glitch.dumpCount;
+    report->glitchDroppedCount = pEngine->glitch.droppedCount;
+    if (pReplay) {
+        ta_callback_trace_info* pTrace = &report->replayTrace;
+        const ta_replay_header* pHeader = &pReplay->header;
+        pTrace->sampleRate = pHeader->sampleRate;
+        pTrace->channels = pHeader->channels;
+        pTrace->captureChannels = pHeader->captureChannels;
+        pTrace->ringBufferSizeFrames = pHeader->ringBufferFrames;
+        pTrace->ringBufferTargetFrames = pHeader->ringTargetFrames;
+        pTrace->driftMode = (int32_t)pHeader->driftMode;
+        pTrace->capturePeriodFrames = pHeader->capturePeriodFrames;
+        pTrace->playbackPeriodFrames = pHeader->playbackPeriodFrames;
+        pTrace->captureCallbacks = pReplay->counts[TA_REPLAY_LANE_CAPTURE];
+        pTrace->playbackCallbacks = pReplay->counts[TA_REPLAY_LANE_PLAYBACK];
+        pTrace->droppedRecords = pHeader->droppedRecords;
+        pTrace->durationSeconds = (float)report->simulatedSeconds;
+        report->replayDivergenceFrames = replayDivergence;
+    }
+    if (latencySamples > 0) {
+        report->latencyMeanMs = (float)(latencySum / (double)latencySamples * 1000.0);
+        report->latencyMinMs = (float)(latencyMin * 1000.0);
+        report->latencyMaxMs = (float)(latencyMax * 1000.0);
+    }
+    
+    ma_free(pTone, NULL);
+    ma_free(pInput, NULL);
+    ma_free(pOutput, NULL);
+    ma_free(pCommits, NULL);
+    ma_free(pPlayed, NULL);
+    uninit_route_conversion(pEngine);
+    uninit_elastic_buffer(pEngine);
+    ta_engine_destroy(pEngine);
+    
+    return traceResult;
+}
+
+TA_API ta_result TA_CALL ta_sim_run(const ta_engine_config* config, const ta_sim_config* simConfig, ta_sim_report* report) {
+    if (!config || !simConfig || !report) {
+        return TA_INVALID_ARGS;
+    }
+    
+    if (!simConfig->replayPath[0]) {
+        return run_simulation(config, simConfig, NULL, report);
+    }
+    
+    /* Replay at the recorded sample rate; ring, drift and format still come from config */
+    ta_sim_replay replay;
+    ma_result loaded = ta_replay_load(simConfig->replayPath, &replay.header, replay.pRecords, replay.counts);
+    if (loaded != MA_SUCCESS) {
+        memset(report, 0, sizeof(ta_sim_report));
+        return loaded == MA_OUT_OF_MEMORY ? TA_OUT_OF_MEMORY : TA_INVALID_ARGS;
+    }
+    
+    ta_engine_config replayConfig = *config;
+    replayConfig.sampleRate = replay.header.sampleRate;
+    ta_result result = run_simulation(&replayConfig, simConfig, &replay, report);
+    
+    ma_free(replay.pRecords[TA_REPLAY_LANE_CAPTURE], NULL);
+    ma_free(replay.pRecords[TA_REPLAY_LANE_PLAYBACK], NULL);
+    return result;
+}
+
+/* ==============================================================================
+ * LEGACY SINGLE-INSTANCE API
+ * Thin shims over g_defaultEngine, kept for MiniaudioWrapper.cs.
+ * ============================================================================== */
+
+TA_API ta_result TA_CALL AudioEngine_Initialize(const ta_engine_config* config) {
+    return ta_engine_initialize(&g_defaultEngine, config);
+}
+
+TA_API ta_result TA_CALL AudioEngine_Start(void) {
+    return ta_engine_start(&g_defaultEngine);
+}
+
+TA_API ta_result TA_CALL AudioEngine_Stop(void) {
+    return ta_engine_stop(&g_defaultEngine);
+}
+
+TA_API ta_result TA_CALL AudioEngine_Uninitialize(void) {
+    return ta_engine_uninitialize(&g_defaultEngine);
+}
+
+TA_API ta_result TA_CALL AudioEngine_SetVolume(float volume) {
+    return ta_engine_set_volume(&g_defaultEngine, volume);
+}
+
+TA_API float TA_CALL AudioEngine_GetVolume(void) {
+    return ta_engine_get_volume(&g_defaultEngine);
+}
+
+TA_API ta_result TA_CALL AudioEngine_GetStatus(ta_engine_status* status) {
+    return ta_engine_get_status(&g_defaultEngine, status);
+}
+
+TA_API int32_t TA_CALL AudioEngine_IsRunning(void) {
+    return ta_engine_is_running(&g_defaultEngine);
+}
+
+TA_API void TA_CALL AudioEngine_SetErrorCallback(ta_error_callback callback) {
+    ta_engine_set_error_callback(&g_defaultEngine, callback);
+}
+
+TA_API void TA_CALL AudioEngine_SetDeviceDisconnectedCallback(ta_device_disconnected_callback callback) {
+    ta_engine_set_device_disconnected_callback(&g_defaultEngine, callback);
+}
+
+TA_API void TA_CALL AudioEngine_SetStateChangedCallback(ta_state_changed_callback callback) {
+    ta_engine_set_state_changed_callback(&g_defaultEngine, callback);
+}
+
+TA_API int32_t TA_CALL AudioEngine_GetCaptureDeviceCount(void) {
+    return ta_engine_get_capture_device_count(&g_defaultEngine);
+}
+
+TA_API int32_t TA_CALL AudioEngine_GetPlaybackDeviceCount(void) {
+    return ta_engine_get_playback_device_count(&g_defaultEngine);
+}
+
+TA_API ta_result TA_CALL AudioEngine_GetCaptureDeviceInfo(int32_t index, ta_device_info* info) {
+    return ta_engine_get_capture_device_info(&g_defaultEngine, index, info);
+}
+
+TA_API ta_result TA_CALL AudioEngine_GetPlaybackDeviceInfo(int32_t index, ta_device_info* info) {
+    return ta_engine_get_playback_device_info(&g_defaultEngine, index, info);
+}
+
+TA_API ta_result TA_CALL AudioEngine_RefreshDevices(void) {
+    return ta_engine_refresh_devices(&g_defaultEngine);
+}
+
+TA_API const wchar_t* TA_CALL AudioEngine_GetLastErrorMessage(void) {
+    return ta_engine_get_last_error_message(&g_defaultEngine);
+}
+
+TA_API ta_result TA_CALL AudioEngine_GetTimingStats(ta_timing_stats* stats) {
+    return ta_engine_get_timing_stats(&g_defaultEngine, stats);
+}
+
+TA_API ta_result TA_CALL AudioEngine_ResetTimingStats(void) {
+    return ta_engine_reset_timing_stats(&g_defaultEngine);
+}
+
+TA_API ta_result TA_CALL AudioEngine_GetRtViolations(ta_rt_report* report) {
+    return ta_engine_get_rt_violations(&g_defaultEngine, report);
+}
+
+TA_API ta_result TA_CALL AudioEngine_StartLatencyMeasurement(const ta_latency_probe_config* config) {
+    return ta_engine_start_latency_measurement(&g_defaultEngine, config);
+}
+
+TA_API ta_result TA_CALL AudioEngine_GetLatencyMeasurement(ta_latency_measurement* measurement) {
+    return ta_engine_get_latency_measurement(&g_defaultEngine, measurement);
+}
+
+TA_API ta_result TA_CALL AudioEngine_GetStartupTiming(ta_startup_timing* timing) {
+    return ta_engine_get_startup_timing(&g_defaultEngine, timing);
+}
+
+#ifdef TA_ENABLE_NULL_BACKEND
+TA_API ta_result TA_CALL AudioEngine_SimulateDeviceLoss(int32_t device) {
+    return ta_engine_simulate_device_loss(&g_defaultEngine, device);
+}
+#endif
+
+TA_API ta_result TA_CALL AudioEngine_StartCallbackTrace(const wchar_t* path) {
+    return ta_engine_start_callback_trace(&g_defaultEngine, path);
+}
+
+TA_API ta_result TA_CALL AudioEngine_StopCallbackTrace(void) {
+    return ta_engine_stop_callback_trace(&g_defaultEngine);
+}
+
+TA_API ta_result TA_CALL AudioEngine_WriteTrace(const wchar_t* path, int32_t format) {
+    if (!path || !path[0] || (format != TA_TRACE_FORMAT_CHROME_JSON && format != TA_TRACE_FORMAT_PERFETTO)) {
+        return TA_INVALID_ARGS;
+    }
+    
+#if defined(TA_ENABLE_TRACE)
+    ma_result result = ta_trace_write_file(path, format == TA_TRACE_FORMAT_PERFETTO);
+    if (result == MA_BUSY) {
+        return TA_INVALID_OPERATION;
+    }
+    return (result == MA_SUCCESS) ? TA_SUCCESS : TA_ERROR;
+#else
+    return TA_INVALID_OPERATION;    /* Probes compiled out */
+#endif
+}
+
+TA_API const ta_telemetry* TA_CALL AudioEngine_GetTelemetry(void) {
+    return ta_engine_get_telemetry(&g_defaultEngine);
+}
+
 /* ==============================================================================
  * DLL ENTRY POINT
  * ============================================================================== */
 
+#if defined(_WIN32)
+
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD reason, LPVOID lpReserved) {
     (void)hModule;
     (void)lpReserved;
@@ -922,8 +4016,8 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD reason, LPVOID lpReserved) {
             
         case DLL_PROCESS_DETACH:
             /* Clean up if still initialized */
-            if (g_engine.initialized) {
-                AudioEngine_Uninitialize();
+            if (engine_state(&g_defaultEngine) != TA_ENGINE_UNINITIALIZED) {
+                ta_engine_uninitialize(&g_defaultEngine);
             }
             CoUninitialize();
             break;
@@ -935,3 +4029,5 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD reason, LPVOID lpReserved) {
     
     return TRUE;
 }
+
+#endif /* _WIN32 */
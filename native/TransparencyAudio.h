@@ -7,10 +7,17 @@
  *
  * "BARE METAL" ARCHITECTURE (December 2025):
  * - Decoupled capture/playback devices with elastic ring buffer
- * - Manual clock drift compensation (skip/duplicate frames)
+ * - Single duplex device fast path when both endpoints share a clock
+ * - Click-free volume: ramped SetVolume, fade-in on Start, fade-out on Stop
+ * - Native device sample formats (S16/S24/S32) converted by SIMD kernels
+ *   straight into the elastic buffer, optional TPDF dither on output
+ * - Manual clock drift compensation (skip/duplicate or adaptive resampling)
+ * - Adaptive ring target: shrinks while clean, backs off on underruns
  * - IAudioClient3 for sub-10ms WASAPI shared mode
  * - Variable callback size support (noFixedSizedCallback)
  * - Target latency: ~3-5ms (down from ~100ms)
+ * - Multi-instance: ta_engine handles, one independent route per instance
+ * - Virtual-clock simulator (ta_sim_run) for headless, hardware-free runs
  *
  * BUILD REQUIREMENTS:
  * - Windows 10/11 SDK
@@ -33,6 +40,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <wchar.h>
 
 /* DLL export/import macros */
 #ifdef _WIN32
@@ -71,8 +79,12 @@ typedef int ta_result;
  * ENUMERATIONS
  * ============================================================================== */
 
+/* Entries in ta_engine_config.channelMap */
+#define TA_MAX_CHANNEL_MAP  32
+
+/* Values for ta_engine_config.format (device side; processing is always f32) */
 typedef enum {
-    TA_FORMAT_UNKNOWN = 0,
+    TA_FORMAT_UNKNOWN = 0,  /* Device native format (U8 devices fall back to F32) */
     TA_FORMAT_U8      = 1,
     TA_FORMAT_S16     = 2,
     TA_FORMAT_S24     = 3,
@@ -90,11 +102,76 @@ typedef enum {
     TA_PERFORMANCE_PROFILE_CONSERVATIVE  = 1
 } ta_performance_profile;
 
+typedef enum {
+    TA_RING_BUFFER_MODE_AUTO     = 0,   /* Mirrored if the OS supports it, else wrapped */
+    TA_RING_BUFFER_MODE_WRAPPED  = 1,   /* Single mapping, wrap-around splits copies in two */
+    TA_RING_BUFFER_MODE_MIRRORED = 2    /* Double-mapped; Initialize fails if unsupported */
+} ta_ring_buffer_mode;
+
+typedef enum {
+    TA_DRIFT_MODE_SKIP_DUPLICATE = 0,   /* Drop/repeat whole frames at 25%/75% fill */
+    TA_DRIFT_MODE_RESAMPLE       = 1    /* PI-steered fractional resampler, no discontinuities */
+} ta_drift_mode;
+
+/* Values for ta_engine_config.useDecoupledDevices */
+typedef enum {
+    TA_DEVICE_TOPOLOGY_AUTO      = 0,   /* Duplex if both endpoints share a clock, else decoupled */
+    TA_DEVICE_TOPOLOGY_DECOUPLED = 1,   /* Separate capture/playback devices joined by the elastic buffer */
+    TA_DEVICE_TOPOLOGY_DUPLEX    = 2    /* One duplex device; Initialize fails if it cannot be opened */
+} ta_device_topology;
+
+/* Shape of the volume ramps (SetVolume, Start fade-in, Stop fade-out) */
+typedef enum {
+    TA_GAIN_CURVE_LINEAR      = 0,  /* Constant amplitude change per frame */
+    TA_GAIN_CURVE_EXPONENTIAL = 1   /* Constant dB change per frame (-60dB floor) */
+} ta_gain_curve;
+
+/* What an audio callback did that it must not (TA_ENABLE_RT_CHECKS builds) */
+typedef enum {
+    TA_RT_VIOLATION_ALLOCATION = 1, /* malloc, calloc, realloc */
+    TA_RT_VIOLATION_FREE       = 2,
+    TA_RT_VIOLATION_LOCK       = 3, /* Mutex, semaphore or engine lock */
+    TA_RT_VIOLATION_SLEEP      = 4,
+    TA_RT_VIOLATION_IO         = 5  /* read/write */
+} ta_rt_violation_kind;
+
+/* Callback a violation happened in (duplex counts as playback) */
+typedef enum {
+    TA_RT_THREAD_CAPTURE  = 0,
+    TA_RT_THREAD_PLAYBACK = 1
+} ta_rt_thread_kind;
+
+/* File format of AudioEngine_WriteTrace (TA_ENABLE_TRACE builds) */
+typedef enum {
+    TA_TRACE_FORMAT_CHROME_JSON = 0,    /* Trace event JSON: chrome://tracing, ui.perfetto.dev */
+    TA_TRACE_FORMAT_PERFETTO    = 1     /* Perfetto protobuf trace: ui.perfetto.dev, trace_processor */
+} ta_trace_format;
+
+/* Test signal for latency measurement */
+typedef enum {
+    TA_PROBE_SIGNAL_MLS   = 0,  /* Maximum length sequence (white, 4095 frames) */
+    TA_PROBE_SIGNAL_CHIRP = 1   /* Linear sweep, 100Hz to 0.45 fs (quieter, same length) */
+} ta_probe_signal;
+
+typedef enum {
+    TA_LATENCY_MEASUREMENT_IDLE    = 0, /* None started since Initialize */
+    TA_LATENCY_MEASUREMENT_RUNNING = 1,
+    TA_LATENCY_MEASUREMENT_DONE    = 2,
+    TA_LATENCY_MEASUREMENT_FAILED  = 3  /* See ta_latency_measurement.error */
+} ta_latency_measurement_state;
+
 /* ==============================================================================
  * STRUCTURES
  * Must match layout in MiniaudioWrapper.cs (LayoutKind.Sequential)
  * ============================================================================== */
 
+/**
+ * Opaque engine instance.
+ * One instance owns one capture->playback route: its own context, devices,
+ * elastic ring buffer, statistics and callbacks. Create with ta_engine_create().
+ */
+typedef struct ta_engine ta_engine;
+
 /**
  * Device information structure.
  * Returned by device enumeration functions.
@@ -117,19 +194,37 @@ typedef struct {
     wchar_t inputDeviceId[256];     /* Capture device ID */
     wchar_t outputDeviceId[256];    /* Playback device ID */
     uint32_t sampleRate;            /* Sample rate (48000 recommended) */
-    uint32_t channels;              /* Channel count (2 for stereo) */
+    uint32_t channels;              /* Channel count (2 for stereo); default for both devices */
     uint32_t bufferSizeFrames;      /* Buffer size in frames (128 = ~2.6ms @ 48kHz) */
-    ta_format format;               /* Sample format (TA_FORMAT_F32) */
+    ta_format format;               /* Device sample format (UNKNOWN = native, U8 = F32) */
     ta_share_mode shareMode;        /* WASAPI share mode */
     ta_performance_profile perfProfile; /* Performance profile */
     int32_t noAutoConvertSRC;       /* 1 = disable Windows SRC for low latency */
-    int32_t enableResampling;       /* DEPRECATED: Ignored in "Bare Metal" mode */
+    int32_t enableResampling;       /* 1 = allow a duplex device whose endpoints run at different native rates */
     float volume;                   /* Initial volume (0.0 - 1.0) */
     
     /* === NEW FIELDS FOR "BARE METAL" ARCHITECTURE === */
     uint32_t ringBufferSizeFrames;  /* Elastic buffer size (0 = use default 2048) */
     int32_t noFixedSizedCallback;   /* 1 = enable variable callback (default: 1) */
-    int32_t useDecoupledDevices;    /* 1 = use separate capture/playback (default: 1) */
+    int32_t useDecoupledDevices;    /* ta_device_topology (0 = AUTO, 1 = DECOUPLED, 2 = DUPLEX) */
+    ta_ring_buffer_mode ringBufferMode; /* Elastic buffer mapping (default: AUTO) */
+    ta_drift_mode driftMode;        /* Clock drift compensation (default: SKIP_DUPLICATE) */
+    uint32_t telemetryIntervalMs;   /* Telemetry publish period (0 = use default 50ms) */
+    uint32_t volumeRampMs;          /* Volume ramp and Start/Stop fade length (0 = use default 10ms) */
+    ta_gain_curve volumeRampCurve;  /* Volume ramp shape (default: LINEAR) */
+    int32_t enableDither;           /* 1 = TPDF dither when the playback device is S16/S24 */
+    uint32_t captureChannels;       /* Capture device channels (0 = channels) */
+    uint32_t playbackChannels;      /* Playback device channels (0 = channels) */
+    int32_t useChannelMap;          /* 1 = use channelMap, 0 = playback ch takes capture ch % captureChannels */
+    int32_t channelMap[TA_MAX_CHANNEL_MAP]; /* Capture channel per playback channel, -1 = silence */
+    int32_t adaptiveLatency;        /* 1 = learn the lowest ring target that avoids underruns */
+    float minTargetLatencyMs;       /* Adaptive target lower bound (0 = use default 1ms) */
+    float maxTargetLatencyMs;       /* Adaptive target upper bound (0 = half the ring) */
+    int32_t countPageFaults;        /* 1 = count page faults inside the audio callbacks (test mode, a syscall per callback) */
+    uint32_t glitchCaptureMs;       /* Output history dumped around each underrun/overrun/drift event (0 = off, max 2000) */
+    uint32_t glitchMaxDumps;        /* Dumps per Initialize (0 = use default 16) */
+    wchar_t glitchDirectory[260];   /* Where dumps are written (empty = working directory) */
+    int32_t sequentialStartup;      /* 1 = open and start the capture and playback devices one after the other */
 } ta_engine_config;
 
 /**
@@ -152,12 +247,198 @@ typedef struct {
     float ringBufferFillLevel;      /* Elastic buffer fill (0.0 - 1.0) */
     float captureLatencyMs;         /* Capture device latency */
     float playbackLatencyMs;        /* Playback device latency */
+    int32_t ringBufferMirrored;     /* 1 if the elastic buffer is double-mapped */
+    float driftPpm;                 /* Estimated capture/playback clock error (RESAMPLE mode) */
+    int32_t duplex;                 /* 1 if running on one duplex device (no elastic buffer) */
+    ta_format captureFormat;        /* Capture device sample format in use */
+    ta_format playbackFormat;       /* Playback device sample format in use */
+    float targetLatencyMs;          /* Ring fill the drift stage currently steers toward */
+    float learnedFloorLatencyMs;    /* Adaptive target floor learned from underruns (0 = none) */
+    uint32_t droppedEventCount;     /* Callback events lost to a full queue since Initialize */
+    uint32_t reserved;              /* Padding, keeps the counters below 8-byte aligned */
+    uint64_t underrunCount64;       /* underrunCount at full width (the 32-bit copies wrap) */
+    uint64_t overrunCount64;        /* overrunCount at full width */
+    uint64_t driftCorrectionCount64; /* driftCorrectionCount at full width */
+    uint64_t arenaBytes;            /* Pre-faulted real-time memory: route buffers plus the engine state */
+    uint64_t capturePageFaults;     /* Page faults inside the capture callback since start (countPageFaults; whole process on Windows) */
+    uint64_t playbackPageFaults;    /* Same for the playback (or duplex) callback */
+    int32_t arenaLocked;            /* 1 if all of arenaBytes is locked in RAM (VirtualLock/mlock) */
+    int32_t countingPageFaults;     /* 1 if the fault counters above are live */
+    uint32_t glitchDumpCount;       /* Glitch dumps written since Initialize (glitchCaptureMs) */
+    uint32_t glitchDroppedCount;    /* Events not recorded: every history slot was still being written */
+    int32_t callbackTraceActive;    /* 1 while a callback trace is being recorded */
+    uint32_t callbackTraceDropped;  /* Callbacks missing from the current/last trace */
+    uint64_t callbackTraceRecords;  /* Callbacks written to the current/last trace */
 } ta_engine_status;
 
+/**
+ * Distribution of one per-callback measurement since the last reset.
+ * Percentiles are bucket bounds (within 12.5% of the true value).
+ */
+typedef struct {
+    uint64_t count;             /* Callbacks recorded */
+    float p50;
+    float p99;
+    float p999;
+    float max;                  /* Exact */
+} ta_timing_percentiles;
+
+/**
+ * Timing of one audio callback (capture or playback).
+ */
+typedef struct {
+    ta_timing_percentiles executionUs;  /* Time spent inside the callback */
+    ta_timing_percentiles intervalUs;   /* Start-to-start time between callbacks */
+    ta_timing_percentiles frames;       /* Frames per callback */
+    float dspLoadPercent;               /* Smoothed run time / period length (JACK-style) */
+    float dspLoadPeakPercent;           /* Worst single callback */
+} ta_callback_timing;
+
+/**
+ * Timing statistics.
+ * Returned by AudioEngine_GetTimingStats.
+ */
+typedef struct {
+    ta_callback_timing capture;
+    ta_callback_timing playback;
+} ta_timing_stats;
+
+#define TA_RT_MAX_VIOLATIONS 8
+
+/**
+ * One recorded real-time violation. The stack is innermost frame first,
+ * "symbol+0x1c" where the symbol is exported, else "module+0x1a2b".
+ */
+typedef struct {
+    int32_t kind;               /* ta_rt_violation_kind */
+    int32_t thread;             /* ta_rt_thread_kind */
+    char call[32];              /* Offending call, e.g. "malloc" */
+    char stack[480];            /* Frames separated by " < " */
+} ta_rt_violation;
+
+/**
+ * Real-time violations since Start.
+ * Returned by AudioEngine_GetRtViolations.
+ */
+typedef struct {
+    int32_t enabled;            /* 1 if built with TA_ENABLE_RT_CHECKS */
+    uint32_t recordedCount;     /* Entries filled in violations[] */
+    uint64_t violationCount;    /* All violations (>= recordedCount) */
+    ta_rt_violation violations[TA_RT_MAX_VIOLATIONS];
+} ta_rt_report;
+
+/**
+ * Latency measurement settings (all zero = MLS at -12dBFS, 500ms window).
+ */
+typedef struct {
+    int32_t signal;             /* ta_probe_signal */
+    float level;                /* Probe peak amplitude, 0 < level <= 1 (0 = 0.25) */
+    uint32_t maxRoundTripMs;    /* Longest round trip searched for (0 = 500, max 2000) */
+} ta_latency_probe_config;
+
+/**
+ * Result of the last latency measurement.
+ * Returned by AudioEngine_GetLatencyMeasurement.
+ */
+typedef struct {
+    int32_t state;              /* ta_latency_measurement_state */
+    int32_t error;              /* ta_result when FAILED */
+    float roundTripMs;          /* Probe leaving the output to arriving at the input (devices + path) */
+    float engineInternalMs;     /* Probe arriving at the input to leaving the output (ring, drift); -1 = unknown */
+    float totalMs;              /* Input-to-output latency: roundTripMs + engineInternalMs */
+    float estimatedMs;          /* actualLatencyMs when the measurement started, for comparison */
+    float peakToNoiseDb;        /* Correlation peak over the noise floor (confidence) */
+    uint32_t probeFrames;       /* Probe length */
+} ta_latency_measurement;
+
+/**
+ * What a callback trace recorded (AudioEngine_StartCallbackTrace), as read
+ * back for replay.
+ */
+typedef struct {
+    uint32_t sampleRate;
+    uint32_t channels;              /* Route channels */
+    uint32_t captureChannels;
+    uint32_t ringBufferSizeFrames;
+    uint32_t ringBufferTargetFrames; /* At the start of the recording */
+    int32_t driftMode;              /* ta_drift_mode */
+    uint32_t capturePeriodFrames;
+    uint32_t playbackPeriodFrames;
+    uint64_t captureCallbacks;
+    uint64_t playbackCallbacks;
+    uint32_t droppedRecords;        /* Callbacks the writer fell too far behind to record */
+    float durationSeconds;          /* First to last recorded callback */
+} ta_callback_trace_info;
+
+/**
+ * Where the time to first sample went in the last Initialize and Start.
+ * Returned by AudioEngine_GetStartupTiming. Milliseconds; -1 = did not
+ * happen (yet). The first* times count from the start of the Start call.
+ */
+typedef struct {
+    int32_t parallel;           /* 1 if the two devices were opened and started concurrently */
+    float initializeMs;         /* Whole Initialize call */
+    float contextInitMs;        /* Backend context */
+    float enumerateMs;          /* Device enumeration */
+    float deviceInitMs;         /* Device opens, wall clock (overlapped when parallel) */
+    float captureInitMs;        /* Capture device open (-1 when duplex) */
+    float playbackInitMs;       /* Playback device open (-1 when duplex) */
+    float startMs;              /* Whole Start call */
+    float deviceStartMs;        /* Device starts, wall clock */
+    float captureStartMs;       /* Capture device start (-1 when duplex) */
+    float playbackStartMs;      /* Playback device start (-1 when duplex) */
+    float firstCaptureMs;       /* First capture callback */
+    float firstPlaybackMs;      /* First playback callback (pre-fill silence goes out) */
+    float firstSampleMs;        /* First captured audio leaves through the output */
+} ta_startup_timing;
+
+#define TA_TELEMETRY_VERSION 1
+
+/**
+ * Live telemetry block, published by the engine under a sequence lock.
+ * Returned (as a pointer, once) by AudioEngine_GetTelemetry; poll it without
+ * further calls. While streaming the playback callback rewrites it every
+ * telemetryIntervalMs; Start/Stop/Initialize publish from the caller's thread.
+ *
+ * READER PROTOCOL:
+ *   1. s1 = sequence (acquire). If odd, a write is in progress: retry.
+ *   2. Copy the block.
+ *   3. Full fence, s2 = sequence. If s1 != s2 the copy is torn: retry.
+ *   4. Accept only if version == TA_TELEMETRY_VERSION and size matches
+ *      (version 0 = nothing published yet).
+ *
+ * NOTE: New fields go at the END; bump TA_TELEMETRY_VERSION on layout changes.
+ */
+typedef struct {
+    volatile uint32_t sequence;     /* Odd while a write is in progress */
+    uint32_t version;               /* TA_TELEMETRY_VERSION */
+    uint32_t size;                  /* sizeof(ta_telemetry) */
+    int32_t isRunning;              /* 1 if running */
+    uint64_t updateCount;           /* Snapshots published */
+    float ringBufferFillLevel;      /* Elastic buffer fill (0.0 - 1.0) */
+    float actualLatencyMs;          /* Ring buffer fill + playback period */
+    float captureLatencyMs;         /* Capture device period */
+    float playbackLatencyMs;        /* Playback device period */
+    float driftPpm;                 /* Estimated capture/playback clock error (RESAMPLE mode) */
+    float capturePeakLevel;         /* Post-volume input peak, 300ms release (1.0 = 0dBFS) */
+    float playbackPeakLevel;        /* Output peak, 300ms release (1.0 = 0dBFS) */
+    float currentVolume;            /* Current volume */
+    uint32_t underrunCount;         /* Buffer underruns since start */
+    uint32_t overrunCount;          /* Buffer overruns since start */
+    uint32_t driftCorrectionCount;  /* Times drift compensation triggered */
+    uint32_t reserved;
+} ta_telemetry;
+
 /* ==============================================================================
  * CALLBACK TYPES
  * ============================================================================== */
 
+/*
+ * All callbacks run on the engine's dispatcher thread, a few milliseconds
+ * after the event, never on an audio thread. They may call back into the
+ * API, except Uninitialize/destroy of the same instance.
+ */
+
 /**
  * Error callback.
  * Called when an error occurs in the audio thread.
@@ -172,17 +453,126 @@ typedef void (TA_CALL *ta_device_disconnected_callback)(const wchar_t* deviceId)
 
 /**
  * State changed callback.
- * Called when the engine starts or stops.
+ * Called once per transition when the engine starts or stops (including
+ * a device lost while running), in order.
  */
 typedef void (TA_CALL *ta_state_changed_callback)(int32_t isRunning);
 
+/* ==============================================================================
+ * INSTANCE API
+ * Every function takes the engine handle returned by ta_engine_create().
+ * Independent instances may run concurrently in one process.
+ * ============================================================================== */
+
+/**
+ * Allocate a new, uninitialized engine instance.
+ *
+ * @param ppEngine Receives the new instance.
+ * @return TA_SUCCESS on success, error code otherwise.
+ */
+TA_API ta_result TA_CALL ta_engine_create(ta_engine** ppEngine);
+
+/**
+ * Stop and uninitialize the instance (if needed) and free it.
+ *
+ * @param pEngine Instance from ta_engine_create(). NULL is ignored.
+ */
+TA_API void TA_CALL ta_engine_destroy(ta_engine* pEngine);
+
+/** Instance equivalent of AudioEngine_Initialize(). */
+TA_API ta_result TA_CALL ta_engine_initialize(ta_engine* pEngine, const ta_engine_config* config);
+
+/** Instance equivalent of AudioEngine_Start(). */
+TA_API ta_result TA_CALL ta_engine_start(ta_engine* pEngine);
+
+/** Instance equivalent of AudioEngine_Stop(). */
+TA_API ta_result TA_CALL ta_engine_stop(ta_engine* pEngine);
+
+/** Instance equivalent of AudioEngine_Uninitialize(). */
+TA_API ta_result TA_CALL ta_engine_uninitialize(ta_engine* pEngine);
+
+/** Instance equivalent of AudioEngine_SetVolume(). */
+TA_API ta_result TA_CALL ta_engine_set_volume(ta_engine* pEngine, float volume);
+
+/** Instance equivalent of AudioEngine_GetVolume(). */
+TA_API float TA_CALL ta_engine_get_volume(ta_engine* pEngine);
+
+/** Instance equivalent of AudioEngine_GetStatus(). */
+TA_API ta_result TA_CALL ta_engine_get_status(ta_engine* pEngine, ta_engine_status* status);
+
+/** Instance equivalent of AudioEngine_IsRunning(). */
+TA_API int32_t TA_CALL ta_engine_is_running(ta_engine* pEngine);
+
+/** Instance equivalent of AudioEngine_SetErrorCallback(). */
+TA_API void TA_CALL ta_engine_set_error_callback(ta_engine* pEngine, ta_error_callback callback);
+
+/** Instance equivalent of AudioEngine_SetDeviceDisconnectedCallback(). */
+TA_API void TA_CALL ta_engine_set_device_disconnected_callback(ta_engine* pEngine, ta_device_disconnected_callback callback);
+
+/** Instance equivalent of AudioEngine_SetStateChangedCallback(). */
+TA_API void TA_CALL ta_engine_set_state_changed_callback(ta_engine* pEngine, ta_state_changed_callback callback);
+
+/** Instance equivalent of AudioEngine_GetCaptureDeviceCount(). */
+TA_API int32_t TA_CALL ta_engine_get_capture_device_count(ta_engine* pEngine);
+
+/** Instance equivalent of AudioEngine_GetPlaybackDeviceCount(). */
+TA_API int32_t TA_CALL ta_engine_get_playback_device_count(ta_engine* pEngine);
+
+/** Instance equivalent of AudioEngine_GetCaptureDeviceInfo(). */
+TA_API ta_result TA_CALL ta_engine_get_capture_device_info(ta_engine* pEngine, int32_t index, ta_device_info* info);
+
+/** Instance equivalent of AudioEngine_GetPlaybackDeviceInfo(). */
+TA_API ta_result TA_CALL ta_engine_get_playback_device_info(ta_engine* pEngine, int32_t index, ta_device_info* info);
+
+/** Instance equivalent of AudioEngine_RefreshDevices(). */
+TA_API ta_result TA_CALL ta_engine_refresh_devices(ta_engine* pEngine);
+
+/** Instance equivalent of AudioEngine_GetTimingStats(). */
+TA_API ta_result TA_CALL ta_engine_get_timing_stats(ta_engine* pEngine, ta_timing_stats* stats);
+
+/** Instance equivalent of AudioEngine_ResetTimingStats(). */
+TA_API ta_result TA_CALL ta_engine_reset_timing_stats(ta_engine* pEngine);
+
+/** Instance equivalent of AudioEngine_GetRtViolations(). */
+TA_API ta_result TA_CALL ta_engine_get_rt_violations(ta_engine* pEngine, ta_rt_report* report);
+
+/** Instance equivalent of AudioEngine_StartLatencyMeasurement(). */
+TA_API ta_result TA_CALL ta_engine_start_latency_measurement(ta_engine* pEngine, const ta_latency_probe_config* config);
+
+/** Instance equivalent of AudioEngine_GetLatencyMeasurement(). */
+TA_API ta_result TA_CALL ta_engine_get_latency_measurement(ta_engine* pEngine, ta_latency_measurement* measurement);
+
+/** Instance equivalent of AudioEngine_GetStartupTiming(). */
+TA_API ta_result TA_CALL ta_engine_get_startup_timing(ta_engine* pEngine, ta_startup_timing* timing);
+
+#ifdef TA_ENABLE_NULL_BACKEND
+/** Instance equivalent of AudioEngine_SimulateDeviceLoss(). */
+TA_API ta_result TA_CALL ta_engine_simulate_device_loss(ta_engine* pEngine, int32_t device);
+#endif
+
+/** Instance equivalent of AudioEngine_StartCallbackTrace(). */
+TA_API ta_result TA_CALL ta_engine_start_callback_trace(ta_engine* pEngine, const wchar_t* path);
+
+/** Instance equivalent of AudioEngine_StopCallbackTrace(). */
+TA_API ta_result TA_CALL ta_engine_stop_callback_trace(ta_engine* pEngine);
+
+/** Instance equivalent of AudioEngine_GetTelemetry(). Valid until ta_engine_destroy(). */
+TA_API const ta_telemetry* TA_CALL ta_engine_get_telemetry(ta_engine* pEngine);
+
+/** Instance equivalent of AudioEngine_GetLastErrorMessage(). */
+TA_API const wchar_t* TA_CALL ta_engine_get_last_error_message(ta_engine* pEngine);
+
 /* ==============================================================================
  * CORE ENGINE API
+ * Legacy single-instance exports. These operate on a built-in default
+ * instance and are kept for MiniaudioWrapper.cs.
  * ============================================================================== */
 
 /**
  * Initialize the audio engine with the specified configuration.
- * Must be called before AudioEngine_Start().
+ * Must be called before AudioEngine_Start(), and not concurrently with any
+ * other call. The capture and playback devices are opened concurrently
+ * (unless sequentialStartup is set or the backend cannot do it).
  *
  * @param config Pointer to engine configuration.
  * @return TA_SUCCESS on success, error code otherwise.
@@ -191,7 +581,10 @@ TA_API ta_result TA_CALL AudioEngine_Initialize(const ta_engine_config* config);
 
 /**
  * Start audio streaming.
- * Engine must be initialized first.
+ * Engine must be initialized first. Output fades in over volumeRampMs.
+ * Decoupled devices are started concurrently, like Initialize opens them.
+ * Start and Stop may be called from any threads: one transition runs at a
+ * time, and a call that finds the other in progress waits for it to finish.
  *
  * @return TA_SUCCESS on success, error code otherwise.
  */
@@ -199,7 +592,9 @@ TA_API ta_result TA_CALL AudioEngine_Start(void);
 
 /**
  * Stop audio streaming.
- * Engine remains initialized and can be restarted.
+ * Engine remains initialized and can be restarted. Output fades out over
+ * volumeRampMs first; the call blocks until the silence has been played
+ * (bounded by the ring buffer length if a device has stalled).
  *
  * @return TA_SUCCESS on success, error code otherwise.
  */
@@ -207,6 +602,7 @@ TA_API ta_result TA_CALL AudioEngine_Stop(void);
 
 /**
  * Uninitialize the audio engine and release all resources.
+ * Stops first if needed. Must not run concurrently with any other call.
  *
  * @return TA_SUCCESS on success, error code otherwise.
  */
@@ -214,7 +610,8 @@ TA_API ta_result TA_CALL AudioEngine_Uninitialize(void);
 
 /**
  * Set the output volume.
- * Thread-safe, can be called while streaming.
+ * Thread-safe, can be called while streaming. The audio thread ramps to
+ * the new level over volumeRampMs (no zipper noise, no step).
  *
  * @param volume Volume level (0.0 to 1.0).
  * @return TA_SUCCESS on success, error code otherwise.
@@ -239,7 +636,8 @@ TA_API ta_result TA_CALL AudioEngine_GetStatus(ta_engine_status* status);
 /**
  * Check if the engine is currently running.
  *
- * @return 1 if running, 0 otherwise.
+ * @return 1 if running, 0 otherwise (including while a Start or Stop is
+ *         still in progress).
  */
 TA_API int32_t TA_CALL AudioEngine_IsRunning(void);
 
@@ -320,6 +718,131 @@ TA_API ta_result TA_CALL AudioEngine_RefreshDevices(void);
  */
 TA_API const wchar_t* TA_CALL AudioEngine_GetLastErrorMessage(void);
 
+/**
+ * Get per-callback timing: execution time, callback interval and frames per
+ * callback (p50/p99/p99.9/max) plus DSP load, for capture and playback.
+ * Recorded lock-free in the callbacks; safe to poll while streaming.
+ *
+ * @param stats Pointer to timing structure to fill.
+ * @return TA_SUCCESS on success, error code otherwise.
+ */
+TA_API ta_result TA_CALL AudioEngine_GetTimingStats(ta_timing_stats* stats);
+
+/**
+ * Clear the timing histograms. Each callback clears its own on its next run.
+ *
+ * @return TA_SUCCESS on success, error code otherwise.
+ */
+TA_API ta_result TA_CALL AudioEngine_ResetTimingStats(void);
+
+/**
+ * Get the allocations, locks and blocking calls the audio callbacks made
+ * since Start, with a stack for the first TA_RT_MAX_VIOLATIONS. Recorded
+ * only in builds with TA_ENABLE_RT_CHECKS (report->enabled = 0 otherwise).
+ *
+ * @param report Pointer to the report structure to fill.
+ * @return TA_SUCCESS on success, error code otherwise.
+ */
+TA_API ta_result TA_CALL AudioEngine_GetRtViolations(ta_rt_report* report);
+
+/**
+ * Measure the real round-trip latency with a test signal. For about
+ * 50ms + maxRoundTripMs the output carries silence and a probe (MLS or
+ * chirp) instead of the route audio; the probe is found in the capture
+ * by cross-correlation on a worker thread. The output must reach the
+ * input: a loopback cable, or speakers within earshot of the microphone.
+ * Poll AudioEngine_GetLatencyMeasurement for the result.
+ *
+ * @param config Probe settings, or NULL for the defaults.
+ * @return TA_SUCCESS if started, TA_DEVICE_NOT_STARTED if not streaming,
+ *         TA_INVALID_OPERATION if a measurement is already running.
+ */
+TA_API ta_result TA_CALL AudioEngine_StartLatencyMeasurement(const ta_latency_probe_config* config);
+
+/**
+ * Get the state and result of the last latency measurement.
+ *
+ * @param measurement Pointer to the result structure to fill.
+ * @return TA_SUCCESS on success, error code otherwise.
+ */
+TA_API ta_result TA_CALL AudioEngine_GetLatencyMeasurement(ta_latency_measurement* measurement);
+
+/**
+ * Get the time-to-first-sample breakdown of the last Initialize and Start:
+ * context, enumeration, device opens and starts, and the first capture,
+ * playback and passed-through callbacks. The first-callback times fill in
+ * while the devices come up; poll until firstSampleMs is not -1.
+ *
+ * @param timing Pointer to the structure to fill.
+ * @return TA_SUCCESS on success, error code otherwise.
+ */
+TA_API ta_result TA_CALL AudioEngine_GetStartupTiming(ta_startup_timing* timing);
+
+#ifdef TA_ENABLE_NULL_BACKEND
+/**
+ * Stop one device behind the engine's back, as unplugging it would, to
+ * exercise the device-lost path: the engine stops the other device,
+ * reverts MMCSS and reports stopped (state callback), and the next Start
+ * brings the route up again. Test builds only (TA_ENABLE_NULL_BACKEND,
+ * ta_stress -device-loss); not exported from the shipped library.
+ *
+ * @param device ta_sim_device: the capture or playback side (duplex: the one device).
+ * @return TA_SUCCESS if the device was stopped, TA_DEVICE_NOT_STARTED if
+ *         not streaming.
+ */
+TA_API ta_result TA_CALL AudioEngine_SimulateDeviceLoss(int32_t device);
+#endif
+
+/**
+ * Record every capture and playback callback (start time, frame count,
+ * ring position; 16 bytes each) to a binary trace until
+ * AudioEngine_StopCallbackTrace or Uninitialize. Replay it offline with
+ * ta_sim_config.replayPath to run the same callback sequence through any
+ * ring/drift settings. Records are written by a background thread.
+ * Stop/Start re-primes the ring but the replay runs one continuous
+ * stream, so record a single run when comparing positions.
+ *
+ * @param path File to create (overwritten).
+ * @return TA_SUCCESS if recording, TA_DEVICE_NOT_INITIALIZED before
+ *         Initialize, TA_INVALID_OPERATION if a trace is already being
+ *         recorded or the route is duplex (no ring to replay).
+ */
+TA_API ta_result TA_CALL AudioEngine_StartCallbackTrace(const wchar_t* path);
+
+/**
+ * Stop recording and finish the trace file. Progress while recording is
+ * in the status (callbackTraceRecords, callbackTraceDropped).
+ *
+ * @return TA_SUCCESS (also when no trace was running), TA_ERROR if the
+ *         file could not be completed.
+ */
+TA_API ta_result TA_CALL AudioEngine_StopCallbackTrace(void);
+
+/**
+ * Get the live telemetry block (fill level, counters, latencies, drift and
+ * peak levels). The pointer is fixed for the life of the process: map it
+ * once and read it with the protocol documented on ta_telemetry, instead of
+ * calling AudioEngine_GetStatus on a timer.
+ *
+ * @return Pointer to the engine's telemetry block. Do not free.
+ */
+TA_API const ta_telemetry* TA_CALL AudioEngine_GetTelemetry(void);
+
+/**
+ * Write the timeline recorded by the trace probes (capture/playback
+ * callbacks, drift decisions, Initialize/Start/Stop phases) since the
+ * last write, and empty the probe buffers. Process-wide: covers every
+ * engine and every thread that made an API call. Recorded only in builds
+ * with TA_ENABLE_TRACE.
+ *
+ * @param path File to create (overwritten).
+ * @param format ta_trace_format.
+ * @return TA_SUCCESS on success, TA_INVALID_OPERATION if built without
+ *         TA_ENABLE_TRACE or another write is in progress, TA_ERROR if
+ *         the file could not be written.
+ */
+TA_API ta_result TA_CALL AudioEngine_WriteTrace(const wchar_t* path, int32_t format);
+
 /**
  * Get a human-readable string for a result code.
  *
@@ -328,6 +851,98 @@ TA_API const wchar_t* TA_CALL AudioEngine_GetLastErrorMessage(void);
  */
 TA_API const char* TA_CALL AudioEngine_ResultToString(ta_result result);
 
+/* ==============================================================================
+ * SIMULATION
+ * Runs the real capture/playback callbacks against two virtual-clock devices,
+ * as fast as the CPU allows. No audio hardware needed; builds on any host.
+ * Deterministic for a given seed.
+ * ============================================================================== */
+
+#define TA_SIM_MAX_STALLS   8
+
+typedef enum {
+    TA_SIM_DEVICE_CAPTURE  = 0,
+    TA_SIM_DEVICE_PLAYBACK = 1
+} ta_sim_device;
+
+/**
+ * Scheduled stall: the device's callbacks are held off for durationMs, then
+ * the backlog is delivered back-to-back (a descheduled audio thread).
+ */
+typedef struct {
+    ta_sim_device device;
+    float atSeconds;            /* Virtual time the stall begins */
+    float durationMs;           /* How long callbacks are held off */
+} ta_sim_stall;
+
+/**
+ * Simulated device pair. Sample rate, channels, ring and drift settings come
+ * from the ta_engine_config passed alongside; both devices use its format
+ * (UNKNOWN and U8 simulate F32 devices).
+ */
+typedef struct {
+    float captureClockPpm;          /* Capture clock error vs nominal rate */
+    float playbackClockPpm;         /* Playback clock error vs nominal rate */
+    uint32_t capturePeriodFrames;   /* Nominal callback size (0 = bufferSizeFrames) */
+    uint32_t playbackPeriodFrames;  /* Nominal callback size (0 = bufferSizeFrames) */
+    uint32_t periodVariationFrames; /* Each callback is nominal +/- up to this many frames */
+    float callbackJitterUs;         /* Callback wake-up jitter, uniform +/- */
+    float durationSeconds;          /* Virtual time to simulate */
+    uint32_t seed;                  /* PRNG seed (0 = fixed default) */
+    uint32_t stallCount;
+    ta_sim_stall stalls[TA_SIM_MAX_STALLS];
+    int32_t loopback;               /* 1 = capture hears the playback output instead of a tone */
+    float loopbackLatencyMs;        /* Output-to-input path delay beyond the playback period */
+    ta_latency_probe_config probe;  /* Loopback: one latency measurement with these settings */
+    float measureAtSeconds;         /* Loopback: when the measurement starts (0 = 1s) */
+    wchar_t recordPath[260];        /* Record this run's callbacks to a trace (empty = no) */
+    wchar_t replayPath[260];        /* Replay a callback trace: its callback times and sizes and its
+                                       sample rate replace the virtual clocks (ppm, periods, jitter,
+                                       stalls, durationSeconds are ignored) */
+} ta_sim_config;
+
+/**
+ * Simulation results. Latency is capture-time to the end of the playback
+ * period that carries the frame (ring + both device periods).
+ */
+typedef struct {
+    uint64_t captureCallbacks;
+    uint64_t playbackCallbacks;
+    uint64_t framesCaptured;
+    uint64_t framesPlayed;
+    uint32_t underrunCount;
+    uint32_t overrunCount;
+    uint32_t driftCorrectionCount;
+    float driftPpm;                 /* Final estimate (RESAMPLE mode) */
+    float finalFillLevel;           /* Ring fill at the end (0.0 - 1.0) */
+    float latencyMeanMs;
+    float latencyMinMs;
+    float latencyMaxMs;
+    double simulatedSeconds;
+    double wallSeconds;             /* simulatedSeconds / wallSeconds = speed-up */
+    ta_timing_stats timing;         /* Execution times are real; intervals are wall-clock gaps */
+    ta_telemetry telemetry;         /* Last snapshot the playback callback published */
+    float targetLatencyMs;          /* Ring target at the end */
+    float learnedFloorLatencyMs;    /* Adaptive target floor at the end (0 = none) */
+    ta_rt_report rtViolations;      /* Callback allocations/locks/blocking (TA_ENABLE_RT_CHECKS) */
+    ta_latency_measurement latencyMeasurement;  /* Loopback runs */
+    uint32_t glitchDumpCount;       /* Glitch dumps written (glitchCaptureMs) */
+    uint32_t glitchDroppedCount;
+    ta_callback_trace_info replayTrace;     /* replayPath: what the trace recorded */
+    uint32_t replayDivergenceFrames;        /* replayPath: largest gap between the replayed and recorded
+                                               playback read positions (0 = same consumption) */
+} ta_sim_report;
+
+/**
+ * Run one simulated session.
+ *
+ * @param config Engine configuration (device IDs and share mode are ignored).
+ * @param simConfig Virtual device behaviour.
+ * @param report Receives the statistics.
+ * @return TA_SUCCESS on success, error code otherwise.
+ */
+TA_API ta_result TA_CALL ta_sim_run(const ta_engine_config* config, const ta_sim_config* simConfig, ta_sim_report* report);
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,11 +5,13 @@
 #   .\build-native.ps1              # Build Release
 #   .\build-native.ps1 -Debug       # Build Debug
 #   .\build-native.ps1 -DownloadMiniaudio  # Download miniaudio.h first
+#   .\build-native.ps1 -Tools       # Also build benchmarks/tools in tools\
 
 param(
     [switch]$Debug,
     [switch]$DownloadMiniaudio,
-    [switch]$Clean
+    [switch]$Clean,
+    [switch]$Tools
 )
 
 $ErrorActionPreference = 'Stop'
@@ -21,6 +23,7 @@ try {
     if ($Clean) {
         Write-Host "Cleaning build artifacts..." -ForegroundColor Yellow
         Remove-Item -Force -ErrorAction SilentlyContinue *.dll, *.obj, *.lib, *.exp, *.pdb
+        Remove-Item -Force -ErrorAction SilentlyContinue tools\*.exe, tools\*.obj, tools\*.pdb
         Write-Host "Clean complete." -ForegroundColor Green
         if (-not $DownloadMiniaudio) {
             exit 0
@@ -43,7 +46,7 @@ try {
     }
 
     # Verify required files exist
-    $requiredFiles = @("miniaudio.h", "TransparencyAudio.h", "TransparencyAudio.c")
+    $requiredFiles = @("miniaudio.h", "TransparencyAudio.h", "TransparencyAudio.c", "ta_ring.h", "ta_drift.h", "ta_timing.h", "ta_kernels.h", "ta_gain.h", "ta_channels.h", "ta_latency.h", "ta_fill.h", "ta_plc.h", "ta_splice.h", "ta_events.h", "ta_arena.h", "ta_rtcheck.h", "ta_probe.h", "ta_glitch.h", "ta_replay.h", "ta_trace.h")
     foreach ($file in $requiredFiles) {
         if (-not (Test-Path (Join-Path $scriptDir $file))) {
             Write-Error "Missing required file: $file"
@@ -99,6 +102,22 @@ try {
     $dllInfo = Get-Item $dllPath
     Write-Host "Created: TransparencyAudio.dll ($([math]::Round($dllInfo.Length / 1KB)) KB)" -ForegroundColor Green
 
+    # Build tools (benchmarks, simulators) - each tools\*.c is one executable
+    if ($Tools) {
+        Write-Host "Building tools..." -ForegroundColor Yellow
+        foreach ($tool in Get-ChildItem (Join-Path $scriptDir "tools") -Filter *.c) {
+            $exe = Join-Path "tools" ($tool.BaseName + ".exe")
+            $toolCmd = "cl $optimization /I. /W3 /WX- tools\$($tool.Name) /Fo:tools\ /Fe:$exe /link TransparencyAudio.lib ole32.lib winmm.lib avrt.lib $debugFlag"
+            $result = cmd /c "`"$vcvarsall`" >nul 2>&1 && $toolCmd 2>&1"
+            if ($LASTEXITCODE -ne 0) {
+                Write-Host $result -ForegroundColor Red
+                Write-Error "Tool build failed: $($tool.Name)"
+                exit $LASTEXITCODE
+            }
+            Write-Host "  Built: $exe" -ForegroundColor Cyan
+        }
+    }
+
     # Copy to output directories
     $appDir = Join-Path $scriptDir "..\src\TransparencyMode.App"
     $destinations = @(
@@ -0,0 +1,298 @@
+/*
+ * ==============================================================================
+ * ta_arena.h - Locked, Pre-Faulted Memory for the Real-Time Path
+ * ==============================================================================
+ * Everything the audio callbacks touch should be resident before the first
+ * callback and stay resident: a page fault on an audio thread is a trip
+ * into the kernel (and, for a trimmed page, to disk) in the middle of a
+ * period. The arena gives the engine's buffers that guarantee:
+ *
+ *   - Allocation: bump allocator over OS pages (VirtualAlloc / mmap) in
+ *     blocks of at least TA_ARENA_BLOCK_BYTES, every allocation aligned to
+ *     TA_CACHE_LINE_SIZE. Nothing is freed individually; ta_arena_uninit()
+ *     returns all of it. Exposed as ma_allocation_callbacks, so the ring,
+ *     resampler, concealment and channel-map helpers allocate from it
+ *     unchanged.
+ *   - Pre-faulting: each new block is written page by page at Initialize,
+ *     on the control thread.
+ *   - Locking: VirtualLock (growing the working-set minimum when the quota
+ *     is too small) or mlock. Memory the arena does not own - the engine
+ *     struct with the device state and telemetry, a mirrored ring's two
+ *     views - is touched and locked in place by ta_arena_lock_region().
+ *     A lock the OS refuses (RLIMIT_MEMLOCK, no quota) is not an error:
+ *     the memory is still pre-faulted, and ta_arena_is_locked() says so.
+ *
+ * ta_arena_page_faults() reads the page-fault counter of the calling
+ * thread (Linux) or process (Windows, macOS) for the engine's fault test
+ * mode.
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h and ta_ring.h.
+ *   ta_arena_init() before the first allocation; control thread only.
+ * ==============================================================================
+ */
+
+#ifndef TA_ARENA_H
+#define TA_ARENA_H
+
+#include <string.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/resource.h>
+    #include <unistd.h>
+#endif
+
+/* Smallest block mapped from the OS */
+#define TA_ARENA_BLOCK_BYTES        (256 * 1024)
+
+/* Foreign regions ta_arena_lock_region() can track (engine struct, ring views) */
+#define TA_ARENA_MAX_REGIONS        4
+
+/* Working-set headroom added on top of the locked bytes (Windows) */
+#define TA_ARENA_WORKING_SET_SLACK  (1024 * 1024)
+
+typedef struct ta_arena_block {
+    struct ta_arena_block* pNext;
+    size_t size;                /* Mapped bytes, this header included */
+    size_t used;                /* Bytes handed out, this header included */
+} ta_arena_block;
+
+typedef struct {
+    void* pStart;
+    size_t size;
+    int locked;
+} ta_arena_region;
+
+typedef struct {
+    ta_arena_block* pBlocks;    /* Newest first; allocations come from the head */
+    ta_arena_region regions[TA_ARENA_MAX_REGIONS];
+    ma_uint32 regionCount;
+    size_t residentBytes;       /* Blocks plus regions: what was pre-faulted */
+    int lockFailed;             /* Some block or region could not be locked */
+    ma_allocation_callbacks callbacks;
+} ta_arena;
+
+/* ==== PLATFORM ==== */
+
+static size_t ta_arena_page_size(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (size_t)info.dwPageSize;
+#else
+    long pageSize = sysconf(_SC_PAGESIZE);
+    return (pageSize > 0) ? (size_t)pageSize : 4096;
+#endif
+}
+
+static void* ta_arena_map(size_t bytes) {
+#if defined(_WIN32)
+    return VirtualAlloc(NULL, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    void* p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return (p == MAP_FAILED) ? NULL : p;
+#endif
+}
+
+static void ta_arena_unmap(void* p, size_t bytes) {
+#if defined(_WIN32)
+    (void)bytes;
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, bytes);
+#endif
+}
+
+static int ta_arena_lock_pages(void* p, size_t bytes) {
+#if defined(_WIN32)
+    if (VirtualLock(p, bytes)) {
+        return 1;
+    }
+    /* The default working-set minimum allows only a few dozen locked pages */
+    SIZE_T minimumBytes, maximumBytes;
+    if (!GetProcessWorkingSetSize(GetCurrentProcess(), &minimumBytes, &maximumBytes) ||
+        !SetProcessWorkingSetSize(GetCurrentProcess(),
+            minimumBytes + bytes + TA_ARENA_WORKING_SET_SLACK,
+            maximumBytes + bytes + TA_ARENA_WORKING_SET_SLACK)) {
+        return 0;
+    }
+    return VirtualLock(p, bytes) ? 1 : 0;
+#else
+    return (mlock(p, bytes) == 0) ? 1 : 0;
+#endif
+}
+
+static void ta_arena_unlock_pages(void* p, size_t bytes) {
+#if defined(_WIN32)
+    VirtualUnlock(p, bytes);
+#else
+    munlock(p, bytes);
+#endif
+}
+
+/* Write every page without changing it: faults in live memory as well as fresh pages */
+static void ta_arena_touch(void* p, size_t bytes) {
+    volatile char* pBytes = (volatile char*)p;
+    size_t pageSize = ta_arena_page_size();
+    for (size_t offset = 0; offset < bytes; offset += pageSize) {
+        pBytes[offset] = pBytes[offset];
+    }
+    if (bytes > 0) {
+        pBytes[bytes - 1] = pBytes[bytes - 1];
+    }
+}
+
+#if defined(_WIN32)
+typedef BOOL (WINAPI *ta_pfn_GetProcessMemoryInfo)(HANDLE, PPROCESS_MEMORY_COUNTERS, DWORD);
+static ta_pfn_GetProcessMemoryInfo g_taGetProcessMemoryInfo = NULL;
+#endif
+
+/* Page faults so far: this thread on Linux, the whole process elsewhere */
+static ma_uint64 ta_arena_page_faults(void) {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!g_taGetProcessMemoryInfo ||
+        !g_taGetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return (ma_uint64)counters.PageFaultCount;
+#else
+    struct rusage usage;
+    #if defined(__linux__)
+        int who = 1;    /* RUSAGE_THREAD (needs _GNU_SOURCE to be named) */
+    #else
+        int who = RUSAGE_SELF;
+    #endif
+    if (getrusage(who, &usage) != 0) {
+        return 0;
+    }
+    return (ma_uint64)usage.ru_minflt + (ma_uint64)usage.ru_majflt;
+#endif
+}
+
+/* ==== ALLOCATION ==== */
+
+static void* ta_arena_alloc(ta_arena* pArena, size_t bytes) {
+    size_t headerBytes = (sizeof(ta_arena_block) + TA_CACHE_LINE_SIZE - 1) & ~(size_t)(TA_CACHE_LINE_SIZE - 1);
+    size_t alignedBytes = (bytes + TA_CACHE_LINE_SIZE - 1) & ~(size_t)(TA_CACHE_LINE_SIZE - 1);
+    ta_arena_block* pBlock = pArena->pBlocks;
+
+    if (!pBlock || pBlock->size - pBlock->used < alignedBytes) {
+        size_t pageSize = ta_arena_page_size();
+        size_t blockBytes = headerBytes + alignedBytes;
+        if (blockBytes < TA_ARENA_BLOCK_BYTES) {
+            blockBytes = TA_ARENA_BLOCK_BYTES;
+        }
+        blockBytes = (blockBytes + pageSize - 1) / pageSize * pageSize;
+
+        pBlock = (ta_arena_block*)ta_arena_map(blockBytes);
+        if (!pBlock) {
+            return NULL;
+        }
+        ta_arena_touch(pBlock, blockBytes);
+        if (!ta_arena_lock_pages(pBlock, blockBytes)) {
+            pArena->lockFailed = 1;
+        }
+
+        pBlock->pNext = pArena->pBlocks;
+        pBlock->size = blockBytes;
+        pBlock->used = headerBytes;
+        pArena->pBlocks = pBlock;
+        pArena->residentBytes += blockBytes;
+    }
+
+    void* p = (char*)pBlock + pBlock->used;
+    pBlock->used += alignedBytes;
+    return p;
+}
+
+static void* ta_arena_on_malloc(size_t bytes, void* pUserData) {
+    return ta_arena_alloc((ta_arena*)pUserData, bytes);
+}
+
+static void* ta_arena_on_realloc(void* p, size_t bytes, void* pUserData) {
+    /* Sizes are fixed at Initialize; only the malloc form is supported */
+    return (p == NULL) ? ta_arena_alloc((ta_arena*)pUserData, bytes) : NULL;
+}
+
+static void ta_arena_on_free(void* p, void* pUserData) {
+    (void)p;
+    (void)pUserData;    /* Released all at once by ta_arena_uninit */
+}
+
+static void ta_arena_init(ta_arena* pArena) {
+    memset(pArena, 0, sizeof(*pArena));
+    pArena->callbacks.pUserData = pArena;
+    pArena->callbacks.onMalloc = ta_arena_on_malloc;
+    pArena->callbacks.onRealloc = ta_arena_on_realloc;
+    pArena->callbacks.onFree = ta_arena_on_free;
+
+#if defined(_WIN32)
+    if (!g_taGetProcessMemoryInfo) {
+        HMODULE hKernel32 = GetModuleHandleW(L"kernel32.dll");
+        if (hKernel32) {
+            g_taGetProcessMemoryInfo = (ta_pfn_GetProcessMemoryInfo)(void*)GetProcAddress(hKernel32, "K32GetProcessMemoryInfo");
+        }
+    }
+#endif
+}
+
+/* Pre-fault and lock memory the arena does not own; undone by ta_arena_uninit */
+static void ta_arena_lock_region(ta_arena* pArena, void* pStart, size_t bytes) {
+    if (!pStart || bytes == 0 || pArena->regionCount >= TA_ARENA_MAX_REGIONS) {
+        return;
+    }
+
+    ta_arena_region* pRegion = &pArena->regions[pArena->regionCount++];
+    pRegion->pStart = pStart;
+    pRegion->size = bytes;
+    ta_arena_touch(pStart, bytes);
+    pRegion->locked = ta_arena_lock_pages(pStart, bytes);
+    if (!pRegion->locked) {
+        pArena->lockFailed = 1;
+    }
+    pArena->residentBytes += bytes;
+}
+
+/* Forget every allocation but keep the blocks (a failed setup attempt) */
+static void ta_arena_rewind(ta_arena* pArena) {
+    size_t headerBytes = (sizeof(ta_arena_block) + TA_CACHE_LINE_SIZE - 1) & ~(size_t)(TA_CACHE_LINE_SIZE - 1);
+    for (ta_arena_block* pBlock = pArena->pBlocks; pBlock; pBlock = pBlock->pNext) {
+        pBlock->used = headerBytes;
+    }
+}
+
+/* Unlock the foreign regions; call before their owners free them */
+static void ta_arena_unlock_regions(ta_arena* pArena) {
+    for (ma_uint32 i = 0; i < pArena->regionCount; i++) {
+        if (pArena->regions[i].locked) {
+            ta_arena_unlock_pages(pArena->regions[i].pStart, pArena->regions[i].size);
+        }
+        pArena->residentBytes -= pArena->regions[i].size;
+    }
+    pArena->regionCount = 0;
+}
+
+/* Unlock what is left and return the blocks. Allocations must be released first. */
+static void ta_arena_uninit(ta_arena* pArena) {
+    ta_arena_unlock_regions(pArena);
+
+    ta_arena_block* pBlock = pArena->pBlocks;
+    while (pBlock) {
+        ta_arena_block* pNext = pBlock->pNext;
+        ta_arena_unmap(pBlock, pBlock->size);
+        pBlock = pNext;
+    }
+
+    ta_arena_init(pArena);
+}
+
+static MA_INLINE int ta_arena_is_locked(const ta_arena* pArena) {
+    return (pArena->residentBytes > 0 && !pArena->lockFailed) ? 1 : 0;
+}
+
+#endif /* TA_ARENA_H */
@@ -0,0 +1,128 @@
+/*
+ * ==============================================================================
+ * ta_channels.h - Capture -> Playback Channel Map
+ * ==============================================================================
+ * The route runs at the playback channel count. When the capture device has
+ * a different count (mono mic into stereo headphones, a mic array into a
+ * stereo pair) or the caller supplies a map, every captured frame is
+ * rebuilt on its way into the ring:
+ *
+ *   out[ch] = in[source[ch]]      (source[ch] < 0: silence)
+ *
+ * The default map sends capture channel (ch % captureChannels) to playback
+ * channel ch: mono is duplicated to every output, identical counts pass
+ * straight through (and skip the remap entirely).
+ *
+ * SPECIALIZATION:
+ *   The remap loop is instantiated for 1, 2, 4, 6 and 8 output channels,
+ *   where the per-frame loop unrolls at compile time, plus a generic
+ *   version for any other count. ta_channel_map_init() picks one.
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h. The map is built once at
+ *   Initialize; remap is called from the capture thread only.
+ * ==============================================================================
+ */
+
+#ifndef TA_CHANNELS_H
+#define TA_CHANNELS_H
+
+#include <string.h>
+
+typedef struct ta_channel_map ta_channel_map;
+
+struct ta_channel_map {
+    ma_uint32 inChannels;
+    ma_uint32 outChannels;
+    ma_int32* pSource;          /* Capture channel per playback channel, -1 = silence */
+    int identity;               /* 1 = frames pass through unchanged */
+    void (*remap)(const ta_channel_map* pMap, float* pDst, const float* pSrc, ma_uint32 frameCount);
+};
+
+static MA_INLINE void ta_channel_remap_frames(const ta_channel_map* pMap, float* pDst, const float* pSrc,
+    ma_uint32 frameCount, ma_uint32 outChannels) {
+    const ma_int32* pSource = pMap->pSource;
+    const ma_uint32 inChannels = pMap->inChannels;
+
+    for (ma_uint32 frame = 0; frame < frameCount; frame++) {
+        const float* pIn = pSrc + (size_t)frame * inChannels;
+        float* pOut = pDst + (size_t)frame * outChannels;
+        for (ma_uint32 ch = 0; ch < outChannels; ch++) {
+            pOut[ch] = (pSource[ch] >= 0) ? pIn[pSource[ch]] : 0.0f;
+        }
+    }
+}
+
+/* Output channel count known at compile time: the inner loop unrolls */
+#define TA_CHANNEL_DEFINE_REMAP(N) \
+    static void ta_channel_remap_##N(const ta_channel_map* pMap, float* pDst, const float* pSrc, ma_uint32 frameCount) { \
+        ta_channel_remap_frames(pMap, pDst, pSrc, frameCount, N); \
+    }
+
+TA_CHANNEL_DEFINE_REMAP(1)
+TA_CHANNEL_DEFINE_REMAP(2)
+TA_CHANNEL_DEFINE_REMAP(4)
+TA_CHANNEL_DEFINE_REMAP(6)
+TA_CHANNEL_DEFINE_REMAP(8)
+
+static void ta_channel_remap_generic(const ta_channel_map* pMap, float* pDst, const float* pSrc, ma_uint32 frameCount) {
+    ta_channel_remap_frames(pMap, pDst, pSrc, frameCount, pMap->outChannels);
+}
+
+/*
+ * Build the map. pUserMap (NULL = default) gives the source of the first
+ * userMapCount playback channels; the rest follow the default rule.
+ * Returns MA_INVALID_ARGS if an entry names a capture channel that does
+ * not exist.
+ */
+static ma_result ta_channel_map_init(ta_channel_map* pMap, ma_uint32 inChannels, ma_uint32 outChannels,
+    const ma_int32* pUserMap, ma_uint32 userMapCount, const ma_allocation_callbacks* pAllocationCallbacks) {
+    memset(pMap, 0, sizeof(*pMap));
+
+    pMap->pSource = (ma_int32*)ma_malloc((size_t)outChannels * sizeof(ma_int32), pAllocationCallbacks);
+    if (!pMap->pSource) {
+        return MA_OUT_OF_MEMORY;
+    }
+    pMap->inChannels = inChannels;
+    pMap->outChannels = outChannels;
+    pMap->identity = (inChannels == outChannels);
+
+    for (ma_uint32 ch = 0; ch < outChannels; ch++) {
+        ma_int32 source = (ma_int32)(ch % inChannels);
+        if (pUserMap && ch < userMapCount) {
+            source = pUserMap[ch];
+            if (source >= (ma_int32)inChannels) {
+                ma_free(pMap->pSource, pAllocationCallbacks);
+                memset(pMap, 0, sizeof(*pMap));
+                return MA_INVALID_ARGS;
+            }
+            if (source < 0) {
+                source = -1;
+            }
+        }
+        pMap->pSource[ch] = source;
+        if (source != (ma_int32)ch) {
+            pMap->identity = 0;
+        }
+    }
+
+    switch (outChannels) {
+        case 1:  pMap->remap = ta_channel_remap_1; break;
+        case 2:  pMap->remap = ta_channel_remap_2; break;
+        case 4:  pMap->remap = ta_channel_remap_4; break;
+        case 6:  pMap->remap = ta_channel_remap_6; break;
+        case 8:  pMap->remap = ta_channel_remap_8; break;
+        default: pMap->remap = ta_channel_remap_generic; break;
+    }
+
+    return MA_SUCCESS;
+}
+
+static void ta_channel_map_uninit(ta_channel_map* pMap, const ma_allocation_callbacks* pAllocationCallbacks) {
+    if (pMap->pSource) {
+        ma_free(pMap->pSource, pAllocationCallbacks);
+    }
+    memset(pMap, 0, sizeof(*pMap));
+}
+
+#endif /* TA_CHANNELS_H */
@@ -0,0 +1,228 @@
+/*
+ * ==============================================================================
+ * ta_drift.h - Adaptive Fractional Resampling Drift Compensation
+ * ==============================================================================
+ * Alternative to the skip/duplicate drift correction in playback_callback.
+ * Instead of dropping or repeating whole frames, the consumer reads the ring
+ * at a continuously adjusted rate of (1 + ppm * 1e-6) input frames per
+ * output frame:
+ *
+ *   - PI controller: steers the read rate from the smoothed ring fill level
+ *     so the ring settles on ringBufferTargetFrames. Its integral term is the
+ *     estimated capture/playback clock ratio error in ppm. It must be fed
+ *     the capture-phase-compensated fill (ta_fill_compensate): the raw fill
+ *     is a sawtooth whose phase creeps at the drift rate, slowly enough to
+ *     sit inside the loop bandwidth, and the integral would follow it.
+ *   - Farrow resampler: 4-tap cubic (Catmull-Rom) interpolator in Farrow
+ *     form. The coefficient polynomials are evaluated per output frame and
+ *     the inner loop runs across interleaved channels, so it vectorizes.
+ *     It is instantiated for 1, 2, 4, 6 and 8 channels (loop unrolled at
+ *     compile time) plus a generic version; ta_drift_init() picks one.
+ *
+ * LOOP TUNING:
+ *   The ring fill is an integrator of the rate error (Fs frames/s per unit
+ *   ratio), so with fill smoothed by a one-pole filter the loop is a
+ *   second-order system. Gains are derived from the sample rate for a
+ *   natural frequency of ~0.3 rad/s, damping 0.7: a 100ppm step is absorbed
+ *   in a few seconds with a ratio change far below audibility.
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h and ta_ring.h. All state is
+ *   owned by the playback thread; no locks, no allocation after init.
+ * ==============================================================================
+ */
+
+#ifndef TA_DRIFT_H
+#define TA_DRIFT_H
+
+#include <string.h>
+
+/* Clamp on the applied ratio correction (0.2%, ~3.5 cents of pitch) */
+#define TA_DRIFT_MAX_PPM                2000.0
+
+/* Closed-loop natural frequency (rad/s) and damping of the PI controller */
+#define TA_DRIFT_LOOP_OMEGA             0.3
+#define TA_DRIFT_LOOP_DAMPING           0.7
+
+/* Time constant of the fill level smoother (seconds) */
+#define TA_DRIFT_FILL_SMOOTHING_SEC     0.25
+
+/*
+ * Frames of history kept in front of new input. The cubic needs x[-1]..x[2];
+ * the fourth frame is slack so the x[2] tap never runs past the input that
+ * was read when the rate is below 1.0.
+ */
+#define TA_DRIFT_HISTORY_FRAMES         4
+
+typedef struct ta_drift ta_drift;
+
+struct ta_drift {
+    /* PI controller */
+    double kp;                  /* ppm per frame of fill error */
+    double ki;                  /* ppm per frame-second of fill error */
+    double integralPpm;         /* Estimated clock ratio error */
+    double smoothedFill;        /* Low-passed ring fill (frames) */
+    double sampleRate;
+
+    /* Farrow resampler */
+    double phase;               /* Fractional read position in [0, 1) */
+    float* pScratch;            /* History + input frames, interleaved */
+    ma_uint32 scratchCapacityFrames;
+    ma_uint32 channels;
+    ma_uint32 (*process)(ta_drift* pDrift, float* pOutput, ma_uint32 frameCount, ma_uint32 inputFrames, double step);
+};
+
+static ma_uint32 ta_drift_process_generic(ta_drift* pDrift, float* pOutput, ma_uint32 frameCount, ma_uint32 inputFrames, double step);
+static ma_uint32 ta_drift_process_1(ta_drift* pDrift, float* pOutput, ma_uint32 frameCount, ma_uint32 inputFrames, double step);
+static ma_uint32 ta_drift_process_2(ta_drift* pDrift, float* pOutput, ma_uint32 frameCount, ma_uint32 inputFrames, double step);
+static ma_uint32 ta_drift_process_4(ta_drift* pDrift, float* pOutput, ma_uint32 frameCount, ma_uint32 inputFrames, double step);
+static ma_uint32 ta_drift_process_6(ta_drift* pDrift, float* pOutput, ma_uint32 frameCount, ma_uint32 inputFrames, double step);
+static ma_uint32 ta_drift_process_8(ta_drift* pDrift, float* pOutput, ma_uint32 frameCount, ma_uint32 inputFrames, double step);
+
+static ma_result ta_drift_init(ta_drift* pDrift, ma_uint32 channels, ma_uint32 maxInputFrames,
+    const ma_allocation_callbacks* pAllocationCallbacks) {
+    memset(pDrift, 0, sizeof(*pDrift));
+
+    pDrift->channels = channels;
+    pDrift->scratchCapacityFrames = maxInputFrames + TA_DRIFT_HISTORY_FRAMES;
+    pDrift->pScratch = (float*)ma_aligned_malloc((size_t)pDrift->scratchCapacityFrames * channels * sizeof(float), TA_CACHE_LINE_SIZE, pAllocationCallbacks);
+    if (!pDrift->pScratch) {
+        return MA_OUT_OF_MEMORY;
+    }
+    memset(pDrift->pScratch, 0, (size_t)pDrift->scratchCapacityFrames * channels * sizeof(float));
+
+    switch (channels) {
+        case 1:  pDrift->process = ta_drift_process_1; break;
+        case 2:  pDrift->process = ta_drift_process_2; break;
+        case 4:  pDrift->process = ta_drift_process_4; break;
+        case 6:  pDrift->process = ta_drift_process_6; break;
+        case 8:  pDrift->process = ta_drift_process_8; break;
+        default: pDrift->process = ta_drift_process_generic; break;
+    }
+    return MA_SUCCESS;
+}
+
+static void ta_drift_uninit(ta_drift* pDrift, const ma_allocation_callbacks* pAllocationCallbacks) {
+    if (pDrift->pScratch) {
+        ma_aligned_free(pDrift->pScratch, pAllocationCallbacks);
+    }
+    memset(pDrift, 0, sizeof(*pDrift));
+}
+
+/* Reset loop state before a start. initialFill is the pre-filled level. */
+static void ta_drift_reset(ta_drift* pDrift, ma_uint32 sampleRate, ma_uint32 initialFill) {
+    pDrift->sampleRate = (sampleRate > 0) ? (double)sampleRate : 48000.0;
+    pDrift->kp = 2.0 * TA_DRIFT_LOOP_DAMPING * TA_DRIFT_LOOP_OMEGA * 1e6 / pDrift->sampleRate;
+    pDrift->ki = TA_DRIFT_LOOP_OMEGA * TA_DRIFT_LOOP_OMEGA * 1e6 / pDrift->sampleRate;
+    pDrift->integralPpm = 0.0;
+    pDrift->smoothedFill = (double)initialFill;
+    pDrift->phase = 0.0;
+    memset(pDrift->pScratch, 0, (size_t)TA_DRIFT_HISTORY_FRAMES * pDrift->channels * sizeof(float));
+}
+
+/*
+ * Feed one compensated fill observation (taken at the start of a callback
+ * of frameCount frames) and return the read rate, in input frames per
+ * output frame.
+ */
+static double ta_drift_update(ta_drift* pDrift, double fill, ma_uint32 targetFill, ma_uint32 frameCount) {
+    double dt = (double)frameCount / pDrift->sampleRate;
+    double alpha = dt / (TA_DRIFT_FILL_SMOOTHING_SEC + dt);
+    pDrift->smoothedFill += alpha * (fill - pDrift->smoothedFill);
+
+    /* Positive error = ring filling up = capture clock faster = read faster */
+    double error = pDrift->smoothedFill - (double)targetFill;
+    double ppm = pDrift->kp * error + pDrift->integralPpm;
+
+    /* Conditional integration: never wind up past the clamp */
+    if ((ppm < TA_DRIFT_MAX_PPM || error < 0.0) && (ppm > -TA_DRIFT_MAX_PPM || error > 0.0)) {
+        pDrift->integralPpm += pDrift->ki * error * dt;
+    }
+
+    if (ppm > TA_DRIFT_MAX_PPM)  ppm = TA_DRIFT_MAX_PPM;
+    if (ppm < -TA_DRIFT_MAX_PPM) ppm = -TA_DRIFT_MAX_PPM;
+
+    return 1.0 + ppm * 1e-6;
+}
+
+/* Input frames that ta_drift_process will consume to emit frameCount frames */
+static MA_INLINE ma_uint32 ta_drift_input_frames(const ta_drift* pDrift, double step, ma_uint32 frameCount) {
+    return (ma_uint32)(pDrift->phase + step * (double)frameCount);
+}
+
+/* Resampler body; channels is a compile-time constant in the specialized versions */
+static MA_INLINE ma_uint32 ta_drift_process_frames(ta_drift* pDrift, float* pOutput, ma_uint32 frameCount,
+    ma_uint32 inputFrames, double step, const ma_uint32 channels) {
+    const float* pIn = pDrift->pScratch;
+    const ma_uint32 lastIndex = inputFrames + TA_DRIFT_HISTORY_FRAMES - 1;
+    const double phase = pDrift->phase;
+    ma_uint32 produced;
+
+    /*
+     * Positions are computed as phase + k * step rather than accumulated, so
+     * the frame count consumed matches ta_drift_input_frames() exactly.
+     */
+    for (produced = 0; produced < frameCount; produced++) {
+        double position = phase + step * (double)produced;
+        ma_uint32 base = (ma_uint32)position;   /* Index of x[-1]; interpolates between base+1 and base+2 */
+        if (base + 3 > lastIndex) {
+            break;
+        }
+
+        const float t = (float)(position - (double)base);
+        const float* xm1 = pIn + (size_t)(base + 0) * channels;
+        const float* x0  = pIn + (size_t)(base + 1) * channels;
+        const float* x1  = pIn + (size_t)(base + 2) * channels;
+        const float* x2  = pIn + (size_t)(base + 3) * channels;
+        float* pOut = pOutput + (size_t)produced * channels;
+
+        for (ma_uint32 ch = 0; ch < channels; ch++) {
+            float c1 = 0.5f * (x1[ch] - xm1[ch]);
+            float c2 = xm1[ch] - 2.5f * x0[ch] + 2.0f * x1[ch] - 0.5f * x2[ch];
+            float c3 = 0.5f * (x2[ch] - xm1[ch]) + 1.5f * (x0[ch] - x1[ch]);
+            pOut[ch] = ((c3 * t + c2) * t + c1) * t + x0[ch];
+        }
+    }
+
+    /*
+     * Keep the last history frames for the next interpolation point. On an
+     * underrun the next callback restarts from the newest input.
+     */
+    memmove(pDrift->pScratch, pDrift->pScratch + (size_t)inputFrames * channels,
+        (size_t)TA_DRIFT_HISTORY_FRAMES * channels * sizeof(float));
+    if (produced == frameCount) {
+        pDrift->phase = phase + step * (double)frameCount - (double)inputFrames;
+    } else {
+        pDrift->phase = 0.0;
+    }
+
+    return produced;
+}
+
+#define TA_DRIFT_DEFINE_PROCESS(N) \
+    static ma_uint32 ta_drift_process_##N(ta_drift* pDrift, float* pOutput, ma_uint32 frameCount, ma_uint32 inputFrames, double step) { \
+        return ta_drift_process_frames(pDrift, pOutput, frameCount, inputFrames, step, N); \
+    }
+
+TA_DRIFT_DEFINE_PROCESS(1)
+TA_DRIFT_DEFINE_PROCESS(2)
+TA_DRIFT_DEFINE_PROCESS(4)
+TA_DRIFT_DEFINE_PROCESS(6)
+TA_DRIFT_DEFINE_PROCESS(8)
+
+static ma_uint32 ta_drift_process_generic(ta_drift* pDrift, float* pOutput, ma_uint32 frameCount, ma_uint32 inputFrames, double step) {
+    return ta_drift_process_frames(pDrift, pOutput, frameCount, inputFrames, step, pDrift->channels);
+}
+
+/*
+ * Resample. The caller has copied inputFrames new frames into
+ * pScratch + TA_DRIFT_HISTORY_FRAMES * channels. Emits up to frameCount
+ * frames and returns how many; fewer only if input runs short (underrun).
+ * Leaves the last TA_DRIFT_HISTORY_FRAMES input frames at the front of
+ * pScratch for the next call.
+ */
+static MA_INLINE ma_uint32 ta_drift_process(ta_drift* pDrift, float* pOutput, ma_uint32 frameCount, ma_uint32 inputFrames, double step) {
+    return pDrift->process(pDrift, pOutput, frameCount, inputFrames, step);
+}
+
+#endif /* TA_DRIFT_H */
@@ -0,0 +1,125 @@
+/*
+ * ==============================================================================
+ * ta_events.h - Lock-Free Event Queue for Engine Notifications
+ * ==============================================================================
+ * Errors and state changes used to call the registered callbacks directly,
+ * on whatever thread noticed them: Miniaudio's device thread for start/stop
+ * notifications, the control thread otherwise. Those callbacks land in
+ * managed code, where a GC pause would stall the device thread with them.
+ *
+ * Instead, notifying posts a fixed-size record into this queue and returns;
+ * a dispatcher thread (TransparencyAudio.c) drains it and invokes the
+ * callbacks.
+ *
+ *   - Bounded multi-producer / single-consumer queue (Vyukov): each slot
+ *     carries a sequence number, a producer claims a slot with one CAS on
+ *     the enqueue position and publishes it with a release store.
+ *   - Producers never wait: when the queue is full the event is dropped
+ *     and droppedCount is incremented.
+ *   - Records are copied in full, messages truncated to
+ *     TA_EVENT_MESSAGE_LENGTH - 1 characters; nothing is allocated.
+ *
+ * USAGE:
+ *   Internal header. Include after TransparencyAudio.h, miniaudio.h and
+ *   ta_ring.h. ta_event_queue_init() before the first post; one consumer.
+ * ==============================================================================
+ */
+
+#ifndef TA_EVENTS_H
+#define TA_EVENTS_H
+
+#include <string.h>
+
+#define TA_EVENT_QUEUE_CAPACITY     64      /* Power of two */
+#define TA_EVENT_MESSAGE_LENGTH     128
+
+typedef enum {
+    TA_EVENT_ERROR = 0,             /* result, message */
+    TA_EVENT_STATE_CHANGED          /* value = isRunning */
+} ta_event_type;
+
+typedef struct {
+    ta_event_type type;
+    ta_result result;
+    int32_t value;
+    wchar_t message[TA_EVENT_MESSAGE_LENGTH];
+} ta_event;
+
+typedef struct {
+    volatile ma_uint32 sequence;    /* == position: free for that enqueue; == position + 1: full */
+    ta_event event;
+} ta_event_slot;
+
+typedef struct {
+    TA_ALIGN(TA_CACHE_LINE_SIZE) volatile ma_uint32 enqueuePosition;
+    TA_ALIGN(TA_CACHE_LINE_SIZE) volatile ma_uint32 dequeuePosition;
+    volatile ma_uint32 droppedCount;
+    ta_event_slot slots[TA_EVENT_QUEUE_CAPACITY];
+} ta_event_queue;
+
+static void ta_event_queue_init(ta_event_queue* pQueue) {
+    for (ma_uint32 i = 0; i < TA_EVENT_QUEUE_CAPACITY; i++) {
+        pQueue->slots[i].sequence = i;
+    }
+    pQueue->enqueuePosition = 0;
+    pQueue->dequeuePosition = 0;
+    pQueue->droppedCount = 0;
+}
+
+/* Post one event. Never blocks; returns 0 (and counts it) if the queue is full. */
+static int ta_event_post(ta_event_queue* pQueue, ta_event_type type, ta_result result, int32_t value, const wchar_t* message) {
+    ma_uint32 position = ma_atomic_load_explicit_32(&pQueue->enqueuePosition, ma_atomic_memory_order_relaxed);
+    ta_event_slot* pSlot;
+
+    for (;;) {
+        pSlot = &pQueue->slots[position & (TA_EVENT_QUEUE_CAPACITY - 1)];
+        ma_uint32 sequence = ma_atomic_load_explicit_32(&pSlot->sequence, ma_atomic_memory_order_acquire);
+        ma_int32 difference = (ma_int32)(sequence - position);
+
+        if (difference == 0) {
+            if (ma_atomic_compare_exchange_weak_explicit_32(&pQueue->enqueuePosition, &position, position + 1,
+                    ma_atomic_memory_order_relaxed, ma_atomic_memory_order_relaxed)) {
+                break;
+            }
+            /* Lost the race: position now holds the current value */
+        } else if (difference < 0) {
+            /* Slot still holds an undelivered event from one lap ago: full */
+            ma_atomic_fetch_add_explicit_32(&pQueue->droppedCount, 1, ma_atomic_memory_order_relaxed);
+            return 0;
+        } else {
+            position = ma_atomic_load_explicit_32(&pQueue->enqueuePosition, ma_atomic_memory_order_relaxed);
+        }
+    }
+
+    pSlot->event.type = type;
+    pSlot->event.result = result;
+    pSlot->event.value = value;
+    pSlot->event.message[0] = L'\0';
+    if (message) {
+        size_t i = 0;
+        for (; i < TA_EVENT_MESSAGE_LENGTH - 1 && message[i] != L'\0'; i++) {
+            pSlot->event.message[i] = message[i];
+        }
+        pSlot->event.message[i] = L'\0';
+    }
+
+    ma_atomic_store_explicit_32(&pSlot->sequence, position + 1, ma_atomic_memory_order_release);
+    return 1;
+}
+
+/* Take the oldest event (single consumer). Returns 0 if the queue is empty. */
+static int ta_event_take(ta_event_queue* pQueue, ta_event* pEvent) {
+    ma_uint32 position = pQueue->dequeuePosition;
+    ta_event_slot* pSlot = &pQueue->slots[position & (TA_EVENT_QUEUE_CAPACITY - 1)];
+
+    if (ma_atomic_load_explicit_32(&pSlot->sequence, ma_atomic_memory_order_acquire) != position + 1) {
+        return 0;
+    }
+
+    *pEvent = pSlot->event;
+    pQueue->dequeuePosition = position + 1;
+    ma_atomic_store_explicit_32(&pSlot->sequence, position + TA_EVENT_QUEUE_CAPACITY, ma_atomic_memory_order_release);
+    return 1;
+}
+
+#endif /* TA_EVENTS_H */
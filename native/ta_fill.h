@@ -0,0 +1,150 @@
+/*
+ * ==============================================================================
+ * ta_fill.h - Phase-Compensated Fill Estimator for Skip/Duplicate Drift
+ * ==============================================================================
+ * A raw ring fill read from the playback callback is a sawtooth: it jumps
+ * by a whole capture period whenever the capture thread commits, so what
+ * the playback side sees depends on where the two callbacks happen to sit
+ * relative to each other. Thresholds on that value fire on scheduling
+ * noise. This estimator removes the capture phase and the jitter before
+ * any decision is made:
+ *
+ *   - Phase compensation: the capture side stamps each commit. Frames the
+ *     capture device has recorded since then but not yet delivered are
+ *     rate * (now - stamp), at most one period; adding them and taking
+ *     away half a period gives the period-averaged fill, a smooth ramp
+ *     rather than a sawtooth.
+ *   - Smoothing: one-pole filter with a TA_FILL_SMOOTHING_SEC time
+ *     constant, stepped by the playback callback's duration.
+ *   - Hysteresis: a correction run starts when the estimate crosses an
+ *     enter threshold and continues until it is back past the release
+ *     threshold nearer the target, so an estimate hovering at a threshold
+ *     does not chatter.
+ *   - Rate limit: at most one single-frame correction every
+ *     TA_FILL_CORRECTION_INTERVAL_MS (100 frames/s, ~2000ppm at 48kHz).
+ *   - Overrun ceiling: with a ring only a little larger than a capture
+ *     period, the high bands can sit above the level at which the next
+ *     commit no longer fits. They are pulled under it, so skipping starts
+ *     before the capture side has to drop input - unless the ceiling is
+ *     down at the underrun floor, where no level avoids both and the bands
+ *     are left alone (an overrun drops frames, an underrun leaves a gap).
+ *
+ * Real underruns (fewer frames in the ring than the callback needs) are
+ * still handled immediately by the caller; the estimator only decides the
+ * proactive skips and duplicates.
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h. All state is owned by the
+ *   playback thread; the capture stamp is read with relaxed loads.
+ * ==============================================================================
+ */
+
+#ifndef TA_FILL_H
+#define TA_FILL_H
+
+/* Time constant of the fill smoother (seconds) */
+#define TA_FILL_SMOOTHING_SEC           0.5
+
+/* Shortest gap between two proactive corrections */
+#define TA_FILL_CORRECTION_INTERVAL_MS  10
+
+typedef enum {
+    TA_FILL_HOLD = 0,           /* No correction this callback */
+    TA_FILL_SKIP = 1,           /* Drop one frame (fill too high) */
+    TA_FILL_DUPLICATE = -1      /* Repeat one frame (fill too low) */
+} ta_fill_action;
+
+typedef struct {
+    double smoothedFill;
+    double sampleRate;
+    ta_fill_action run;         /* Correction run in progress */
+    ma_uint32 framesSinceCorrection;
+    ma_uint32 correctionIntervalFrames;
+} ta_fill_estimator;
+
+/* Thresholds in frames: enter < release on the low side, release < enter on the high side */
+typedef struct {
+    double lowEnter;
+    double lowRelease;
+    double highRelease;
+    double highEnter;
+} ta_fill_bands;
+
+/*
+ * Keep the skip bands under ceilingFill, the estimate above which a capture
+ * commit would overrun the ring, if it is above floorFill, the one below
+ * which playback underruns. The release stays halfway between the target
+ * and the enter threshold so a run still ends near the target.
+ */
+static MA_INLINE void ta_fill_limit_high_bands(ta_fill_bands* pBands, double ceilingFill, double floorFill,
+    double targetFill) {
+    if (pBands->highEnter <= ceilingFill || ceilingFill < floorFill) {
+        return;
+    }
+    pBands->highEnter = (ceilingFill > targetFill) ? ceilingFill : targetFill;
+    double release = 0.5 * (targetFill + pBands->highEnter);
+    if (pBands->highRelease > release) {
+        pBands->highRelease = release;
+    }
+}
+
+/* Reset before a start. initialFill is the pre-filled level. */
+static void ta_fill_reset(ta_fill_estimator* pFill, ma_uint32 sampleRate, ma_uint32 initialFill) {
+    pFill->sampleRate = (sampleRate > 0) ? (double)sampleRate : 48000.0;
+    pFill->smoothedFill = (double)initialFill;
+    pFill->run = TA_FILL_HOLD;
+    pFill->correctionIntervalFrames = (ma_uint32)(pFill->sampleRate * TA_FILL_CORRECTION_INTERVAL_MS / 1000.0);
+    pFill->framesSinceCorrection = pFill->correctionIntervalFrames;
+}
+
+/*
+ * Period-averaged fill: rawFill as read, plus what the capture device has
+ * recorded since its last commit (elapsedNs ago), minus half a period.
+ */
+static MA_INLINE double ta_fill_compensate(const ta_fill_estimator* pFill, ma_uint32 rawFill,
+    ma_uint64 elapsedNs, ma_uint32 capturePeriodFrames) {
+    double pending = (double)elapsedNs * 1e-9 * pFill->sampleRate;
+    if (pending > (double)capturePeriodFrames) {
+        pending = (double)capturePeriodFrames;   /* Late capture is real drain, not phase */
+    }
+    return (double)rawFill + pending - 0.5 * (double)capturePeriodFrames;
+}
+
+/*
+ * Feed one compensated observation taken at the start of a callback of
+ * frameCount frames and return the correction to apply in it.
+ */
+static ta_fill_action ta_fill_update(ta_fill_estimator* pFill, double compensatedFill, ma_uint32 frameCount,
+    const ta_fill_bands* pBands) {
+    double dt = (double)frameCount / pFill->sampleRate;
+    double alpha = dt / (TA_FILL_SMOOTHING_SEC + dt);
+    pFill->smoothedFill += alpha * (compensatedFill - pFill->smoothedFill);
+    pFill->framesSinceCorrection += frameCount;
+
+    double fill = pFill->smoothedFill;
+    if (pFill->run == TA_FILL_SKIP && fill <= pBands->highRelease) {
+        pFill->run = TA_FILL_HOLD;
+    } else if (pFill->run == TA_FILL_DUPLICATE && fill >= pBands->lowRelease) {
+        pFill->run = TA_FILL_HOLD;
+    }
+    if (pFill->run == TA_FILL_HOLD) {
+        if (fill > pBands->highEnter) {
+            pFill->run = TA_FILL_SKIP;
+        } else if (fill < pBands->lowEnter) {
+            pFill->run = TA_FILL_DUPLICATE;
+        }
+    }
+
+    if (pFill->run == TA_FILL_HOLD || pFill->framesSinceCorrection < pFill->correctionIntervalFrames) {
+        return TA_FILL_HOLD;
+    }
+    pFill->framesSinceCorrection = 0;
+    return pFill->run;
+}
+
+/* The caller dropped or repeated a frame outside the estimator (underrun) */
+static MA_INLINE void ta_fill_note_correction(ta_fill_estimator* pFill) {
+    pFill->framesSinceCorrection = 0;
+}
+
+#endif /* TA_FILL_H */
@@ -0,0 +1,138 @@
+/*
+ * ==============================================================================
+ * ta_gain.h - Click-Free Volume Stage
+ * ==============================================================================
+ * Replaces the hard per-callback volume step with a ramp, in the spirit of
+ * Miniaudio's ma_gainer but driven through the SIMD kernel table:
+ *
+ *   - Every change of target (SetVolume, the Start fade-in, the Stop
+ *     fade-out) restarts a ramp of rampFrames from the gain currently
+ *     applied, so a ramp interrupted by a new target never jumps.
+ *   - LINEAR ramps are one gain_ramp kernel call per callback.
+ *   - EXPONENTIAL ramps move at constant dB/s (-60dB floor, then the last
+ *     segment lands on 0). They are applied as linear segments of at most
+ *     TA_GAIN_SEGMENT_FRAMES, with the exact curve value at each segment end.
+ *   - Settled, the stage is the same single pass as before the ramp
+ *     existed: copy at unity, fill at 0, gain otherwise.
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h and ta_kernels.h. State is
+ *   owned by the thread that runs the capture side of the route; the target
+ *   is passed in on every call.
+ * ==============================================================================
+ */
+
+#ifndef TA_GAIN_H
+#define TA_GAIN_H
+
+#include <string.h>
+#include <math.h>
+
+/* Longest linear segment of an exponential ramp (~1.3ms @ 48kHz) */
+#define TA_GAIN_SEGMENT_FRAMES      64
+
+/* Exponential ramps start/end at -60dB instead of 0 */
+#define TA_GAIN_EXP_FLOOR           0.001f
+
+typedef struct {
+    float current;              /* Gain of the next frame processed */
+    float rampFrom;             /* Gain when the ramp in progress began */
+    float rampTo;               /* Target of the ramp in progress (or settled gain) */
+    ma_uint32 rampElapsed;      /* Frames of the ramp already applied */
+    ma_uint32 rampLength;       /* Frames of the ramp in progress, 0 = settled */
+    ma_uint32 rampFrames;       /* Configured ramp length */
+    int exponential;
+} ta_gain;
+
+/* Settle at startGain. A later target differing from it starts a ramp. */
+static void ta_gain_reset(ta_gain* pGain, ma_uint32 rampFrames, int exponential, float startGain) {
+    memset(pGain, 0, sizeof(*pGain));
+    pGain->rampFrames = rampFrames;
+    pGain->exponential = exponential;
+    pGain->current = startGain;
+    pGain->rampFrom = startGain;
+    pGain->rampTo = startGain;
+}
+
+/* 1 once the applied gain has reached target */
+static MA_INLINE int ta_gain_is_settled(const ta_gain* pGain, float target) {
+    return pGain->rampLength == 0 && pGain->rampTo == target;
+}
+
+/* Curve value `elapsed` frames into the ramp */
+static float ta_gain_curve_at(const ta_gain* pGain, ma_uint32 elapsed) {
+    if (elapsed >= pGain->rampLength) {
+        return pGain->rampTo;
+    }
+
+    float t = (float)elapsed / (float)pGain->rampLength;
+    if (!pGain->exponential) {
+        return pGain->rampFrom + (pGain->rampTo - pGain->rampFrom) * t;
+    }
+
+    float from = (pGain->rampFrom > TA_GAIN_EXP_FLOOR) ? pGain->rampFrom : TA_GAIN_EXP_FLOOR;
+    float to = (pGain->rampTo > TA_GAIN_EXP_FLOOR) ? pGain->rampTo : TA_GAIN_EXP_FLOOR;
+    return from * powf(to / from, t);
+}
+
+/*
+ * pDst = pSrc * gain over frameCount interleaved frames, ramping toward
+ * target. pDst may equal pSrc.
+ */
+static void ta_gain_process(ta_gain* pGain, const ta_kernels* pKernels, float* pDst, const float* pSrc,
+    ma_uint32 channels, ma_uint32 frameCount, float target) {
+    if (target != pGain->rampTo) {
+        pGain->rampFrom = pGain->current;
+        pGain->rampTo = target;
+        pGain->rampElapsed = 0;
+        pGain->rampLength = pGain->rampFrames;
+        if (pGain->rampLength == 0) {
+            pGain->current = target;
+        }
+    }
+
+    ma_uint32 done = 0;
+
+    while (pGain->rampLength > 0 && done < frameCount) {
+        ma_uint32 frames = frameCount - done;
+        if (frames > pGain->rampLength - pGain->rampElapsed) {
+            frames = pGain->rampLength - pGain->rampElapsed;
+        }
+        if (pGain->exponential && frames > TA_GAIN_SEGMENT_FRAMES) {
+            frames = TA_GAIN_SEGMENT_FRAMES;
+        }
+
+        float start = pGain->current;
+        float end = ta_gain_curve_at(pGain, pGain->rampElapsed + frames);
+        pKernels->gain_ramp(pDst + (size_t)done * channels, pSrc + (size_t)done * channels,
+            channels, frames, start, (end - start) / (float)frames);
+
+        pGain->current = end;
+        pGain->rampElapsed += frames;
+        if (pGain->rampElapsed >= pGain->rampLength) {
+            pGain->rampLength = 0;
+        }
+        done += frames;
+    }
+
+    if (done == frameCount) {
+        return;
+    }
+
+    /* Settled: one plain pass */
+    float* pOut = pDst + (size_t)done * channels;
+    const float* pIn = pSrc + (size_t)done * channels;
+    ma_uint32 sampleCount = (frameCount - done) * channels;
+
+    if (pGain->current == 1.0f) {
+        if (pOut != pIn) {
+            pKernels->copy(pOut, pIn, sampleCount);
+        }
+    } else if (pGain->current == 0.0f) {
+        memset(pOut, 0, (size_t)sampleCount * sizeof(float));
+    } else {
+        pKernels->gain(pOut, pIn, sampleCount, pGain->current);
+    }
+}
+
+#endif /* TA_GAIN_H */
@@ -0,0 +1,541 @@
+/*
+ * ==============================================================================
+ * ta_glitch.h - Glitch Forensics: Rolling History Dumped Around Each Event
+ * ==============================================================================
+ * A crackle report comes with an underrun count and nothing else. With
+ * glitchCaptureMs set, the engine keeps the last glitchCaptureMs of output
+ * audio and a timing record per callback, and writes them out whenever an
+ * underrun, overrun or drift correction happens:
+ *
+ *   - History slots: TA_GLITCH_SLOTS buffers, each an audio ring (the route
+ *     output, f32) plus a ring of playback callback records. The playback
+ *     thread writes into the ACTIVE one.
+ *   - Trigger: the playback callback compares the underrun/overrun/drift
+ *     counters with their last values (no hooks on the counting sites).
+ *     A drift correction only starts a dump after a window without one
+ *     (the corrections that follow a disturbance are one incident).
+ *     Recording carries on for TA_GLITCH_POST_TRIGGER_MS, further events
+ *     merge into the same dump, then the slot is marked READY and the
+ *     playback thread moves to a FREE one. Nothing is copied; no FREE slot
+ *     means history stops (droppedCount) until the writer returns one.
+ *   - Capture records: a ring of their own, written by the capture
+ *     callback; the writer takes the newest half, which the capture thread
+ *     cannot reach before the copy is done.
+ *   - Writer (background thread, or ta_sim_run inline): for each READY slot
+ *     writes glitch-<session>-<n>.wav (f32) and a .json with the trigger,
+ *     the counters and both callback timelines aligned to WAV frames, then
+ *     sets the slot FREE.
+ *
+ * The audio threads only store and publish with release; the writer never
+ * holds anything they wait on. Cost per callback while nothing happens: one
+ * copy of the output into locked memory, one record, three compares.
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h and ta_arena.h.
+ *   ta_glitch_alloc() at Initialize (control thread), ta_glitch_*_callback()
+ *   and ta_glitch_record_audio() from the callbacks, ta_glitch_service()
+ *   on the writer, ta_glitch_flush() once the callbacks have stopped.
+ * ==============================================================================
+ */
+
+#ifndef TA_GLITCH_H
+#define TA_GLITCH_H
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <wchar.h>
+
+#define TA_GLITCH_SLOTS                 3
+#define TA_GLITCH_MAX_WINDOW_MS         2000
+#define TA_GLITCH_POST_TRIGGER_MS       100     /* Capped at half the window */
+#define TA_GLITCH_PLAYBACK_RECORDS      1024    /* Per slot; power of two */
+#define TA_GLITCH_CAPTURE_RECORDS       2048    /* Power of two; the newest half is dumped */
+#define TA_GLITCH_DEFAULT_MAX_DUMPS     16      /* Per Initialize, when glitchMaxDumps is 0 */
+#define TA_GLITCH_PATH_LENGTH           512
+
+/* Event bits in a record / dump */
+#define TA_GLITCH_UNDERRUN              1u
+#define TA_GLITCH_OVERRUN               2u
+#define TA_GLITCH_DRIFT                 4u
+
+typedef enum {
+    TA_GLITCH_SLOT_FREE = 0,
+    TA_GLITCH_SLOT_ACTIVE,          /* Playback thread writes it */
+    TA_GLITCH_SLOT_READY            /* Writer owns it */
+} ta_glitch_slot_state;
+
+typedef struct {
+    ma_uint64 timeNs;           /* Callback start, engine clock */
+    ma_uint64 frame;            /* Playback: slot audio frame at callback start */
+    ma_uint32 executionNs;
+    ma_uint32 frames;
+    ma_uint32 fillFrames;       /* Ring fill at callback end */
+    ma_uint32 events;           /* TA_GLITCH_* seen in this callback */
+} ta_glitch_record;
+
+typedef struct {
+    volatile ma_uint32 state;   /* ta_glitch_slot_state */
+    float* pAudio;              /* capacityFrames * channels */
+    ta_glitch_record* pRecords; /* TA_GLITCH_PLAYBACK_RECORDS */
+    ma_uint64 audioFrames;      /* Frames ever written into this slot */
+    ma_uint64 recordCount;
+    ma_uint32 events;           /* Everything merged into this dump (0 = no trigger yet) */
+    ma_uint64 triggerFrame;
+    ma_uint64 triggerNs;
+    ma_uint32 postFramesLeft;
+    ma_uint64 underrunCount;    /* Counters when the slot was handed over */
+    ma_uint64 overrunCount;
+    ma_uint64 driftCorrectionCount;
+} ta_glitch_slot;
+
+typedef struct {
+    int enabled;
+    ma_uint32 channels;
+    ma_uint32 sampleRate;
+    ma_uint32 capacityFrames;   /* Power of two >= windowFrames */
+    ma_uint32 windowFrames;
+    ma_uint32 postTriggerFrames;
+    ma_uint32 maxDumps;
+    char session[32];           /* File name stamp, fixed at ta_glitch_alloc */
+
+    ta_glitch_slot slots[TA_GLITCH_SLOTS];
+
+    /* Playback thread */
+    ta_glitch_slot* pActive;    /* NULL: every slot is with the writer */
+    ma_uint64 lastUnderruns;
+    ma_uint64 lastOverruns;
+    ma_uint64 lastDrifts;
+    ma_uint64 framesSinceDrift; /* Drift triggers again once this reaches windowFrames */
+    ma_uint32 triggerCount;     /* Dumps started (<= maxDumps) */
+
+    /* Capture thread */
+    ta_glitch_record* pCaptureRecords;
+    volatile ma_uint64 captureRecordCount;
+    ma_uint64 lastCaptureOverruns;
+
+    /* Writer */
+    ma_uint32 nextFile;
+    volatile ma_uint32 dumpCount;
+    volatile ma_uint32 droppedCount;    /* Events with no slot to record into (playback) */
+} ta_glitch;
+
+/* ==== SETUP (CONTROL THREAD) ==== */
+
+static ma_uint32 ta_glitch_next_pow2(ma_uint32 value) {
+    ma_uint32 result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+/* Allocate the history (windowMs 0 = disabled). Buffers come from pAllocationCallbacks. */
+static ma_result ta_glitch_alloc(ta_glitch* pGlitch, ma_uint32 windowMs, ma_uint32 maxDumps, ma_uint32 sampleRate,
+    ma_uint32 channels, const ma_allocation_callbacks* pAllocationCallbacks) {
+    memset(pGlitch, 0, sizeof(*pGlitch));
+    if (windowMs == 0) {
+        return MA_SUCCESS;
+    }
+    if (windowMs > TA_GLITCH_MAX_WINDOW_MS) {
+        windowMs = TA_GLITCH_MAX_WINDOW_MS;
+    }
+
+    pGlitch->channels = channels;
+    pGlitch->sampleRate = sampleRate;
+    pGlitch->windowFrames = (ma_uint32)((ma_uint64)sampleRate * windowMs / 1000);
+    pGlitch->capacityFrames = ta_glitch_next_pow2(pGlitch->windowFrames);
+    pGlitch->postTriggerFrames = sampleRate * TA_GLITCH_POST_TRIGGER_MS / 1000;
+    if (pGlitch->postTriggerFrames > pGlitch->windowFrames / 2) {
+        pGlitch->postTriggerFrames = pGlitch->windowFrames / 2;
+    }
+    pGlitch->maxDumps = maxDumps > 0 ? maxDumps : TA_GLITCH_DEFAULT_MAX_DUMPS;
+
+    for (ma_uint32 i = 0; i < TA_GLITCH_SLOTS; i++) {
+        ta_glitch_slot* pSlot = &pGlitch->slots[i];
+        pSlot->pAudio = (float*)ma_malloc((size_t)pGlitch->capacityFrames * channels * sizeof(float), pAllocationCallbacks);
+        pSlot->pRecords = (ta_glitch_record*)ma_malloc(TA_GLITCH_PLAYBACK_RECORDS * sizeof(ta_glitch_record), pAllocationCallbacks);
+        if (!pSlot->pAudio || !pSlot->pRecords) {
+            return MA_OUT_OF_MEMORY;    /* Freed with the allocator (arena) */
+        }
+    }
+    pGlitch->pCaptureRecords = (ta_glitch_record*)ma_malloc(TA_GLITCH_CAPTURE_RECORDS * sizeof(ta_glitch_record), pAllocationCallbacks);
+    if (!pGlitch->pCaptureRecords) {
+        return MA_OUT_OF_MEMORY;
+    }
+
+    time_t now = time(NULL);
+    struct tm* pLocal = localtime(&now);
+    if (pLocal) {
+        strftime(pGlitch->session, sizeof(pGlitch->session), "%Y%m%d-%H%M%S", pLocal);
+    } else {
+        snprintf(pGlitch->session, sizeof(pGlitch->session), "%llu", (unsigned long long)now);
+    }
+
+    pGlitch->slots[0].state = TA_GLITCH_SLOT_ACTIVE;
+    pGlitch->pActive = &pGlitch->slots[0];
+    pGlitch->enabled = 1;
+    return MA_SUCCESS;
+}
+
+/* Playback thread: take a FREE slot, if the writer has returned one */
+static ta_glitch_slot* ta_glitch_claim_slot(ta_glitch* pGlitch) {
+    for (ma_uint32 i = 0; i < TA_GLITCH_SLOTS; i++) {
+        ta_glitch_slot* pSlot = &pGlitch->slots[i];
+        if (ma_atomic_load_explicit_32(&pSlot->state, ma_atomic_memory_order_acquire) == TA_GLITCH_SLOT_FREE) {
+            pSlot->audioFrames = 0;
+            pSlot->recordCount = 0;
+            pSlot->events = 0;
+            pSlot->postFramesLeft = 0;
+            ma_atomic_store_explicit_32(&pSlot->state, TA_GLITCH_SLOT_ACTIVE, ma_atomic_memory_order_relaxed);
+            return pSlot;
+        }
+    }
+    return NULL;
+}
+
+/* Start (callbacks stopped, counters just reset): history from before the last Stop is dropped */
+static void ta_glitch_prime(ta_glitch* pGlitch) {
+    if (!pGlitch->enabled) {
+        return;
+    }
+
+    pGlitch->lastUnderruns = 0;
+    pGlitch->lastOverruns = 0;
+    pGlitch->lastDrifts = 0;
+    pGlitch->lastCaptureOverruns = 0;
+    pGlitch->framesSinceDrift = pGlitch->windowFrames;
+    if (pGlitch->pActive) {
+        pGlitch->pActive->audioFrames = 0;
+        pGlitch->pActive->recordCount = 0;
+        pGlitch->pActive->events = 0;
+    } else {
+        pGlitch->pActive = ta_glitch_claim_slot(pGlitch);
+    }
+}
+
+/* ==== CALLBACKS ==== */
+
+/* Playback thread: append rendered output (route channels, f32) */
+static void ta_glitch_record_audio(ta_glitch* pGlitch, const float* pOutput, ma_uint32 frameCount) {
+    ta_glitch_slot* pSlot = pGlitch->pActive;
+    if (!pSlot) {
+        return;
+    }
+
+    ma_uint32 channels = pGlitch->channels;
+    ma_uint32 mask = pGlitch->capacityFrames - 1;
+    ma_uint32 done = 0;
+    while (done < frameCount) {
+        ma_uint32 index = (ma_uint32)((pSlot->audioFrames + done) & mask);
+        ma_uint32 frames = frameCount - done;
+        if (frames > pGlitch->capacityFrames - index) {
+            frames = pGlitch->capacityFrames - index;
+        }
+        memcpy(pSlot->pAudio + (size_t)index * channels, pOutput + (size_t)done * channels,
+            (size_t)frames * channels * sizeof(float));
+        done += frames;
+    }
+    pSlot->audioFrames += frameCount;
+}
+
+/*
+ * Playback thread, end of callback (after ta_glitch_record_audio).
+ * The counters are the engine's running totals.
+ */
+static void ta_glitch_playback_callback(ta_glitch* pGlitch, ma_uint64 timeNs, ma_uint64 executionNs, ma_uint32 frameCount,
+    ma_uint32 fillFrames, ma_uint64 underruns, ma_uint64 overruns, ma_uint64 drifts) {
+    if (!pGlitch->enabled) {
+        return;
+    }
+
+    ma_uint32 events = 0;
+    if (underruns != pGlitch->lastUnderruns) events |= TA_GLITCH_UNDERRUN;
+    if (overruns != pGlitch->lastOverruns)   events |= TA_GLITCH_OVERRUN;
+    if (drifts != pGlitch->lastDrifts)       events |= TA_GLITCH_DRIFT;
+    pGlitch->lastUnderruns = underruns;
+    pGlitch->lastOverruns = overruns;
+    pGlitch->lastDrifts = drifts;
+
+    /* Recorded either way; only a first correction after a quiet window triggers */
+    ma_uint32 triggers = events;
+    if (events & TA_GLITCH_DRIFT) {
+        if (pGlitch->framesSinceDrift < pGlitch->windowFrames) {
+            triggers &= ~TA_GLITCH_DRIFT;
+        }
+        pGlitch->framesSinceDrift = 0;
+    } else {
+        pGlitch->framesSinceDrift += frameCount;
+    }
+
+    ta_glitch_slot* pSlot = pGlitch->pActive;
+    if (!pSlot) {
+        pSlot = pGlitch->pActive = ta_glitch_claim_slot(pGlitch);
+        if (!pSlot) {
+            if (triggers) {
+                ma_atomic_fetch_add_explicit_32(&pGlitch->droppedCount, 1, ma_atomic_memory_order_relaxed);
+            }
+            return;
+        }
+    }
+
+    ta_glitch_record* pRecord = &pSlot->pRecords[pSlot->recordCount & (TA_GLITCH_PLAYBACK_RECORDS - 1)];
+    pRecord->timeNs = timeNs;
+    pRecord->frame = pSlot->audioFrames - frameCount;
+    pRecord->executionNs = (ma_uint32)(executionNs < 0xFFFFFFFFu ? executionNs : 0xFFFFFFFFu);
+    pRecord->frames = frameCount;
+    pRecord->fillFrames = fillFrames;
+    pRecord->events = events;
+    pSlot->recordCount++;
+
+    if (!pSlot->events) {
+        if (!triggers || pGlitch->triggerCount >= pGlitch->maxDumps) {
+            return;                     /* Nothing to dump: keep rolling */
+        }
+        pGlitch->triggerCount++;
+        pSlot->events = events;
+        pSlot->triggerFrame = pRecord->frame;
+        pSlot->triggerNs = timeNs;
+        pSlot->postFramesLeft = pGlitch->postTriggerFrames;
+        return;
+    }
+
+    pSlot->events |= events;            /* Inside the post-trigger tail: same dump */
+    if (pSlot->postFramesLeft > frameCount) {
+        pSlot->postFramesLeft -= frameCount;
+        return;
+    }
+
+    /* Tail recorded: hand the slot to the writer and continue in a free one */
+    pSlot->underrunCount = underruns;
+    pSlot->overrunCount = overruns;
+    pSlot->driftCorrectionCount = drifts;
+    ma_atomic_store_explicit_32(&pSlot->state, TA_GLITCH_SLOT_READY, ma_atomic_memory_order_release);
+    pGlitch->pActive = ta_glitch_claim_slot(pGlitch);
+}
+
+/* Capture thread, end of callback */
+static void ta_glitch_capture_callback(ta_glitch* pGlitch, ma_uint64 timeNs, ma_uint64 executionNs, ma_uint32 frameCount,
+    ma_uint32 fillFrames, ma_uint64 overruns) {
+    if (!pGlitch->enabled) {
+        return;
+    }
+
+    ma_uint64 count = pGlitch->captureRecordCount;
+    ta_glitch_record* pRecord = &pGlitch->pCaptureRecords[count & (TA_GLITCH_CAPTURE_RECORDS - 1)];
+    pRecord->timeNs = timeNs;
+    pRecord->frame = 0;
+    pRecord->executionNs = (ma_uint32)(executionNs < 0xFFFFFFFFu ? executionNs : 0xFFFFFFFFu);
+    pRecord->frames = frameCount;
+    pRecord->fillFrames = fillFrames;
+    pRecord->events = (overruns != pGlitch->lastCaptureOverruns) ? TA_GLITCH_OVERRUN : 0;
+    pGlitch->lastCaptureOverruns = overruns;
+    ma_atomic_store_explicit_64(&pGlitch->captureRecordCount, count + 1, ma_atomic_memory_order_release);
+}
+
+/* Callbacks stopped: hand over a slot still recording its post-trigger tail */
+static void ta_glitch_flush(ta_glitch* pGlitch) {
+    ta_glitch_slot* pSlot = pGlitch->pActive;
+    if (pSlot && pSlot->events) {
+        pSlot->underrunCount = pGlitch->lastUnderruns;
+        pSlot->overrunCount = pGlitch->lastOverruns;
+        pSlot->driftCorrectionCount = pGlitch->lastDrifts;
+        ma_atomic_store_explicit_32(&pSlot->state, TA_GLITCH_SLOT_READY, ma_atomic_memory_order_release);
+        pGlitch->pActive = ta_glitch_claim_slot(pGlitch);
+    }
+}
+
+/* ==== WRITER ==== */
+
+static FILE* ta_glitch_open(const wchar_t* directory, const char* name) {
+#if defined(_WIN32)
+    wchar_t path[TA_GLITCH_PATH_LENGTH];
+    if (directory && directory[0]) {
+        _snwprintf(path, TA_GLITCH_PATH_LENGTH, L"%ls\\%hs", directory, name);
+    } else {
+        _snwprintf(path, TA_GLITCH_PATH_LENGTH, L"%hs", name);
+    }
+    path[TA_GLITCH_PATH_LENGTH - 1] = L'\0';
+    return _wfopen(path, L"wb");
+#else
+    char path[TA_GLITCH_PATH_LENGTH];
+    char dir[TA_GLITCH_PATH_LENGTH];
+    dir[0] = '\0';
+    if (directory && directory[0] && wcstombs(dir, directory, sizeof(dir)) == (size_t)-1) {
+        return NULL;
+    }
+    dir[sizeof(dir) - 1] = '\0';
+    int length = snprintf(path, sizeof(path), "%s%s%s", dir, dir[0] ? "/" : "", name);
+    if (length < 0 || (size_t)length >= sizeof(path)) {
+        return NULL;    /* Truncated: never write a dump somewhere else */
+    }
+    return fopen(path, "wb");
+#endif
+}
+
+static void ta_glitch_put_u16(FILE* pFile, ma_uint32 value) {
+    fputc((int)(value & 0xFF), pFile);
+    fputc((int)((value >> 8) & 0xFF), pFile);
+}
+
+static void ta_glitch_put_u32(FILE* pFile, ma_uint32 value) {
+    ta_glitch_put_u16(pFile, value & 0xFFFF);
+    ta_glitch_put_u16(pFile, value >> 16);
+}
+
+/* IEEE float WAV of the slot's last `frames` frames */
+static int ta_glitch_write_wav(const ta_glitch* pGlitch, const ta_glitch_slot* pSlot, ma_uint64 firstFrame,
+    ma_uint32 frames, const wchar_t* directory, const char* name) {
+    FILE* pFile = ta_glitch_open(directory, name);
+    if (!pFile) {
+        return 0;
+    }
+
+    ma_uint32 channels = pGlitch->channels;
+    ma_uint32 dataBytes = frames * channels * (ma_uint32)sizeof(float);
+    fwrite("RIFF", 1, 4, pFile);
+    ta_glitch_put_u32(pFile, 36 + dataBytes);
+    fwrite("WAVEfmt ", 1, 8, pFile);
+    ta_glitch_put_u32(pFile, 16);
+    ta_glitch_put_u16(pFile, 3);    /* WAVE_FORMAT_IEEE_FLOAT */
+    ta_glitch_put_u16(pFile, channels);
+    ta_glitch_put_u32(pFile, pGlitch->sampleRate);
+    ta_glitch_put_u32(pFile, pGlitch->sampleRate * channels * (ma_uint32)sizeof(float));
+    ta_glitch_put_u16(pFile, channels * (ma_uint32)sizeof(float));
+    ta_glitch_put_u16(pFile, 32);
+    fwrite("data", 1, 4, pFile);
+    ta_glitch_put_u32(pFile, dataBytes);
+
+    /* Little-endian hosts only (x86, ARM): samples go out as stored */
+    ma_uint32 mask = pGlitch->capacityFrames - 1;
+    ma_uint32 done = 0;
+    while (done < frames) {
+        ma_uint32 index = (ma_uint32)((firstFrame + done) & mask);
+        ma_uint32 span = frames - done;
+        if (span > pGlitch->capacityFrames - index) {
+            span = pGlitch->capacityFrames - index;
+        }
+        fwrite(pSlot->pAudio + (size_t)index * channels, sizeof(float) * channels, span, pFile);
+        done += span;
+    }
+
+    int ok = !ferror(pFile);
+    fclose(pFile);
+    return ok;
+}
+
+static void ta_glitch_write_events(FILE* pFile, ma_uint32 events) {
+    static const char* names[] = { "underrun", "overrun", "drift" };
+    int first = 1;
+    fputc('[', pFile);
+    for (ma_uint32 bit = 0; bit < 3; bit++) {
+        if (events & (1u << bit)) {
+            fprintf(pFile, "%s\"%s\"", first ? "" : ",", names[bit]);
+            first = 0;
+        }
+    }
+    fputc(']', pFile);
+}
+
+static void ta_glitch_write_record(FILE* pFile, const ta_glitch_record* pRecord, ma_uint64 firstFrame, int playback, int first) {
+    fprintf(pFile, "%s\n    {\"timeNs\":%llu,", first ? "" : ",", (unsigned long long)pRecord->timeNs);
+    if (playback) {
+        fprintf(pFile, "\"frame\":%lld,", (long long)(pRecord->frame - firstFrame));
+    }
+    fprintf(pFile, "\"frames\":%u,\"executionUs\":%.2f,\"fillFrames\":%u,\"events\":",
+        pRecord->frames, (double)pRecord->executionNs * 1e-3, pRecord->fillFrames);
+    ta_glitch_write_events(pFile, pRecord->events);
+    fputc('}', pFile);
+}
+
+/* Timing trace: trigger, counters, then both callback timelines */
+static int ta_glitch_write_json(const ta_glitch* pGlitch, const ta_glitch_slot* pSlot, ma_uint64 firstFrame,
+    ma_uint32 frames, const wchar_t* directory, const char* name, const char* wavName) {
+    FILE* pFile = ta_glitch_open(directory, name);
+    if (!pFile) {
+        return 0;
+    }
+
+    fprintf(pFile, "{\n  \"version\": 1,\n  \"audioFile\": \"%s\",\n", wavName);
+    fprintf(pFile, "  \"sampleRate\": %u,\n  \"channels\": %u,\n  \"frames\": %u,\n",
+        pGlitch->sampleRate, pGlitch->channels, frames);
+    fprintf(pFile, "  \"events\": ");
+    ta_glitch_write_events(pFile, pSlot->events);
+    fprintf(pFile, ",\n  \"triggerFrame\": %lld,\n  \"triggerNs\": %llu,\n",
+        (long long)(pSlot->triggerFrame - firstFrame), (unsigned long long)pSlot->triggerNs);
+    fprintf(pFile, "  \"underrunCount\": %llu,\n  \"overrunCount\": %llu,\n  \"driftCorrectionCount\": %llu,\n",
+        (unsigned long long)pSlot->underrunCount, (unsigned long long)pSlot->overrunCount,
+        (unsigned long long)pSlot->driftCorrectionCount);
+
+    /* Playback callbacks whose audio is in the WAV */
+    ma_uint64 recordStart = pSlot->recordCount > TA_GLITCH_PLAYBACK_RECORDS ? pSlot->recordCount - TA_GLITCH_PLAYBACK_RECORDS : 0;
+    ma_uint64 startNs = 0;
+    ma_uint64 endNs = 0;
+    int first = 1;
+    fprintf(pFile, "  \"playback\": [");
+    for (ma_uint64 i = recordStart; i < pSlot->recordCount; i++) {
+        const ta_glitch_record* pRecord = &pSlot->pRecords[i & (TA_GLITCH_PLAYBACK_RECORDS - 1)];
+        if (pRecord->frame < firstFrame) {
+            continue;
+        }
+        if (first) {
+            startNs = pRecord->timeNs;
+        }
+        endNs = pRecord->timeNs + (ma_uint64)pRecord->frames * 1000000000ull / pGlitch->sampleRate;
+        ta_glitch_write_record(pFile, pRecord, firstFrame, 1, first);
+        first = 0;
+    }
+    fprintf(pFile, "\n  ],\n");
+
+    /* Capture callbacks over the same span (newest half of the ring only) */
+    ma_uint64 captureCount = ma_atomic_load_explicit_64(&pGlitch->captureRecordCount, ma_atomic_memory_order_acquire);
+    ma_uint64 captureStart = captureCount > TA_GLITCH_CAPTURE_RECORDS / 2 ? captureCount - TA_GLITCH_CAPTURE_RECORDS / 2 : 0;
+    first = 1;
+    fprintf(pFile, "  \"capture\": [");
+    for (ma_uint64 i = captureStart; i < captureCount; i++) {
+        const ta_glitch_record* pRecord = &pGlitch->pCaptureRecords[i & (TA_GLITCH_CAPTURE_RECORDS - 1)];
+        if (pRecord->timeNs + 1000000000ull * pRecord->frames / pGlitch->sampleRate < startNs || pRecord->timeNs > endNs) {
+            continue;
+        }
+        ta_glitch_write_record(pFile, pRecord, 0, 0, first);
+        first = 0;
+    }
+    fprintf(pFile, "\n  ]\n}\n");
+
+    int ok = !ferror(pFile);
+    fclose(pFile);
+    return ok;
+}
+
+/* Writer: dump every READY slot and return it. Returns the dumps written. */
+static ma_uint32 ta_glitch_service(ta_glitch* pGlitch, const wchar_t* directory) {
+    ma_uint32 written = 0;
+    if (!pGlitch->enabled) {
+        return 0;
+    }
+
+    for (ma_uint32 i = 0; i < TA_GLITCH_SLOTS; i++) {
+        ta_glitch_slot* pSlot = &pGlitch->slots[i];
+        if (ma_atomic_load_explicit_32(&pSlot->state, ma_atomic_memory_order_acquire) != TA_GLITCH_SLOT_READY) {
+            continue;
+        }
+
+        ma_uint32 frames = (ma_uint32)(pSlot->audioFrames < pGlitch->windowFrames ? pSlot->audioFrames : pGlitch->windowFrames);
+        ma_uint64 firstFrame = pSlot->audioFrames - frames;
+        char wavName[96];
+        char jsonName[96];
+        snprintf(wavName, sizeof(wavName), "glitch-%s-%03u.wav", pGlitch->session, pGlitch->nextFile);
+        snprintf(jsonName, sizeof(jsonName), "glitch-%s-%03u.json", pGlitch->session, pGlitch->nextFile);
+        pGlitch->nextFile++;
+
+        if (ta_glitch_write_wav(pGlitch, pSlot, firstFrame, frames, directory, wavName) &&
+            ta_glitch_write_json(pGlitch, pSlot, firstFrame, frames, directory, jsonName, wavName)) {
+            ma_atomic_fetch_add_explicit_32(&pGlitch->dumpCount, 1, ma_atomic_memory_order_relaxed);
+            written++;
+        }
+        ma_atomic_store_explicit_32(&pSlot->state, TA_GLITCH_SLOT_FREE, ma_atomic_memory_order_release);
+    }
+    return written;
+}
+
+#endif /* TA_GLITCH_H */
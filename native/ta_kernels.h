@@ -0,0 +1,1717 @@
+/*
+ * ==============================================================================
+ * ta_kernels.h - Runtime-Dispatched SIMD Sample Kernels
+ * ==============================================================================
+ * The inner loops of the audio callbacks, in one scalar reference version
+ * and one version per instruction set:
+ *
+ *   gain        dst[i] = src[i] * gain              (in place allowed)
+ *   gain_ramp   gain moving linearly per frame: frame f of an interleaved
+ *               block is scaled by start + step * f  (in place allowed)
+ *   copy        dst[i] = src[i]
+ *   fill_frame  repeat one interleaved frame over frameCount frames
+ *   mix         dst[i] += src[i] * gain
+ *   peak        max |src[i]|
+ *   peak_rms    max |src[i]| and sum of src[i]^2
+ *   diff_energy sum of (a[i] - b[i])^2, the similarity measure of the
+ *               splice search (a and b may overlap)
+ *   s16/s24/s32_to_f32
+ *               integer PCM (S24 = packed 3-byte) to float
+ *   f32_to_s16/s24/s32
+ *               float to integer PCM, rounded and clamped, with optional
+ *               TPDF dither (16 xorshift lanes, same noise in every variant)
+ *
+ * DISPATCH:
+ *   ta_simd_detect() reads CPUID (and XCR0, so AVX state is only used when
+ *   the OS saves it) and picks AVX-512F > AVX2 > SSE2 > scalar on x86/x64.
+ *   ARM64 always has NEON. Every x86 variant lives in this one translation
+ *   unit: GCC/Clang compile each with a target attribute, MSVC accepts the
+ *   intrinsics without /arch, so the DLL still runs on any x64 CPU.
+ *
+ * BIT EXACTNESS:
+ *   Every variant returns exactly the scalar result. The elementwise kernels
+ *   do one multiply and one add per sample in the same order (no FMA; the
+ *   header switches off floating-point contraction for GCC/Clang). The
+ *   sums of squares are defined as 16 interleaved partial sums (sample i goes
+ *   to lane i % 16) reduced by a fixed pairwise tree, which every vector
+ *   width reproduces. tools/ta_bench_kernels.c checks this.
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h. All pointers may be
+ *   unaligned; kernels never allocate and never touch memory past count.
+ * ==============================================================================
+ */
+
+#ifndef TA_KERNELS_H
+#define TA_KERNELS_H
+
+#include <string.h>
+#include <math.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define TA_SIMD_X86
+    #include <immintrin.h>
+    #if !defined(_MSC_VER) || defined(__clang__)
+        #include <cpuid.h>
+    #endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+    #define TA_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+/* Per-function ISA selection (MSVC needs none to emit the intrinsics) */
+#if defined(_MSC_VER) && !defined(__clang__)
+    #define TA_TARGET(isa)
+#else
+    #define TA_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+/* One rounding per multiply and per add in every variant, even under -march=native */
+#if defined(__clang__)
+    #pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+    #pragma GCC push_options
+    #pragma GCC optimize("fp-contract=off")
+#endif
+
+/* Partial sums in the canonical sum-of-squares order */
+#define TA_KERNEL_SUM_LANES         16
+
+/* Largest repeating pattern fill_frame/gain_ramp build (lcm of channels and vector width) */
+#define TA_KERNEL_FILL_PATTERN_MAX  64
+
+/*
+ * Float <-> integer PCM. Integers are read as value / 2^(bits-1), so every
+ * input maps exactly, and written as round(x * 2^(bits-1)) clamped to the
+ * integer range: an S16/S24 round trip through float is lossless.
+ */
+#define TA_S16_SCALE                32768.0f
+#define TA_S24_SCALE                8388608.0f
+#define TA_S32_SCALE                2147483648.0f
+#define TA_S16_MAX                  32767.0f
+#define TA_S24_MAX                  8388607.0f
+#define TA_S32_MAX                  2147483520.0f       /* Largest float below 2^31 */
+
+/* Independent dither generators: sample i of a call uses lane i % 16 */
+#define TA_DITHER_LANES             16
+#define TA_DITHER_SCALE             (1.0f / 65536.0f)
+
+/* TPDF dither state for the f32_to_* kernels. NULL where a kernel takes one = no dither. */
+typedef struct {
+    ma_uint32 state[TA_DITHER_LANES];
+} ta_dither;
+
+typedef enum {
+    TA_SIMD_SCALAR = 0,
+    TA_SIMD_SSE2,
+    TA_SIMD_AVX2,
+    TA_SIMD_AVX512,
+    TA_SIMD_NEON,
+    TA_SIMD_COUNT
+} ta_simd_level;
+
+typedef struct {
+    ta_simd_level level;
+    const char* name;
+    void  (*gain)(float* pDst, const float* pSrc, ma_uint32 count, float gain);
+    void  (*gain_ramp)(float* pDst, const float* pSrc, ma_uint32 channels, ma_uint32 frameCount, float gainStart, float gainStep);
+    void  (*copy)(float* pDst, const float* pSrc, ma_uint32 count);
+    void  (*fill_frame)(float* pDst, const float* pFrame, ma_uint32 channels, ma_uint32 frameCount);
+    void  (*mix)(float* pDst, const float* pSrc, ma_uint32 count, float gain);
+    float (*peak)(const float* pSrc, ma_uint32 count);
+    void  (*peak_rms)(const float* pSrc, ma_uint32 count, float* pPeak, float* pSumSquares);
+    float (*diff_energy)(const float* pA, const float* pB, ma_uint32 count);
+    void  (*s16_to_f32)(float* pDst, const void* pSrc, ma_uint32 count);
+    void  (*s24_to_f32)(float* pDst, const void* pSrc, ma_uint32 count);
+    void  (*s32_to_f32)(float* pDst, const void* pSrc, ma_uint32 count);
+    void  (*f32_to_s16)(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither);
+    void  (*f32_to_s24)(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither);
+    void  (*f32_to_s32)(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither);
+} ta_kernels;
+
+/* ==============================================================================
+ * SHARED HELPERS
+ * ============================================================================== */
+
+/* Fixed pairwise reduction of the 16 partial sums */
+static MA_INLINE float ta_kernel_reduce_sum(float* pLanes) {
+    for (ma_uint32 width = TA_KERNEL_SUM_LANES / 2; width > 0; width /= 2) {
+        for (ma_uint32 i = 0; i < width; i++) {
+            pLanes[i] = pLanes[i] + pLanes[i + width];
+        }
+    }
+    return pLanes[0];
+}
+
+/* Repeating pattern for fill_frame: lcm(channels, width) floats, 0 if too long */
+static ma_uint32 ta_kernel_fill_pattern(float* pPattern, const float* pFrame, ma_uint32 channels, ma_uint32 width) {
+    ma_uint32 period = channels;
+    while (period % width != 0) {
+        period += channels;
+    }
+    if (period > TA_KERNEL_FILL_PATTERN_MAX) {
+        return 0;
+    }
+    for (ma_uint32 i = 0; i < period; i++) {
+        pPattern[i] = pFrame[i % channels];
+    }
+    return period;
+}
+
+/*
+ * Frame index of each sample over one repeating period for gain_ramp:
+ * lcm(channels, width) floats, 0 if too long. A period spans
+ * period / channels frames.
+ */
+static ma_uint32 ta_kernel_ramp_pattern(float* pPattern, ma_uint32 channels, ma_uint32 width) {
+    ma_uint32 period = channels;
+    while (period % width != 0) {
+        period += channels;
+    }
+    if (period > TA_KERNEL_FILL_PATTERN_MAX) {
+        return 0;
+    }
+    for (ma_uint32 i = 0; i < period; i++) {
+        pPattern[i] = (float)(i / channels);
+    }
+    return period;
+}
+
+/* Seed every lane (xorshift state must be nonzero) */
+static void ta_dither_init(ta_dither* pDither, ma_uint32 seed) {
+    for (ma_uint32 i = 0; i < TA_DITHER_LANES; i++) {
+        ma_uint32 state = seed + 0x9E3779B9u * (i + 1);
+        pDither->state[i] = (state != 0) ? state : 0x9E3779B9u;
+    }
+}
+
+/*
+ * Next TPDF sample of one lane, in LSBs: the difference of two 16-bit
+ * uniforms taken from one xorshift32 step, in (-1, 1).
+ */
+static MA_INLINE float ta_dither_next(ta_dither* pDither, ma_uint32 lane) {
+    ma_uint32 x = pDither->state[lane];
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    pDither->state[lane] = x;
+    return (float)((ma_int32)(x & 0xFFFF) - (ma_int32)(x >> 16)) * TA_DITHER_SCALE;
+}
+
+/* round(x * scale [+ dither]) clamped to [-scale, maxValue]; NaN gives maxValue */
+static MA_INLINE ma_int32 ta_quantize(float x, float scale, float maxValue, ta_dither* pDither, ma_uint32 lane) {
+    float v = x * scale;
+    if (pDither) {
+        v = v + ta_dither_next(pDither, lane);
+    }
+    v = (v < maxValue) ? v : maxValue;
+    v = (v > -scale) ? v : -scale;
+    return (ma_int32)lrintf(v);
+}
+
+/* ==============================================================================
+ * SCALAR REFERENCE
+ * ============================================================================== */
+
+static void ta_gain_scalar(float* pDst, const float* pSrc, ma_uint32 count, float gain) {
+    for (ma_uint32 i = 0; i < count; i++) {
+        pDst[i] = pSrc[i] * gain;
+    }
+}
+
+/* Frame indices stay below 2^24, so (float)f is exact in every variant */
+static void ta_gain_ramp_scalar(float* pDst, const float* pSrc, ma_uint32 channels, ma_uint32 frameCount, float gainStart, float gainStep) {
+    for (ma_uint32 f = 0; f < frameCount; f++) {
+        float gain = gainStart + gainStep * (float)f;
+        for (ma_uint32 ch = 0; ch < channels; ch++) {
+            pDst[f * channels + ch] = pSrc[f * channels + ch] * gain;
+        }
+    }
+}
+
+static void ta_copy_scalar(float* pDst, const float* pSrc, ma_uint32 count) {
+    for (ma_uint32 i = 0; i < count; i++) {
+        pDst[i] = pSrc[i];
+    }
+}
+
+static void ta_fill_frame_scalar(float* pDst, const float* pFrame, ma_uint32 channels, ma_uint32 frameCount) {
+    for (ma_uint32 i = 0; i < frameCount; i++) {
+        for (ma_uint32 ch = 0; ch < channels; ch++) {
+            pDst[i * channels + ch] = pFrame[ch];
+        }
+    }
+}
+
+static void ta_mix_scalar(float* pDst, const float* pSrc, ma_uint32 count, float gain) {
+    for (ma_uint32 i = 0; i < count; i++) {
+        pDst[i] = pDst[i] + pSrc[i] * gain;
+    }
+}
+
+static float ta_peak_scalar(const float* pSrc, ma_uint32 count) {
+    float peak = 0.0f;
+    for (ma_uint32 i = 0; i < count; i++) {
+        float magnitude = fabsf(pSrc[i]);
+        if (magnitude > peak) {
+            peak = magnitude;
+        }
+    }
+    return peak;
+}
+
+static void ta_peak_rms_scalar(const float* pSrc, ma_uint32 count, float* pPeak, float* pSumSquares) {
+    float lanes[TA_KERNEL_SUM_LANES] = { 0 };
+    for (ma_uint32 i = 0; i < count; i++) {
+        lanes[i % TA_KERNEL_SUM_LANES] += pSrc[i] * pSrc[i];
+    }
+    *pPeak = ta_peak_scalar(pSrc, count);
+    *pSumSquares = ta_kernel_reduce_sum(lanes);
+}
+
+static float ta_diff_energy_scalar(const float* pA, const float* pB, ma_uint32 count) {
+    float lanes[TA_KERNEL_SUM_LANES] = { 0 };
+    for (ma_uint32 i = 0; i < count; i++) {
+        float d = pA[i] - pB[i];
+        lanes[i % TA_KERNEL_SUM_LANES] += d * d;
+    }
+    return ta_kernel_reduce_sum(lanes);
+}
+
+
+/* ---- Format conversion ---- */
+
+static void ta_s16_to_f32_scalar(float* pDst, const void* pSrc, ma_uint32 count) {
+    const ma_int16* pIn = (const ma_int16*)pSrc;
+    for (ma_uint32 i = 0; i < count; i++) {
+        pDst[i] = (float)pIn[i] * (1.0f / TA_S16_SCALE);
+    }
+}
+
+/* Packed little-endian 24-bit, placed in the top of an int32 (exact in float) */
+static void ta_s24_to_f32_scalar(float* pDst, const void* pSrc, ma_uint32 count) {
+    const ma_uint8* pIn = (const ma_uint8*)pSrc;
+    for (ma_uint32 i = 0; i < count; i++) {
+        const ma_uint8* p = pIn + (size_t)i * 3;
+        ma_int32 v = (ma_int32)(((ma_uint32)p[0] << 8) | ((ma_uint32)p[1] << 16) | ((ma_uint32)p[2] << 24));
+        pDst[i] = (float)v * (1.0f / TA_S32_SCALE);
+    }
+}
+
+static void ta_s32_to_f32_scalar(float* pDst, const void* pSrc, ma_uint32 count) {
+    const ma_int32* pIn = (const ma_int32*)pSrc;
+    for (ma_uint32 i = 0; i < count; i++) {
+        pDst[i] = (float)pIn[i] * (1.0f / TA_S32_SCALE);
+    }
+}
+
+static void ta_f32_to_s16_scalar(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither) {
+    ma_int16* pOut = (ma_int16*)pDst;
+    for (ma_uint32 i = 0; i < count; i++) {
+        pOut[i] = (ma_int16)ta_quantize(pSrc[i], TA_S16_SCALE, TA_S16_MAX, pDither, i % TA_DITHER_LANES);
+    }
+}
+
+static void ta_f32_to_s24_scalar(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither) {
+    ma_uint8* pOut = (ma_uint8*)pDst;
+    for (ma_uint32 i = 0; i < count; i++) {
+        ma_int32 v = ta_quantize(pSrc[i], TA_S24_SCALE, TA_S24_MAX, pDither, i % TA_DITHER_LANES);
+        pOut[(size_t)i * 3 + 0] = (ma_uint8)(v);
+        pOut[(size_t)i * 3 + 1] = (ma_uint8)(v >> 8);
+        pOut[(size_t)i * 3 + 2] = (ma_uint8)(v >> 16);
+    }
+}
+
+static void ta_f32_to_s32_scalar(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither) {
+    ma_int32* pOut = (ma_int32*)pDst;
+    for (ma_uint32 i = 0; i < count; i++) {
+        pOut[i] = ta_quantize(pSrc[i], TA_S32_SCALE, TA_S32_MAX, pDither, i % TA_DITHER_LANES);
+    }
+}
+
+/* ==============================================================================
+ * SSE2 / AVX2 / AVX-512F
+ * ============================================================================== */
+
+#if defined(TA_SIMD_X86)
+
+/* ---- SSE2 (4 lanes) ---- */
+
+TA_TARGET("sse2")
+static void ta_gain_sse2(float* pDst, const float* pSrc, ma_uint32 count, float gain) {
+    __m128 g = _mm_set1_ps(gain);
+    ma_uint32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(pDst + i, _mm_mul_ps(_mm_loadu_ps(pSrc + i), g));
+    }
+    for (; i < count; i++) {
+        pDst[i] = pSrc[i] * gain;
+    }
+}
+
+TA_TARGET("sse2")
+static void ta_gain_ramp_sse2(float* pDst, const float* pSrc, ma_uint32 channels, ma_uint32 frameCount, float gainStart, float gainStep) {
+    float pattern[TA_KERNEL_FILL_PATTERN_MAX];
+    ma_uint32 period = ta_kernel_ramp_pattern(pattern, channels, 4);
+    ma_uint32 count = channels * frameCount;
+    ma_uint32 i = 0;
+    ma_uint32 offset = 0;
+    float base = 0.0f;
+    if (period == 0) {
+        ta_gain_ramp_scalar(pDst, pSrc, channels, frameCount, gainStart, gainStep);
+        return;
+    }
+    __m128 start = _mm_set1_ps(gainStart);
+    __m128 step = _mm_set1_ps(gainStep);
+    for (; i + 4 <= count; i += 4) {
+        __m128 frame = _mm_add_ps(_mm_set1_ps(base), _mm_loadu_ps(pattern + offset));
+        __m128 g = _mm_add_ps(start, _mm_mul_ps(step, frame));
+        _mm_storeu_ps(pDst + i, _mm_mul_ps(_mm_loadu_ps(pSrc + i), g));
+        offset += 4;
+        if (offset == period) {
+            offset = 0;
+            base += (float)(period / channels);
+        }
+    }
+    for (; i < count; i++) {
+        pDst[i] = pSrc[i] * (gainStart + gainStep * (float)(i / channels));
+    }
+}
+
+TA_TARGET("sse2")
+static void ta_copy_sse2(float* pDst, const float* pSrc, ma_uint32 count) {
+    ma_uint32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_loadu_ps(pSrc + i);
+        __m128 b = _mm_loadu_ps(pSrc + i + 4);
+        _mm_storeu_ps(pDst + i, a);
+        _mm_storeu_ps(pDst + i + 4, b);
+    }
+    for (; i < count; i++) {
+        pDst[i] = pSrc[i];
+    }
+}
+
+TA_TARGET("sse2")
+static void ta_fill_frame_sse2(float* pDst, const float* pFrame, ma_uint32 channels, ma_uint32 frameCount) {
+    float pattern[TA_KERNEL_FILL_PATTERN_MAX];
+    ma_uint32 period = ta_kernel_fill_pattern(pattern, pFrame, channels, 4);
+    ma_uint32 count = channels * frameCount;
+    ma_uint32 i = 0;
+    ma_uint32 offset = 0;
+    if (period == 0) {
+        ta_fill_frame_scalar(pDst, pFrame, channels, frameCount);
+        return;
+    }
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(pDst + i, _mm_loadu_ps(pattern + offset));
+        offset += 4;
+        if (offset == period) {
+            offset = 0;
+        }
+    }
+    for (; i < count; i++) {
+        pDst[i] = pattern[i % period];
+    }
+}
+
+TA_TARGET("sse2")
+static void ta_mix_sse2(float* pDst, const float* pSrc, ma_uint32 count, float gain) {
+    __m128 g = _mm_set1_ps(gain);
+    ma_uint32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 product = _mm_mul_ps(_mm_loadu_ps(pSrc + i), g);
+        _mm_storeu_ps(pDst + i, _mm_add_ps(_mm_loadu_ps(pDst + i), product));
+    }
+    for (; i < count; i++) {
+        pDst[i] = pDst[i] + pSrc[i] * gain;
+    }
+}
+
+TA_TARGET("sse2")
+static float ta_peak_sse2(const float* pSrc, ma_uint32 count) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 peak4 = _mm_setzero_ps();
+    float lanes[4];
+    ma_uint32 i = 0;
+    /* max(x, acc) keeps acc when x is NaN, like the scalar compare */
+    for (; i + 4 <= count; i += 4) {
+        peak4 = _mm_max_ps(_mm_and_ps(_mm_loadu_ps(pSrc + i), absMask), peak4);
+    }
+    _mm_storeu_ps(lanes, peak4);
+    float peak = ta_peak_scalar(lanes, 4);
+    float tail = ta_peak_scalar(pSrc + i, count - i);
+    return (tail > peak) ? tail : peak;
+}
+
+TA_TARGET("sse2")
+static void ta_peak_rms_sse2(const float* pSrc, ma_uint32 count, float* pPeak, float* pSumSquares) {
+    float lanes[TA_KERNEL_SUM_LANES];
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps();
+    __m128 acc3 = _mm_setzero_ps();
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128 x0 = _mm_loadu_ps(pSrc + i);
+        __m128 x1 = _mm_loadu_ps(pSrc + i + 4);
+        __m128 x2 = _mm_loadu_ps(pSrc + i + 8);
+        __m128 x3 = _mm_loadu_ps(pSrc + i + 12);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(x0, x0));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(x1, x1));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(x2, x2));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(x3, x3));
+    }
+    _mm_storeu_ps(lanes + 0, acc0);
+    _mm_storeu_ps(lanes + 4, acc1);
+    _mm_storeu_ps(lanes + 8, acc2);
+    _mm_storeu_ps(lanes + 12, acc3);
+    for (; i < count; i++) {
+        lanes[i % TA_KERNEL_SUM_LANES] += pSrc[i] * pSrc[i];
+    }
+    *pPeak = ta_peak_sse2(pSrc, count);
+    *pSumSquares = ta_kernel_reduce_sum(lanes);
+}
+
+TA_TARGET("sse2")
+static float ta_diff_energy_sse2(const float* pA, const float* pB, ma_uint32 count) {
+    float lanes[TA_KERNEL_SUM_LANES];
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps();
+    __m128 acc3 = _mm_setzero_ps();
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128 d0 = _mm_sub_ps(_mm_loadu_ps(pA + i), _mm_loadu_ps(pB + i));
+        __m128 d1 = _mm_sub_ps(_mm_loadu_ps(pA + i + 4), _mm_loadu_ps(pB + i + 4));
+        __m128 d2 = _mm_sub_ps(_mm_loadu_ps(pA + i + 8), _mm_loadu_ps(pB + i + 8));
+        __m128 d3 = _mm_sub_ps(_mm_loadu_ps(pA + i + 12), _mm_loadu_ps(pB + i + 12));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(d1, d1));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(d2, d2));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(d3, d3));
+    }
+    _mm_storeu_ps(lanes + 0, acc0);
+    _mm_storeu_ps(lanes + 4, acc1);
+    _mm_storeu_ps(lanes + 8, acc2);
+    _mm_storeu_ps(lanes + 12, acc3);
+    for (; i < count; i++) {
+        float d = pA[i] - pB[i];
+        lanes[i % TA_KERNEL_SUM_LANES] += d * d;
+    }
+    return ta_kernel_reduce_sum(lanes);
+}
+
+/* TPDF noise for lanes 4k..4k+3 (see ta_dither_next) */
+TA_TARGET("sse2")
+static __m128 ta_dither_next_sse2(__m128i* pState) {
+    __m128i x = *pState;
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+    *pState = x;
+    __m128i diff = _mm_sub_epi32(_mm_and_si128(x, _mm_set1_epi32(0xFFFF)), _mm_srli_epi32(x, 16));
+    return _mm_mul_ps(_mm_cvtepi32_ps(diff), _mm_set1_ps(TA_DITHER_SCALE));
+}
+
+/* ta_quantize for 4 samples: minps/maxps pick the bound for NaN, like the scalar compare */
+TA_TARGET("sse2")
+static __m128i ta_quantize_sse2(__m128 x, float scale, float maxValue, __m128i* pDitherState) {
+    __m128 v = _mm_mul_ps(x, _mm_set1_ps(scale));
+    if (pDitherState) {
+        v = _mm_add_ps(v, ta_dither_next_sse2(pDitherState));
+    }
+    v = _mm_min_ps(v, _mm_set1_ps(maxValue));
+    v = _mm_max_ps(v, _mm_set1_ps(-scale));
+    return _mm_cvtps_epi32(v);
+}
+
+TA_TARGET("sse2")
+static void ta_s16_to_f32_sse2(float* pDst, const void* pSrc, ma_uint32 count) {
+    const ma_int16* pIn = (const ma_int16*)pSrc;
+    const __m128 scale = _mm_set1_ps(1.0f / TA_S16_SCALE);
+    ma_uint32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(pIn + i));
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(pDst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(pDst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    ta_s16_to_f32_scalar(pDst + i, pIn + i, count - i);
+}
+
+TA_TARGET("sse2")
+static void ta_s32_to_f32_sse2(float* pDst, const void* pSrc, ma_uint32 count) {
+    const ma_int32* pIn = (const ma_int32*)pSrc;
+    const __m128 scale = _mm_set1_ps(1.0f / TA_S32_SCALE);
+    ma_uint32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(pIn + i));
+        _mm_storeu_ps(pDst + i, _mm_mul_ps(_mm_cvtepi32_ps(x), scale));
+    }
+    ta_s32_to_f32_scalar(pDst + i, pIn + i, count - i);
+}
+
+TA_TARGET("sse2")
+static void ta_f32_to_s16_sse2(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither) {
+    ma_int16* pOut = (ma_int16*)pDst;
+    __m128i rng[4];
+    ma_uint32 i = 0;
+    memset(rng, 0, sizeof(rng));
+    if (pDither) {
+        for (int r = 0; r < 4; r++) {
+            rng[r] = _mm_loadu_si128((const __m128i*)(pDither->state + r * 4));
+        }
+    }
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = ta_quantize_sse2(_mm_loadu_ps(pSrc + i), TA_S16_SCALE, TA_S16_MAX, pDither ? &rng[(i >> 2) & 3] : NULL);
+        __m128i b = ta_quantize_sse2(_mm_loadu_ps(pSrc + i + 4), TA_S16_SCALE, TA_S16_MAX, pDither ? &rng[((i >> 2) + 1) & 3] : NULL);
+        _mm_storeu_si128((__m128i*)(pOut + i), _mm_packs_epi32(a, b));
+    }
+    if (pDither) {
+        for (int r = 0; r < 4; r++) {
+            _mm_storeu_si128((__m128i*)(pDither->state + r * 4), rng[r]);
+        }
+    }
+    for (; i < count; i++) {
+        pOut[i] = (ma_int16)ta_quantize(pSrc[i], TA_S16_SCALE, TA_S16_MAX, pDither, i % TA_DITHER_LANES);
+    }
+}
+
+/* No byte shuffle in SSE2: quantize 4 at a time, pack the bytes in scalar code */
+TA_TARGET("sse2")
+static void ta_f32_to_s24_sse2(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither) {
+    ma_uint8* pOut = (ma_uint8*)pDst;
+    __m128i rng[4];
+    ma_int32 values[4];
+    ma_uint32 i = 0;
+    memset(rng, 0, sizeof(rng));
+    if (pDither) {
+        for (int r = 0; r < 4; r++) {
+            rng[r] = _mm_loadu_si128((const __m128i*)(pDither->state + r * 4));
+        }
+    }
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i*)values, ta_quantize_sse2(_mm_loadu_ps(pSrc + i), TA_S24_SCALE, TA_S24_MAX, pDither ? &rng[(i >> 2) & 3] : NULL));
+        for (ma_uint32 k = 0; k < 4; k++) {
+            pOut[(size_t)(i + k) * 3 + 0] = (ma_uint8)(values[k]);
+            pOut[(size_t)(i + k) * 3 + 1] = (ma_uint8)(values[k] >> 8);
+            pOut[(size_t)(i + k) * 3 + 2] = (ma_uint8)(values[k] >> 16);
+        }
+    }
+    if (pDither) {
+        for (int r = 0; r < 4; r++) {
+            _mm_storeu_si128((__m128i*)(pDither->state + r * 4), rng[r]);
+        }
+    }
+    for (; i < count; i++) {
+        ma_int32 v = ta_quantize(pSrc[i], TA_S24_SCALE, TA_S24_MAX, pDither, i % TA_DITHER_LANES);
+        pOut[(size_t)i * 3 + 0] = (ma_uint8)(v);
+        pOut[(size_t)i * 3 + 1] = (ma_uint8)(v >> 8);
+        pOut[(size_t)i * 3 + 2] = (ma_uint8)(v >> 16);
+    }
+}
+
+TA_TARGET("sse2")
+static void ta_f32_to_s32_sse2(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither) {
+    ma_int32* pOut = (ma_int32*)pDst;
+    __m128i rng[4];
+    ma_uint32 i = 0;
+    memset(rng, 0, sizeof(rng));
+    if (pDither) {
+        for (int r = 0; r < 4; r++) {
+            rng[r] = _mm_loadu_si128((const __m128i*)(pDither->state + r * 4));
+        }
+    }
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i*)(pOut + i), ta_quantize_sse2(_mm_loadu_ps(pSrc + i), TA_S32_SCALE, TA_S32_MAX, pDither ? &rng[(i >> 2) & 3] : NULL));
+    }
+    if (pDither) {
+        for (int r = 0; r < 4; r++) {
+            _mm_storeu_si128((__m128i*)(pDither->state + r * 4), rng[r]);
+        }
+    }
+    for (; i < count; i++) {
+        pOut[i] = ta_quantize(pSrc[i], TA_S32_SCALE, TA_S32_MAX, pDither, i % TA_DITHER_LANES);
+    }
+}
+
+/* ---- AVX2 (8 lanes) ---- */
+
+TA_TARGET("avx2")
+static void ta_gain_avx2(float* pDst, const float* pSrc, ma_uint32 count, float gain) {
+    __m256 g = _mm256_set1_ps(gain);
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(pSrc + i), g);
+        __m256 b = _mm256_mul_ps(_mm256_loadu_ps(pSrc + i + 8), g);
+        _mm256_storeu_ps(pDst + i, a);
+        _mm256_storeu_ps(pDst + i + 8, b);
+    }
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(pDst + i, _mm256_mul_ps(_mm256_loadu_ps(pSrc + i), g));
+    }
+    for (; i < count; i++) {
+        pDst[i] = pSrc[i] * gain;
+    }
+}
+
+TA_TARGET("avx2")
+static void ta_gain_ramp_avx2(float* pDst, const float* pSrc, ma_uint32 channels, ma_uint32 frameCount, float gainStart, float gainStep) {
+    float pattern[TA_KERNEL_FILL_PATTERN_MAX];
+    ma_uint32 period = ta_kernel_ramp_pattern(pattern, channels, 8);
+    ma_uint32 count = channels * frameCount;
+    ma_uint32 i = 0;
+    ma_uint32 offset = 0;
+    float base = 0.0f;
+    if (period == 0) {
+        ta_gain_ramp_scalar(pDst, pSrc, channels, frameCount, gainStart, gainStep);
+        return;
+    }
+    __m256 start = _mm256_set1_ps(gainStart);
+    __m256 step = _mm256_set1_ps(gainStep);
+    for (; i + 8 <= count; i += 8) {
+        __m256 frame = _mm256_add_ps(_mm256_set1_ps(base), _mm256_loadu_ps(pattern + offset));
+        __m256 g = _mm256_add_ps(start, _mm256_mul_ps(step, frame));
+        _mm256_storeu_ps(pDst + i, _mm256_mul_ps(_mm256_loadu_ps(pSrc + i), g));
+        offset += 8;
+        if (offset == period) {
+            offset = 0;
+            base += (float)(period / channels);
+        }
+    }
+    for (; i < count; i++) {
+        pDst[i] = pSrc[i] * (gainStart + gainStep * (float)(i / channels));
+    }
+}
+
+TA_TARGET("avx2")
+static void ta_copy_avx2(float* pDst, const float* pSrc, ma_uint32 count) {
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 a = _mm256_loadu_ps(pSrc + i);
+        __m256 b = _mm256_loadu_ps(pSrc + i + 8);
+        _mm256_storeu_ps(pDst + i, a);
+        _mm256_storeu_ps(pDst + i + 8, b);
+    }
+    for (; i < count; i++) {
+        pDst[i] = pSrc[i];
+    }
+}
+
+TA_TARGET("avx2")
+static void ta_fill_frame_avx2(float* pDst, const float* pFrame, ma_uint32 channels, ma_uint32 frameCount) {
+    float pattern[TA_KERNEL_FILL_PATTERN_MAX];
+    ma_uint32 period = ta_kernel_fill_pattern(pattern, pFrame, channels, 8);
+    ma_uint32 count = channels * frameCount;
+    ma_uint32 i = 0;
+    ma_uint32 offset = 0;
+    if (period == 0) {
+        ta_fill_frame_scalar(pDst, pFrame, channels, frameCount);
+        return;
+    }
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(pDst + i, _mm256_loadu_ps(pattern + offset));
+        offset += 8;
+        if (offset == period) {
+            offset = 0;
+        }
+    }
+    for (; i < count; i++) {
+        pDst[i] = pattern[i % period];
+    }
+}
+
+TA_TARGET("avx2")
+static void ta_mix_avx2(float* pDst, const float* pSrc, ma_uint32 count, float gain) {
+    __m256 g = _mm256_set1_ps(gain);
+    ma_uint32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 product = _mm256_mul_ps(_mm256_loadu_ps(pSrc + i), g);
+        _mm256_storeu_ps(pDst + i, _mm256_add_ps(_mm256_loadu_ps(pDst + i), product));
+    }
+    for (; i < count; i++) {
+        pDst[i] = pDst[i] + pSrc[i] * gain;
+    }
+}
+
+TA_TARGET("avx2")
+static float ta_peak_avx2(const float* pSrc, ma_uint32 count) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 peak8 = _mm256_setzero_ps();
+    float lanes[8];
+    ma_uint32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        peak8 = _mm256_max_ps(_mm256_and_ps(_mm256_loadu_ps(pSrc + i), absMask), peak8);
+    }
+    _mm256_storeu_ps(lanes, peak8);
+    float peak = ta_peak_scalar(lanes, 8);
+    float tail = ta_peak_scalar(pSrc + i, count - i);
+    return (tail > peak) ? tail : peak;
+}
+
+TA_TARGET("avx2")
+static void ta_peak_rms_avx2(const float* pSrc, ma_uint32 count, float* pPeak, float* pSumSquares) {
+    float lanes[TA_KERNEL_SUM_LANES];
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 x0 = _mm256_loadu_ps(pSrc + i);
+        __m256 x1 = _mm256_loadu_ps(pSrc + i + 8);
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(x0, x0));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(x1, x1));
+    }
+    _mm256_storeu_ps(lanes + 0, acc0);
+    _mm256_storeu_ps(lanes + 8, acc1);
+    for (; i < count; i++) {
+        lanes[i % TA_KERNEL_SUM_LANES] += pSrc[i] * pSrc[i];
+    }
+    *pPeak = ta_peak_avx2(pSrc, count);
+    *pSumSquares = ta_kernel_reduce_sum(lanes);
+}
+
+TA_TARGET("avx2")
+static float ta_diff_energy_avx2(const float* pA, const float* pB, ma_uint32 count) {
+    float lanes[TA_KERNEL_SUM_LANES];
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(pA + i), _mm256_loadu_ps(pB + i));
+        __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(pA + i + 8), _mm256_loadu_ps(pB + i + 8));
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(d0, d0));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(d1, d1));
+    }
+    _mm256_storeu_ps(lanes + 0, acc0);
+    _mm256_storeu_ps(lanes + 8, acc1);
+    for (; i < count; i++) {
+        float d = pA[i] - pB[i];
+        lanes[i % TA_KERNEL_SUM_LANES] += d * d;
+    }
+    return ta_kernel_reduce_sum(lanes);
+}
+
+TA_TARGET("avx2")
+static __m256 ta_dither_next_avx2(__m256i* pState) {
+    __m256i x = *pState;
+    x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+    x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+    *pState = x;
+    __m256i diff = _mm256_sub_epi32(_mm256_and_si256(x, _mm256_set1_epi32(0xFFFF)), _mm256_srli_epi32(x, 16));
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(diff), _mm256_set1_ps(TA_DITHER_SCALE));
+}
+
+TA_TARGET("avx2")
+static __m256i ta_quantize_avx2(__m256 x, float scale, float maxValue, __m256i* pDitherState) {
+    __m256 v = _mm256_mul_ps(x, _mm256_set1_ps(scale));
+    if (pDitherState) {
+        v = _mm256_add_ps(v, ta_dither_next_avx2(pDitherState));
+    }
+    v = _mm256_min_ps(v, _mm256_set1_ps(maxValue));
+    v = _mm256_max_ps(v, _mm256_set1_ps(-scale));
+    return _mm256_cvtps_epi32(v);
+}
+
+TA_TARGET("avx2")
+static void ta_s16_to_f32_avx2(float* pDst, const void* pSrc, ma_uint32 count) {
+    const ma_int16* pIn = (const ma_int16*)pSrc;
+    const __m256 scale = _mm256_set1_ps(1.0f / TA_S16_SCALE);
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(pIn + i)));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(pIn + i + 8)));
+        _mm256_storeu_ps(pDst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(pDst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    ta_s16_to_f32_scalar(pDst + i, pIn + i, count - i);
+}
+
+/*
+ * 8 samples (24 bytes) per step: each 128-bit lane loads 16 bytes holding
+ * 4 samples and shuffles them into the top 3 bytes of 4 int32s. The upper
+ * lane's load reads 4 bytes past its samples, so the loop stops early
+ * enough that this stays inside the buffer.
+ */
+TA_TARGET("avx2")
+static void ta_s24_to_f32_avx2(float* pDst, const void* pSrc, ma_uint32 count) {
+    const ma_uint8* pIn = (const ma_uint8*)pSrc;
+    const __m256 scale = _mm256_set1_ps(1.0f / TA_S32_SCALE);
+    const __m256i unpack = _mm256_setr_epi8(
+        -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+        -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    ma_uint32 i = 0;
+    for (; (size_t)(i + 8) * 3 + 4 <= (size_t)count * 3; i += 8) {
+        const ma_uint8* p = pIn + (size_t)i * 3;
+        __m256i bytes = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)p)),
+            _mm_loadu_si128((const __m128i*)(p + 12)), 1);
+        __m256i x = _mm256_shuffle_epi8(bytes, unpack);
+        _mm256_storeu_ps(pDst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+    }
+    ta_s24_to_f32_scalar(pDst + i, pIn + (size_t)i * 3, count - i);
+}
+
+TA_TARGET("avx2")
+static void ta_s32_to_f32_avx2(float* pDst, const void* pSrc, ma_uint32 count) {
+    const ma_int32* pIn = (const ma_int32*)pSrc;
+    const __m256 scale = _mm256_set1_ps(1.0f / TA_S32_SCALE);
+    ma_uint32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(pIn + i));
+        _mm256_storeu_ps(pDst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+    }
+    ta_s32_to_f32_scalar(pDst + i, pIn + i, count - i);
+}
+
+TA_TARGET("avx2")
+static void ta_f32_to_s16_avx2(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither) {
+    ma_int16* pOut = (ma_int16*)pDst;
+    __m256i rng[2];
+    ma_uint32 i = 0;
+    memset(rng, 0, sizeof(rng));
+    if (pDither) {
+        rng[0] = _mm256_loadu_si256((const __m256i*)(pDither->state));
+        rng[1] = _mm256_loadu_si256((const __m256i*)(pDither->state + 8));
+    }
+    for (; i + 16 <= count; i += 16) {
+        __m256i a = ta_quantize_avx2(_mm256_loadu_ps(pSrc + i), TA_S16_SCALE, TA_S16_MAX, pDither ? &rng[0] : NULL);
+        __m256i b = ta_quantize_avx2(_mm256_loadu_ps(pSrc + i + 8), TA_S16_SCALE, TA_S16_MAX, pDither ? &rng[1] : NULL);
+        /* packs works per 128-bit lane; restore sample order */
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i*)(pOut + i), packed);
+    }
+    if (pDither) {
+        _mm256_storeu_si256((__m256i*)(pDither->state), rng[0]);
+        _mm256_storeu_si256((__m256i*)(pDither->state + 8), rng[1]);
+    }
+    for (; i < count; i++) {
+        pOut[i] = (ma_int16)ta_quantize(pSrc[i], TA_S16_SCALE, TA_S16_MAX, pDither, i % TA_DITHER_LANES);
+    }
+}
+
+TA_TARGET("avx2")
+static void ta_f32_to_s24_avx2(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither) {
+    ma_uint8* pOut = (ma_uint8*)pDst;
+    const __m256i pack = _mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    __m256i rng[2];
+    ma_uint32 i = 0;
+    memset(rng, 0, sizeof(rng));
+    if (pDither) {
+        rng[0] = _mm256_loadu_si256((const __m256i*)(pDither->state));
+        rng[1] = _mm256_loadu_si256((const __m256i*)(pDither->state + 8));
+    }
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = ta_quantize_avx2(_mm256_loadu_ps(pSrc + i), TA_S24_SCALE, TA_S24_MAX, pDither ? &rng[(i >> 3) & 1] : NULL);
+        __m256i packed = _mm256_shuffle_epi8(v, pack);
+        __m128i lo = _mm256_castsi256_si128(packed);
+        __m128i hi = _mm256_extracti128_si256(packed, 1);
+        ma_uint8* p = pOut + (size_t)i * 3;
+        ma_int32 tail;
+        /* 12 bytes per lane: 8 + 4, never past this block's 24 bytes */
+        _mm_storel_epi64((__m128i*)p, lo);
+        tail = _mm_cvtsi128_si32(_mm_srli_si128(lo, 8));
+        memcpy(p + 8, &tail, 4);
+        _mm_storel_epi64((__m128i*)(p + 12), hi);
+        tail = _mm_cvtsi128_si32(_mm_srli_si128(hi, 8));
+        memcpy(p + 20, &tail, 4);
+    }
+    if (pDither) {
+        _mm256_storeu_si256((__m256i*)(pDither->state), rng[0]);
+        _mm256_storeu_si256((__m256i*)(pDither->state + 8), rng[1]);
+    }
+    for (; i < count; i++) {
+        ma_int32 v = ta_quantize(pSrc[i], TA_S24_SCALE, TA_S24_MAX, pDither, i % TA_DITHER_LANES);
+        pOut[(size_t)i * 3 + 0] = (ma_uint8)(v);
+        pOut[(size_t)i * 3 + 1] = (ma_uint8)(v >> 8);
+        pOut[(size_t)i * 3 + 2] = (ma_uint8)(v >> 16);
+    }
+}
+
+TA_TARGET("avx2")
+static void ta_f32_to_s32_avx2(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither) {
+    ma_int32* pOut = (ma_int32*)pDst;
+    __m256i rng[2];
+    ma_uint32 i = 0;
+    memset(rng, 0, sizeof(rng));
+    if (pDither) {
+        rng[0] = _mm256_loadu_si256((const __m256i*)(pDither->state));
+        rng[1] = _mm256_loadu_si256((const __m256i*)(pDither->state + 8));
+    }
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = ta_quantize_avx2(_mm256_loadu_ps(pSrc + i), TA_S32_SCALE, TA_S32_MAX, pDither ? &rng[(i >> 3) & 1] : NULL);
+        _mm256_storeu_si256((__m256i*)(pOut + i), v);
+    }
+    if (pDither) {
+        _mm256_storeu_si256((__m256i*)(pDither->state), rng[0]);
+        _mm256_storeu_si256((__m256i*)(pDither->state + 8), rng[1]);
+    }
+    for (; i < count; i++) {
+        pOut[i] = ta_quantize(pSrc[i], TA_S32_SCALE, TA_S32_MAX, pDither, i % TA_DITHER_LANES);
+    }
+}
+
+/* ---- AVX-512F (16 lanes) ---- */
+
+TA_TARGET("avx512f")
+static void ta_gain_avx512(float* pDst, const float* pSrc, ma_uint32 count, float gain) {
+    __m512 g = _mm512_set1_ps(gain);
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm512_storeu_ps(pDst + i, _mm512_mul_ps(_mm512_loadu_ps(pSrc + i), g));
+    }
+    if (i < count) {
+        /* Masked tail: no scalar loop, no access past count */
+        __mmask16 mask = (__mmask16)((1u << (count - i)) - 1);
+        _mm512_mask_storeu_ps(pDst + i, mask, _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, pSrc + i), g));
+    }
+}
+
+TA_TARGET("avx512f")
+static void ta_gain_ramp_avx512(float* pDst, const float* pSrc, ma_uint32 channels, ma_uint32 frameCount, float gainStart, float gainStep) {
+    float pattern[TA_KERNEL_FILL_PATTERN_MAX];
+    ma_uint32 period = ta_kernel_ramp_pattern(pattern, channels, 16);
+    ma_uint32 count = channels * frameCount;
+    ma_uint32 i = 0;
+    ma_uint32 offset = 0;
+    float base = 0.0f;
+    if (period == 0) {
+        ta_gain_ramp_scalar(pDst, pSrc, channels, frameCount, gainStart, gainStep);
+        return;
+    }
+    __m512 start = _mm512_set1_ps(gainStart);
+    __m512 step = _mm512_set1_ps(gainStep);
+    /* Explicit rounding keeps start + step * frame out of an FMA, as in mix */
+    for (; i + 16 <= count; i += 16) {
+        __m512 frame = _mm512_add_ps(_mm512_set1_ps(base), _mm512_loadu_ps(pattern + offset));
+        __m512 g = _mm512_add_round_ps(start, _mm512_mul_round_ps(step, frame, _MM_FROUND_CUR_DIRECTION), _MM_FROUND_CUR_DIRECTION);
+        _mm512_storeu_ps(pDst + i, _mm512_mul_ps(_mm512_loadu_ps(pSrc + i), g));
+        offset += 16;
+        if (offset == period) {
+            offset = 0;
+            base += (float)(period / channels);
+        }
+    }
+    if (i < count) {
+        __mmask16 mask = (__mmask16)((1u << (count - i)) - 1);
+        __m512 frame = _mm512_add_ps(_mm512_set1_ps(base), _mm512_loadu_ps(pattern + offset));
+        __m512 g = _mm512_add_round_ps(start, _mm512_mul_round_ps(step, frame, _MM_FROUND_CUR_DIRECTION), _MM_FROUND_CUR_DIRECTION);
+        _mm512_mask_storeu_ps(pDst + i, mask, _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, pSrc + i), g));
+    }
+}
+
+TA_TARGET("avx512f")
+static void ta_copy_avx512(float* pDst, const float* pSrc, ma_uint32 count) {
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm512_storeu_ps(pDst + i, _mm512_loadu_ps(pSrc + i));
+    }
+    if (i < count) {
+        __mmask16 mask = (__mmask16)((1u << (count - i)) - 1);
+        _mm512_mask_storeu_ps(pDst + i, mask, _mm512_maskz_loadu_ps(mask, pSrc + i));
+    }
+}
+
+TA_TARGET("avx512f")
+static void ta_fill_frame_avx512(float* pDst, const float* pFrame, ma_uint32 channels, ma_uint32 frameCount) {
+    float pattern[TA_KERNEL_FILL_PATTERN_MAX];
+    ma_uint32 period = ta_kernel_fill_pattern(pattern, pFrame, channels, 16);
+    ma_uint32 count = channels * frameCount;
+    ma_uint32 i = 0;
+    ma_uint32 offset = 0;
+    if (period == 0) {
+        ta_fill_frame_scalar(pDst, pFrame, channels, frameCount);
+        return;
+    }
+    for (; i + 16 <= count; i += 16) {
+        _mm512_storeu_ps(pDst + i, _mm512_loadu_ps(pattern + offset));
+        offset += 16;
+        if (offset == period) {
+            offset = 0;
+        }
+    }
+    if (i < count) {
+        __mmask16 mask = (__mmask16)((1u << (count - i)) - 1);
+        _mm512_mask_storeu_ps(pDst + i, mask, _mm512_loadu_ps(pattern + offset));
+    }
+}
+
+TA_TARGET("avx512f")
+static void ta_mix_avx512(float* pDst, const float* pSrc, ma_uint32 count, float gain) {
+    __m512 g = _mm512_set1_ps(gain);
+    ma_uint32 i = 0;
+    /* Explicit rounding keeps the compiler from contracting mul+add into an FMA */
+    for (; i + 16 <= count; i += 16) {
+        __m512 product = _mm512_mul_round_ps(_mm512_loadu_ps(pSrc + i), g, _MM_FROUND_CUR_DIRECTION);
+        _mm512_storeu_ps(pDst + i, _mm512_add_round_ps(_mm512_loadu_ps(pDst + i), product, _MM_FROUND_CUR_DIRECTION));
+    }
+    if (i < count) {
+        __mmask16 mask = (__mmask16)((1u << (count - i)) - 1);
+        __m512 product = _mm512_mul_round_ps(_mm512_maskz_loadu_ps(mask, pSrc + i), g, _MM_FROUND_CUR_DIRECTION);
+        __m512 sum = _mm512_add_round_ps(_mm512_maskz_loadu_ps(mask, pDst + i), product, _MM_FROUND_CUR_DIRECTION);
+        _mm512_mask_storeu_ps(pDst + i, mask, sum);
+    }
+}
+
+TA_TARGET("avx512f")
+static float ta_peak_avx512(const float* pSrc, ma_uint32 count) {
+    const __m512 absMask = _mm512_castsi512_ps(_mm512_set1_epi32(0x7FFFFFFF));
+    __m512 peak16 = _mm512_setzero_ps();
+    float lanes[16];
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 magnitude = _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(_mm512_loadu_ps(pSrc + i)), _mm512_castps_si512(absMask)));
+        peak16 = _mm512_max_ps(magnitude, peak16);
+    }
+    _mm512_storeu_ps(lanes, peak16);
+    float peak = ta_peak_scalar(lanes, 16);
+    float tail = ta_peak_scalar(pSrc + i, count - i);
+    return (tail > peak) ? tail : peak;
+}
+
+TA_TARGET("avx512f")
+static void ta_peak_rms_avx512(const float* pSrc, ma_uint32 count, float* pPeak, float* pSumSquares) {
+    float lanes[TA_KERNEL_SUM_LANES];
+    __m512 acc = _mm512_setzero_ps();
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 x = _mm512_loadu_ps(pSrc + i);
+        acc = _mm512_add_round_ps(acc, _mm512_mul_round_ps(x, x, _MM_FROUND_CUR_DIRECTION), _MM_FROUND_CUR_DIRECTION);
+    }
+    if (i < count) {
+        /* Tail lands on lanes 0..n-1 (i is a multiple of 16); masked-off lanes add +0 */
+        __mmask16 mask = (__mmask16)((1u << (count - i)) - 1);
+        __m512 x = _mm512_maskz_loadu_ps(mask, pSrc + i);
+        acc = _mm512_add_round_ps(acc, _mm512_mul_round_ps(x, x, _MM_FROUND_CUR_DIRECTION), _MM_FROUND_CUR_DIRECTION);
+    }
+    _mm512_storeu_ps(lanes, acc);
+    *pPeak = ta_peak_avx512(pSrc, count);
+    *pSumSquares = ta_kernel_reduce_sum(lanes);
+}
+
+TA_TARGET("avx512f")
+static float ta_diff_energy_avx512(const float* pA, const float* pB, ma_uint32 count) {
+    float lanes[TA_KERNEL_SUM_LANES];
+    __m512 acc = _mm512_setzero_ps();
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 d = _mm512_sub_round_ps(_mm512_loadu_ps(pA + i), _mm512_loadu_ps(pB + i), _MM_FROUND_CUR_DIRECTION);
+        acc = _mm512_add_round_ps(acc, _mm512_mul_round_ps(d, d, _MM_FROUND_CUR_DIRECTION), _MM_FROUND_CUR_DIRECTION);
+    }
+    if (i < count) {
+        /* Masked-off lanes load 0 - 0 and add +0 */
+        __mmask16 mask = (__mmask16)((1u << (count - i)) - 1);
+        __m512 d = _mm512_sub_round_ps(_mm512_maskz_loadu_ps(mask, pA + i), _mm512_maskz_loadu_ps(mask, pB + i), _MM_FROUND_CUR_DIRECTION);
+        acc = _mm512_add_round_ps(acc, _mm512_mul_round_ps(d, d, _MM_FROUND_CUR_DIRECTION), _MM_FROUND_CUR_DIRECTION);
+    }
+    _mm512_storeu_ps(lanes, acc);
+    return ta_kernel_reduce_sum(lanes);
+}
+
+TA_TARGET("avx512f")
+static __m512 ta_dither_next_avx512(__m512i* pState) {
+    __m512i x = *pState;
+    x = _mm512_xor_si512(x, _mm512_slli_epi32(x, 13));
+    x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 17));
+    x = _mm512_xor_si512(x, _mm512_slli_epi32(x, 5));
+    *pState = x;
+    __m512i diff = _mm512_sub_epi32(_mm512_and_si512(x, _mm512_set1_epi32(0xFFFF)), _mm512_srli_epi32(x, 16));
+    return _mm512_mul_ps(_mm512_cvtepi32_ps(diff), _mm512_set1_ps(TA_DITHER_SCALE));
+}
+
+TA_TARGET("avx512f")
+static __m512i ta_quantize_avx512(__m512 x, float scale, float maxValue, __m512i* pDitherState) {
+    __m512 v = _mm512_mul_round_ps(x, _mm512_set1_ps(scale), _MM_FROUND_CUR_DIRECTION);
+    if (pDitherState) {
+        v = _mm512_add_round_ps(v, ta_dither_next_avx512(pDitherState), _MM_FROUND_CUR_DIRECTION);
+    }
+    v = _mm512_min_ps(v, _mm512_set1_ps(maxValue));
+    v = _mm512_max_ps(v, _mm512_set1_ps(-scale));
+    return _mm512_cvtps_epi32(v);
+}
+
+TA_TARGET("avx512f")
+static void ta_s16_to_f32_avx512(float* pDst, const void* pSrc, ma_uint32 count) {
+    const ma_int16* pIn = (const ma_int16*)pSrc;
+    const __m512 scale = _mm512_set1_ps(1.0f / TA_S16_SCALE);
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i x = _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i*)(pIn + i)));
+        _mm512_storeu_ps(pDst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(x), scale));
+    }
+    ta_s16_to_f32_scalar(pDst + i, pIn + i, count - i);
+}
+
+TA_TARGET("avx512f")
+static void ta_s32_to_f32_avx512(float* pDst, const void* pSrc, ma_uint32 count) {
+    const ma_int32* pIn = (const ma_int32*)pSrc;
+    const __m512 scale = _mm512_set1_ps(1.0f / TA_S32_SCALE);
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i x = _mm512_loadu_si512((const void*)(pIn + i));
+        _mm512_storeu_ps(pDst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(x), scale));
+    }
+    if (i < count) {
+        __mmask16 mask = (__mmask16)((1u << (count - i)) - 1);
+        __m512i x = _mm512_maskz_loadu_epi32(mask, (const void*)(pIn + i));
+        _mm512_mask_storeu_ps(pDst + i, mask, _mm512_mul_ps(_mm512_cvtepi32_ps(x), scale));
+    }
+}
+
+/* One 16-lane dither register covers exactly the 16 canonical lanes */
+TA_TARGET("avx512f")
+static void ta_f32_to_s16_avx512(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither) {
+    ma_int16* pOut = (ma_int16*)pDst;
+    __m512i rng = _mm512_setzero_si512();
+    ma_uint32 i = 0;
+    if (pDither) {
+        rng = _mm512_loadu_si512((const void*)pDither->state);
+    }
+    for (; i + 16 <= count; i += 16) {
+        __m512i v = ta_quantize_avx512(_mm512_loadu_ps(pSrc + i), TA_S16_SCALE, TA_S16_MAX, pDither ? &rng : NULL);
+        _mm256_storeu_si256((__m256i*)(pOut + i), _mm512_cvtsepi32_epi16(v));
+    }
+    if (pDither) {
+        _mm512_storeu_si512((void*)pDither->state, rng);
+    }
+    for (; i < count; i++) {
+        pOut[i] = (ma_int16)ta_quantize(pSrc[i], TA_S16_SCALE, TA_S16_MAX, pDither, i % TA_DITHER_LANES);
+    }
+}
+
+TA_TARGET("avx512f")
+static void ta_f32_to_s32_avx512(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither) {
+    ma_int32* pOut = (ma_int32*)pDst;
+    __m512i rng = _mm512_setzero_si512();
+    ma_uint32 i = 0;
+    if (pDither) {
+        rng = _mm512_loadu_si512((const void*)pDither->state);
+    }
+    for (; i + 16 <= count; i += 16) {
+        __m512i v = ta_quantize_avx512(_mm512_loadu_ps(pSrc + i), TA_S32_SCALE, TA_S32_MAX, pDither ? &rng : NULL);
+        _mm512_storeu_si512((void*)(pOut + i), v);
+    }
+    if (pDither) {
+        _mm512_storeu_si512((void*)pDither->state, rng);
+    }
+    for (; i < count; i++) {
+        pOut[i] = ta_quantize(pSrc[i], TA_S32_SCALE, TA_S32_MAX, pDither, i % TA_DITHER_LANES);
+    }
+}
+
+/* ---- CPU detection ---- */
+
+static void ta_cpuid(int info[4], int leaf, int subleaf) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    __cpuidex(info, leaf, subleaf);
+#else
+    unsigned int a, b, c, d;
+    __cpuid_count((unsigned int)leaf, (unsigned int)subleaf, a, b, c, d);
+    info[0] = (int)a;
+    info[1] = (int)b;
+    info[2] = (int)c;
+    info[3] = (int)d;
+#endif
+}
+
+/* XCR0: which register files the OS saves on context switch */
+static ma_uint64 ta_xgetbv0(void) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return (ma_uint64)_xgetbv(0);
+#else
+    unsigned int lo, hi;
+    __asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((ma_uint64)hi << 32) | lo;
+#endif
+}
+
+#endif /* TA_SIMD_X86 */
+
+/* ==============================================================================
+ * NEON (ARM64, 4 lanes)
+ * ============================================================================== */
+
+#if defined(TA_SIMD_NEON)
+
+static void ta_gain_neon(float* pDst, const float* pSrc, ma_uint32 count, float gain) {
+    ma_uint32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a = vmulq_n_f32(vld1q_f32(pSrc + i), gain);
+        float32x4_t b = vmulq_n_f32(vld1q_f32(pSrc + i + 4), gain);
+        vst1q_f32(pDst + i, a);
+        vst1q_f32(pDst + i + 4, b);
+    }
+    for (; i < count; i++) {
+        pDst[i] = pSrc[i] * gain;
+    }
+}
+
+static void ta_gain_ramp_neon(float* pDst, const float* pSrc, ma_uint32 channels, ma_uint32 frameCount, float gainStart, float gainStep) {
+    float pattern[TA_KERNEL_FILL_PATTERN_MAX];
+    ma_uint32 period = ta_kernel_ramp_pattern(pattern, channels, 4);
+    ma_uint32 count = channels * frameCount;
+    ma_uint32 i = 0;
+    ma_uint32 offset = 0;
+    float base = 0.0f;
+    if (period == 0) {
+        ta_gain_ramp_scalar(pDst, pSrc, channels, frameCount, gainStart, gainStep);
+        return;
+    }
+    float32x4_t start = vdupq_n_f32(gainStart);
+    float32x4_t step = vdupq_n_f32(gainStep);
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t frame = vaddq_f32(vdupq_n_f32(base), vld1q_f32(pattern + offset));
+        float32x4_t g = vaddq_f32(start, vmulq_f32(step, frame));
+        vst1q_f32(pDst + i, vmulq_f32(vld1q_f32(pSrc + i), g));
+        offset += 4;
+        if (offset == period) {
+            offset = 0;
+            base += (float)(period / channels);
+        }
+    }
+    for (; i < count; i++) {
+        pDst[i] = pSrc[i] * (gainStart + gainStep * (float)(i / channels));
+    }
+}
+
+static void ta_copy_neon(float* pDst, const float* pSrc, ma_uint32 count) {
+    ma_uint32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a = vld1q_f32(pSrc + i);
+        float32x4_t b = vld1q_f32(pSrc + i + 4);
+        vst1q_f32(pDst + i, a);
+        vst1q_f32(pDst + i + 4, b);
+    }
+    for (; i < count; i++) {
+        pDst[i] = pSrc[i];
+    }
+}
+
+static void ta_fill_frame_neon(float* pDst, const float* pFrame, ma_uint32 channels, ma_uint32 frameCount) {
+    float pattern[TA_KERNEL_FILL_PATTERN_MAX];
+    ma_uint32 period = ta_kernel_fill_pattern(pattern, pFrame, channels, 4);
+    ma_uint32 count = channels * frameCount;
+    ma_uint32 i = 0;
+    ma_uint32 offset = 0;
+    if (period == 0) {
+        ta_fill_frame_scalar(pDst, pFrame, channels, frameCount);
+        return;
+    }
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(pDst + i, vld1q_f32(pattern + offset));
+        offset += 4;
+        if (offset == period) {
+            offset = 0;
+        }
+    }
+    for (; i < count; i++) {
+        pDst[i] = pattern[i % period];
+    }
+}
+
+static void ta_mix_neon(float* pDst, const float* pSrc, ma_uint32 count, float gain) {
+    ma_uint32 i = 0;
+    /* vmulq + vaddq, not vfmaq: matches the scalar rounding */
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t product = vmulq_n_f32(vld1q_f32(pSrc + i), gain);
+        vst1q_f32(pDst + i, vaddq_f32(vld1q_f32(pDst + i), product));
+    }
+    for (; i < count; i++) {
+        pDst[i] = pDst[i] + pSrc[i] * gain;
+    }
+}
+
+static float ta_peak_neon(const float* pSrc, ma_uint32 count) {
+    float32x4_t peak4 = vdupq_n_f32(0.0f);
+    ma_uint32 i = 0;
+    /* maxnm ignores NaN inputs, like the scalar compare */
+    for (; i + 4 <= count; i += 4) {
+        peak4 = vmaxnmq_f32(vabsq_f32(vld1q_f32(pSrc + i)), peak4);
+    }
+    float peak = vmaxnmvq_f32(peak4);
+    float tail = ta_peak_scalar(pSrc + i, count - i);
+    return (tail > peak) ? tail : peak;
+}
+
+static void ta_peak_rms_neon(const float* pSrc, ma_uint32 count, float* pPeak, float* pSumSquares) {
+    float lanes[TA_KERNEL_SUM_LANES];
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    float32x4_t acc2 = vdupq_n_f32(0.0f);
+    float32x4_t acc3 = vdupq_n_f32(0.0f);
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        float32x4_t x0 = vld1q_f32(pSrc + i);
+        float32x4_t x1 = vld1q_f32(pSrc + i + 4);
+        float32x4_t x2 = vld1q_f32(pSrc + i + 8);
+        float32x4_t x3 = vld1q_f32(pSrc + i + 12);
+        acc0 = vaddq_f32(acc0, vmulq_f32(x0, x0));
+        acc1 = vaddq_f32(acc1, vmulq_f32(x1, x1));
+        acc2 = vaddq_f32(acc2, vmulq_f32(x2, x2));
+        acc3 = vaddq_f32(acc3, vmulq_f32(x3, x3));
+    }
+    vst1q_f32(lanes + 0, acc0);
+    vst1q_f32(lanes + 4, acc1);
+    vst1q_f32(lanes + 8, acc2);
+    vst1q_f32(lanes + 12, acc3);
+    for (; i < count; i++) {
+        lanes[i % TA_KERNEL_SUM_LANES] += pSrc[i] * pSrc[i];
+    }
+    *pPeak = ta_peak_neon(pSrc, count);
+    *pSumSquares = ta_kernel_reduce_sum(lanes);
+}
+
+static float ta_diff_energy_neon(const float* pA, const float* pB, ma_uint32 count) {
+    float lanes[TA_KERNEL_SUM_LANES];
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    float32x4_t acc2 = vdupq_n_f32(0.0f);
+    float32x4_t acc3 = vdupq_n_f32(0.0f);
+    ma_uint32 i = 0;
+    for (; i + 16 <= count; i += 16) {
+        float32x4_t d0 = vsubq_f32(vld1q_f32(pA + i), vld1q_f32(pB + i));
+        float32x4_t d1 = vsubq_f32(vld1q_f32(pA + i + 4), vld1q_f32(pB + i + 4));
+        float32x4_t d2 = vsubq_f32(vld1q_f32(pA + i + 8), vld1q_f32(pB + i + 8));
+        float32x4_t d3 = vsubq_f32(vld1q_f32(pA + i + 12), vld1q_f32(pB + i + 12));
+        acc0 = vaddq_f32(acc0, vmulq_f32(d0, d0));
+        acc1 = vaddq_f32(acc1, vmulq_f32(d1, d1));
+        acc2 = vaddq_f32(acc2, vmulq_f32(d2, d2));
+        acc3 = vaddq_f32(acc3, vmulq_f32(d3, d3));
+    }
+    vst1q_f32(lanes + 0, acc0);
+    vst1q_f32(lanes + 4, acc1);
+    vst1q_f32(lanes + 8, acc2);
+    vst1q_f32(lanes + 12, acc3);
+    for (; i < count; i++) {
+        float d = pA[i] - pB[i];
+        lanes[i % TA_KERNEL_SUM_LANES] += d * d;
+    }
+    return ta_kernel_reduce_sum(lanes);
+}
+
+static float32x4_t ta_dither_next_neon(uint32x4_t* pState) {
+    uint32x4_t x = *pState;
+    x = veorq_u32(x, vshlq_n_u32(x, 13));
+    x = veorq_u32(x, vshrq_n_u32(x, 17));
+    x = veorq_u32(x, vshlq_n_u32(x, 5));
+    *pState = x;
+    int32x4_t diff = vsubq_s32(vreinterpretq_s32_u32(vandq_u32(x, vdupq_n_u32(0xFFFF))), vreinterpretq_s32_u32(vshrq_n_u32(x, 16)));
+    return vmulq_n_f32(vcvtq_f32_s32(diff), TA_DITHER_SCALE);
+}
+
+/* Compare + select rather than vminq/vmaxq, so NaN clamps to the bound like the scalar code */
+static int32x4_t ta_quantize_neon(float32x4_t x, float scale, float maxValue, uint32x4_t* pDitherState) {
+    float32x4_t v = vmulq_n_f32(x, scale);
+    float32x4_t hi = vdupq_n_f32(maxValue);
+    float32x4_t lo = vdupq_n_f32(-scale);
+    if (pDitherState) {
+        v = vaddq_f32(v, ta_dither_next_neon(pDitherState));
+    }
+    v = vbslq_f32(vcltq_f32(v, hi), v, hi);
+    v = vbslq_f32(vcgtq_f32(v, lo), v, lo);
+    return vcvtnq_s32_f32(v);
+}
+
+static void ta_s16_to_f32_neon(float* pDst, const void* pSrc, ma_uint32 count) {
+    const ma_int16* pIn = (const ma_int16*)pSrc;
+    ma_uint32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t x = vld1q_s16(pIn + i);
+        vst1q_f32(pDst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), 1.0f / TA_S16_SCALE));
+        vst1q_f32(pDst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), 1.0f / TA_S16_SCALE));
+    }
+    ta_s16_to_f32_scalar(pDst + i, pIn + i, count - i);
+}
+
+/* vld3 splits 8 packed samples into their low/mid/high bytes */
+static void ta_s24_to_f32_neon(float* pDst, const void* pSrc, ma_uint32 count) {
+    const ma_uint8* pIn = (const ma_uint8*)pSrc;
+    ma_uint32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x3_t b = vld3_u8(pIn + (size_t)i * 3);
+        uint16x8_t low = vshlq_n_u16(vmovl_u8(b.val[0]), 8);
+        uint16x8_t high = vorrq_u16(vmovl_u8(b.val[1]), vshlq_n_u16(vmovl_u8(b.val[2]), 8));
+        uint32x4_t x0 = vorrq_u32(vmovl_u16(vget_low_u16(low)), vshlq_n_u32(vmovl_u16(vget_low_u16(high)), 16));
+        uint32x4_t x1 = vorrq_u32(vmovl_u16(vget_high_u16(low)), vshlq_n_u32(vmovl_u16(vget_high_u16(high)), 16));
+        vst1q_f32(pDst + i, vmulq_n_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(x0)), 1.0f / TA_S32_SCALE));
+        vst1q_f32(pDst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(x1)), 1.0f / TA_S32_SCALE));
+    }
+    ta_s24_to_f32_scalar(pDst + i, pIn + (size_t)i * 3, count - i);
+}
+
+static void ta_s32_to_f32_neon(float* pDst, const void* pSrc, ma_uint32 count) {
+    const ma_int32* pIn = (const ma_int32*)pSrc;
+    ma_uint32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(pDst + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(pIn + i)), 1.0f / TA_S32_SCALE));
+    }
+    ta_s32_to_f32_scalar(pDst + i, pIn + i, count - i);
+}
+
+static void ta_f32_to_s16_neon(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither) {
+    ma_int16* pOut = (ma_int16*)pDst;
+    uint32x4_t rng[4];
+    ma_uint32 i = 0;
+    memset(rng, 0, sizeof(rng));
+    if (pDither) {
+        for (int r = 0; r < 4; r++) {
+            rng[r] = vld1q_u32(pDither->state + r * 4);
+        }
+    }
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t a = ta_quantize_neon(vld1q_f32(pSrc + i), TA_S16_SCALE, TA_S16_MAX, pDither ? &rng[(i >> 2) & 3] : NULL);
+        int32x4_t b = ta_quantize_neon(vld1q_f32(pSrc + i + 4), TA_S16_SCALE, TA_S16_MAX, pDither ? &rng[((i >> 2) + 1) & 3] : NULL);
+        vst1q_s16(pOut + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+    if (pDither) {
+        for (int r = 0; r < 4; r++) {
+            vst1q_u32(pDither->state + r * 4, rng[r]);
+        }
+    }
+    for (; i < count; i++) {
+        pOut[i] = (ma_int16)ta_quantize(pSrc[i], TA_S16_SCALE, TA_S16_MAX, pDither, i % TA_DITHER_LANES);
+    }
+}
+
+static void ta_f32_to_s24_neon(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither) {
+    ma_uint8* pOut = (ma_uint8*)pDst;
+    uint32x4_t rng[4];
+    ma_uint32 i = 0;
+    memset(rng, 0, sizeof(rng));
+    if (pDither) {
+        for (int r = 0; r < 4; r++) {
+            rng[r] = vld1q_u32(pDither->state + r * 4);
+        }
+    }
+    for (; i + 8 <= count; i += 8) {
+        uint32x4_t v0 = vreinterpretq_u32_s32(ta_quantize_neon(vld1q_f32(pSrc + i), TA_S24_SCALE, TA_S24_MAX, pDither ? &rng[(i >> 2) & 3] : NULL));
+        uint32x4_t v1 = vreinterpretq_u32_s32(ta_quantize_neon(vld1q_f32(pSrc + i + 4), TA_S24_SCALE, TA_S24_MAX, pDither ? &rng[((i >> 2) + 1) & 3] : NULL));
+        uint8x8x3_t b;
+        b.val[0] = vmovn_u16(vcombine_u16(vmovn_u32(v0), vmovn_u32(v1)));
+        b.val[1] = vmovn_u16(vcombine_u16(vmovn_u32(vshrq_n_u32(v0, 8)), vmovn_u32(vshrq_n_u32(v1, 8))));
+        b.val[2] = vmovn_u16(vcombine_u16(vmovn_u32(vshrq_n_u32(v0, 16)), vmovn_u32(vshrq_n_u32(v1, 16))));
+        vst3_u8(pOut + (size_t)i * 3, b);
+    }
+    if (pDither) {
+        for (int r = 0; r < 4; r++) {
+            vst1q_u32(pDither->state + r * 4, rng[r]);
+        }
+    }
+    for (; i < count; i++) {
+        ma_int32 v = ta_quantize(pSrc[i], TA_S24_SCALE, TA_S24_MAX, pDither, i % TA_DITHER_LANES);
+        pOut[(size_t)i * 3 + 0] = (ma_uint8)(v);
+        pOut[(size_t)i * 3 + 1] = (ma_uint8)(v >> 8);
+        pOut[(size_t)i * 3 + 2] = (ma_uint8)(v >> 16);
+    }
+}
+
+static void ta_f32_to_s32_neon(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither) {
+    ma_int32* pOut = (ma_int32*)pDst;
+    uint32x4_t rng[4];
+    ma_uint32 i = 0;
+    memset(rng, 0, sizeof(rng));
+    if (pDither) {
+        for (int r = 0; r < 4; r++) {
+            rng[r] = vld1q_u32(pDither->state + r * 4);
+        }
+    }
+    for (; i + 4 <= count; i += 4) {
+        vst1q_s32(pOut + i, ta_quantize_neon(vld1q_f32(pSrc + i), TA_S32_SCALE, TA_S32_MAX, pDither ? &rng[(i >> 2) & 3] : NULL));
+    }
+    if (pDither) {
+        for (int r = 0; r < 4; r++) {
+            vst1q_u32(pDither->state + r * 4, rng[r]);
+        }
+    }
+    for (; i < count; i++) {
+        pOut[i] = ta_quantize(pSrc[i], TA_S32_SCALE, TA_S32_MAX, pDither, i % TA_DITHER_LANES);
+    }
+}
+
+#endif /* TA_SIMD_NEON */
+
+/* ==============================================================================
+ * DISPATCH
+ * ============================================================================== */
+
+/* Best variant this CPU (and OS) can run */
+static ta_simd_level ta_simd_detect(void) {
+#if defined(TA_SIMD_X86)
+    int info[4];
+    ta_cpuid(info, 0, 0);
+    int maxLeaf = info[0];
+
+    ta_cpuid(info, 1, 0);
+    int hasSse2 = (info[3] >> 26) & 1;
+    int hasOsxsave = (info[2] >> 27) & 1;
+    int hasAvx = (info[2] >> 28) & 1;
+    ma_uint64 xcr0 = hasOsxsave ? ta_xgetbv0() : 0;
+
+    int hasAvx2 = 0;
+    int hasAvx512f = 0;
+    if (maxLeaf >= 7) {
+        ta_cpuid(info, 7, 0);
+        hasAvx2 = (info[1] >> 5) & 1;
+        hasAvx512f = (info[1] >> 16) & 1;
+    }
+
+    /* XCR0 bits: 1 SSE, 2 AVX, 5-7 opmask/ZMM state */
+    /* The AVX-512 table reuses the AVX2 packed 24-bit kernels */
+    if (hasAvx && hasAvx2 && hasAvx512f && (xcr0 & 0xE6) == 0xE6) {
+        return TA_SIMD_AVX512;
+    }
+    if (hasAvx && hasAvx2 && (xcr0 & 0x06) == 0x06) {
+        return TA_SIMD_AVX2;
+    }
+    if (hasSse2) {
+        return TA_SIMD_SSE2;
+    }
+    return TA_SIMD_SCALAR;
+#elif defined(TA_SIMD_NEON)
+    return TA_SIMD_NEON;
+#else
+    return TA_SIMD_SCALAR;
+#endif
+}
+
+static const char* ta_simd_level_name(ta_simd_level level) {
+    switch (level) {
+        case TA_SIMD_SSE2:      return "sse2";
+        case TA_SIMD_AVX2:      return "avx2";
+        case TA_SIMD_AVX512:    return "avx512f";
+        case TA_SIMD_NEON:      return "neon";
+        default:                return "scalar";
+    }
+}
+
+/* Fill the table for one level. Returns 0 if not compiled in or not supported here. */
+static int ta_kernels_select(ta_kernels* pKernels, ta_simd_level level) {
+    ta_simd_level best = ta_simd_detect();
+
+    pKernels->level = TA_SIMD_SCALAR;
+    pKernels->name = ta_simd_level_name(TA_SIMD_SCALAR);
+    pKernels->gain = ta_gain_scalar;
+    pKernels->gain_ramp = ta_gain_ramp_scalar;
+    pKernels->copy = ta_copy_scalar;
+    pKernels->fill_frame = ta_fill_frame_scalar;
+    pKernels->mix = ta_mix_scalar;
+    pKernels->peak = ta_peak_scalar;
+    pKernels->peak_rms = ta_peak_rms_scalar;
+    pKernels->diff_energy = ta_diff_energy_scalar;
+    pKernels->s16_to_f32 = ta_s16_to_f32_scalar;
+    pKernels->s24_to_f32 = ta_s24_to_f32_scalar;
+    pKernels->s32_to_f32 = ta_s32_to_f32_scalar;
+    pKernels->f32_to_s16 = ta_f32_to_s16_scalar;
+    pKernels->f32_to_s24 = ta_f32_to_s24_scalar;
+    pKernels->f32_to_s32 = ta_f32_to_s32_scalar;
+
+    switch (level) {
+        case TA_SIMD_SCALAR:
+            break;
+
+#if defined(TA_SIMD_X86)
+        case TA_SIMD_SSE2:
+            if (best < TA_SIMD_SSE2) {
+                return 0;
+            }
+            pKernels->gain = ta_gain_sse2;
+            pKernels->gain_ramp = ta_gain_ramp_sse2;
+            pKernels->copy = ta_copy_sse2;
+            pKernels->fill_frame = ta_fill_frame_sse2;
+            pKernels->mix = ta_mix_sse2;
+            pKernels->peak = ta_peak_sse2;
+            pKernels->peak_rms = ta_peak_rms_sse2;
+            pKernels->diff_energy = ta_diff_energy_sse2;
+            pKernels->s16_to_f32 = ta_s16_to_f32_sse2;
+            pKernels->s32_to_f32 = ta_s32_to_f32_sse2;
+            pKernels->f32_to_s16 = ta_f32_to_s16_sse2;
+            pKernels->f32_to_s24 = ta_f32_to_s24_sse2;
+            pKernels->f32_to_s32 = ta_f32_to_s32_sse2;
+            break;
+
+        case TA_SIMD_AVX2:
+            if (best < TA_SIMD_AVX2) {
+                return 0;
+            }
+            pKernels->gain = ta_gain_avx2;
+            pKernels->gain_ramp = ta_gain_ramp_avx2;
+            pKernels->copy = ta_copy_avx2;
+            pKernels->fill_frame = ta_fill_frame_avx2;
+            pKernels->mix = ta_mix_avx2;
+            pKernels->peak = ta_peak_avx2;
+            pKernels->peak_rms = ta_peak_rms_avx2;
+            pKernels->diff_energy = ta_diff_energy_avx2;
+            pKernels->s16_to_f32 = ta_s16_to_f32_avx2;
+            pKernels->s24_to_f32 = ta_s24_to_f32_avx2;
+            pKernels->s32_to_f32 = ta_s32_to_f32_avx2;
+            pKernels->f32_to_s16 = ta_f32_to_s16_avx2;
+            pKernels->f32_to_s24 = ta_f32_to_s24_avx2;
+            pKernels->f32_to_s32 = ta_f32_to_s32_avx2;
+            break;
+
+        case TA_SIMD_AVX512:
+            if (best < TA_SIMD_AVX512) {
+                return 0;
+            }
+            pKernels->gain = ta_gain_avx512;
+            pKernels->gain_ramp = ta_gain_ramp_avx512;
+            pKernels->copy = ta_copy_avx512;
+            pKernels->fill_frame = ta_fill_frame_avx512;
+            pKernels->mix = ta_mix_avx512;
+            pKernels->peak = ta_peak_avx512;
+            pKernels->peak_rms = ta_peak_rms_avx512;
+            pKernels->diff_energy = ta_diff_energy_avx512;
+            pKernels->s16_to_f32 = ta_s16_to_f32_avx512;
+            pKernels->s24_to_f32 = ta_s24_to_f32_avx2;
+            pKernels->s32_to_f32 = ta_s32_to_f32_avx512;
+            pKernels->f32_to_s16 = ta_f32_to_s16_avx512;
+            pKernels->f32_to_s24 = ta_f32_to_s24_avx2;
+            pKernels->f32_to_s32 = ta_f32_to_s32_avx512;
+            break;
+#endif
+
+#if defined(TA_SIMD_NEON)
+        case TA_SIMD_NEON:
+            pKernels->gain = ta_gain_neon;
+            pKernels->gain_ramp = ta_gain_ramp_neon;
+            pKernels->copy = ta_copy_neon;
+            pKernels->fill_frame = ta_fill_frame_neon;
+            pKernels->mix = ta_mix_neon;
+            pKernels->peak = ta_peak_neon;
+            pKernels->peak_rms = ta_peak_rms_neon;
+            pKernels->diff_energy = ta_diff_energy_neon;
+            pKernels->s16_to_f32 = ta_s16_to_f32_neon;
+            pKernels->s24_to_f32 = ta_s24_to_f32_neon;
+            pKernels->s32_to_f32 = ta_s32_to_f32_neon;
+            pKernels->f32_to_s16 = ta_f32_to_s16_neon;
+            pKernels->f32_to_s24 = ta_f32_to_s24_neon;
+            pKernels->f32_to_s32 = ta_f32_to_s32_neon;
+            break;
+#endif
+
+        default:
+            return 0;
+    }
+
+    pKernels->level = level;
+    pKernels->name = ta_simd_level_name(level);
+    return 1;
+}
+
+/* Best available variant */
+static MA_INLINE void ta_kernels_init(ta_kernels* pKernels) {
+    if (!ta_kernels_select(pKernels, ta_simd_detect())) {
+        ta_kernels_select(pKernels, TA_SIMD_SCALAR);
+    }
+}
+
+#if defined(__clang__)
+    #pragma STDC FP_CONTRACT DEFAULT
+#elif defined(__GNUC__)
+    #pragma GCC pop_options
+#endif
+
+#endif /* TA_KERNELS_H */
@@ -0,0 +1,201 @@
+/*
+ * ==============================================================================
+ * ta_latency.h - Adaptive Ring Target
+ * ==============================================================================
+ * The ring target (the fill the drift stage steers toward) is the latency
+ * the elastic buffer adds. Instead of a fixed half-ring, the playback thread
+ * learns the lowest target the devices sustain on this machine:
+ *
+ *   - Every callback reports the fill it found before reading. Over a
+ *     window of TA_LATENCY_WINDOW_MS the controller keeps the mean of that
+ *     fill (what the drift stage steers onto the target) and the low-water
+ *     mark of what the reads left behind; their difference is how deep the
+ *     ring dips below the target (the read itself, capture bursts,
+ *     scheduling jitter, resampler correction).
+ *   - After a window without underruns the target moves a quarter of the
+ *     way down toward dip + TA_LATENCY_MARGIN_MS, at most
+ *     TA_LATENCY_MAX_SHRINK_MS per window, and never below the learned
+ *     floor. Measuring the dip against the mean keeps the estimate valid
+ *     while the fill is still converging on a previous target.
+ *   - On an underrun the target immediately grows by half (at least two
+ *     callbacks), and the target that underran plus one callback becomes
+ *     the learned floor.
+ *   - After TA_LATENCY_FLOOR_HOLD_SEC without underruns the floor relaxes
+ *     toward minFrames, so one stall does not pin the latency up forever.
+ *
+ * Everything stays inside [minFrames, maxFrames].
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h. All state is owned by the
+ *   playback thread; ta_latency_configure() runs before the devices start.
+ * ==============================================================================
+ */
+
+#ifndef TA_LATENCY_H
+#define TA_LATENCY_H
+
+#include <string.h>
+
+/* Observation window for the low-water mark */
+#define TA_LATENCY_WINDOW_MS            500
+
+/* Fill kept in reserve below the deepest observed dip */
+#define TA_LATENCY_MARGIN_MS            1.0f
+
+/* Largest target reduction per clean window */
+#define TA_LATENCY_MAX_SHRINK_MS        1.0f
+
+/* Underrun-free time before the learned floor starts to relax */
+#define TA_LATENCY_FLOOR_HOLD_SEC       120
+
+typedef struct {
+    ma_uint32 minFrames;
+    ma_uint32 maxFrames;
+    ma_uint32 targetFrames;     /* Current target, 0 until first configured */
+    ma_uint32 floorFrames;      /* Learned from underruns, 0 = none yet */
+
+    ma_uint32 windowFrames;
+    ma_uint32 marginFrames;
+    ma_uint32 maxShrinkFrames;
+    ma_uint32 floorHoldWindows;
+
+    /* Current window */
+    ma_uint32 windowElapsed;
+    ma_uint32 windowLowWater;
+    ma_uint64 windowFillSum;
+    ma_uint32 windowCallbacks;
+    ma_uint32 cleanWindows;     /* Complete windows since the last underrun */
+} ta_latency;
+
+static void ta_latency_window_reset(ta_latency* pLatency) {
+    pLatency->windowElapsed = 0;
+    pLatency->windowLowWater = 0xFFFFFFFFu;
+    pLatency->windowFillSum = 0;
+    pLatency->windowCallbacks = 0;
+}
+
+static void ta_latency_init(ta_latency* pLatency) {
+    memset(pLatency, 0, sizeof(*pLatency));
+    ta_latency_window_reset(pLatency);
+}
+
+/*
+ * Set the bounds for a run at sampleRate. The first call starts at
+ * maxFrames; later calls (Stop/Start) keep the learned target and floor,
+ * clamped to the new bounds.
+ */
+static void ta_latency_configure(ta_latency* pLatency, ma_uint32 sampleRate, ma_uint32 minFrames, ma_uint32 maxFrames) {
+    if (maxFrames < 1) {
+        maxFrames = 1;
+    }
+    if (minFrames < 1) {
+        minFrames = 1;
+    }
+    if (minFrames > maxFrames) {
+        minFrames = maxFrames;
+    }
+
+    pLatency->minFrames = minFrames;
+    pLatency->maxFrames = maxFrames;
+    pLatency->windowFrames = (ma_uint32)(((ma_uint64)sampleRate * TA_LATENCY_WINDOW_MS) / 1000);
+    pLatency->marginFrames = (ma_uint32)((float)sampleRate * TA_LATENCY_MARGIN_MS / 1000.0f);
+    pLatency->maxShrinkFrames = (ma_uint32)((float)sampleRate * TA_LATENCY_MAX_SHRINK_MS / 1000.0f);
+    pLatency->floorHoldWindows = (TA_LATENCY_FLOOR_HOLD_SEC * 1000) / TA_LATENCY_WINDOW_MS;
+    if (pLatency->maxShrinkFrames < 1) {
+        pLatency->maxShrinkFrames = 1;
+    }
+
+    if (pLatency->targetFrames == 0 || pLatency->targetFrames > maxFrames) {
+        pLatency->targetFrames = maxFrames;
+    }
+    if (pLatency->floorFrames > maxFrames) {
+        pLatency->floorFrames = maxFrames;
+    }
+    if (pLatency->targetFrames < minFrames) {
+        pLatency->targetFrames = minFrames;
+    }
+
+    pLatency->cleanWindows = 0;
+    ta_latency_window_reset(pLatency);
+}
+
+/* Back off after an underrun and remember where it happened */
+static void ta_latency_on_underrun(ta_latency* pLatency, ma_uint32 frameCount) {
+    ma_uint32 target = pLatency->targetFrames;
+    ma_uint32 grow = target / 2;
+    if (grow < 2 * frameCount) {
+        grow = 2 * frameCount;
+    }
+
+    ma_uint32 floor = target + frameCount;
+    if (floor > pLatency->maxFrames) {
+        floor = pLatency->maxFrames;
+    }
+    if (floor > pLatency->floorFrames) {
+        pLatency->floorFrames = floor;
+    }
+
+    target = (grow > pLatency->maxFrames - target) ? pLatency->maxFrames : target + grow;
+    if (target < pLatency->floorFrames) {
+        target = pLatency->floorFrames;
+    }
+    pLatency->targetFrames = target;
+
+    pLatency->cleanWindows = 0;
+    ta_latency_window_reset(pLatency);
+}
+
+/* A full window without underruns: shrink toward what the dip needs */
+static void ta_latency_on_clean_window(ta_latency* pLatency) {
+    ma_uint32 meanFill = (ma_uint32)(pLatency->windowFillSum / pLatency->windowCallbacks);
+    ma_uint32 dip = (meanFill > pLatency->windowLowWater) ? meanFill - pLatency->windowLowWater : 0;
+    ma_uint32 needed = dip + pLatency->marginFrames;
+
+    pLatency->cleanWindows++;
+    if (pLatency->cleanWindows >= pLatency->floorHoldWindows && pLatency->floorFrames > pLatency->minFrames) {
+        pLatency->floorFrames -= (pLatency->floorFrames - pLatency->minFrames + 7) / 8;
+    }
+
+    ma_uint32 lowest = (pLatency->floorFrames > pLatency->minFrames) ? pLatency->floorFrames : pLatency->minFrames;
+    if (needed < lowest) {
+        needed = lowest;
+    }
+
+    if (needed < pLatency->targetFrames) {
+        ma_uint32 shrink = (pLatency->targetFrames - needed + 3) / 4;
+        if (shrink > pLatency->maxShrinkFrames) {
+            shrink = pLatency->maxShrinkFrames;
+        }
+        pLatency->targetFrames -= shrink;
+    } else if (pLatency->targetFrames < lowest) {
+        pLatency->targetFrames = lowest;
+    }
+}
+
+/*
+ * Feed one callback: fill is the ring fill before the read, underran is 1
+ * if the callback ran short. Returns the target to steer toward.
+ */
+static ma_uint32 ta_latency_update(ta_latency* pLatency, ma_uint32 fill, ma_uint32 frameCount, int underran) {
+    if (underran) {
+        ta_latency_on_underrun(pLatency, frameCount);
+        return pLatency->targetFrames;
+    }
+
+    ma_uint32 remaining = (fill > frameCount) ? fill - frameCount : 0;
+    if (remaining < pLatency->windowLowWater) {
+        pLatency->windowLowWater = remaining;
+    }
+    pLatency->windowFillSum += fill;
+    pLatency->windowCallbacks++;
+    pLatency->windowElapsed += frameCount;
+
+    if (pLatency->windowElapsed >= pLatency->windowFrames) {
+        ta_latency_on_clean_window(pLatency);
+        ta_latency_window_reset(pLatency);
+    }
+
+    return pLatency->targetFrames;
+}
+
+#endif /* TA_LATENCY_H */
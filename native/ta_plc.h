@@ -0,0 +1,379 @@
+/*
+ * ==============================================================================
+ * ta_plc.h - Underrun Concealment
+ * ==============================================================================
+ * When the ring runs dry mid-callback, holding the last frame is a DC step:
+ * a pop going in, another coming out, and an offset on the speakers while it
+ * lasts. This stage hides the gap instead, in the spirit of packet loss
+ * concealment (G.711 Appendix I):
+ *
+ *   - History: the last TA_PLC_HISTORY_MS of real output, stored twice
+ *     (like the mirrored ring) so any window of it is one contiguous span.
+ *   - Pitch: on entry to a gap, the period is found by normalized
+ *     cross-correlation of the newest TA_PLC_WINDOW_MS against the history,
+ *     coarse on a channel-summed, 4x decimated copy, then refined at full
+ *     rate. Lags cover TA_PLC_MIN_PERIOD_MS..TA_PLC_MAX_PERIOD_MS.
+ *   - Extension: the last period is repeated. Its tail is crossfaded with
+ *     the period before it so the repeats join smoothly, and the first
+ *     frames blend out of the last real frame.
+ *   - Envelope: full level for TA_PLC_HOLD_MS, then a linear fade to zero
+ *     over TA_PLC_FADE_MS; a long gap ends in silence, never in DC.
+ *   - Recovery: when frames return, they are crossfaded in over
+ *     TA_PLC_CROSSFADE_MS against the continuing extension (or against
+ *     silence once faded out).
+ *
+ * Work per callback is bounded: one pitch search per gap (a few thousand
+ * multiply-adds), then one pass over the concealed and crossfaded frames.
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h. Buffers are allocated at
+ *   init; all state is owned by the playback thread.
+ * ==============================================================================
+ */
+
+#ifndef TA_PLC_H
+#define TA_PLC_H
+
+#include <string.h>
+#include <math.h>
+
+#define TA_PLC_HISTORY_MS           40
+#define TA_PLC_WINDOW_MS            10
+#define TA_PLC_MIN_PERIOD_MS        2.5f    /* 400Hz */
+#define TA_PLC_MAX_PERIOD_MS        15.0f   /* ~67Hz */
+#define TA_PLC_HOLD_MS              5.0f
+#define TA_PLC_FADE_MS              15.0f
+#define TA_PLC_CROSSFADE_MS         2.0f
+#define TA_PLC_MAX_OLA_MS           1.0f    /* Crossfade at period joins (at most a quarter period) */
+#define TA_PLC_DECIMATION           4
+
+/* History is allocated for this rate when the device rate is not known up front */
+#define TA_PLC_MAX_SAMPLE_RATE      192000
+
+typedef struct {
+    ma_uint32 channels;
+    ma_uint32 capacityFrames;   /* History allocated per copy */
+    float* pHistory;            /* 2 * capacityFrames interleaved frames */
+    float* pCycle;              /* One period, wrap crossfaded */
+    float* pMono;               /* Channel-summed history */
+    float* pDecimated;          /* pMono, decimated */
+
+    /* Lengths for the current sample rate */
+    ma_uint32 historyFrames;
+    ma_uint32 windowFrames;
+    ma_uint32 minPeriod;
+    ma_uint32 maxPeriod;
+    ma_uint32 holdFrames;
+    ma_uint32 fadeFrames;
+    ma_uint32 crossfadeFrames;
+    ma_uint32 maxOlaFrames;
+    ma_uint32 writeIndex;       /* Oldest history frame; newest is writeIndex - 1 */
+
+    /* Gap in progress */
+    int concealing;
+    ma_uint32 period;
+    ma_uint32 olaFrames;
+    ma_uint32 position;         /* Frames synthesized (or crossfaded) since the gap began */
+    ma_uint32 recovered;        /* Crossfade frames done since data returned */
+    ma_uint32 gapCount;         /* Gaps concealed since reset */
+} ta_plc;
+
+static ma_uint32 ta_plc_ms_to_frames(float ms, ma_uint32 sampleRate) {
+    return (ma_uint32)(ms * (float)sampleRate / 1000.0f);
+}
+
+/* Allocate for channels at up to maxSampleRate. */
+static ma_result ta_plc_init(ta_plc* pPlc, ma_uint32 channels, ma_uint32 maxSampleRate,
+    const ma_allocation_callbacks* pAllocationCallbacks) {
+    memset(pPlc, 0, sizeof(*pPlc));
+
+    pPlc->channels = channels;
+    pPlc->capacityFrames = ta_plc_ms_to_frames((float)TA_PLC_HISTORY_MS, maxSampleRate);
+    ma_uint32 maxPeriod = ta_plc_ms_to_frames(TA_PLC_MAX_PERIOD_MS, maxSampleRate);
+
+    pPlc->pHistory = (float*)ma_malloc((size_t)2 * pPlc->capacityFrames * channels * sizeof(float), pAllocationCallbacks);
+    pPlc->pCycle = (float*)ma_malloc((size_t)maxPeriod * channels * sizeof(float), pAllocationCallbacks);
+    pPlc->pMono = (float*)ma_malloc((size_t)pPlc->capacityFrames * sizeof(float), pAllocationCallbacks);
+    pPlc->pDecimated = (float*)ma_malloc((size_t)(pPlc->capacityFrames / TA_PLC_DECIMATION + 1) * sizeof(float), pAllocationCallbacks);
+    if (!pPlc->pHistory || !pPlc->pCycle || !pPlc->pMono || !pPlc->pDecimated) {
+        ma_free(pPlc->pHistory, pAllocationCallbacks);
+        ma_free(pPlc->pCycle, pAllocationCallbacks);
+        ma_free(pPlc->pMono, pAllocationCallbacks);
+        ma_free(pPlc->pDecimated, pAllocationCallbacks);
+        memset(pPlc, 0, sizeof(*pPlc));
+        return MA_OUT_OF_MEMORY;
+    }
+    return MA_SUCCESS;
+}
+
+static void ta_plc_uninit(ta_plc* pPlc, const ma_allocation_callbacks* pAllocationCallbacks) {
+    ma_free(pPlc->pHistory, pAllocationCallbacks);
+    ma_free(pPlc->pCycle, pAllocationCallbacks);
+    ma_free(pPlc->pMono, pAllocationCallbacks);
+    ma_free(pPlc->pDecimated, pAllocationCallbacks);
+    memset(pPlc, 0, sizeof(*pPlc));
+}
+
+/* Clear history and size everything for sampleRate (before a start). */
+static void ta_plc_reset(ta_plc* pPlc, ma_uint32 sampleRate) {
+    ma_uint32 rateFrames = ta_plc_ms_to_frames((float)TA_PLC_HISTORY_MS, sampleRate);
+
+    pPlc->historyFrames = (rateFrames < pPlc->capacityFrames) ? rateFrames : pPlc->capacityFrames;
+    pPlc->maxPeriod = ta_plc_ms_to_frames(TA_PLC_MAX_PERIOD_MS, sampleRate);
+    pPlc->windowFrames = ta_plc_ms_to_frames((float)TA_PLC_WINDOW_MS, sampleRate);
+
+    /* Extension needs two periods; the search needs window + longest lag */
+    if (pPlc->maxPeriod > pPlc->historyFrames / 2) {
+        pPlc->maxPeriod = pPlc->historyFrames / 2;
+    }
+    if (pPlc->windowFrames > pPlc->historyFrames - pPlc->maxPeriod) {
+        pPlc->windowFrames = pPlc->historyFrames - pPlc->maxPeriod;
+    }
+    pPlc->minPeriod = ta_plc_ms_to_frames(TA_PLC_MIN_PERIOD_MS, sampleRate);
+    if (pPlc->minPeriod < TA_PLC_DECIMATION) {
+        pPlc->minPeriod = TA_PLC_DECIMATION;
+    }
+    if (pPlc->minPeriod > pPlc->maxPeriod) {
+        pPlc->minPeriod = pPlc->maxPeriod;
+    }
+
+    pPlc->holdFrames = ta_plc_ms_to_frames(TA_PLC_HOLD_MS, sampleRate);
+    pPlc->fadeFrames = ta_plc_ms_to_frames(TA_PLC_FADE_MS, sampleRate);
+    pPlc->crossfadeFrames = ta_plc_ms_to_frames(TA_PLC_CROSSFADE_MS, sampleRate);
+    pPlc->maxOlaFrames = ta_plc_ms_to_frames(TA_PLC_MAX_OLA_MS, sampleRate);
+
+    memset(pPlc->pHistory, 0, (size_t)2 * pPlc->historyFrames * pPlc->channels * sizeof(float));
+    pPlc->writeIndex = 0;
+    pPlc->concealing = 0;
+    pPlc->gapCount = 0;
+}
+
+/* The history as one span, oldest first */
+static MA_INLINE const float* ta_plc_history(const ta_plc* pPlc) {
+    return pPlc->pHistory + (size_t)pPlc->writeIndex * pPlc->channels;
+}
+
+static void ta_plc_push(ta_plc* pPlc, const float* pFrames, ma_uint32 frameCount) {
+    const ma_uint32 channels = pPlc->channels;
+    const ma_uint32 historyFrames = pPlc->historyFrames;
+
+    if (frameCount > historyFrames) {
+        pFrames += (size_t)(frameCount - historyFrames) * channels;
+        frameCount = historyFrames;
+    }
+    while (frameCount > 0) {
+        ma_uint32 frames = historyFrames - pPlc->writeIndex;
+        if (frames > frameCount) {
+            frames = frameCount;
+        }
+        size_t bytes = (size_t)frames * channels * sizeof(float);
+        memcpy(pPlc->pHistory + (size_t)pPlc->writeIndex * channels, pFrames, bytes);
+        memcpy(pPlc->pHistory + (size_t)(pPlc->writeIndex + historyFrames) * channels, pFrames, bytes);
+
+        pPlc->writeIndex += frames;
+        if (pPlc->writeIndex == historyFrames) {
+            pPlc->writeIndex = 0;
+        }
+        pFrames += (size_t)frames * channels;
+        frameCount -= frames;
+    }
+}
+
+/* Normalized correlation of the newest `window` samples of x against the ones `lag` earlier */
+static float ta_plc_correlation(const float* pX, ma_uint32 count, ma_uint32 window, ma_uint32 lag) {
+    const float* pA = pX + count - window;
+    const float* pB = pA - lag;
+    float cross = 0.0f;
+    float energyA = 0.0f;
+    float energyB = 0.0f;
+    for (ma_uint32 i = 0; i < window; i++) {
+        cross += pA[i] * pB[i];
+        energyA += pA[i] * pA[i];
+        energyB += pB[i] * pB[i];
+    }
+    if (energyA <= 0.0f || energyB <= 0.0f) {
+        return 0.0f;
+    }
+    return cross / sqrtf(energyA * energyB);
+}
+
+static ma_uint32 ta_plc_find_period(ta_plc* pPlc) {
+    const float* pHistory = ta_plc_history(pPlc);
+    const ma_uint32 channels = pPlc->channels;
+    const ma_uint32 count = pPlc->historyFrames;
+
+    /* Channel sum, then a box-filtered, decimated copy for the coarse pass */
+    for (ma_uint32 i = 0; i < count; i++) {
+        float sum = 0.0f;
+        for (ma_uint32 ch = 0; ch < channels; ch++) {
+            sum += pHistory[(size_t)i * channels + ch];
+        }
+        pPlc->pMono[i] = sum;
+    }
+    ma_uint32 decimatedCount = count / TA_PLC_DECIMATION;
+    ma_uint32 offset = count - decimatedCount * TA_PLC_DECIMATION;
+    for (ma_uint32 i = 0; i < decimatedCount; i++) {
+        float sum = 0.0f;
+        for (ma_uint32 j = 0; j < TA_PLC_DECIMATION; j++) {
+            sum += pPlc->pMono[offset + i * TA_PLC_DECIMATION + j];
+        }
+        pPlc->pDecimated[i] = sum;
+    }
+
+    ma_uint32 window = pPlc->windowFrames / TA_PLC_DECIMATION;
+    ma_uint32 bestLag = pPlc->maxPeriod / TA_PLC_DECIMATION;
+    float best = 0.0f;
+    for (ma_uint32 lag = pPlc->minPeriod / TA_PLC_DECIMATION; lag <= pPlc->maxPeriod / TA_PLC_DECIMATION; lag++) {
+        float c = ta_plc_correlation(pPlc->pDecimated, decimatedCount, window, lag);
+        if (c > best) {
+            best = c;
+            bestLag = lag;
+        }
+    }
+    if (best <= 0.0f) {
+        return pPlc->maxPeriod;     /* Noise or silence: the longest segment buzzes least */
+    }
+
+    /* Fine: full rate around the coarse pick */
+    ma_uint32 lo = bestLag * TA_PLC_DECIMATION - (TA_PLC_DECIMATION - 1);
+    ma_uint32 hi = bestLag * TA_PLC_DECIMATION + (TA_PLC_DECIMATION - 1);
+    if (lo < pPlc->minPeriod) lo = pPlc->minPeriod;
+    if (hi > pPlc->maxPeriod) hi = pPlc->maxPeriod;
+
+    ma_uint32 period = bestLag * TA_PLC_DECIMATION;
+    float bestFine = -2.0f;
+    for (ma_uint32 lag = lo; lag <= hi; lag++) {
+        float c = ta_plc_correlation(pPlc->pMono, count, pPlc->windowFrames, lag);
+        if (c > bestFine) {
+            bestFine = c;
+            period = lag;
+        }
+    }
+    if (period > pPlc->maxPeriod) {
+        period = pPlc->maxPeriod;
+    }
+    return period;
+}
+
+/* Enter a gap: pick the period and build the repeating cycle */
+static void ta_plc_begin_gap(ta_plc* pPlc) {
+    const float* pHistory = ta_plc_history(pPlc);
+    const ma_uint32 channels = pPlc->channels;
+    const ma_uint32 count = pPlc->historyFrames;
+
+    ma_uint32 period = ta_plc_find_period(pPlc);
+    ma_uint32 ola = period / 4;
+    if (ola > pPlc->maxOlaFrames) {
+        ola = pPlc->maxOlaFrames;
+    }
+
+    /* Last period; its tail fades into the period before, which runs on into the head */
+    const float* pLast = pHistory + (size_t)(count - period) * channels;
+    const float* pPrevious = pHistory + (size_t)(count - 2 * period) * channels;
+    for (ma_uint32 j = 0; j < period; j++) {
+        float* pOut = pPlc->pCycle + (size_t)j * channels;
+        if (j + ola < period) {
+            memcpy(pOut, pLast + (size_t)j * channels, channels * sizeof(float));
+        } else {
+            float w = (float)(j + ola - period + 1) / (float)(ola + 1);
+            for (ma_uint32 ch = 0; ch < channels; ch++) {
+                size_t i = (size_t)j * channels + ch;
+                pOut[ch] = (1.0f - w) * pLast[i] + w * pPrevious[i];
+            }
+        }
+    }
+
+    pPlc->period = period;
+    pPlc->olaFrames = ola;
+    pPlc->position = 0;
+    pPlc->recovered = 0;
+    pPlc->concealing = 1;
+    pPlc->gapCount++;
+}
+
+/* Envelope at gap position k */
+static MA_INLINE float ta_plc_gain(const ta_plc* pPlc, ma_uint32 k) {
+    if (k < pPlc->holdFrames) {
+        return 1.0f;
+    }
+    k -= pPlc->holdFrames;
+    if (k >= pPlc->fadeFrames) {
+        return 0.0f;
+    }
+    return 1.0f - (float)(k + 1) / (float)(pPlc->fadeFrames + 1);
+}
+
+/* Extension sample at gap position k, channel ch (before the envelope) */
+static MA_INLINE float ta_plc_extend(const ta_plc* pPlc, const float* pLastFrame, ma_uint32 k, ma_uint32 ch) {
+    float v = pPlc->pCycle[(size_t)(k % pPlc->period) * pPlc->channels + ch];
+    if (k < pPlc->olaFrames) {
+        float w = (float)(k + 1) / (float)(pPlc->olaFrames + 1);
+        v = (1.0f - w) * pLastFrame[ch] + w * v;
+    }
+    return v;
+}
+
+/*
+ * Finish one callback. pOutput[0, realFrames) came from the ring and the
+ * rest is missing. Crossfades returning frames out of a gap, records the
+ * real frames, and conceals [realFrames, frameCount).
+ */
+static void ta_plc_process(ta_plc* pPlc, float* pOutput, ma_uint32 realFrames, ma_uint32 frameCount) {
+    const ma_uint32 channels = pPlc->channels;
+
+    if (pPlc->concealing && realFrames > 0) {
+        const float* pLastFrame = ta_plc_history(pPlc) + (size_t)(pPlc->historyFrames - 1) * channels;
+        ma_uint32 frames = pPlc->crossfadeFrames - pPlc->recovered;
+        if (frames > realFrames) {
+            frames = realFrames;
+        }
+        for (ma_uint32 i = 0; i < frames; i++) {
+            ma_uint32 k = pPlc->position + i;
+            float w = (float)(pPlc->recovered + i + 1) / (float)(pPlc->crossfadeFrames + 1);
+            float g = (1.0f - w) * ta_plc_gain(pPlc, k);
+            float* pFrame = pOutput + (size_t)i * channels;
+            if (g != 0.0f) {
+                for (ma_uint32 ch = 0; ch < channels; ch++) {
+                    pFrame[ch] = w * pFrame[ch] + g * ta_plc_extend(pPlc, pLastFrame, k, ch);
+                }
+            } else {
+                for (ma_uint32 ch = 0; ch < channels; ch++) {
+                    pFrame[ch] *= w;
+                }
+            }
+        }
+        pPlc->position += frames;
+        pPlc->recovered += frames;
+        if (pPlc->recovered >= pPlc->crossfadeFrames) {
+            pPlc->concealing = 0;
+        }
+    }
+
+    ta_plc_push(pPlc, pOutput, realFrames);
+
+    if (realFrames == frameCount) {
+        return;
+    }
+
+    if (!pPlc->concealing) {
+        ta_plc_begin_gap(pPlc);
+    }
+    pPlc->recovered = 0;
+
+    const float* pLastFrame = ta_plc_history(pPlc) + (size_t)(pPlc->historyFrames - 1) * channels;
+    for (ma_uint32 i = realFrames; i < frameCount; i++) {
+        ma_uint32 k = pPlc->position++;
+        float g = ta_plc_gain(pPlc, k);
+        float* pFrame = pOutput + (size_t)i * channels;
+        if (g == 0.0f) {
+            memset(pFrame, 0, (size_t)(frameCount - i) * channels * sizeof(float));
+            pPlc->position += frameCount - i - 1;
+            break;
+        }
+        for (ma_uint32 ch = 0; ch < channels; ch++) {
+            pFrame[ch] = g * ta_plc_extend(pPlc, pLastFrame, k, ch);
+        }
+    }
+}
+
+#endif /* TA_PLC_H */
@@ -0,0 +1,575 @@
+/*
+ * ==============================================================================
+ * ta_probe.h - Round-Trip Latency Measurement
+ * ==============================================================================
+ * actualLatencyMs (ring fill + playback period) is a model. This measures
+ * the real thing by sending a known signal around the loop:
+ *
+ *   - Playback: for the length of the measurement the route output is
+ *     replaced by TA_PROBE_LEAD_IN_MS of silence, the probe (a maximum
+ *     length sequence or a linear chirp), and silence again. The frame
+ *     time of the probe's first frame is noted.
+ *   - Capture: channel 0 of the device input is recorded, and each
+ *     callback is logged with its time and ring write range.
+ *   - Playback keeps logging its ring read range until it has read past
+ *     the last recorded frame, so the route's own delay can be looked up.
+ *   - Analysis (worker thread, or ta_sim_run at the end): FFT
+ *     cross-correlation of the recording with the probe. The first peak
+ *     within 6dB of the strongest is the direct path (a room adds later
+ *     reflections); parabolic interpolation gives the sub-frame position.
+ *
+ * Frame times remove the period quantization on both sides: a playback
+ * frame is timed at callback start + offset, a captured frame at callback
+ * start - (frames after it). Then
+ *
+ *   roundTrip = capture frame time - playback frame time of the probe
+ *               (output buffering, DAC, path, ADC, input buffering)
+ *   internal  = playback frame time of the ring slot the probe landed in
+ *               - its capture frame time (capture period, ring, drift)
+ *
+ * and input-to-output through the engine is about roundTrip + internal
+ * (minus the acoustic path, which is ~0 on a cable loopback).
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h and TransparencyAudio.h.
+ *   ta_probe_alloc() and ta_probe_arm() on the control thread;
+ *   ta_probe_capture() / ta_probe_playback_*() from the callbacks;
+ *   ta_probe_analyze() once the phase reached TA_PROBE_CAPTURED.
+ * ==============================================================================
+ */
+
+#ifndef TA_PROBE_H
+#define TA_PROBE_H
+
+#include <math.h>
+#include <string.h>
+
+/* Silence before the probe, so capture is recording when it arrives */
+#define TA_PROBE_LEAD_IN_MS             50
+
+/* MLS order: 2^12 - 1 frames (85ms at 48kHz); the chirp has the same length */
+#define TA_PROBE_MLS_ORDER              12
+#define TA_PROBE_FRAMES                 ((1u << TA_PROBE_MLS_ORDER) - 1)
+#define TA_PROBE_MLS_TAPS               0xE08u  /* x^12 + x^11 + x^10 + x^4 + 1 (Galois) */
+
+/* Probe peak amplitude when ta_latency_probe_config.level is 0 (-12dBFS) */
+#define TA_PROBE_DEFAULT_LEVEL          0.25f
+
+/* Search window: round trips up to this long are found */
+#define TA_PROBE_DEFAULT_MAX_ROUND_TRIP_MS  500
+#define TA_PROBE_MAX_ROUND_TRIP_MS          2000
+
+/* Correlation peak over the RMS of the rest, below which nothing was heard */
+#define TA_PROBE_MIN_PEAK_TO_NOISE_DB   15.0f
+
+/* Smallest callback the logs are sized for */
+#define TA_PROBE_MIN_CALLBACK_FRAMES    16
+
+/* Chirp sweep and edge taper */
+#define TA_PROBE_CHIRP_START_HZ         100.0
+#define TA_PROBE_CHIRP_END_FRACTION     0.45    /* Of the sample rate */
+#define TA_PROBE_CHIRP_TAPER_FRACTION   0.05
+
+typedef enum {
+    TA_PROBE_IDLE = 0,
+    TA_PROBE_ARMED,         /* Playback injects, capture records */
+    TA_PROBE_CAPTURED,      /* Recording full; playback still logs its reads */
+    TA_PROBE_LOGGED         /* Playback has read past the recording */
+} ta_probe_phase;
+
+typedef struct {
+    ma_uint64 timeNs;       /* Callback start, engine clock */
+    ma_uint64 ringStart;    /* Capture: write position before; playback: read position before */
+    ma_uint64 ringEnd;      /* ...and after the callback */
+    ma_uint32 frames;       /* Device frames in the callback */
+    ma_uint32 recordOffset; /* Capture: index in pRecord of the callback's first frame */
+} ta_probe_entry;
+
+typedef struct {
+    volatile ma_uint32 phase;   /* ta_probe_phase; ARMED is published with release */
+    ma_uint32 sampleRate;
+
+    /* Fixed at ta_probe_alloc (control thread) */
+    float* pProbe;
+    float* pRecord;
+    ta_probe_entry* pCaptureLog;
+    ta_probe_entry* pPlaybackLog;
+    ma_uint32 recordCapacity;
+    ma_uint32 logCapacity;
+
+    /* Set at ta_probe_arm */
+    ma_uint32 leadInFrames;
+    ma_uint32 recordFrames;
+
+    /* Capture thread */
+    ma_uint32 recordedFrames;
+    volatile ma_uint32 captureLogCount;
+    ma_uint64 captureEndPos;        /* Ring position after the last recorded frame (before CAPTURED) */
+
+    /* Playback thread */
+    ma_uint64 outputFrames;         /* Frames rendered since ARMED */
+    ma_uint64 callbackNs;
+    ma_uint32 callbackOffset;       /* Frames rendered so far in the current callback */
+    volatile ma_uint64 probeStartNs;    /* Frame time of the probe's first frame (0 = not yet) */
+    volatile ma_uint32 playbackLogCount;
+
+    /* Duplex: frames through the callback, standing in for ring positions */
+    ma_uint64 duplexPos;
+} ta_probe;
+
+typedef struct {
+    double roundTripMs;
+    double internalMs;          /* < 0: playback did not log the read (stopped, log full) */
+    double peakToNoiseDb;
+} ta_probe_result;
+
+/* ==== PROBE SIGNALS ==== */
+
+/* Maximum length sequence: +/-level, flat spectrum, sharp autocorrelation */
+static void ta_probe_make_mls(float* pOut, ma_uint32 frames, float level) {
+    ma_uint32 state = 1;
+    for (ma_uint32 i = 0; i < frames; i++) {
+        ma_uint32 bit = state & 1u;
+        state >>= 1;
+        if (bit) {
+            state ^= TA_PROBE_MLS_TAPS;
+        }
+        pOut[i] = bit ? level : -level;
+    }
+}
+
+/* Linear sweep TA_PROBE_CHIRP_START_HZ -> 0.45 fs, raised-cosine edges */
+static void ta_probe_make_chirp(float* pOut, ma_uint32 frames, float level, ma_uint32 sampleRate) {
+    double duration = (double)frames / (double)sampleRate;
+    double f0 = TA_PROBE_CHIRP_START_HZ;
+    double f1 = TA_PROBE_CHIRP_END_FRACTION * (double)sampleRate;
+    ma_uint32 taper = (ma_uint32)((double)frames * TA_PROBE_CHIRP_TAPER_FRACTION);
+
+    for (ma_uint32 i = 0; i < frames; i++) {
+        double t = (double)i / (double)sampleRate;
+        double phase = 2.0 * MA_PI_D * (f0 * t + (f1 - f0) * t * t / (2.0 * duration));
+        double gain = 1.0;
+        ma_uint32 edge = (i < frames - 1 - i) ? i : frames - 1 - i;
+        if (edge < taper) {
+            gain = 0.5 - 0.5 * cos(MA_PI_D * (double)edge / (double)taper);
+        }
+        pOut[i] = (float)((double)level * gain * sin(phase));
+    }
+}
+
+/* ==== SETUP (CONTROL THREAD) ==== */
+
+/* Allocate for the largest window at this rate; pre-faulted. Freed by ta_probe_free. */
+static ma_result ta_probe_alloc(ta_probe* pProbe, ma_uint32 sampleRate) {
+    memset(pProbe, 0, sizeof(*pProbe));
+    pProbe->sampleRate = sampleRate;
+    pProbe->recordCapacity = (ma_uint32)((ma_uint64)sampleRate * (TA_PROBE_LEAD_IN_MS + TA_PROBE_MAX_ROUND_TRIP_MS) / 1000)
+        + TA_PROBE_FRAMES;
+    pProbe->logCapacity = pProbe->recordCapacity / TA_PROBE_MIN_CALLBACK_FRAMES + 64;
+
+    size_t probeBytes = TA_PROBE_FRAMES * sizeof(float);
+    size_t recordBytes = (size_t)pProbe->recordCapacity * sizeof(float);
+    size_t logBytes = (size_t)pProbe->logCapacity * sizeof(ta_probe_entry);
+
+    pProbe->pProbe = (float*)ma_malloc(probeBytes, NULL);
+    pProbe->pRecord = (float*)ma_malloc(recordBytes, NULL);
+    pProbe->pCaptureLog = (ta_probe_entry*)ma_malloc(logBytes, NULL);
+    pProbe->pPlaybackLog = (ta_probe_entry*)ma_malloc(logBytes, NULL);
+    if (!pProbe->pProbe || !pProbe->pRecord || !pProbe->pCaptureLog || !pProbe->pPlaybackLog) {
+        ma_free(pProbe->pProbe, NULL);
+        ma_free(pProbe->pRecord, NULL);
+        ma_free(pProbe->pCaptureLog, NULL);
+        ma_free(pProbe->pPlaybackLog, NULL);
+        memset(pProbe, 0, sizeof(*pProbe));
+        return MA_OUT_OF_MEMORY;
+    }
+
+    /* Touch every page here rather than on an audio thread */
+    memset(pProbe->pProbe, 0, probeBytes);
+    memset(pProbe->pRecord, 0, recordBytes);
+    memset(pProbe->pCaptureLog, 0, logBytes);
+    memset(pProbe->pPlaybackLog, 0, logBytes);
+    return MA_SUCCESS;
+}
+
+/* No callback may be running */
+static void ta_probe_free(ta_probe* pProbe) {
+    ma_free(pProbe->pProbe, NULL);
+    ma_free(pProbe->pRecord, NULL);
+    ma_free(pProbe->pCaptureLog, NULL);
+    ma_free(pProbe->pPlaybackLog, NULL);
+    memset(pProbe, 0, sizeof(*pProbe));
+}
+
+/* Start a run. The phase must be IDLE (no callback touches the buffers). */
+static void ta_probe_arm(ta_probe* pProbe, ta_probe_signal signal, float level, ma_uint32 maxRoundTripMs) {
+    if (level <= 0.0f || level > 1.0f) {
+        level = TA_PROBE_DEFAULT_LEVEL;
+    }
+    if (maxRoundTripMs == 0) {
+        maxRoundTripMs = TA_PROBE_DEFAULT_MAX_ROUND_TRIP_MS;
+    }
+    if (maxRoundTripMs > TA_PROBE_MAX_ROUND_TRIP_MS) {
+        maxRoundTripMs = TA_PROBE_MAX_ROUND_TRIP_MS;
+    }
+
+    if (signal == TA_PROBE_SIGNAL_CHIRP) {
+        ta_probe_make_chirp(pProbe->pProbe, TA_PROBE_FRAMES, level, pProbe->sampleRate);
+    } else {
+        ta_probe_make_mls(pProbe->pProbe, TA_PROBE_FRAMES, level);
+    }
+
+    pProbe->leadInFrames = pProbe->sampleRate * TA_PROBE_LEAD_IN_MS / 1000;
+    pProbe->recordFrames = (ma_uint32)((ma_uint64)pProbe->sampleRate * (TA_PROBE_LEAD_IN_MS + maxRoundTripMs) / 1000)
+        + TA_PROBE_FRAMES;
+    pProbe->recordedFrames = 0;
+    pProbe->captureLogCount = 0;
+    pProbe->captureEndPos = 0;
+    pProbe->outputFrames = 0;
+    pProbe->callbackNs = 0;
+    pProbe->callbackOffset = 0;
+    pProbe->probeStartNs = 0;
+    pProbe->playbackLogCount = 0;
+
+    ma_atomic_store_explicit_32(&pProbe->phase, TA_PROBE_ARMED, ma_atomic_memory_order_release);
+}
+
+static MA_INLINE ta_probe_phase ta_probe_get_phase(const ta_probe* pProbe) {
+    return (ta_probe_phase)ma_atomic_load_explicit_32(&pProbe->phase, ma_atomic_memory_order_acquire);
+}
+
+/* Stop the callbacks touching the run (analysis done or abandoned) */
+static MA_INLINE void ta_probe_disarm(ta_probe* pProbe) {
+    ma_atomic_store_explicit_32(&pProbe->phase, TA_PROBE_IDLE, ma_atomic_memory_order_release);
+}
+
+/* ==== CALLBACKS ==== */
+
+/* Channel 0 of one device frame as float */
+static MA_INLINE float ta_probe_sample(const void* pFrame, ma_format format) {
+    const ma_uint8* p = (const ma_uint8*)pFrame;
+    switch (format) {
+        case ma_format_s16: return (float)*(const ma_int16*)p * (1.0f / 32768.0f);
+        case ma_format_s24: return (float)((ma_int32)(((ma_uint32)p[0] << 8) | ((ma_uint32)p[1] << 16) | ((ma_uint32)p[2] << 24)) >> 8) * (1.0f / 8388608.0f);
+        case ma_format_s32: return (float)*(const ma_int32*)p * (1.0f / 2147483648.0f);
+        default:            return *(const float*)p;
+    }
+}
+
+/*
+ * Capture callback: record channel 0 of this callback's input and log it.
+ * ringStart/ringEnd: the ring write position before and after the commit.
+ */
+static void ta_probe_capture(ta_probe* pProbe, const void* pInput, ma_uint32 frameCount, ma_format format,
+    ma_uint32 frameBytes, ma_uint64 timeNs, ma_uint64 ringStart, ma_uint64 ringEnd) {
+    if (ta_probe_get_phase(pProbe) != TA_PROBE_ARMED || !pInput) {
+        return;
+    }
+
+    ma_uint32 logCount = pProbe->captureLogCount;
+    ma_uint32 frames = pProbe->recordFrames - pProbe->recordedFrames;
+    if (frames > frameCount) {
+        frames = frameCount;
+    }
+
+    ta_probe_entry* pEntry = &pProbe->pCaptureLog[logCount];
+    pEntry->timeNs = timeNs;
+    pEntry->ringStart = ringStart;
+    pEntry->ringEnd = ringEnd;
+    pEntry->frames = frameCount;
+    pEntry->recordOffset = pProbe->recordedFrames;
+
+    const ma_uint8* pFrame = (const ma_uint8*)pInput;
+    float* pRecord = pProbe->pRecord + pProbe->recordedFrames;
+    for (ma_uint32 i = 0; i < frames; i++) {
+        pRecord[i] = ta_probe_sample(pFrame, format);
+        pFrame += frameBytes;
+    }
+    pProbe->recordedFrames += frames;
+    ma_atomic_store_explicit_32(&pProbe->captureLogCount, logCount + 1, ma_atomic_memory_order_release);
+
+    if (pProbe->recordedFrames >= pProbe->recordFrames || logCount + 1 >= pProbe->logCapacity) {
+        /* Frames past the recording in this callback still count as written */
+        pProbe->captureEndPos = ringStart + (ringEnd - ringStart < frames ? ringEnd - ringStart : frames);
+        ma_uint32 expected = TA_PROBE_ARMED;
+        ma_atomic_compare_exchange_strong_explicit_32(&pProbe->phase, &expected, TA_PROBE_CAPTURED,
+            ma_atomic_memory_order_release, ma_atomic_memory_order_relaxed);
+    }
+}
+
+/* Playback callback start: open a log entry at the current ring read position */
+static void ta_probe_playback_begin(ta_probe* pProbe, ma_uint64 timeNs, ma_uint64 ringPos, ma_uint32 frameCount) {
+    ta_probe_phase phase = ta_probe_get_phase(pProbe);
+    if (phase != TA_PROBE_ARMED && phase != TA_PROBE_CAPTURED) {
+        return;
+    }
+
+    ma_uint32 logCount = pProbe->playbackLogCount;
+    if (logCount >= pProbe->logCapacity) {
+        return;
+    }
+    ta_probe_entry* pEntry = &pProbe->pPlaybackLog[logCount];
+    pEntry->timeNs = timeNs;
+    pEntry->ringStart = ringPos;
+    pEntry->ringEnd = ringPos;
+    pEntry->frames = frameCount;
+    pEntry->recordOffset = 0;
+
+    pProbe->callbackNs = timeNs;
+    pProbe->callbackOffset = 0;
+}
+
+/* Replace frameCount rendered frames (route f32) with the probe or silence while ARMED */
+static void ta_probe_render(ta_probe* pProbe, float* pOutput, ma_uint32 frameCount, ma_uint32 channels) {
+    if (ta_probe_get_phase(pProbe) != TA_PROBE_ARMED) {
+        return;
+    }
+
+    for (ma_uint32 i = 0; i < frameCount; i++) {
+        ma_uint64 index = pProbe->outputFrames + i;
+        float sample = 0.0f;
+        if (index >= pProbe->leadInFrames && index - pProbe->leadInFrames < TA_PROBE_FRAMES) {
+            if (index == pProbe->leadInFrames) {
+                ma_atomic_store_explicit_64(&pProbe->probeStartNs, pProbe->callbackNs
+                    + (ma_uint64)(pProbe->callbackOffset + i) * 1000000000ull / pProbe->sampleRate,
+                    ma_atomic_memory_order_relaxed);
+            }
+            sample = pProbe->pProbe[index - pProbe->leadInFrames];
+        }
+        for (ma_uint32 ch = 0; ch < channels; ch++) {
+            pOutput[(size_t)i * channels + ch] = sample;
+        }
+    }
+    pProbe->outputFrames += frameCount;
+    pProbe->callbackOffset += frameCount;
+}
+
+/* Playback callback end: close the entry; LOGGED once the reads passed the recording */
+static void ta_probe_playback_end(ta_probe* pProbe, ma_uint64 ringPos) {
+    ta_probe_phase phase = ta_probe_get_phase(pProbe);
+    if (phase != TA_PROBE_ARMED && phase != TA_PROBE_CAPTURED) {
+        return;
+    }
+
+    ma_uint32 logCount = pProbe->playbackLogCount;
+    if (logCount < pProbe->logCapacity) {
+        pProbe->pPlaybackLog[logCount].ringEnd = ringPos;
+        logCount++;
+        ma_atomic_store_explicit_32(&pProbe->playbackLogCount, logCount, ma_atomic_memory_order_release);
+    }
+
+    if (phase == TA_PROBE_CAPTURED && (ringPos >= pProbe->captureEndPos || logCount >= pProbe->logCapacity)) {
+        ma_uint32 expected = TA_PROBE_CAPTURED;
+        ma_atomic_compare_exchange_strong_explicit_32(&pProbe->phase, &expected, TA_PROBE_LOGGED,
+            ma_atomic_memory_order_release, ma_atomic_memory_order_relaxed);
+    }
+}
+
+/* ==== ANALYSIS (WORKER THREAD) ==== */
+
+/* In-place radix-2 complex FFT; pCos/pSin hold the n/2 twiddles */
+static void ta_probe_fft(double* pRe, double* pIm, ma_uint32 n, const double* pCos, const double* pSin, int inverse) {
+    for (ma_uint32 i = 1, j = 0; i < n; i++) {
+        ma_uint32 bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            double t = pRe[i]; pRe[i] = pRe[j]; pRe[j] = t;
+            t = pIm[i]; pIm[i] = pIm[j]; pIm[j] = t;
+        }
+    }
+
+    for (ma_uint32 length = 2; length <= n; length <<= 1) {
+        ma_uint32 half = length >> 1;
+        ma_uint32 stride = n / length;
+        for (ma_uint32 start = 0; start < n; start += length) {
+            for (ma_uint32 k = 0; k < half; k++) {
+                double wr = pCos[k * stride];
+                double wi = inverse ? pSin[k * stride] : -pSin[k * stride];
+                ma_uint32 a = start + k;
+                ma_uint32 b = a + half;
+                double xr = pRe[b] * wr - pIm[b] * wi;
+                double xi = pRe[b] * wi + pIm[b] * wr;
+                pRe[b] = pRe[a] - xr;
+                pIm[b] = pIm[a] - xi;
+                pRe[a] += xr;
+                pIm[a] += xi;
+            }
+        }
+    }
+}
+
+/*
+ * Cross-correlate pRecord[0..recordFrames) with the probe. Returns the
+ * direct-path lag in frames (sub-frame), or -1 if the peak does not clear
+ * TA_PROBE_MIN_PEAK_TO_NOISE_DB.
+ */
+static double ta_probe_correlate(const ta_probe* pProbe, ma_uint32 recordFrames, double* pPeakToNoiseDb) {
+    *pPeakToNoiseDb = 0.0;
+    if (recordFrames <= TA_PROBE_FRAMES) {
+        return -1.0;
+    }
+
+    ma_uint32 n = 1;
+    while (n < recordFrames + TA_PROBE_FRAMES) {
+        n <<= 1;
+    }
+
+    double* pMemory = (double*)ma_malloc((size_t)n * 5 * sizeof(double), NULL);
+    if (!pMemory) {
+        return -1.0;
+    }
+    double* pRecRe = pMemory;
+    double* pRecIm = pRecRe + n;
+    double* pProRe = pRecIm + n;
+    double* pProIm = pProRe + n;
+    double* pCos = pProIm + n;
+    double* pSin = pCos + n / 2;
+
+    for (ma_uint32 k = 0; k < n / 2; k++) {
+        pCos[k] = cos(2.0 * MA_PI_D * (double)k / (double)n);
+        pSin[k] = sin(2.0 * MA_PI_D * (double)k / (double)n);
+    }
+    memset(pRecRe, 0, (size_t)n * 4 * sizeof(double));
+    for (ma_uint32 i = 0; i < recordFrames; i++) {
+        pRecRe[i] = pProbe->pRecord[i];
+    }
+    for (ma_uint32 i = 0; i < TA_PROBE_FRAMES; i++) {
+        pProRe[i] = pProbe->pProbe[i];
+    }
+
+    /* r[lag] = sum record[lag + i] * probe[i] = IFFT(R * conj(P)) */
+    ta_probe_fft(pRecRe, pRecIm, n, pCos, pSin, 0);
+    ta_probe_fft(pProRe, pProIm, n, pCos, pSin, 0);
+    for (ma_uint32 k = 0; k < n; k++) {
+        double re = pRecRe[k] * pProRe[k] + pRecIm[k] * pProIm[k];
+        double im = pRecIm[k] * pProRe[k] - pRecRe[k] * pProIm[k];
+        pRecRe[k] = re;
+        pRecIm[k] = im;
+    }
+    ta_probe_fft(pRecRe, pRecIm, n, pCos, pSin, 1);
+
+    /* |r| over the valid lags (probe fully inside the recording) */
+    ma_uint32 lags = recordFrames - TA_PROBE_FRAMES + 1;
+    double* pCorr = pRecRe;
+    double peak = 0.0;
+    ma_uint32 peakLag = 0;
+    for (ma_uint32 lag = 0; lag < lags; lag++) {
+        pCorr[lag] = fabs(pCorr[lag]);
+        if (pCorr[lag] > peak) {
+            peak = pCorr[lag];
+            peakLag = lag;
+        }
+    }
+
+    /* Noise: RMS away from the peak (1ms either side) */
+    ma_uint32 guard = pProbe->sampleRate / 1000 + 1;
+    double noise = 0.0;
+    ma_uint32 noiseCount = 0;
+    for (ma_uint32 lag = 0; lag < lags; lag++) {
+        if (lag + guard < peakLag || lag > peakLag + guard) {
+            noise += pCorr[lag] * pCorr[lag];
+            noiseCount++;
+        }
+    }
+    noise = (noiseCount > 0) ? sqrt(noise / (double)noiseCount) : 0.0;
+    if (peak > 0.0) {
+        *pPeakToNoiseDb = (noise > 0.0) ? 20.0 * log10(peak / noise) : 200.0;
+    }
+
+    double lagFrames = -1.0;
+    if (peak > 0.0 && *pPeakToNoiseDb >= TA_PROBE_MIN_PEAK_TO_NOISE_DB) {
+        /* Direct path: the first local maximum within 6dB of the strongest */
+        ma_uint32 lag = 0;
+        for (; lag < peakLag; lag++) {
+            if (pCorr[lag] >= 0.5 * peak &&
+                (lag == 0 || pCorr[lag] >= pCorr[lag - 1]) && pCorr[lag] >= pCorr[lag + 1]) {
+                break;
+            }
+        }
+
+        lagFrames = (double)lag;
+        if (lag > 0 && lag + 1 < lags) {
+            double a = pCorr[lag - 1];
+            double b = pCorr[lag];
+            double c = pCorr[lag + 1];
+            double denominator = a - 2.0 * b + c;
+            if (denominator < 0.0) {
+                lagFrames += 0.5 * (a - c) / denominator;
+            }
+        }
+    }
+
+    ma_free(pMemory, NULL);
+    return lagFrames;
+}
+
+/* Capture frame time of recording index `position` (-1 if not logged) */
+static double ta_probe_capture_time_ns(const ta_probe* pProbe, ma_uint32 logCount, double position,
+    const ta_probe_entry** ppEntry) {
+    double nsPerFrame = 1e9 / (double)pProbe->sampleRate;
+    for (ma_uint32 i = 0; i < logCount; i++) {
+        const ta_probe_entry* pEntry = &pProbe->pCaptureLog[i];
+        double offset = position - (double)pEntry->recordOffset;
+        if (offset >= 0.0 && offset < (double)pEntry->frames) {
+            *ppEntry = pEntry;
+            return (double)pEntry->timeNs - ((double)pEntry->frames - offset) * nsPerFrame;
+        }
+    }
+    return -1.0;
+}
+
+/* Playback frame time at which ring position `ringPos` was read (-1 if not logged) */
+static double ta_probe_playback_time_ns(const ta_probe* pProbe, ma_uint32 logCount, double ringPos) {
+    double nsPerFrame = 1e9 / (double)pProbe->sampleRate;
+    for (ma_uint32 i = 0; i < logCount; i++) {
+        const ta_probe_entry* pEntry = &pProbe->pPlaybackLog[i];
+        if (pEntry->ringEnd > pEntry->ringStart &&
+            ringPos >= (double)pEntry->ringStart && ringPos < (double)pEntry->ringEnd) {
+            /* Drift correction reads more or fewer ring frames than it outputs */
+            double fraction = (ringPos - (double)pEntry->ringStart) / (double)(pEntry->ringEnd - pEntry->ringStart);
+            return (double)pEntry->timeNs + fraction * (double)pEntry->frames * nsPerFrame;
+        }
+    }
+    return -1.0;
+}
+
+/* Needs phase >= TA_PROBE_CAPTURED. Returns MA_SUCCESS if the probe was found. */
+static ma_result ta_probe_analyze(const ta_probe* pProbe, ta_probe_result* pResult) {
+    memset(pResult, 0, sizeof(*pResult));
+    pResult->internalMs = -1.0;
+
+    ma_uint32 captureLogCount = ma_atomic_load_explicit_32(&pProbe->captureLogCount, ma_atomic_memory_order_acquire);
+    ma_uint32 playbackLogCount = ma_atomic_load_explicit_32(&pProbe->playbackLogCount, ma_atomic_memory_order_acquire);
+    ma_uint64 probeStartNs = ma_atomic_load_explicit_64(&pProbe->probeStartNs, ma_atomic_memory_order_relaxed);
+    if (probeStartNs == 0) {
+        return MA_INVALID_OPERATION;
+    }
+
+    double lag = ta_probe_correlate(pProbe, pProbe->recordedFrames, &pResult->peakToNoiseDb);
+    if (lag < 0.0) {
+        return MA_NO_DATA_AVAILABLE;
+    }
+
+    const ta_probe_entry* pEntry = NULL;
+    double capturedNs = ta_probe_capture_time_ns(pProbe, captureLogCount, lag, &pEntry);
+    if (capturedNs < 0.0) {
+        return MA_NO_DATA_AVAILABLE;
+    }
+    pResult->roundTripMs = (capturedNs - (double)probeStartNs) * 1e-6;
+
+    /* Where the probe's first frame went in the ring, and when playback read it */
+    double offset = lag - (double)pEntry->recordOffset;
+    if (offset < (double)(pEntry->ringEnd - pEntry->ringStart)) {
+        double playedNs = ta_probe_playback_time_ns(pProbe, playbackLogCount, (double)pEntry->ringStart + offset);
+        if (playedNs >= 0.0) {
+            pResult->internalMs = (playedNs - capturedNs) * 1e-6;
+        }
+    }
+
+    return MA_SUCCESS;
+}
+
+#endif /* TA_PROBE_H */
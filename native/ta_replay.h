@@ -0,0 +1,312 @@
+/*
+ * ==============================================================================
+ * ta_replay.h - Callback Trace Recording and Replay
+ * ==============================================================================
+ * Scheduling problems on a customer machine depend on when its audio
+ * threads woke up and how many frames each callback asked for. The trace
+ * records exactly that, one 16-byte record per capture/playback callback:
+ *
+ *   timeNs    callback start on the engine clock
+ *   frames    frame count; bit 31 set for playback
+ *   position  ring write (capture) / read (playback) position at callback
+ *             start, low 32 bits
+ *
+ * Recording: each audio thread appends to its own SPSC lane (no shared
+ * cache line, no lock); a writer thread drains both lanes into the file.
+ * A full lane drops the record and counts it. Records of one device are
+ * in time order in the file, the two devices interleave in batches.
+ *
+ * Replay (ta_sim_run): each device's next callback fires at its recorded
+ * time with its recorded size, so the ring/drift code under test sees the
+ * field's callback sequence, deterministically and faster than real time.
+ * The recorded playback positions show where the replay diverges from
+ * what the recording engine did.
+ *
+ * FILE: ta_replay_header (little-endian, headerBytes long) then records.
+ * recordCount and droppedRecords are rewritten when the trace is closed.
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h and ta_ring.h (TA_ALIGN).
+ *   ta_replay_alloc/open/close on the control thread, ta_replay_note()
+ *   from the callbacks, ta_replay_drain() on the writer.
+ * ==============================================================================
+ */
+
+#ifndef TA_REPLAY_H
+#define TA_REPLAY_H
+
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+
+#define TA_REPLAY_MAGIC             "TACBTRC1"
+#define TA_REPLAY_VERSION           1
+#define TA_REPLAY_LANE_RECORDS      8192    /* Per audio thread; power of two (~20s of 2.6ms callbacks) */
+#define TA_REPLAY_PLAYBACK_FLAG     0x80000000u
+#define TA_REPLAY_PATH_LENGTH       512
+
+typedef enum {
+    TA_REPLAY_LANE_CAPTURE = 0,
+    TA_REPLAY_LANE_PLAYBACK,
+    TA_REPLAY_LANE_COUNT
+} ta_replay_lane_id;
+
+typedef struct {
+    ma_uint64 timeNs;
+    ma_uint32 frames;           /* | TA_REPLAY_PLAYBACK_FLAG */
+    ma_uint32 position;
+} ta_replay_record;
+
+typedef struct {
+    char magic[8];
+    ma_uint32 version;
+    ma_uint32 headerBytes;
+    ma_uint32 sampleRate;
+    ma_uint32 channels;
+    ma_uint32 captureChannels;
+    ma_uint32 ringBufferFrames;
+    ma_uint32 ringTargetFrames;
+    ma_uint32 driftMode;
+    ma_uint32 capturePeriodFrames;
+    ma_uint32 playbackPeriodFrames;
+    ma_uint64 startNs;          /* Engine clock when recording began (replay time 0) */
+    ma_uint64 recordCount;
+    ma_uint32 droppedRecords;
+    ma_uint32 reserved;
+} ta_replay_header;
+
+typedef struct TA_ALIGN(TA_CACHE_LINE_SIZE) {
+    ta_replay_record* pRecords;
+    volatile ma_uint64 writeCount;  /* Audio thread */
+    volatile ma_uint64 readCount;   /* Writer */
+} ta_replay_lane;
+
+typedef struct {
+    ta_replay_lane lanes[TA_REPLAY_LANE_COUNT];
+    volatile ma_uint32 active;      /* Callbacks append while set */
+    volatile ma_uint32 droppedCount;
+    volatile ma_uint64 writtenCount;
+    FILE* pFile;
+    ta_replay_header header;
+} ta_replay_recorder;
+
+/* ==== FILES ==== */
+
+static FILE* ta_replay_fopen(const wchar_t* path, int write) {
+#if defined(_WIN32)
+    return _wfopen(path, write ? L"wb" : L"rb");
+#else
+    char narrow[TA_REPLAY_PATH_LENGTH];
+    if (wcstombs(narrow, path, sizeof(narrow)) == (size_t)-1) {
+        return NULL;
+    }
+    narrow[sizeof(narrow) - 1] = '\0';
+    return fopen(narrow, write ? "wb" : "rb");
+#endif
+}
+
+/* ==== RECORDER (CONTROL THREAD) ==== */
+
+/* Lanes come from the heap, pre-faulted; they live until ta_replay_free so a late callback never writes freed memory */
+static ma_result ta_replay_alloc(ta_replay_recorder* pRecorder) {
+    for (ma_uint32 i = 0; i < TA_REPLAY_LANE_COUNT; i++) {
+        if (pRecorder->lanes[i].pRecords) {
+            continue;
+        }
+        pRecorder->lanes[i].pRecords = (ta_replay_record*)ma_malloc(TA_REPLAY_LANE_RECORDS * sizeof(ta_replay_record), NULL);
+        if (!pRecorder->lanes[i].pRecords) {
+            return MA_OUT_OF_MEMORY;
+        }
+        memset(pRecorder->lanes[i].pRecords, 0, TA_REPLAY_LANE_RECORDS * sizeof(ta_replay_record));
+    }
+    return MA_SUCCESS;
+}
+
+static void ta_replay_free(ta_replay_recorder* pRecorder) {
+    for (ma_uint32 i = 0; i < TA_REPLAY_LANE_COUNT; i++) {
+        ma_free(pRecorder->lanes[i].pRecords, NULL);
+        pRecorder->lanes[i].pRecords = NULL;
+    }
+}
+
+/* Create the file and start recording. pHeader: everything but magic/version/counts. */
+static ma_result ta_replay_open(ta_replay_recorder* pRecorder, const wchar_t* path, const ta_replay_header* pHeader) {
+    pRecorder->pFile = ta_replay_fopen(path, 1);
+    if (!pRecorder->pFile) {
+        return MA_ACCESS_DENIED;
+    }
+
+    pRecorder->header = *pHeader;
+    memcpy(pRecorder->header.magic, TA_REPLAY_MAGIC, sizeof(pRecorder->header.magic));
+    pRecorder->header.version = TA_REPLAY_VERSION;
+    pRecorder->header.headerBytes = (ma_uint32)sizeof(ta_replay_header);
+    pRecorder->header.recordCount = 0;
+    pRecorder->header.droppedRecords = 0;
+    if (fwrite(&pRecorder->header, sizeof(ta_replay_header), 1, pRecorder->pFile) != 1) {
+        fclose(pRecorder->pFile);
+        pRecorder->pFile = NULL;
+        return MA_IO_ERROR;
+    }
+
+    /* Drop anything left from a previous trace (callbacks are not appending yet) */
+    for (ma_uint32 i = 0; i < TA_REPLAY_LANE_COUNT; i++) {
+        ta_replay_lane* pLane = &pRecorder->lanes[i];
+        ma_atomic_store_explicit_64(&pLane->readCount,
+            ma_atomic_load_explicit_64(&pLane->writeCount, ma_atomic_memory_order_acquire), ma_atomic_memory_order_release);
+    }
+    pRecorder->droppedCount = 0;
+    pRecorder->writtenCount = 0;
+    ma_atomic_store_explicit_32(&pRecorder->active, 1, ma_atomic_memory_order_release);
+    return MA_SUCCESS;
+}
+
+/* ==== CALLBACKS ==== */
+
+static MA_INLINE int ta_replay_is_active(const ta_replay_recorder* pRecorder) {
+    return ma_atomic_load_explicit_32((volatile ma_uint32*)&pRecorder->active, ma_atomic_memory_order_relaxed) != 0;
+}
+
+static MA_INLINE void ta_replay_note(ta_replay_recorder* pRecorder, ta_replay_lane_id laneId, ma_uint64 timeNs,
+    ma_uint32 frames, ma_uint64 position) {
+    if (!ta_replay_is_active(pRecorder)) {
+        return;
+    }
+
+    ta_replay_lane* pLane = &pRecorder->lanes[laneId];
+    ma_uint64 writeCount = pLane->writeCount;
+    if (writeCount - ma_atomic_load_explicit_64(&pLane->readCount, ma_atomic_memory_order_acquire) >= TA_REPLAY_LANE_RECORDS) {
+        ma_atomic_fetch_add_explicit_32(&pRecorder->droppedCount, 1, ma_atomic_memory_order_relaxed);
+        return;
+    }
+
+    ta_replay_record* pRecord = &pLane->pRecords[writeCount & (TA_REPLAY_LANE_RECORDS - 1)];
+    pRecord->timeNs = timeNs;
+    pRecord->frames = frames | (laneId == TA_REPLAY_LANE_PLAYBACK ? TA_REPLAY_PLAYBACK_FLAG : 0);
+    pRecord->position = (ma_uint32)position;
+    ma_atomic_store_explicit_64(&pLane->writeCount, writeCount + 1, ma_atomic_memory_order_release);
+}
+
+/* ==== WRITER ==== */
+
+/* Append everything the callbacks published. Returns the records written. */
+static ma_uint64 ta_replay_drain(ta_replay_recorder* pRecorder) {
+    ma_uint64 written = 0;
+    if (!pRecorder->pFile) {
+        return 0;
+    }
+
+    for (ma_uint32 i = 0; i < TA_REPLAY_LANE_COUNT; i++) {
+        ta_replay_lane* pLane = &pRecorder->lanes[i];
+        ma_uint64 readCount = pLane->readCount;
+        ma_uint64 writeCount = ma_atomic_load_explicit_64(&pLane->writeCount, ma_atomic_memory_order_acquire);
+
+        while (readCount < writeCount) {
+            ma_uint32 index = (ma_uint32)(readCount & (TA_REPLAY_LANE_RECORDS - 1));
+            ma_uint64 span = writeCount - readCount;
+            if (span > TA_REPLAY_LANE_RECORDS - index) {
+                span = TA_REPLAY_LANE_RECORDS - index;
+            }
+            fwrite(&pLane->pRecords[index], sizeof(ta_replay_record), (size_t)span, pRecorder->pFile);
+            readCount += span;
+            written += span;
+        }
+        ma_atomic_store_explicit_64(&pLane->readCount, readCount, ma_atomic_memory_order_release);
+    }
+
+    ma_atomic_store_explicit_64(&pRecorder->writtenCount, pRecorder->writtenCount + written, ma_atomic_memory_order_relaxed);
+    return written;
+}
+
+/* Stop recording (callbacks have left ta_replay_note), write the rest and the final counts */
+static ma_result ta_replay_close(ta_replay_recorder* pRecorder) {
+    ma_atomic_store_explicit_32(&pRecorder->active, 0, ma_atomic_memory_order_release);
+    if (!pRecorder->pFile) {
+        return MA_SUCCESS;
+    }
+
+    ta_replay_drain(pRecorder);
+    pRecorder->header.recordCount = pRecorder->writtenCount;
+    pRecorder->header.droppedRecords = ma_atomic_load_explicit_32(&pRecorder->droppedCount, ma_atomic_memory_order_relaxed);
+
+    int ok = !ferror(pRecorder->pFile);
+    if (ok && fseek(pRecorder->pFile, 0, SEEK_SET) == 0) {
+        ok = fwrite(&pRecorder->header, sizeof(ta_replay_header), 1, pRecorder->pFile) == 1;
+    }
+    ok = (fclose(pRecorder->pFile) == 0) && ok;
+    pRecorder->pFile = NULL;
+    return ok ? MA_SUCCESS : MA_IO_ERROR;
+}
+
+/* ==== REPLAY ==== */
+
+/*
+ * Read a trace into one array per device, each in time order. Free the
+ * arrays with ma_free. A trace cut short (crash while recording) loads
+ * whatever whole records it has.
+ */
+static ma_result ta_replay_load(const wchar_t* path, ta_replay_header* pHeader,
+    ta_replay_record** ppRecords, ma_uint64* pCounts) {
+    ppRecords[TA_REPLAY_LANE_CAPTURE] = NULL;
+    ppRecords[TA_REPLAY_LANE_PLAYBACK] = NULL;
+    pCounts[TA_REPLAY_LANE_CAPTURE] = 0;
+    pCounts[TA_REPLAY_LANE_PLAYBACK] = 0;
+
+    FILE* pFile = ta_replay_fopen(path, 0);
+    if (!pFile) {
+        return MA_DOES_NOT_EXIST;
+    }
+
+    if (fread(pHeader, sizeof(ta_replay_header), 1, pFile) != 1 ||
+        memcmp(pHeader->magic, TA_REPLAY_MAGIC, sizeof(pHeader->magic)) != 0 ||
+        pHeader->version != TA_REPLAY_VERSION || pHeader->headerBytes < sizeof(ta_replay_header) ||
+        pHeader->sampleRate == 0) {
+        fclose(pFile);
+        return MA_INVALID_FILE;
+    }
+
+    fseek(pFile, 0, SEEK_END);
+    long bytes = ftell(pFile);
+    fseek(pFile, (long)pHeader->headerBytes, SEEK_SET);
+    ma_uint64 total = bytes > (long)pHeader->headerBytes
+        ? (ma_uint64)(bytes - (long)pHeader->headerBytes) / sizeof(ta_replay_record)
+        : 0;
+
+    ta_replay_record* pAll = (ta_replay_record*)ma_malloc((size_t)(total > 0 ? total : 1) * sizeof(ta_replay_record), NULL);
+    if (!pAll) {
+        fclose(pFile);
+        return MA_OUT_OF_MEMORY;
+    }
+    total = fread(pAll, sizeof(ta_replay_record), (size_t)total, pFile);
+    fclose(pFile);
+
+    /* Split in place: playback records move to a second array, capture records compact */
+    ma_uint64 playbackCount = 0;
+    for (ma_uint64 i = 0; i < total; i++) {
+        playbackCount += (pAll[i].frames & TA_REPLAY_PLAYBACK_FLAG) ? 1 : 0;
+    }
+    ta_replay_record* pPlayback = (ta_replay_record*)ma_malloc((size_t)(playbackCount > 0 ? playbackCount : 1) * sizeof(ta_replay_record), NULL);
+    if (!pPlayback) {
+        ma_free(pAll, NULL);
+        return MA_OUT_OF_MEMORY;
+    }
+
+    ma_uint64 captureCount = 0;
+    playbackCount = 0;
+    for (ma_uint64 i = 0; i < total; i++) {
+        ta_replay_record record = pAll[i];
+        if (record.frames & TA_REPLAY_PLAYBACK_FLAG) {
+            record.frames &= ~TA_REPLAY_PLAYBACK_FLAG;
+            pPlayback[playbackCount++] = record;
+        } else {
+            pAll[captureCount++] = record;
+        }
+    }
+
+    ppRecords[TA_REPLAY_LANE_CAPTURE] = pAll;
+    ppRecords[TA_REPLAY_LANE_PLAYBACK] = pPlayback;
+    pCounts[TA_REPLAY_LANE_CAPTURE] = captureCount;
+    pCounts[TA_REPLAY_LANE_PLAYBACK] = playbackCount;
+    return MA_SUCCESS;
+}
+
+#endif /* TA_REPLAY_H */
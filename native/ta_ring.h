@@ -0,0 +1,421 @@
+/*
+ * ==============================================================================
+ * ta_ring.h - Single-Producer/Single-Consumer Float Ring ("Bare Metal" Edition)
+ * ==============================================================================
+ * The elastic buffer between capture_callback (producer) and
+ * playback_callback (consumer). Replaces ma_pcm_rb in the hot path.
+ *
+ * LAYOUT:
+ *   - Line 0: immutable geometry (buffer pointer, channels, capacity, mask)
+ *   - Line 1: producer-owned write position
+ *   - Line 2: consumer-owned read position
+ *   Each thread only ever stores to its own cache line, so the two audio
+ *   threads no longer invalidate each other on every callback.
+ *
+ * POSITIONS:
+ *   Read/write positions are 64-bit monotonic frame counters that never wrap
+ *   in practice (~6 million years @ 48kHz). Fill level is simply
+ *   writePos - readPos, which any thread can read without locks.
+ *   Buffer indexing uses (pos & mask) on a power-of-two capacity.
+ *
+ * MIRRORED MODE:
+ *   ta_ring_init_mirrored() maps the same physical pages twice, back to back
+ *   (memfd + mmap on Linux, VirtualAlloc2 + MapViewOfFile3 on Windows 10
+ *   1803+). A span starting anywhere in the first copy can run a full
+ *   capacity past the end and land in the second copy, so every
+ *   write/read span is contiguous and callbacks do one straight copy.
+ *   Capacity is additionally rounded so the buffer size is a multiple of
+ *   the mapping granularity (page size / 64KB).
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h in a translation unit that
+ *   defines MINIAUDIO_IMPLEMENTATION (uses ma_atomic_* and ma_aligned_malloc).
+ * ==============================================================================
+ */
+
+#ifndef TA_RING_H
+#define TA_RING_H
+
+#include <string.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <stdio.h>
+    #if defined(__linux__)
+        #include <sys/syscall.h>
+    #endif
+#endif
+
+/* Cache line size assumed for padding (x64 and ARM64 Windows targets) */
+#define TA_CACHE_LINE_SIZE  64
+
+#if defined(_MSC_VER)
+    #define TA_ALIGN(n) __declspec(align(n))
+#else
+    #define TA_ALIGN(n) __attribute__((aligned(n)))
+#endif
+
+typedef struct TA_ALIGN(TA_CACHE_LINE_SIZE) {
+    float* pBuffer;             /* capacityFrames * channels interleaved f32 */
+    ma_uint32 channels;
+    ma_uint32 capacityFrames;   /* Always a power of two */
+    ma_uint32 mask;             /* capacityFrames - 1 */
+    ma_uint32 isMirrored;       /* 1 = pBuffer is followed by a second mapping of itself */
+    size_t mappedBytes;         /* Size of ONE copy when mirrored */
+#if defined(_WIN32)
+    HANDLE hSection;            /* Pagefile-backed section shared by both views */
+#endif
+} ta_ring_layout;
+
+typedef struct TA_ALIGN(TA_CACHE_LINE_SIZE) {
+    volatile ma_uint64 writePos;    /* Frames ever written (producer stores, release) */
+} ta_ring_producer;
+
+typedef struct TA_ALIGN(TA_CACHE_LINE_SIZE) {
+    volatile ma_uint64 readPos;     /* Frames ever read (consumer stores, release) */
+} ta_ring_consumer;
+
+typedef struct TA_ALIGN(TA_CACHE_LINE_SIZE) {
+    ta_ring_layout layout;
+    ta_ring_producer producer;
+    ta_ring_consumer consumer;
+} ta_ring;
+
+/* ==============================================================================
+ * LIFETIME (not real-time safe)
+ * ============================================================================== */
+
+static MA_INLINE ma_uint32 ta_ring_next_power_of_two(ma_uint32 v) {
+    if (v <= 1) {
+        return 1;
+    }
+    v--;
+    v |= v >> 1;
+    v |= v >> 2;
+    v |= v >> 4;
+    v |= v >> 8;
+    v |= v >> 16;
+    return v + 1;
+}
+
+/**
+ * Allocate a ring holding at least minCapacityFrames frames.
+ * Capacity is rounded up to a power of two.
+ */
+static ma_result ta_ring_init(ta_ring* pRing, ma_uint32 channels, ma_uint32 minCapacityFrames,
+    const ma_allocation_callbacks* pAllocationCallbacks) {
+    if (!pRing || channels == 0 || minCapacityFrames == 0 || minCapacityFrames > 0x40000000) {
+        return MA_INVALID_ARGS;
+    }
+
+    memset(pRing, 0, sizeof(*pRing));
+
+    ma_uint32 capacity = ta_ring_next_power_of_two(minCapacityFrames);
+    size_t bytes = (size_t)capacity * channels * sizeof(float);
+
+    pRing->layout.pBuffer = (float*)ma_aligned_malloc(bytes, TA_CACHE_LINE_SIZE, pAllocationCallbacks);
+    if (!pRing->layout.pBuffer) {
+        return MA_OUT_OF_MEMORY;
+    }
+    memset(pRing->layout.pBuffer, 0, bytes);
+
+    pRing->layout.channels = channels;
+    pRing->layout.capacityFrames = capacity;
+    pRing->layout.mask = capacity - 1;
+
+    return MA_SUCCESS;
+}
+
+/* ==============================================================================
+ * MIRRORED MAPPING (platform specific)
+ * ============================================================================== */
+
+#if defined(_WIN32)
+
+#ifndef MEM_RESERVE_PLACEHOLDER
+    #define MEM_RESERVE_PLACEHOLDER     0x00040000
+#endif
+#ifndef MEM_REPLACE_PLACEHOLDER
+    #define MEM_REPLACE_PLACEHOLDER     0x00004000
+#endif
+#ifndef MEM_PRESERVE_PLACEHOLDER
+    #define MEM_PRESERVE_PLACEHOLDER    0x00000002
+#endif
+
+/* Loaded at runtime: both exist only on Windows 10 1803+ (kernelbase.dll) */
+typedef PVOID (WINAPI *ta_pfn_VirtualAlloc2)(HANDLE, PVOID, SIZE_T, ULONG, ULONG, void*, ULONG);
+typedef PVOID (WINAPI *ta_pfn_MapViewOfFile3)(HANDLE, HANDLE, PVOID, ULONG64, SIZE_T, ULONG, ULONG, void*, ULONG);
+
+static size_t ta_ring_mapping_granularity(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+}
+
+static float* ta_ring_map_mirrored(ta_ring_layout* pLayout, size_t bytes) {
+    HMODULE hKernelBase = GetModuleHandleW(L"kernelbase.dll");
+    if (!hKernelBase) {
+        return NULL;
+    }
+    ta_pfn_VirtualAlloc2 pVirtualAlloc2 = (ta_pfn_VirtualAlloc2)(void*)GetProcAddress(hKernelBase, "VirtualAlloc2");
+    ta_pfn_MapViewOfFile3 pMapViewOfFile3 = (ta_pfn_MapViewOfFile3)(void*)GetProcAddress(hKernelBase, "MapViewOfFile3");
+    if (!pVirtualAlloc2 || !pMapViewOfFile3) {
+        return NULL;
+    }
+
+    HANDLE hSection = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+        (DWORD)((ma_uint64)bytes >> 32), (DWORD)(bytes & 0xFFFFFFFF), NULL);
+    if (!hSection) {
+        return NULL;
+    }
+
+    /* Reserve 2x as one placeholder, then split it into two halves */
+    char* pPlaceholder = (char*)pVirtualAlloc2(NULL, NULL, 2 * bytes,
+        MEM_RESERVE | MEM_RESERVE_PLACEHOLDER, PAGE_NOACCESS, NULL, 0);
+    if (!pPlaceholder) {
+        CloseHandle(hSection);
+        return NULL;
+    }
+    if (!VirtualFree(pPlaceholder, bytes, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER)) {
+        VirtualFree(pPlaceholder, 0, MEM_RELEASE);
+        CloseHandle(hSection);
+        return NULL;
+    }
+
+    void* pView1 = pMapViewOfFile3(hSection, NULL, pPlaceholder, 0, bytes,
+        MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, NULL, 0);
+    void* pView2 = pMapViewOfFile3(hSection, NULL, pPlaceholder + bytes, 0, bytes,
+        MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, NULL, 0);
+    if (!pView1 || !pView2) {
+        if (pView1) {
+            UnmapViewOfFile(pView1);
+        } else {
+            VirtualFree(pPlaceholder, 0, MEM_RELEASE);
+        }
+        if (pView2) {
+            UnmapViewOfFile(pView2);
+        } else {
+            VirtualFree(pPlaceholder + bytes, 0, MEM_RELEASE);
+        }
+        CloseHandle(hSection);
+        return NULL;
+    }
+
+    pLayout->hSection = hSection;
+    return (float*)pView1;
+}
+
+static void ta_ring_unmap_mirrored(ta_ring_layout* pLayout) {
+    UnmapViewOfFile(pLayout->pBuffer);
+    UnmapViewOfFile((char*)pLayout->pBuffer + pLayout->mappedBytes);
+    CloseHandle(pLayout->hSection);
+}
+
+#else
+
+static size_t ta_ring_mapping_granularity(void) {
+    long pageSize = sysconf(_SC_PAGESIZE);
+    return (pageSize > 0) ? (size_t)pageSize : 4096;
+}
+
+static int ta_ring_create_shared_fd(size_t bytes) {
+    int fd = -1;
+#if defined(__linux__) && defined(SYS_memfd_create)
+    fd = (int)syscall(SYS_memfd_create, "ta_ring", 1u /* MFD_CLOEXEC */);
+#endif
+    if (fd < 0) {
+        /* POSIX fallback: anonymous shared memory object, unlinked immediately */
+        char name[64];
+        snprintf(name, sizeof(name), "/ta_ring_%ld_%p", (long)getpid(), (void*)&name);
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            shm_unlink(name);
+        }
+    }
+    if (fd >= 0 && ftruncate(fd, (off_t)bytes) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+static float* ta_ring_map_mirrored(ta_ring_layout* pLayout, size_t bytes) {
+    (void)pLayout;
+
+    int fd = ta_ring_create_shared_fd(bytes);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    /* Reserve 2x address space, then map the same file into both halves */
+    char* pBase = (char*)mmap(NULL, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pBase == (char*)MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    if (mmap(pBase, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+        mmap(pBase + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(pBase, 2 * bytes);
+        close(fd);
+        return NULL;
+    }
+
+    close(fd);  /* Mappings keep the pages alive */
+    return (float*)pBase;
+}
+
+static void ta_ring_unmap_mirrored(ta_ring_layout* pLayout) {
+    munmap(pLayout->pBuffer, 2 * pLayout->mappedBytes);
+}
+
+#endif
+
+/**
+ * Allocate a mirrored ring holding at least minCapacityFrames frames.
+ * Returns MA_NOT_IMPLEMENTED when the OS cannot double-map memory; callers
+ * fall back to ta_ring_init().
+ */
+static ma_result ta_ring_init_mirrored(ta_ring* pRing, ma_uint32 channels, ma_uint32 minCapacityFrames) {
+    if (!pRing || channels == 0 || minCapacityFrames == 0 || minCapacityFrames > 0x40000000) {
+        return MA_INVALID_ARGS;
+    }
+
+    memset(pRing, 0, sizeof(*pRing));
+
+    /* Grow the power-of-two capacity until one copy is a whole number of mapping units */
+    size_t granularity = ta_ring_mapping_granularity();
+    ma_uint32 capacity = ta_ring_next_power_of_two(minCapacityFrames);
+    while (((size_t)capacity * channels * sizeof(float)) % granularity != 0) {
+        if (capacity >= 0x40000000) {
+            return MA_NOT_IMPLEMENTED;
+        }
+        capacity <<= 1;
+    }
+    size_t bytes = (size_t)capacity * channels * sizeof(float);
+
+    float* pBuffer = ta_ring_map_mirrored(&pRing->layout, bytes);
+    if (!pBuffer) {
+        return MA_NOT_IMPLEMENTED;
+    }
+
+    /* Fresh mappings are zero-filled by the OS */
+    pRing->layout.pBuffer = pBuffer;
+    pRing->layout.channels = channels;
+    pRing->layout.capacityFrames = capacity;
+    pRing->layout.mask = capacity - 1;
+    pRing->layout.isMirrored = 1;
+    pRing->layout.mappedBytes = bytes;
+
+    return MA_SUCCESS;
+}
+
+/* pAllocationCallbacks: as given to ta_ring_init (unused for a mirrored ring) */
+static void ta_ring_uninit(ta_ring* pRing, const ma_allocation_callbacks* pAllocationCallbacks) {
+    if (!pRing) {
+        return;
+    }
+    if (pRing->layout.pBuffer) {
+        if (pRing->layout.isMirrored) {
+            ta_ring_unmap_mirrored(&pRing->layout);
+        } else {
+            ma_aligned_free(pRing->layout.pBuffer, pAllocationCallbacks);
+        }
+    }
+    memset(pRing, 0, sizeof(*pRing));
+}
+
+/**
+ * Empty the ring. Only valid while neither audio thread is running.
+ */
+static MA_INLINE void ta_ring_reset(ta_ring* pRing) {
+    ma_atomic_store_explicit_64(&pRing->producer.writePos, 0, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_64(&pRing->consumer.readPos, 0, ma_atomic_memory_order_release);
+}
+
+/* ==============================================================================
+ * ANY THREAD
+ * ============================================================================== */
+
+/**
+ * Frames currently stored. Lock-free and consistent from any thread:
+ * readPos is loaded first, so writePos - readPos can never be negative.
+ */
+static MA_INLINE ma_uint32 ta_ring_fill(const ta_ring* pRing) {
+    ma_uint64 readPos  = ma_atomic_load_explicit_64(&pRing->consumer.readPos, ma_atomic_memory_order_acquire);
+    ma_uint64 writePos = ma_atomic_load_explicit_64(&pRing->producer.writePos, ma_atomic_memory_order_acquire);
+    ma_uint64 fill = writePos - readPos;
+    return (fill > pRing->layout.capacityFrames) ? pRing->layout.capacityFrames : (ma_uint32)fill;
+}
+
+/* ==============================================================================
+ * PRODUCER (capture thread only)
+ * ============================================================================== */
+
+/**
+ * Pointer to the frame offsetFrames past the current write position.
+ * *pContiguousFrames receives how many frames can be written there before
+ * the end of the buffer (always the full capacity in mirrored mode).
+ * Callers loop until all frames are written, then commit once.
+ */
+static MA_INLINE float* ta_ring_write_span(ta_ring* pRing, ma_uint32 offsetFrames, ma_uint32* pContiguousFrames) {
+    ma_uint64 writePos = ma_atomic_load_explicit_64(&pRing->producer.writePos, ma_atomic_memory_order_relaxed);
+    ma_uint32 index = (ma_uint32)((writePos + offsetFrames) & pRing->layout.mask);
+    *pContiguousFrames = pRing->layout.isMirrored 
+        ? pRing->layout.capacityFrames 
+        : pRing->layout.capacityFrames - index;
+    return pRing->layout.pBuffer + (size_t)index * pRing->layout.channels;
+}
+
+/** Publish frameCount frames written through ta_ring_write_span(). */
+static MA_INLINE void ta_ring_commit_write(ta_ring* pRing, ma_uint32 frameCount) {
+    ma_uint64 writePos = ma_atomic_load_explicit_64(&pRing->producer.writePos, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_64(&pRing->producer.writePos, writePos + frameCount, ma_atomic_memory_order_release);
+}
+
+/* ==============================================================================
+ * CONSUMER (playback thread only)
+ * ============================================================================== */
+
+/** Consumer-side counterpart of ta_ring_write_span(). */
+static MA_INLINE const float* ta_ring_read_span(const ta_ring* pRing, ma_uint32 offsetFrames, ma_uint32* pContiguousFrames) {
+    ma_uint64 readPos = ma_atomic_load_explicit_64(&pRing->consumer.readPos, ma_atomic_memory_order_relaxed);
+    ma_uint32 index = (ma_uint32)((readPos + offsetFrames) & pRing->layout.mask);
+    *pContiguousFrames = pRing->layout.isMirrored 
+        ? pRing->layout.capacityFrames 
+        : pRing->layout.capacityFrames - index;
+    return pRing->layout.pBuffer + (size_t)index * pRing->layout.channels;
+}
+
+/** Release frameCount frames back to the producer (also used to skip frames). */
+static MA_INLINE void ta_ring_commit_read(ta_ring* pRing, ma_uint32 frameCount) {
+    ma_uint64 readPos = ma_atomic_load_explicit_64(&pRing->consumer.readPos, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_64(&pRing->consumer.readPos, readPos + frameCount, ma_atomic_memory_order_release);
+}
+
+/**
+ * Copy frameCount frames out of the ring (handling wrap-around) and commit.
+ * Caller must have checked ta_ring_fill() >= frameCount.
+ */
+static MA_INLINE void ta_ring_read(ta_ring* pRing, float* pDst, ma_uint32 frameCount) {
+    ma_uint32 channels = pRing->layout.channels;
+    ma_uint32 done = 0;
+
+    while (done < frameCount) {
+        ma_uint32 contiguous;
+        const float* pSrc = ta_ring_read_span(pRing, done, &contiguous);
+        ma_uint32 n = frameCount - done;
+        if (n > contiguous) {
+            n = contiguous;
+        }
+        memcpy(pDst + (size_t)done * channels, pSrc, (size_t)n * channels * sizeof(float));
+        done += n;
+    }
+
+    ta_ring_commit_read(pRing, frameCount);
+}
+
+#endif /* TA_RING_H */
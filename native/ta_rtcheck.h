@@ -0,0 +1,344 @@
+/*
+ * ==============================================================================
+ * ta_rtcheck.h - Real-Time Violation Detector (debug builds)
+ * ==============================================================================
+ * The callbacks must not allocate, lock or block. With TA_ENABLE_RT_CHECKS
+ * defined, the engine flags each audio thread as real-time for the length
+ * of a callback, and the calls below record a violation - kind, call name
+ * and a raw stack - instead of passing silently:
+ *
+ *   - Linux (glibc): malloc/calloc/realloc/free, pthread_mutex_lock,
+ *     sem_wait, nanosleep/usleep/clock_nanosleep, read/write. The hooks are
+ *     symbol interposers, so they see the whole process when the engine is
+ *     linked into the executable (tools/ta_sim.c, tools/ta_stress.c) or
+ *     LD_PRELOADed; a dlopen'ed engine only sees its own calls.
+ *   - Windows (debug CRT, /MTd or /MDd): allocations via _CrtSetAllocHook.
+ *   - Everywhere: engine paths that take a lock call ta_rt_check() directly.
+ *
+ * Recording never allocates: the stack is captured with backtrace() /
+ * RtlCaptureStackBackTrace into a fixed slot, and symbolized (dladdr, or
+ * module + offset) only when the control thread reads the report.
+ *
+ * Not for sanitizer builds: ASan/TSan intercept the same symbols.
+ * Without TA_ENABLE_RT_CHECKS every entry point here is an empty inline.
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h and ta_ring.h.
+ *   ta_rt_install() on a control thread before the first callback;
+ *   ta_rt_enter()/ta_rt_leave() around each callback.
+ * ==============================================================================
+ */
+
+#ifndef TA_RTCHECK_H
+#define TA_RTCHECK_H
+
+#include <stdio.h>
+#include <string.h>
+
+/* Violations kept with a stack per monitor; further ones are only counted */
+#define TA_RT_MAX_RECORDS       TA_RT_MAX_VIOLATIONS
+
+/* Return addresses captured per violation */
+#define TA_RT_STACK_DEPTH       12
+
+/* Frames belonging to the detector: ta_rt_capture_stack, ta_rt_check, the hook */
+#define TA_RT_STACK_SKIP        3
+
+typedef struct {
+    volatile ma_uint32 ready;   /* Set (release) once the slot is filled */
+    ma_uint32 kind;             /* ta_rt_violation_kind */
+    ma_uint32 thread;           /* ta_rt_thread_kind */
+    ma_uint32 frameCount;
+    const char* call;           /* String literal */
+    void* frames[TA_RT_STACK_DEPTH];
+} ta_rt_record;
+
+typedef struct {
+    volatile ma_uint64 violationCount;
+    volatile ma_uint32 claimed;         /* Slots handed out (may exceed TA_RT_MAX_RECORDS) */
+    ta_rt_record records[TA_RT_MAX_RECORDS];
+} ta_rt_monitor;
+
+/* Clear the monitor; no callback may be running (a reader may be) */
+static void ta_rt_monitor_reset(ta_rt_monitor* pMonitor) {
+    for (ma_uint32 i = 0; i < TA_RT_MAX_RECORDS; i++) {
+        ma_atomic_store_explicit_32(&pMonitor->records[i].ready, 0, ma_atomic_memory_order_relaxed);
+    }
+    ma_atomic_store_explicit_32(&pMonitor->claimed, 0, ma_atomic_memory_order_relaxed);
+    ma_atomic_store_explicit_64(&pMonitor->violationCount, 0, ma_atomic_memory_order_relaxed);
+}
+
+#if defined(TA_ENABLE_RT_CHECKS)
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #if defined(_MSC_VER) && defined(_DEBUG)
+        #include <crtdbg.h>
+        #define TA_RT_HOOK_CRT
+    #endif
+    #define TA_RT_THREAD_LOCAL __declspec(thread)
+#else
+    #include <dlfcn.h>
+    #include <stdlib.h>
+    #if defined(__GLIBC__) || defined(__APPLE__)
+        #include <execinfo.h>
+        #define TA_RT_HAVE_BACKTRACE
+    #endif
+    #if defined(__GLIBC__)
+        #include <pthread.h>
+        #include <semaphore.h>
+        #include <time.h>
+        #include <unistd.h>
+        #define TA_RT_HOOK_LIBC
+    #endif
+    /* initial-exec: a dynamic TLS lookup may itself call malloc */
+    #define TA_RT_THREAD_LOCAL __thread __attribute__((tls_model("initial-exec")))
+#endif
+
+typedef struct {
+    ta_rt_monitor* pMonitor;    /* Non-NULL while inside a callback */
+    ma_uint32 thread;
+    ma_uint32 inCheck;          /* Recording: hooks pass straight through */
+} ta_rt_thread_state;
+
+static TA_RT_THREAD_LOCAL ta_rt_thread_state g_taRtThread;
+
+/* Not inlined, so TA_RT_STACK_SKIP is exact at any optimization level */
+static MA_NO_INLINE ma_uint32 ta_rt_capture_stack(void** pFrames, ma_uint32 maxFrames) {
+#if defined(_WIN32)
+    return (ma_uint32)RtlCaptureStackBackTrace(TA_RT_STACK_SKIP, (DWORD)maxFrames, pFrames, NULL);
+#elif defined(TA_RT_HAVE_BACKTRACE)
+    void* frames[TA_RT_STACK_DEPTH + TA_RT_STACK_SKIP];
+    int count = backtrace(frames, (int)(maxFrames + TA_RT_STACK_SKIP));
+    ma_uint32 kept = (count > TA_RT_STACK_SKIP) ? (ma_uint32)(count - TA_RT_STACK_SKIP) : 0;
+    memcpy(pFrames, frames + TA_RT_STACK_SKIP, kept * sizeof(void*));
+    return kept;
+#else
+    (void)pFrames;
+    (void)maxFrames;
+    return 0;
+#endif
+}
+
+/* Record a violation if the calling thread is inside a callback */
+static MA_NO_INLINE void ta_rt_check(ma_uint32 kind, const char* call) {
+    ta_rt_thread_state* pThread = &g_taRtThread;
+    ta_rt_monitor* pMonitor = pThread->pMonitor;
+    if (!pMonitor || pThread->inCheck) {
+        return;
+    }
+    pThread->inCheck = 1;
+
+    ma_atomic_fetch_add_explicit_64(&pMonitor->violationCount, 1, ma_atomic_memory_order_relaxed);
+    ma_uint32 slot = ma_atomic_fetch_add_explicit_32(&pMonitor->claimed, 1, ma_atomic_memory_order_relaxed);
+    if (slot < TA_RT_MAX_RECORDS) {
+        ta_rt_record* pRecord = &pMonitor->records[slot];
+        pRecord->kind = kind;
+        pRecord->thread = pThread->thread;
+        pRecord->call = call;
+        pRecord->frameCount = ta_rt_capture_stack(pRecord->frames, TA_RT_STACK_DEPTH);
+        ma_atomic_store_explicit_32(&pRecord->ready, 1, ma_atomic_memory_order_release);
+    }
+
+    pThread->inCheck = 0;
+}
+
+static MA_INLINE void ta_rt_enter(ta_rt_monitor* pMonitor, ma_uint32 thread) {
+    g_taRtThread.thread = thread;
+    g_taRtThread.pMonitor = pMonitor;
+}
+
+static MA_INLINE void ta_rt_leave(void) {
+    g_taRtThread.pMonitor = NULL;
+}
+
+/* ==== HOOKS ==== */
+
+#if defined(TA_RT_HOOK_CRT)
+static _CRT_ALLOC_HOOK g_taRtPreviousAllocHook = NULL;
+
+static int __cdecl ta_rt_crt_alloc_hook(int allocType, void* pUserData, size_t size, int blockType,
+    long requestNumber, const unsigned char* pFileName, int lineNumber) {
+    switch (allocType) {
+        case _HOOK_ALLOC:   ta_rt_check(TA_RT_VIOLATION_ALLOCATION, "malloc"); break;
+        case _HOOK_REALLOC: ta_rt_check(TA_RT_VIOLATION_ALLOCATION, "realloc"); break;
+        case _HOOK_FREE:    ta_rt_check(TA_RT_VIOLATION_FREE, "free"); break;
+        default: break;
+    }
+    return g_taRtPreviousAllocHook
+        ? g_taRtPreviousAllocHook(allocType, pUserData, size, blockType, requestNumber, pFileName, lineNumber)
+        : TRUE;
+}
+#endif
+
+#if defined(TA_RT_HOOK_LIBC)
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* p, size_t size);
+extern void __libc_free(void* p);
+
+/* Next definition of a hooked symbol (libc), resolved once */
+static void* ta_rt_next(void* volatile* pSlot, const char* name) {
+    void* p = __atomic_load_n(pSlot, __ATOMIC_ACQUIRE);
+    if (!p) {
+        p = dlsym(RTLD_NEXT, name);
+        __atomic_store_n(pSlot, p, __ATOMIC_RELEASE);
+    }
+    return p;
+}
+
+#define TA_RT_NEXT(name, type) ((type)ta_rt_next(&g_taRtNext_##name, #name))
+
+static void* volatile g_taRtNext_pthread_mutex_lock = NULL;
+static void* volatile g_taRtNext_sem_wait = NULL;
+static void* volatile g_taRtNext_nanosleep = NULL;
+static void* volatile g_taRtNext_clock_nanosleep = NULL;
+static void* volatile g_taRtNext_usleep = NULL;
+static void* volatile g_taRtNext_read = NULL;
+static void* volatile g_taRtNext_write = NULL;
+
+void* malloc(size_t size) {
+    ta_rt_check(TA_RT_VIOLATION_ALLOCATION, "malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    ta_rt_check(TA_RT_VIOLATION_ALLOCATION, "calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, size_t size) {
+    ta_rt_check(TA_RT_VIOLATION_ALLOCATION, "realloc");
+    return __libc_realloc(p, size);
+}
+
+void free(void* p) {
+    ta_rt_check(TA_RT_VIOLATION_FREE, "free");
+    __libc_free(p);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* pMutex) {
+    ta_rt_check(TA_RT_VIOLATION_LOCK, "pthread_mutex_lock");
+    return TA_RT_NEXT(pthread_mutex_lock, int (*)(pthread_mutex_t*))(pMutex);
+}
+
+int sem_wait(sem_t* pSemaphore) {
+    ta_rt_check(TA_RT_VIOLATION_LOCK, "sem_wait");
+    return TA_RT_NEXT(sem_wait, int (*)(sem_t*))(pSemaphore);
+}
+
+int nanosleep(const struct timespec* pDuration, struct timespec* pRemaining) {
+    ta_rt_check(TA_RT_VIOLATION_SLEEP, "nanosleep");
+    return TA_RT_NEXT(nanosleep, int (*)(const struct timespec*, struct timespec*))(pDuration, pRemaining);
+}
+
+int clock_nanosleep(clockid_t clock, int flags, const struct timespec* pTime, struct timespec* pRemaining) {
+    ta_rt_check(TA_RT_VIOLATION_SLEEP, "clock_nanosleep");
+    return TA_RT_NEXT(clock_nanosleep, int (*)(clockid_t, int, const struct timespec*, struct timespec*))(clock, flags, pTime, pRemaining);
+}
+
+int usleep(useconds_t us) {
+    ta_rt_check(TA_RT_VIOLATION_SLEEP, "usleep");
+    return TA_RT_NEXT(usleep, int (*)(useconds_t))(us);
+}
+
+ssize_t read(int fd, void* pBuffer, size_t bytes) {
+    ta_rt_check(TA_RT_VIOLATION_IO, "read");
+    return TA_RT_NEXT(read, ssize_t (*)(int, void*, size_t))(fd, pBuffer, bytes);
+}
+
+ssize_t write(int fd, const void* pBuffer, size_t bytes) {
+    ta_rt_check(TA_RT_VIOLATION_IO, "write");
+    return TA_RT_NEXT(write, ssize_t (*)(int, const void*, size_t))(fd, pBuffer, bytes);
+}
+#endif
+
+/*
+ * Arm the hooks. Control thread, before the first callback: warms up
+ * backtrace() (its first call loads the unwinder, which allocates) and
+ * resolves the forwarded symbols.
+ */
+static void ta_rt_install(void) {
+    static volatile ma_uint32 installed = 0;
+    if (ma_atomic_exchange_explicit_32(&installed, 1, ma_atomic_memory_order_acq_rel)) {
+        return;
+    }
+
+#if defined(TA_RT_HAVE_BACKTRACE)
+    void* frames[1];
+    backtrace(frames, 1);
+#endif
+#if defined(TA_RT_HOOK_LIBC)
+    TA_RT_NEXT(pthread_mutex_lock, void*);
+    TA_RT_NEXT(sem_wait, void*);
+    TA_RT_NEXT(nanosleep, void*);
+    TA_RT_NEXT(clock_nanosleep, void*);
+    TA_RT_NEXT(usleep, void*);
+    TA_RT_NEXT(read, void*);
+    TA_RT_NEXT(write, void*);
+#endif
+#if defined(TA_RT_HOOK_CRT)
+    g_taRtPreviousAllocHook = _CrtSetAllocHook(ta_rt_crt_alloc_hook);
+#endif
+}
+
+/* "symbol+0x1c" where exported, else "module+0x1a2b" (addr2line / .map lookup) */
+static void ta_rt_describe_frame(void* pFrame, char* pOut, size_t outSize) {
+#if defined(_WIN32)
+    HMODULE hModule = NULL;
+    char path[MAX_PATH];
+    if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+            (LPCSTR)pFrame, &hModule) && GetModuleFileNameA(hModule, path, MAX_PATH) > 0) {
+        const char* pName = strrchr(path, '\\');
+        snprintf(pOut, outSize, "%s+0x%llx", pName ? pName + 1 : path,
+            (unsigned long long)((const char*)pFrame - (const char*)hModule));
+        return;
+    }
+#else
+    Dl_info info;
+    if (dladdr(pFrame, &info)) {
+        if (info.dli_sname && info.dli_saddr) {
+            snprintf(pOut, outSize, "%s+0x%llx", info.dli_sname,
+                (unsigned long long)((const char*)pFrame - (const char*)info.dli_saddr));
+            return;
+        }
+        if (info.dli_fname && info.dli_fbase) {
+            const char* pName = strrchr(info.dli_fname, '/');
+            snprintf(pOut, outSize, "%s+0x%llx", pName ? pName + 1 : info.dli_fname,
+                (unsigned long long)((const char*)pFrame - (const char*)info.dli_fbase));
+            return;
+        }
+    }
+#endif
+    snprintf(pOut, outSize, "%p", pFrame);
+}
+
+#else /* !TA_ENABLE_RT_CHECKS */
+
+static MA_INLINE void ta_rt_check(ma_uint32 kind, const char* call) { (void)kind; (void)call; }
+static MA_INLINE void ta_rt_enter(ta_rt_monitor* pMonitor, ma_uint32 thread) { (void)pMonitor; (void)thread; }
+static MA_INLINE void ta_rt_leave(void) { }
+static MA_INLINE void ta_rt_install(void) { }
+
+static void ta_rt_describe_frame(void* pFrame, char* pOut, size_t outSize) {
+    snprintf(pOut, outSize, "%p", pFrame);
+}
+
+#endif /* TA_ENABLE_RT_CHECKS */
+
+/* Innermost frame first, " < " between frames, truncated to fit */
+static void ta_rt_format_stack(const ta_rt_record* pRecord, char* pOut, size_t outSize) {
+    size_t used = 0;
+    pOut[0] = '\0';
+    for (ma_uint32 i = 0; i < pRecord->frameCount && used + 1 < outSize; i++) {
+        char frame[96];
+        ta_rt_describe_frame(pRecord->frames[i], frame, sizeof(frame));
+        int written = snprintf(pOut + used, outSize - used, "%s%s", (i > 0) ? " < " : "", frame);
+        if (written < 0 || (size_t)written >= outSize - used) {
+            break;
+        }
+        used += (size_t)written;
+    }
+}
+
+#endif /* TA_RTCHECK_H */
@@ -0,0 +1,123 @@
+/*
+ * ==============================================================================
+ * ta_splice.h - Crossfaded Single-Frame Splices for Skip/Duplicate Drift
+ * ==============================================================================
+ * A skip or duplicate correction used to drop or repeat one frame at a hard
+ * boundary: a step in the waveform, heard as a click on tonal material.
+ * Here the one-frame shift is spread over an overlap of
+ * TA_SPLICE_OVERLAP_MS instead (WSOLA with a one-frame tolerance):
+ *
+ *   - Search: within the frames the callback is about to play, find the
+ *     start t where frames [t, t + overlap) and [t + 1, t + 1 + overlap)
+ *     differ least (sum of squared differences, the diff_energy kernel).
+ *     That is where the signal is most similar to itself shifted by one
+ *     frame: quiet or slowly moving. At most TA_SPLICE_MAX_CANDIDATES
+ *     starts are tried, evenly spaced.
+ *   - Splice: across the overlap, the output crossfades linearly from the
+ *     stream to the stream shifted by one frame (forward to remove a frame,
+ *     back to insert one); before it the stream plays as read, after it
+ *     shifted.
+ *
+ * Nothing is delayed: both operations work on the frames of the current
+ * callback in place. Callbacks too short for the overlap splice with a
+ * shorter one, down to a plain drop or repeat.
+ *
+ * USAGE:
+ *   Internal header. Include after ta_kernels.h.
+ * ==============================================================================
+ */
+
+#ifndef TA_SPLICE_H
+#define TA_SPLICE_H
+
+#include <string.h>
+
+#define TA_SPLICE_OVERLAP_MS        1.0f
+#define TA_SPLICE_MAX_CANDIDATES    32
+
+static ma_uint32 ta_splice_overlap_frames(ma_uint32 sampleRate) {
+    return (ma_uint32)(TA_SPLICE_OVERLAP_MS * (float)sampleRate / 1000.0f);
+}
+
+/* Start in [0, lastStart] where the overlap is most similar to itself one frame on */
+static ma_uint32 ta_splice_search(const ta_kernels* pKernels, const float* pFrames, ma_uint32 channels,
+    ma_uint32 lastStart, ma_uint32 overlap) {
+    if (overlap == 0) {
+        return 0;
+    }
+
+    ma_uint32 stride = lastStart / TA_SPLICE_MAX_CANDIDATES + 1;
+    ma_uint32 best = 0;
+    float bestEnergy = 0.0f;
+    for (ma_uint32 t = 0; t <= lastStart; t += stride) {
+        const float* pA = pFrames + (size_t)t * channels;
+        float energy = pKernels->diff_energy(pA + channels, pA, overlap * channels);
+        if (t == 0 || energy < bestEnergy) {
+            bestEnergy = energy;
+            best = t;
+        }
+    }
+    return best;
+}
+
+/*
+ * Remove one frame. pFrames holds frameCount frames read from the ring and
+ * pNext the frame after them; on return pFrames holds frameCount frames
+ * covering all frameCount + 1.
+ */
+static void ta_splice_remove(const ta_kernels* pKernels, float* pFrames, const float* pNext,
+    ma_uint32 channels, ma_uint32 frameCount, ma_uint32 overlap) {
+    if (frameCount == 0) {
+        return;
+    }
+    if (overlap > frameCount - 1) {
+        overlap = frameCount - 1;
+    }
+
+    ma_uint32 start = ta_splice_search(pKernels, pFrames, channels, frameCount - 1 - overlap, overlap);
+
+    /* Fade toward the next frame (forward, so every read is still unmodified) */
+    for (ma_uint32 j = 0; j < overlap; j++) {
+        float w = (float)(j + 1) / (float)(overlap + 1);
+        float* pFrame = pFrames + (size_t)(start + j) * channels;
+        for (ma_uint32 ch = 0; ch < channels; ch++) {
+            pFrame[ch] += w * (pFrame[ch + channels] - pFrame[ch]);
+        }
+    }
+
+    ma_uint32 tail = start + overlap;
+    memmove(pFrames + (size_t)tail * channels, pFrames + (size_t)(tail + 1) * channels,
+        (size_t)(frameCount - 1 - tail) * channels * sizeof(float));
+    memcpy(pFrames + (size_t)(frameCount - 1) * channels, pNext, channels * sizeof(float));
+}
+
+/*
+ * Insert one frame. pFrames holds frameCount - 1 frames read from the ring
+ * (at least 1) and has room for frameCount; on return it holds frameCount.
+ */
+static void ta_splice_insert(const ta_kernels* pKernels, float* pFrames, ma_uint32 channels,
+    ma_uint32 frameCount, ma_uint32 overlap) {
+    ma_uint32 readFrames = frameCount - 1;
+    if (overlap > readFrames - 1) {
+        overlap = readFrames - 1;
+    }
+
+    /* The splice starts one frame after the match: it crossfades back onto it */
+    ma_uint32 start = ta_splice_search(pKernels, pFrames, channels, readFrames - 1 - overlap, overlap) + 1;
+
+    ma_uint32 tail = start + overlap;
+    memmove(pFrames + (size_t)tail * channels, pFrames + (size_t)(tail - 1) * channels,
+        (size_t)(frameCount - tail) * channels * sizeof(float));
+
+    /* Fade toward the previous frame (backward, so every read is still unmodified) */
+    for (ma_uint32 j = overlap; j-- > 0;) {
+        float w = (float)(j + 1) / (float)(overlap + 1);
+        float* pFrame = pFrames + (size_t)(start + j) * channels;
+        const float* pPrevious = pFrame - channels;
+        for (ma_uint32 ch = 0; ch < channels; ch++) {
+            pFrame[ch] += w * (pPrevious[ch] - pFrame[ch]);
+        }
+    }
+}
+
+#endif /* TA_SPLICE_H */
@@ -0,0 +1,232 @@
+/*
+ * ==============================================================================
+ * ta_timing.h - Callback Timing Histograms and DSP Load
+ * ==============================================================================
+ * Lock-free, allocation-free instrumentation for the audio callbacks.
+ * Each callback owns one ta_callback_timer and records, per call:
+ *   - execution time (ns)
+ *   - interval since the previous call started (ns)
+ *   - frames delivered
+ * into log-bucketed histograms, plus a JACK-style DSP load (run time as a
+ * fraction of the period the callback had to fill).
+ *
+ * HISTOGRAM:
+ *   Values below 8 get their own bucket; above that every power of two is
+ *   split into 8 sub-buckets, so any recorded value is within 12.5% of its
+ *   bucket bound. 240 buckets cover the full 32-bit range (4.29s in ns).
+ *
+ * THREADING:
+ *   Only the owning audio thread writes a timer. Readers copy the counts
+ *   (a snapshot may be a few samples stale, never torn per bucket). A reset
+ *   is a request: the reader bumps resetRequest and the audio thread clears
+ *   its own histograms at the start of its next callback.
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h and ta_ring.h.
+ * ==============================================================================
+ */
+
+#ifndef TA_TIMING_H
+#define TA_TIMING_H
+
+#include <string.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#else
+    #include <time.h>
+#endif
+
+#define TA_HISTOGRAM_SUB_BITS       3
+#define TA_HISTOGRAM_BUCKETS        240     /* 8 linear + 29 octaves * 8 */
+
+/* DSP load: peak of each 32-callback window, averaged 50/50 into the meter (as JACK does) */
+#define TA_DSP_LOAD_WINDOW          32
+
+typedef struct {
+    volatile ma_uint32 counts[TA_HISTOGRAM_BUCKETS];
+    volatile ma_uint32 maxValue;
+} ta_histogram;
+
+typedef struct {
+    ta_histogram executionNs;
+    ta_histogram intervalNs;
+    ta_histogram frames;
+    ma_uint64 lastStartNs;          /* 0 = no previous callback since reset */
+    float windowPeakLoad;           /* Highest load in the current window */
+    ma_uint32 windowCallbacks;
+    volatile float dspLoad;         /* Smoothed load, 1.0 = 100% of the period */
+    volatile float dspLoadPeak;     /* Worst single callback since reset */
+    volatile ma_uint32 resetRequest;    /* Bumped by readers */
+    ma_uint32 resetAck;                 /* Audio thread's copy of the last served request */
+} ta_callback_timer;
+
+/* ==============================================================================
+ * CLOCK
+ * ============================================================================== */
+
+static MA_INLINE ma_uint64 ta_timing_now_ns(void) {
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency;     /* Constant after boot; first read is idempotent */
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (ma_uint64)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ma_uint64)ts.tv_sec * 1000000000ull + (ma_uint64)ts.tv_nsec;
+#endif
+}
+
+/* ==============================================================================
+ * HISTOGRAM
+ * ============================================================================== */
+
+static MA_INLINE ma_uint32 ta_histogram_log2(ma_uint32 v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, v);
+    return (ma_uint32)index;
+#else
+    return 31u - (ma_uint32)__builtin_clz(v);
+#endif
+}
+
+static MA_INLINE ma_uint32 ta_histogram_bucket(ma_uint32 value) {
+    if (value < (1u << TA_HISTOGRAM_SUB_BITS)) {
+        return value;
+    }
+    ma_uint32 octave = ta_histogram_log2(value);
+    ma_uint32 sub = (value >> (octave - TA_HISTOGRAM_SUB_BITS)) & ((1u << TA_HISTOGRAM_SUB_BITS) - 1);
+    return ((octave - TA_HISTOGRAM_SUB_BITS + 1) << TA_HISTOGRAM_SUB_BITS) + sub;
+}
+
+/* Largest value that falls into a bucket */
+static ma_uint32 ta_histogram_bucket_upper(ma_uint32 bucket) {
+    if (bucket < (1u << TA_HISTOGRAM_SUB_BITS)) {
+        return bucket;
+    }
+    ma_uint32 octave = (bucket >> TA_HISTOGRAM_SUB_BITS) + TA_HISTOGRAM_SUB_BITS - 1;
+    ma_uint32 sub = bucket & ((1u << TA_HISTOGRAM_SUB_BITS) - 1);
+    ma_uint32 shift = octave - TA_HISTOGRAM_SUB_BITS;
+    ma_uint64 lower = (ma_uint64)((1u << TA_HISTOGRAM_SUB_BITS) + sub) << shift;
+    ma_uint64 upper = lower + ((ma_uint64)1 << shift) - 1;
+    return (upper > 0xFFFFFFFFull) ? 0xFFFFFFFFu : (ma_uint32)upper;
+}
+
+static MA_INLINE void ta_histogram_record(ta_histogram* pHistogram, ma_uint64 value) {
+    ma_uint32 v = (value > 0xFFFFFFFFull) ? 0xFFFFFFFFu : (ma_uint32)value;
+    pHistogram->counts[ta_histogram_bucket(v)]++;
+    if (v > pHistogram->maxValue) {
+        pHistogram->maxValue = v;
+    }
+}
+
+/*
+ * Percentiles from a snapshot (reader side). Each percentile is the upper
+ * bound of the bucket holding that rank, clamped to the exact maximum.
+ */
+static void ta_histogram_percentiles(const ta_histogram* pHistogram, ma_uint64* pCount,
+    ma_uint32* pP50, ma_uint32* pP99, ma_uint32* pP999, ma_uint32* pMax) {
+    ma_uint32 counts[TA_HISTOGRAM_BUCKETS];
+    ma_uint64 total = 0;
+    ma_uint32 maxValue = pHistogram->maxValue;
+
+    for (ma_uint32 i = 0; i < TA_HISTOGRAM_BUCKETS; i++) {
+        counts[i] = pHistogram->counts[i];
+        total += counts[i];
+    }
+
+    const double quantiles[3] = { 0.50, 0.99, 0.999 };
+    ma_uint32* outputs[3] = { pP50, pP99, pP999 };
+
+    for (int q = 0; q < 3; q++) {
+        ma_uint64 rank = (ma_uint64)(quantiles[q] * (double)total + 0.999999);
+        ma_uint64 seen = 0;
+        ma_uint32 value = 0;
+        if (rank == 0) {
+            rank = 1;
+        }
+        for (ma_uint32 i = 0; i < TA_HISTOGRAM_BUCKETS && total > 0; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                value = ta_histogram_bucket_upper(i);
+                break;
+            }
+        }
+        *outputs[q] = (value > maxValue) ? maxValue : value;
+    }
+
+    *pCount = total;
+    *pMax = maxValue;
+}
+
+/* ==============================================================================
+ * CALLBACK TIMER (audio thread)
+ * ============================================================================== */
+
+static void ta_callback_timer_clear(ta_callback_timer* pTimer) {
+    memset(&pTimer->executionNs, 0, sizeof(pTimer->executionNs));
+    memset(&pTimer->intervalNs, 0, sizeof(pTimer->intervalNs));
+    memset(&pTimer->frames, 0, sizeof(pTimer->frames));
+    pTimer->lastStartNs = 0;
+    pTimer->windowPeakLoad = 0.0f;
+    pTimer->windowCallbacks = 0;
+    pTimer->dspLoad = 0.0f;
+    pTimer->dspLoadPeak = 0.0f;
+    pTimer->resetAck = pTimer->resetRequest;
+}
+
+/* Call first thing in the callback. Returns the start timestamp. */
+static MA_INLINE ma_uint64 ta_callback_timer_begin(ta_callback_timer* pTimer) {
+    if (pTimer->resetRequest != pTimer->resetAck) {
+        ta_callback_timer_clear(pTimer);
+    }
+
+    ma_uint64 now = ta_timing_now_ns();
+    if (pTimer->lastStartNs != 0) {
+        ta_histogram_record(&pTimer->intervalNs, now - pTimer->lastStartNs);
+    }
+    pTimer->lastStartNs = now;
+    return now;
+}
+
+/* Call last thing in the callback. Returns the execution time. */
+static MA_INLINE ma_uint64 ta_callback_timer_end(ta_callback_timer* pTimer, ma_uint64 startNs, ma_uint32 frameCount, ma_uint32 sampleRate) {
+    ma_uint64 elapsed = ta_timing_now_ns() - startNs;
+
+    ta_histogram_record(&pTimer->executionNs, elapsed);
+    ta_histogram_record(&pTimer->frames, frameCount);
+
+    if (frameCount == 0 || sampleRate == 0) {
+        return elapsed;
+    }
+
+    /* Load = time spent / time the period represents */
+    float load = (float)((double)elapsed * (double)sampleRate / ((double)frameCount * 1e9));
+    if (load > pTimer->dspLoadPeak) {
+        pTimer->dspLoadPeak = load;
+    }
+    if (load > pTimer->windowPeakLoad) {
+        pTimer->windowPeakLoad = load;
+    }
+    if (++pTimer->windowCallbacks >= TA_DSP_LOAD_WINDOW) {
+        pTimer->dspLoad = 0.5f * pTimer->dspLoad + 0.5f * pTimer->windowPeakLoad;
+        pTimer->windowPeakLoad = 0.0f;
+        pTimer->windowCallbacks = 0;
+    }
+    return elapsed;
+}
+
+/* Reader side: ask the owning thread to clear on its next callback */
+static MA_INLINE void ta_callback_timer_request_reset(ta_callback_timer* pTimer) {
+    pTimer->resetRequest++;
+}
+
+#endif /* TA_TIMING_H */
@@ -0,0 +1,535 @@
+/*
+ * ==============================================================================
+ * ta_trace.h - Timeline Trace Probes (Chrome JSON / Perfetto export)
+ * ==============================================================================
+ * Where the time goes at the period level - how the capture and playback
+ * callbacks interleave with each other, with the drift decisions and with
+ * the host's control calls - is only visible on one timeline. With
+ * TA_ENABLE_TRACE defined, the probes below record into that timeline:
+ *
+ *   TA_TRACE_BEGIN(name)          open a slice on the calling thread
+ *   TA_TRACE_END()                close the innermost one
+ *   TA_TRACE_COUNTER(name, value) sample a counter track
+ *   TA_TRACE_THREAD(name, owner)  name the calling thread's track
+ *
+ * name is a string literal (only the pointer is stored). Each thread that
+ * records gets its own SPSC buffer from a pool allocated, pre-faulted, by
+ * the first Initialize: a probe is a thread-local load and one 32-byte
+ * store, no lock and no allocation. A full buffer drops the event and
+ * counts it. ta_trace_write() empties every buffer into a Chrome trace
+ * JSON file (chrome://tracing, ui.perfetto.dev) or a Perfetto protobuf
+ * trace.
+ *
+ * Without TA_ENABLE_TRACE every probe expands to ((void)0): arguments are
+ * not evaluated and no code or data is emitted.
+ *
+ * Buffers belong to their thread until the engine that owns it (the owner
+ * given to TA_TRACE_THREAD) is uninitialized; they are reused once their
+ * events have been written out. Other threads keep theirs for the life of
+ * the process.
+ *
+ * USAGE:
+ *   Internal header. Include after miniaudio.h, ta_ring.h (TA_ALIGN) and
+ *   ta_timing.h.
+ *   ta_trace_init() on a control thread before the first probe.
+ * ==============================================================================
+ */
+
+#ifndef TA_TRACE_H
+#define TA_TRACE_H
+
+#if defined(TA_ENABLE_TRACE)
+
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+
+#if defined(_WIN32)
+    #include <windows.h>
+    #define TA_TRACE_THREAD_LOCAL __declspec(thread)
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+    #if defined(__linux__)
+        #include <sys/syscall.h>
+    #endif
+    /* initial-exec: a dynamic TLS lookup may itself call malloc */
+    #define TA_TRACE_THREAD_LOCAL __thread __attribute__((tls_model("initial-exec")))
+#endif
+
+#define TA_TRACE_MAX_THREADS        32
+#define TA_TRACE_THREAD_EVENTS      8192    /* Per thread; power of two (~5s of a 2.6ms playback callback) */
+#define TA_TRACE_NAME_LENGTH        32
+#define TA_TRACE_MAX_COUNTERS       32      /* Distinct counter names per written trace */
+#define TA_TRACE_PATH_LENGTH        512
+
+/* Perfetto track uuids: the process, then one per thread buffer and per counter */
+#define TA_TRACE_PROCESS_UUID       0x7A700000ull
+#define TA_TRACE_THREAD_UUID        0x7A710000ull
+#define TA_TRACE_COUNTER_UUID       0x7A720000ull
+
+typedef enum {
+    TA_TRACE_EVENT_BEGIN = 1,
+    TA_TRACE_EVENT_END = 2,
+    TA_TRACE_EVENT_COUNTER = 3
+} ta_trace_event_type;
+
+typedef enum {
+    TA_TRACE_SLOT_FREE = 0,
+    TA_TRACE_SLOT_CLAIMING,     /* Being named by its new thread */
+    TA_TRACE_SLOT_CLAIMED,      /* Owned by a live thread */
+    TA_TRACE_SLOT_RETIRED       /* Its thread has exited; free once written out */
+} ta_trace_slot_state;
+
+typedef struct {
+    ma_uint64 timeNs;
+    const char* name;           /* String literal; NULL for END */
+    double value;               /* COUNTER */
+    ma_uint32 type;             /* ta_trace_event_type */
+    ma_uint32 reserved;
+} ta_trace_event;
+
+typedef struct TA_ALIGN(TA_CACHE_LINE_SIZE) {
+    volatile ma_uint64 writeCount;      /* Owning thread */
+    volatile ma_uint64 readCount;       /* ta_trace_write */
+    volatile ma_uint32 state;           /* ta_trace_slot_state */
+    const void* owner;                  /* Engine whose Uninitialize retires the slot */
+    ma_uint64 threadId;
+    char name[TA_TRACE_NAME_LENGTH];
+    ta_trace_event* pEvents;
+} ta_trace_slot;
+
+typedef struct {
+    volatile ma_uint32 ready;           /* 0 none, 1 allocating, 2 ready */
+    volatile ma_uint32 writing;         /* ta_trace_write in progress */
+    volatile ma_uint64 droppedCount;    /* Full buffers, or no buffer left */
+    ta_trace_slot slots[TA_TRACE_MAX_THREADS];
+} ta_trace_state;
+
+static ta_trace_state g_taTrace;
+
+/* The calling thread's buffer: NULL until claimed, g_taTraceNoSlot when the pool was empty */
+static TA_TRACE_THREAD_LOCAL ta_trace_slot* g_taTraceSlot;
+static ta_trace_slot g_taTraceNoSlot;
+
+/* ==== SETUP (CONTROL THREAD) ==== */
+
+/* Allocate and pre-fault every buffer once per process; later calls return at once */
+static void ta_trace_init(void) {
+    ma_uint32 none = 0;
+    if (!ma_atomic_compare_exchange_strong_explicit_32(&g_taTrace.ready, &none, 1,
+            ma_atomic_memory_order_acquire, ma_atomic_memory_order_relaxed)) {
+        return;
+    }
+
+    for (ma_uint32 i = 0; i < TA_TRACE_MAX_THREADS; i++) {
+        ta_trace_event* pEvents = (ta_trace_event*)ma_malloc(TA_TRACE_THREAD_EVENTS * sizeof(ta_trace_event), NULL);
+        if (!pEvents) {
+            break;      /* Fewer threads can record */
+        }
+        memset(pEvents, 0, TA_TRACE_THREAD_EVENTS * sizeof(ta_trace_event));
+        g_taTrace.slots[i].pEvents = pEvents;
+    }
+    ma_atomic_store_explicit_32(&g_taTrace.ready, 2, ma_atomic_memory_order_release);
+}
+
+/* After the owner's threads have been joined: their buffers go back to the pool once written out */
+static void ta_trace_retire(const void* owner) {
+    for (ma_uint32 i = 0; i < TA_TRACE_MAX_THREADS; i++) {
+        ta_trace_slot* pSlot = &g_taTrace.slots[i];
+        if (ma_atomic_load_explicit_32(&pSlot->state, ma_atomic_memory_order_acquire) == TA_TRACE_SLOT_CLAIMED &&
+            pSlot->owner == owner) {
+            ma_atomic_store_explicit_32(&pSlot->state, TA_TRACE_SLOT_RETIRED, ma_atomic_memory_order_release);
+        }
+    }
+}
+
+/* ==== PROBES (ANY THREAD) ==== */
+
+static ma_uint64 ta_trace_os_thread_id(void) {
+#if defined(_WIN32)
+    return (ma_uint64)GetCurrentThreadId();
+#elif defined(__linux__)
+    return (ma_uint64)syscall(SYS_gettid);
+#else
+    return (ma_uint64)(size_t)pthread_self();
+#endif
+}
+
+static ma_uint64 ta_trace_os_process_id(void) {
+#if defined(_WIN32)
+    return (ma_uint64)GetCurrentProcessId();
+#else
+    return (ma_uint64)getpid();
+#endif
+}
+
+/* Once per thread: take a free buffer (or record nothing if there is none) */
+static MA_NO_INLINE ta_trace_slot* ta_trace_claim(const char* name, const void* owner) {
+    if (ma_atomic_load_explicit_32(&g_taTrace.ready, ma_atomic_memory_order_acquire) != 2) {
+        return NULL;    /* Before the first Initialize: try again on the next probe */
+    }
+
+    for (ma_uint32 i = 0; i < TA_TRACE_MAX_THREADS; i++) {
+        ta_trace_slot* pSlot = &g_taTrace.slots[i];
+        ma_uint32 state = TA_TRACE_SLOT_FREE;
+        if (!pSlot->pEvents || !ma_atomic_compare_exchange_strong_explicit_32(&pSlot->state, &state,
+                TA_TRACE_SLOT_CLAIMING, ma_atomic_memory_order_acquire, ma_atomic_memory_order_relaxed)) {
+            continue;
+        }
+        pSlot->owner = owner;
+        pSlot->threadId = ta_trace_os_thread_id();
+        if (name) {
+            snprintf(pSlot->name, sizeof(pSlot->name), "%s", name);
+        } else {
+            snprintf(pSlot->name, sizeof(pSlot->name), "thread %llu", (unsigned long long)pSlot->threadId);
+        }
+        ma_atomic_store_explicit_32(&pSlot->state, TA_TRACE_SLOT_CLAIMED, ma_atomic_memory_order_release);
+        g_taTraceSlot = pSlot;
+        return pSlot;
+    }
+
+    g_taTraceSlot = &g_taTraceNoSlot;
+    return &g_taTraceNoSlot;
+}
+
+static MA_INLINE void ta_trace_thread(const char* name, const void* owner) {
+    if (!g_taTraceSlot) {
+        ta_trace_claim(name, owner);
+    }
+}
+
+static MA_INLINE void ta_trace_emit(ma_uint32 type, const char* name, double value) {
+    ta_trace_slot* pSlot = g_taTraceSlot;
+    if (!pSlot) {
+        pSlot = ta_trace_claim(NULL, NULL);
+        if (!pSlot) {
+            return;
+        }
+    }
+    if (pSlot == &g_taTraceNoSlot) {
+        ma_atomic_fetch_add_explicit_64(&g_taTrace.droppedCount, 1, ma_atomic_memory_order_relaxed);
+        return;
+    }
+
+    ma_uint64 writeCount = pSlot->writeCount;
+    if (writeCount - ma_atomic_load_explicit_64(&pSlot->readCount, ma_atomic_memory_order_acquire) >= TA_TRACE_THREAD_EVENTS) {
+        ma_atomic_fetch_add_explicit_64(&g_taTrace.droppedCount, 1, ma_atomic_memory_order_relaxed);
+        return;
+    }
+
+    ta_trace_event* pEvent = &pSlot->pEvents[writeCount & (TA_TRACE_THREAD_EVENTS - 1)];
+    pEvent->timeNs = ta_timing_now_ns();
+    pEvent->name = name;
+    pEvent->value = value;
+    pEvent->type = type;
+    ma_atomic_store_explicit_64(&pSlot->writeCount, writeCount + 1, ma_atomic_memory_order_release);
+}
+
+#define TA_TRACE_BEGIN(name)            ta_trace_emit(TA_TRACE_EVENT_BEGIN, (name), 0.0)
+#define TA_TRACE_END()                  ta_trace_emit(TA_TRACE_EVENT_END, NULL, 0.0)
+#define TA_TRACE_COUNTER(name, value)   ta_trace_emit(TA_TRACE_EVENT_COUNTER, (name), (double)(value))
+#define TA_TRACE_THREAD(name, owner)    ta_trace_thread((name), (owner))
+#define TA_TRACE_INIT()                 ta_trace_init()
+#define TA_TRACE_RETIRE(owner)          ta_trace_retire(owner)
+
+/* ==== WRITER (CONTROL THREAD) ==== */
+
+static FILE* ta_trace_fopen(const wchar_t* path) {
+#if defined(_WIN32)
+    return _wfopen(path, L"wb");
+#else
+    char narrow[TA_TRACE_PATH_LENGTH];
+    if (wcstombs(narrow, path, sizeof(narrow)) == (size_t)-1) {
+        return NULL;
+    }
+    narrow[sizeof(narrow) - 1] = '\0';
+    return fopen(narrow, "wb");
+#endif
+}
+
+/* Counter names seen in this write; a counter's track is its index */
+typedef struct {
+    const char* names[TA_TRACE_MAX_COUNTERS];
+    ma_uint32 count;
+} ta_trace_counters;
+
+static ma_uint32 ta_trace_counter_index(ta_trace_counters* pCounters, const char* name) {
+    for (ma_uint32 i = 0; i < pCounters->count; i++) {
+        if (pCounters->names[i] == name || strcmp(pCounters->names[i], name) == 0) {
+            return i;
+        }
+    }
+    if (pCounters->count == TA_TRACE_MAX_COUNTERS) {
+        return TA_TRACE_MAX_COUNTERS - 1;   /* Overflow shares the last track */
+    }
+    pCounters->names[pCounters->count] = name;
+    return pCounters->count++;
+}
+
+/* JSON string body: quotes, backslashes and control characters escaped */
+static void ta_trace_json_string(FILE* pFile, const char* text) {
+    fputc('"', pFile);
+    for (const char* p = text; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', pFile);
+            fputc(*p, pFile);
+        } else if ((unsigned char)*p < 0x20) {
+            fprintf(pFile, "\\u%04x", (unsigned int)(unsigned char)*p);
+        } else {
+            fputc(*p, pFile);
+        }
+    }
+    fputc('"', pFile);
+}
+
+/* Chrome trace event format: one metadata event per thread, then the events */
+static void ta_trace_write_json(FILE* pFile, const ma_uint64* pEnd, ma_uint64 pid) {
+    fprintf(pFile, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(pFile, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%llu,\"args\":{\"name\":\"TransparencyAudio\"}}",
+        (unsigned long long)pid);
+
+    for (ma_uint32 i = 0; i < TA_TRACE_MAX_THREADS; i++) {
+        ta_trace_slot* pSlot = &g_taTrace.slots[i];
+        if (pEnd[i] == pSlot->readCount) {
+            continue;
+        }
+        fprintf(pFile, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%llu,\"tid\":%llu,\"args\":{\"name\":",
+            (unsigned long long)pid, (unsigned long long)pSlot->threadId);
+        ta_trace_json_string(pFile, pSlot->name);
+        fprintf(pFile, "}}");
+
+        for (ma_uint64 n = pSlot->readCount; n < pEnd[i]; n++) {
+            const ta_trace_event* pEvent = &pSlot->pEvents[n & (TA_TRACE_THREAD_EVENTS - 1)];
+            double us = (double)pEvent->timeNs * 1e-3;
+            fprintf(pFile, ",\n{\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%llu,\"tid\":%llu",
+                pEvent->type == TA_TRACE_EVENT_BEGIN ? 'B' : (pEvent->type == TA_TRACE_EVENT_END ? 'E' : 'C'),
+                us, (unsigned long long)pid, (unsigned long long)pSlot->threadId);
+            if (pEvent->name) {
+                fprintf(pFile, ",\"name\":");
+                ta_trace_json_string(pFile, pEvent->name);
+            }
+            if (pEvent->type == TA_TRACE_EVENT_COUNTER) {
+                fprintf(pFile, ",\"args\":{\"value\":%.9g}", pEvent->value);
+            }
+            fprintf(pFile, "}");
+        }
+    }
+
+    fprintf(pFile, "\n],\"otherData\":{\"droppedEvents\":%llu}}\n",
+        (unsigned long long)ma_atomic_load_explicit_64(&g_taTrace.droppedCount, ma_atomic_memory_order_relaxed));
+}
+
+/*
+ * PERFETTO: a Trace message is a sequence of TracePacket (field 1), each
+ * written as one length-delimited record. Only the fields used here:
+ *   TracePacket     timestamp 8, trusted_packet_sequence_id 10,
+ *                   track_event 11, sequence_flags 13, track_descriptor 60
+ *   TrackEvent      type 9, track_uuid 11, name 23, double_counter_value 44
+ *   TrackDescriptor uuid 1, name 2, process 3, thread 4, parent_uuid 5, counter 8
+ *   ProcessDescriptor pid 1, process_name 6
+ *   ThreadDescriptor  pid 1, tid 2, thread_name 5
+ */
+#define TA_PB_VARINT        0
+#define TA_PB_FIXED64       1
+#define TA_PB_BYTES         2
+
+typedef struct {
+    ma_uint8 data[256];
+    size_t size;
+} ta_pb;
+
+static void ta_pb_varint(ta_pb* pBuffer, ma_uint64 value) {
+    while (pBuffer->size < sizeof(pBuffer->data)) {
+        ma_uint8 byte = (ma_uint8)(value & 0x7F);
+        value >>= 7;
+        pBuffer->data[pBuffer->size++] = byte | (value ? 0x80 : 0);
+        if (!value) {
+            break;
+        }
+    }
+}
+
+static void ta_pb_uint(ta_pb* pBuffer, ma_uint32 field, ma_uint64 value) {
+    ta_pb_varint(pBuffer, ((ma_uint64)field << 3) | TA_PB_VARINT);
+    ta_pb_varint(pBuffer, value);
+}
+
+static void ta_pb_double(ta_pb* pBuffer, ma_uint32 field, double value) {
+    ma_uint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    ta_pb_varint(pBuffer, ((ma_uint64)field << 3) | TA_PB_FIXED64);
+    for (ma_uint32 i = 0; i < 8 && pBuffer->size < sizeof(pBuffer->data); i++) {
+        pBuffer->data[pBuffer->size++] = (ma_uint8)(bits >> (i * 8));    /* Little-endian */
+    }
+}
+
+static void ta_pb_bytes(ta_pb* pBuffer, ma_uint32 field, const void* pData, size_t size) {
+    ta_pb_varint(pBuffer, ((ma_uint64)field << 3) | TA_PB_BYTES);
+    ta_pb_varint(pBuffer, size);
+    if (size > sizeof(pBuffer->data) - pBuffer->size) {
+        size = sizeof(pBuffer->data) - pBuffer->size;
+    }
+    memcpy(pBuffer->data + pBuffer->size, pData, size);
+    pBuffer->size += size;
+}
+
+static void ta_pb_string(ta_pb* pBuffer, ma_uint32 field, const char* text) {
+    ta_pb_bytes(pBuffer, field, text, strlen(text));
+}
+
+static void ta_pb_message(ta_pb* pBuffer, ma_uint32 field, const ta_pb* pMessage) {
+    ta_pb_bytes(pBuffer, field, pMessage->data, pMessage->size);
+}
+
+/* Append one TracePacket (sequence 1) as Trace.packet */
+static void ta_pb_write_packet(FILE* pFile, ta_pb* pPacket) {
+    ta_pb record;
+    record.size = 0;
+    ta_pb_uint(pPacket, 10, 1);     /* trusted_packet_sequence_id */
+    ta_pb_message(&record, 1, pPacket);
+    fwrite(record.data, 1, record.size, pFile);
+}
+
+static void ta_pb_write_descriptor(FILE* pFile, ma_uint64 uuid, ma_uint32 kind, const ta_pb* pInner,
+    const char* name, int first) {
+    ta_pb descriptor, packet;
+    descriptor.size = 0;
+    packet.size = 0;
+
+    ta_pb_uint(&descriptor, 1, uuid);
+    if (name) {
+        ta_pb_string(&descriptor, 2, name);
+        ta_pb_uint(&descriptor, 5, TA_TRACE_PROCESS_UUID);     /* parent_uuid */
+    }
+    ta_pb_message(&descriptor, kind, pInner);
+
+    if (first) {
+        ta_pb_uint(&packet, 13, 1);     /* SEQ_INCREMENTAL_STATE_CLEARED */
+    }
+    ta_pb_message(&packet, 60, &descriptor);
+    ta_pb_write_packet(pFile, &packet);
+}
+
+static void ta_trace_write_perfetto(FILE* pFile, const ma_uint64* pEnd, ma_uint64 pid) {
+    ta_trace_counters counters;
+    ta_pb inner;
+    memset(&counters, 0, sizeof(counters));
+
+    /* Tracks first: the process, each thread, each counter */
+    inner.size = 0;
+    ta_pb_uint(&inner, 1, pid);
+    ta_pb_string(&inner, 6, "TransparencyAudio");
+    ta_pb_write_descriptor(pFile, TA_TRACE_PROCESS_UUID, 3, &inner, NULL, 1);
+
+    for (ma_uint32 i = 0; i < TA_TRACE_MAX_THREADS; i++) {
+        ta_trace_slot* pSlot = &g_taTrace.slots[i];
+        if (pEnd[i] == pSlot->readCount) {
+            continue;
+        }
+        inner.size = 0;
+        ta_pb_uint(&inner, 1, pid);
+        ta_pb_uint(&inner, 2, pSlot->threadId);
+        ta_pb_string(&inner, 5, pSlot->name);
+        ta_pb_write_descriptor(pFile, TA_TRACE_THREAD_UUID + i, 4, &inner, NULL, 0);
+
+        for (ma_uint64 n = pSlot->readCount; n < pEnd[i]; n++) {
+            const ta_trace_event* pEvent = &pSlot->pEvents[n & (TA_TRACE_THREAD_EVENTS - 1)];
+            if (pEvent->type == TA_TRACE_EVENT_COUNTER) {
+                ta_trace_counter_index(&counters, pEvent->name);
+            }
+        }
+    }
+    for (ma_uint32 c = 0; c < counters.count; c++) {
+        inner.size = 0;     /* Empty CounterDescriptor: unitless */
+        ta_pb_write_descriptor(pFile, TA_TRACE_COUNTER_UUID + c, 8, &inner, counters.names[c], 0);
+    }
+
+    /* Events, each on its thread's track or its counter's */
+    for (ma_uint32 i = 0; i < TA_TRACE_MAX_THREADS; i++) {
+        ta_trace_slot* pSlot = &g_taTrace.slots[i];
+        for (ma_uint64 n = pSlot->readCount; n < pEnd[i]; n++) {
+            const ta_trace_event* pEvent = &pSlot->pEvents[n & (TA_TRACE_THREAD_EVENTS - 1)];
+            ta_pb event, packet;
+            event.size = 0;
+            packet.size = 0;
+
+            if (pEvent->type == TA_TRACE_EVENT_COUNTER) {
+                ta_pb_uint(&event, 9, 4);       /* TYPE_COUNTER */
+                ta_pb_uint(&event, 11, TA_TRACE_COUNTER_UUID + ta_trace_counter_index(&counters, pEvent->name));
+                ta_pb_double(&event, 44, pEvent->value);
+            } else {
+                ta_pb_uint(&event, 9, pEvent->type == TA_TRACE_EVENT_BEGIN ? 1 : 2);   /* TYPE_SLICE_BEGIN/END */
+                ta_pb_uint(&event, 11, TA_TRACE_THREAD_UUID + i);
+                if (pEvent->name) {
+                    ta_pb_string(&event, 23, pEvent->name);
+                }
+            }
+
+            ta_pb_uint(&packet, 8, pEvent->timeNs);
+            ta_pb_message(&packet, 11, &event);
+            ta_pb_write_packet(pFile, &packet);
+        }
+    }
+}
+
+/*
+ * Write every buffered event to path and empty the buffers. Events
+ * recorded while this runs go to the next write.
+ */
+static ma_result ta_trace_write_file(const wchar_t* path, int perfetto) {
+    ma_uint32 idle = 0;
+    if (!ma_atomic_compare_exchange_strong_explicit_32(&g_taTrace.writing, &idle, 1,
+            ma_atomic_memory_order_acquire, ma_atomic_memory_order_relaxed)) {
+        return MA_BUSY;
+    }
+
+    FILE* pFile = ta_trace_fopen(path);
+    if (!pFile) {
+        ma_atomic_store_explicit_32(&g_taTrace.writing, 0, ma_atomic_memory_order_release);
+        return MA_ACCESS_DENIED;
+    }
+
+    /* Each buffer up to here; the threads keep appending behind it */
+    ma_uint64 end[TA_TRACE_MAX_THREADS];
+    ma_uint32 states[TA_TRACE_MAX_THREADS];
+    for (ma_uint32 i = 0; i < TA_TRACE_MAX_THREADS; i++) {
+        ta_trace_slot* pSlot = &g_taTrace.slots[i];
+        states[i] = ma_atomic_load_explicit_32(&pSlot->state, ma_atomic_memory_order_acquire);
+        end[i] = (states[i] == TA_TRACE_SLOT_FREE || states[i] == TA_TRACE_SLOT_CLAIMING) ? pSlot->readCount
+            : ma_atomic_load_explicit_64(&pSlot->writeCount, ma_atomic_memory_order_acquire);
+    }
+
+    ma_uint64 pid = ta_trace_os_process_id();
+    if (perfetto) {
+        ta_trace_write_perfetto(pFile, end, pid);
+    } else {
+        ta_trace_write_json(pFile, end, pid);
+    }
+    int ok = !ferror(pFile);
+    ok = (fclose(pFile) == 0) && ok;
+
+    /* Hand the space back; retired buffers return to the pool */
+    for (ma_uint32 i = 0; i < TA_TRACE_MAX_THREADS; i++) {
+        ta_trace_slot* pSlot = &g_taTrace.slots[i];
+        ma_atomic_store_explicit_64(&pSlot->readCount, end[i], ma_atomic_memory_order_release);
+        if (states[i] == TA_TRACE_SLOT_RETIRED) {
+            ma_atomic_store_explicit_32(&pSlot->state, TA_TRACE_SLOT_FREE, ma_atomic_memory_order_release);
+        }
+    }
+    ma_atomic_store_explicit_32(&g_taTrace.writing, 0, ma_atomic_memory_order_release);
+    return ok ? MA_SUCCESS : MA_IO_ERROR;
+}
+
+#else /* !TA_ENABLE_TRACE */
+
+#define TA_TRACE_BEGIN(name)            ((void)0)
+#define TA_TRACE_END()                  ((void)0)
+#define TA_TRACE_COUNTER(name, value)   ((void)0)
+#define TA_TRACE_THREAD(name, owner)    ((void)0)
+#define TA_TRACE_INIT()                 ((void)0)
+#define TA_TRACE_RETIRE(owner)          ((void)0)
+
+#endif /* TA_ENABLE_TRACE */
+
+#endif /* TA_TRACE_H */
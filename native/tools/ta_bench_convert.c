@@ -0,0 +1,205 @@
+/*
+ * ==============================================================================
+ * ta_bench_convert.c - Integer device formats: Miniaudio's path vs direct
+ * ==============================================================================
+ * Times what one callback does to move an integer-format device buffer in
+ * or out of the float route, both ways the engine could do it:
+ *
+ *   capture   miniaudio  ma_pcm_convert into an f32 intermediate (what the
+ *                        device does when opened as f32 over an integer
+ *                        endpoint), then the gain/copy pass into the ring
+ *             direct     one conversion kernel straight into the ring
+ *                        (gain pass skipped at unity, in place otherwise)
+ *   playback  miniaudio  the route writes f32, ma_pcm_convert turns it
+ *                        into the device format (triangle dither for S16/S24)
+ *             direct     the route writes f32 scratch, one conversion
+ *                        kernel (TPDF dither for S16/S24) into the device
+ *
+ * Reports ns/frame at stereo for S16, packed S24 and S32, at unity and at
+ * 0.5 gain, with the kernels this CPU dispatches to.
+ *
+ * BUILD (MSVC, from native/):
+ *   cl /O2 /I. tools\ta_bench_convert.c /Fe:ta_bench_convert.exe
+ *
+ * BUILD (GCC/Clang):
+ *   gcc -O2 -I. tools/ta_bench_convert.c -o ta_bench_convert -lpthread -lm -ldl
+ *
+ * USAGE:
+ *   ta_bench_convert [blockFrames] [channels]
+ * ==============================================================================
+ */
+
+#define MINIAUDIO_IMPLEMENTATION
+#define MA_NO_DECODING
+#define MA_NO_ENCODING
+#define MA_NO_GENERATION
+#define MA_NO_RESOURCE_MANAGER
+#define MA_NO_NODE_GRAPH
+#define MA_NO_ENGINE
+
+#include "miniaudio.h"
+#include "ta_kernels.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_TOTAL_FRAMES      (48000u * 60u)     /* 1 minute of audio @ 48kHz per measurement */
+
+typedef enum {
+    PATH_MINIAUDIO = 0,
+    PATH_DIRECT
+} bench_path;
+
+typedef struct {
+    const ta_kernels* pKernels;
+    ma_format format;
+    ma_uint32 channels;
+    ma_uint32 blockFrames;
+    float gain;
+    void* pDevice;          /* Device-format buffer */
+    float* pFloat;          /* Miniaudio's f32 intermediate / the playback scratch */
+    float* pRing;           /* Ring span the capture side writes */
+    ta_dither dither;
+} bench_state;
+
+typedef void (*to_float_proc)(float* pDst, const void* pSrc, ma_uint32 count);
+typedef void (*from_float_proc)(void* pDst, const float* pSrc, ma_uint32 count, ta_dither* pDither);
+
+static volatile float g_sink;
+
+static to_float_proc to_float(const ta_kernels* pKernels, ma_format format) {
+    switch (format) {
+        case ma_format_s16: return pKernels->s16_to_f32;
+        case ma_format_s24: return pKernels->s24_to_f32;
+        default:            return pKernels->s32_to_f32;
+    }
+}
+
+static from_float_proc from_float(const ta_kernels* pKernels, ma_format format) {
+    switch (format) {
+        case ma_format_s16: return pKernels->f32_to_s16;
+        case ma_format_s24: return pKernels->f32_to_s24;
+        default:            return pKernels->f32_to_s32;
+    }
+}
+
+/* Route gain pass the way ta_gain_process runs once settled */
+static void apply_gain(const ta_kernels* pKernels, float* pDst, const float* pSrc, ma_uint32 count, float gain) {
+    if (gain == 1.0f) {
+        if (pDst != pSrc) {
+            pKernels->copy(pDst, pSrc, count);
+        }
+    } else {
+        pKernels->gain(pDst, pSrc, count, gain);
+    }
+}
+
+static void capture_block(bench_state* pState, bench_path path) {
+    ma_uint32 count = pState->blockFrames * pState->channels;
+
+    if (path == PATH_MINIAUDIO) {
+        ma_pcm_convert(pState->pFloat, ma_format_f32, pState->pDevice, pState->format, count, ma_dither_mode_none);
+        apply_gain(pState->pKernels, pState->pRing, pState->pFloat, count, pState->gain);
+    } else {
+        to_float(pState->pKernels, pState->format)(pState->pRing, pState->pDevice, count);
+        apply_gain(pState->pKernels, pState->pRing, pState->pRing, count, pState->gain);
+    }
+}
+
+static void playback_block(bench_state* pState, bench_path path) {
+    ma_uint32 count = pState->blockFrames * pState->channels;
+    int dither = (pState->format == ma_format_s16 || pState->format == ma_format_s24);
+
+    /* Both paths render the route's output into f32 first */
+    apply_gain(pState->pKernels, pState->pFloat, pState->pRing, count, pState->gain);
+
+    if (path == PATH_MINIAUDIO) {
+        ma_pcm_convert(pState->pDevice, pState->format, pState->pFloat, ma_format_f32, count,
+            dither ? ma_dither_mode_triangle : ma_dither_mode_none);
+    } else {
+        from_float(pState->pKernels, pState->format)(pState->pDevice, pState->pFloat, count,
+            dither ? &pState->dither : NULL);
+    }
+}
+
+static double run(bench_state* pState, int playback, bench_path path) {
+    ma_uint32 blocks = BENCH_TOTAL_FRAMES / pState->blockFrames;
+    ma_timer timer;
+
+    ma_timer_init(&timer);
+    double start = ma_timer_get_time_in_seconds(&timer);
+
+    for (ma_uint32 b = 0; b < blocks; b++) {
+        if (playback) {
+            playback_block(pState, path);
+        } else {
+            capture_block(pState, path);
+        }
+    }
+
+    double elapsed = ma_timer_get_time_in_seconds(&timer) - start;
+    g_sink = pState->pRing[0] + pState->pFloat[0];
+    return elapsed * 1e9 / ((double)blocks * pState->blockFrames);
+}
+
+int main(int argc, char** argv) {
+    static const ma_format formats[] = { ma_format_s16, ma_format_s24, ma_format_s32 };
+    static const char* formatNames[] = { "s16", "s24", "s32" };
+    static const float gains[] = { 1.0f, 0.5f };
+    ma_uint32 blockFrames = (argc > 1) ? (ma_uint32)atoi(argv[1]) : 128;
+    ma_uint32 channels = (argc > 2) ? (ma_uint32)atoi(argv[2]) : 2;
+    ta_kernels kernels;
+    bench_state state;
+
+    if (blockFrames == 0 || channels == 0) {
+        fprintf(stderr, "usage: ta_bench_convert [blockFrames] [channels]\n");
+        return 1;
+    }
+
+    ta_kernels_init(&kernels);
+    printf("format conversion: %u-frame blocks, %u channels, %s kernels\n\n",
+        blockFrames, channels, kernels.name);
+
+    size_t samples = (size_t)blockFrames * channels;
+    memset(&state, 0, sizeof(state));
+    state.pKernels = &kernels;
+    state.channels = channels;
+    state.blockFrames = blockFrames;
+    state.pDevice = ma_aligned_malloc(samples * sizeof(ma_int32), 64, NULL);
+    state.pFloat = (float*)ma_aligned_malloc(samples * sizeof(float), 64, NULL);
+    state.pRing = (float*)ma_aligned_malloc(samples * sizeof(float), 64, NULL);
+    if (!state.pDevice || !state.pFloat || !state.pRing) {
+        return 1;
+    }
+    ta_dither_init(&state.dither, 1);
+
+    /* -20dBFS 997Hz, so the playback side converts realistic values */
+    for (size_t i = 0; i < samples; i++) {
+        state.pRing[i] = 0.1f * (float)sin(2.0 * MA_PI_D * 997.0 * (double)(i / channels) / 48000.0);
+    }
+
+    printf("%-9s %-4s %5s %10s %10s %8s   (ns/frame)\n", "path", "fmt", "gain", "miniaudio", "direct", "saving");
+
+    for (int playback = 0; playback < 2; playback++) {
+        for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+            for (size_t g = 0; g < sizeof(gains) / sizeof(gains[0]); g++) {
+                state.format = formats[f];
+                state.gain = gains[g];
+
+                /* Valid device data for the capture side */
+                from_float(&kernels, state.format)(state.pDevice, state.pRing, (ma_uint32)samples, NULL);
+
+                double miniaudioNs = run(&state, playback, PATH_MINIAUDIO);
+                double directNs = run(&state, playback, PATH_DIRECT);
+                printf("%-9s %-4s %5.1f %10.3f %10.3f %7.0f%%\n",
+                    playback ? "playback" : "capture", formatNames[f], state.gain,
+                    miniaudioNs, directNs, miniaudioNs > 0.0 ? (1.0 - directNs / miniaudioNs) * 100.0 : 0.0);
+            }
+        }
+    }
+
+    ma_aligned_free(state.pDevice, NULL);
+    ma_aligned_free(state.pFloat, NULL);
+    ma_aligned_free(state.pRing, NULL);
+    return 0;
+}
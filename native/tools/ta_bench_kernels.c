@@ -0,0 +1,400 @@
+/*
+ * ==============================================================================
+ * ta_bench_kernels.c - Verify and benchmark the SIMD sample kernels
+ * ==============================================================================
+ * For every kernel variant this CPU can run (scalar, SSE2, AVX2, AVX-512F,
+ * NEON):
+ *   1. checks it is bit-exact against the scalar reference over odd sizes,
+ *      unaligned pointers and channel counts 1..20 (fill_frame, gain_ramp),
+ *      and that it never writes past the end of its buffer; the integer
+ *      conversions are checked byte for byte, with and without dither, and
+ *      S16/S24 -> float -> S16/S24 must round-trip losslessly
+ *   2. reports ns/frame for each kernel at 1, 2 and 8 channels, moving
+ *      callback-sized (128-frame) blocks like the engine does
+ * Exits non-zero if any variant disagrees with the reference.
+ *
+ * BUILD (MSVC, from native/):
+ *   cl /O2 /I. tools\ta_bench_kernels.c /Fe:ta_bench_kernels.exe
+ *
+ * BUILD (GCC/Clang):
+ *   gcc -O2 -I. tools/ta_bench_kernels.c -o ta_bench_kernels -lpthread -lm -ldl
+ *
+ * USAGE:
+ *   ta_bench_kernels [blockFrames]
+ * ==============================================================================
+ */
+
+#define MINIAUDIO_IMPLEMENTATION
+#define MA_NO_DECODING
+#define MA_NO_ENCODING
+#define MA_NO_GENERATION
+#define MA_NO_RESOURCE_MANAGER
+#define MA_NO_NODE_GRAPH
+#define MA_NO_ENGINE
+
+#include "miniaudio.h"
+#include "ta_kernels.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_TOTAL_FRAMES      (48000u * 60u)     /* 1 minute of audio @ 48kHz per measurement */
+#define VERIFY_MAX_SAMPLES      261
+#define VERIFY_MAX_CHANNELS     100     /* Past TA_KERNEL_FILL_PATTERN_MAX: exercises the scalar fallback */
+#define VERIFY_GUARD            16
+#define VERIFY_SENTINEL         12345.0f
+
+static const ma_uint32 g_benchChannels[] = { 1, 2, 8 };
+
+static ma_uint32 g_rng = 0x9E3779B9u;
+
+static float random_sample(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    /* Mostly audio-range values, with a few large ones to exercise the peak */
+    float value = ((float)(g_rng & 0xFFFFFF) / (float)0x800000) - 1.0f;
+    return ((g_rng >> 24) == 0) ? value * 1000.0f : value;
+}
+
+static void fill_random(float* pBuffer, ma_uint32 count) {
+    for (ma_uint32 i = 0; i < count; i++) {
+        pBuffer[i] = random_sample();
+    }
+}
+
+static int same_bits(const float* a, const float* b, ma_uint32 count) {
+    return memcmp(a, b, (size_t)count * sizeof(float)) == 0;
+}
+
+/* ==============================================================================
+ * VERIFICATION
+ * ============================================================================== */
+
+static int verify(const ta_kernels* pReference, const ta_kernels* pKernels) {
+    float src[VERIFY_MAX_SAMPLES + 4];
+    float expected[VERIFY_MAX_SAMPLES + VERIFY_GUARD + 4];
+    float actual[VERIFY_MAX_SAMPLES + VERIFY_GUARD + 4];
+    float frame[VERIFY_MAX_CHANNELS];
+    int failures = 0;
+
+    for (ma_uint32 misalign = 0; misalign < 4; misalign++) {
+        for (ma_uint32 count = 0; count <= VERIFY_MAX_SAMPLES; count++) {
+            float* pSrc = src + misalign;
+            float* pExpected = expected + misalign;
+            float* pActual = actual + misalign;
+            float gain = random_sample();
+
+            fill_random(pSrc, count);
+            for (ma_uint32 i = 0; i < count + VERIFY_GUARD; i++) {
+                pExpected[i] = VERIFY_SENTINEL;
+                pActual[i] = VERIFY_SENTINEL;
+            }
+
+            pReference->gain(pExpected, pSrc, count, gain);
+            pKernels->gain(pActual, pSrc, count, gain);
+            if (!same_bits(pExpected, pActual, count + VERIFY_GUARD)) {
+                printf("  MISMATCH gain count=%u misalign=%u\n", count, misalign);
+                failures++;
+            }
+
+            pReference->copy(pExpected, pSrc, count);
+            pKernels->copy(pActual, pSrc, count);
+            if (!same_bits(pExpected, pActual, count + VERIFY_GUARD)) {
+                printf("  MISMATCH copy count=%u misalign=%u\n", count, misalign);
+                failures++;
+            }
+
+            /* Mix on top of identical random destinations */
+            fill_random(pExpected, count);
+            memcpy(pActual, pExpected, (size_t)count * sizeof(float));
+            pReference->mix(pExpected, pSrc, count, gain);
+            pKernels->mix(pActual, pSrc, count, gain);
+            if (!same_bits(pExpected, pActual, count + VERIFY_GUARD)) {
+                printf("  MISMATCH mix count=%u misalign=%u\n", count, misalign);
+                failures++;
+            }
+
+            float peakExpected = pReference->peak(pSrc, count);
+            float peakActual = pKernels->peak(pSrc, count);
+            float rmsPeakExpected, rmsPeakActual, sumExpected, sumActual;
+            pReference->peak_rms(pSrc, count, &rmsPeakExpected, &sumExpected);
+            pKernels->peak_rms(pSrc, count, &rmsPeakActual, &sumActual);
+            if (!same_bits(&peakExpected, &peakActual, 1) ||
+                !same_bits(&rmsPeakExpected, &rmsPeakActual, 1) ||
+                !same_bits(&sumExpected, &sumActual, 1)) {
+                printf("  MISMATCH peak/peak_rms count=%u misalign=%u\n", count, misalign);
+                failures++;
+            }
+
+            /* Overlapping operands, one frame apart as in the splice search */
+            ma_uint32 offset = 1 + misalign;
+            if (count >= offset) {
+                float energyExpected = pReference->diff_energy(pSrc + offset, pSrc, count - offset);
+                float energyActual = pKernels->diff_energy(pSrc + offset, pSrc, count - offset);
+                if (!same_bits(&energyExpected, &energyActual, 1)) {
+                    printf("  MISMATCH diff_energy count=%u misalign=%u\n", count, misalign);
+                    failures++;
+                }
+            }
+        }
+    }
+
+    for (ma_uint32 channels = 1; channels <= VERIFY_MAX_CHANNELS; channels++) {
+        for (ma_uint32 frames = 0; frames * channels <= VERIFY_MAX_SAMPLES; frames++) {
+            ma_uint32 count = frames * channels;
+            fill_random(frame, channels);
+            for (ma_uint32 i = 0; i < count + VERIFY_GUARD; i++) {
+                expected[i + 1] = VERIFY_SENTINEL;
+                actual[i + 1] = VERIFY_SENTINEL;
+            }
+            pReference->fill_frame(expected + 1, frame, channels, frames);
+            pKernels->fill_frame(actual + 1, frame, channels, frames);
+            if (!same_bits(expected + 1, actual + 1, count + VERIFY_GUARD)) {
+                printf("  MISMATCH fill_frame channels=%u frames=%u\n", channels, frames);
+                failures++;
+            }
+
+            /* Ramp from a random gain with a step that may flip sign mid-block */
+            float gainStart = random_sample();
+            float gainStep = random_sample() * 0.01f;
+            fill_random(src + 3, count);
+            for (ma_uint32 i = 0; i < count + VERIFY_GUARD; i++) {
+                expected[i + 1] = VERIFY_SENTINEL;
+                actual[i + 1] = VERIFY_SENTINEL;
+            }
+            pReference->gain_ramp(expected + 1, src + 3, channels, frames, gainStart, gainStep);
+            pKernels->gain_ramp(actual + 1, src + 3, channels, frames, gainStart, gainStep);
+            if (!same_bits(expected + 1, actual + 1, count + VERIFY_GUARD)) {
+                printf("  MISMATCH gain_ramp channels=%u frames=%u\n", channels, frames);
+                failures++;
+            }
+        }
+    }
+
+    return failures;
+}
+
+static void fill_random_bytes(ma_uint8* pBuffer, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        g_rng ^= g_rng << 13;
+        g_rng ^= g_rng >> 17;
+        g_rng ^= g_rng << 5;
+        pBuffer[i] = (ma_uint8)(g_rng >> 11);
+    }
+}
+
+static int verify_convert(const ta_kernels* pReference, const ta_kernels* pKernels) {
+    static const char* names[3] = { "s16", "s24", "s32" };
+    static const size_t sampleBytes[3] = { 2, 3, 4 };
+    void (*toFloat[2][3])(float*, const void*, ma_uint32) = {
+        { pReference->s16_to_f32, pReference->s24_to_f32, pReference->s32_to_f32 },
+        { pKernels->s16_to_f32, pKernels->s24_to_f32, pKernels->s32_to_f32 }
+    };
+    void (*fromFloat[2][3])(void*, const float*, ma_uint32, ta_dither*) = {
+        { pReference->f32_to_s16, pReference->f32_to_s24, pReference->f32_to_s32 },
+        { pKernels->f32_to_s16, pKernels->f32_to_s24, pKernels->f32_to_s32 }
+    };
+    ma_uint8 pcm[(VERIFY_MAX_SAMPLES + VERIFY_GUARD) * 4 + 4];
+    ma_uint8 pcmExpected[(VERIFY_MAX_SAMPLES + VERIFY_GUARD) * 4 + 4];
+    ma_uint8 pcmActual[(VERIFY_MAX_SAMPLES + VERIFY_GUARD) * 4 + 4];
+    float src[VERIFY_MAX_SAMPLES + 4];
+    float expected[VERIFY_MAX_SAMPLES + VERIFY_GUARD + 4];
+    float actual[VERIFY_MAX_SAMPLES + VERIFY_GUARD + 4];
+    int failures = 0;
+
+    for (int format = 0; format < 3; format++) {
+        size_t bytes = sampleBytes[format];
+        for (ma_uint32 misalign = 0; misalign < 4; misalign++) {
+            for (ma_uint32 count = 0; count <= VERIFY_MAX_SAMPLES; count++) {
+                size_t used = (size_t)count * bytes;
+                size_t guard = (size_t)VERIFY_GUARD * bytes;
+
+                /* Integer -> float */
+                fill_random_bytes(pcm + misalign, used);
+                for (ma_uint32 i = 0; i < count + VERIFY_GUARD; i++) {
+                    expected[i + misalign] = VERIFY_SENTINEL;
+                    actual[i + misalign] = VERIFY_SENTINEL;
+                }
+                toFloat[0][format](expected + misalign, pcm + misalign, count);
+                toFloat[1][format](actual + misalign, pcm + misalign, count);
+                if (!same_bits(expected + misalign, actual + misalign, count + VERIFY_GUARD)) {
+                    printf("  MISMATCH %s_to_f32 count=%u misalign=%u\n", names[format], count, misalign);
+                    failures++;
+                }
+
+                /* ... and back, which must give the original samples */
+                if (format < 2) {
+                    memset(pcmActual, 0xA5, used + guard + 4);
+                    fromFloat[1][format](pcmActual + misalign, actual + misalign, count, NULL);
+                    if (memcmp(pcmActual + misalign, pcm + misalign, used) != 0) {
+                        printf("  ROUND TRIP %s count=%u misalign=%u\n", names[format], count, misalign);
+                        failures++;
+                    }
+                }
+
+                /* Float -> integer, plain and dithered from the same seed */
+                float* pSrc = src + misalign;
+                fill_random(pSrc, count);
+                if (count > 2) {
+                    pSrc[0] = 1.0f;
+                    pSrc[1] = -1.0f;
+                    pSrc[2] = 0.99999994f;
+                }
+                for (int dithered = 0; dithered < 2; dithered++) {
+                    ta_dither ditherExpected;
+                    ta_dither ditherActual;
+                    ta_dither_init(&ditherExpected, count * 7 + misalign);
+                    ta_dither_init(&ditherActual, count * 7 + misalign);
+                    memset(pcmExpected, 0xA5, used + guard + 4);
+                    memset(pcmActual, 0xA5, used + guard + 4);
+                    fromFloat[0][format](pcmExpected + misalign, pSrc, count, dithered ? &ditherExpected : NULL);
+                    fromFloat[1][format](pcmActual + misalign, pSrc, count, dithered ? &ditherActual : NULL);
+                    if (memcmp(pcmExpected, pcmActual, used + guard + 4) != 0 ||
+                        memcmp(&ditherExpected, &ditherActual, sizeof(ta_dither)) != 0) {
+                        printf("  MISMATCH f32_to_%s%s count=%u misalign=%u\n",
+                            names[format], dithered ? " (dither)" : "", count, misalign);
+                        failures++;
+                    }
+                }
+            }
+        }
+    }
+
+    return failures;
+}
+
+/* ==============================================================================
+ * BENCHMARK
+ * ============================================================================== */
+
+typedef enum {
+    BENCH_GAIN = 0,
+    BENCH_GAIN_RAMP,
+    BENCH_COPY,
+    BENCH_FILL_FRAME,
+    BENCH_MIX,
+    BENCH_PEAK,
+    BENCH_PEAK_RMS,
+    BENCH_DIFF_ENERGY,
+    BENCH_S16_TO_F32,
+    BENCH_S24_TO_F32,
+    BENCH_F32_TO_S16,
+    BENCH_F32_TO_S16_DITHER,
+    BENCH_F32_TO_S24,
+    BENCH_KERNEL_COUNT
+} bench_kernel;
+
+static const char* g_kernelNames[BENCH_KERNEL_COUNT] = { "gain", "gain_ramp", "copy", "fill_frame", "mix", "peak", "peak_rms",
+    "diff_energy", "s16_to_f32", "s24_to_f32", "f32_to_s16", "f32_to_s16+d", "f32_to_s24" };
+
+static volatile float g_sink;
+
+static double run_kernel(const ta_kernels* pKernels, bench_kernel kernel, ma_uint32 channels,
+    ma_uint32 blockFrames, float* pSrc, float* pDst) {
+    ma_uint32 count = blockFrames * channels;
+    ma_uint32 blocks = BENCH_TOTAL_FRAMES / blockFrames;
+    float peak = 0.0f;
+    float sum = 0.0f;
+    ta_dither dither;
+    ma_timer timer;
+
+    ta_dither_init(&dither, 1);
+
+    ma_timer_init(&timer);
+    double start = ma_timer_get_time_in_seconds(&timer);
+
+    for (ma_uint32 b = 0; b < blocks; b++) {
+        switch (kernel) {
+            case BENCH_GAIN:        pKernels->gain(pDst, pSrc, count, 0.5f); break;
+            case BENCH_GAIN_RAMP:   pKernels->gain_ramp(pDst, pSrc, channels, blockFrames, 0.5f, 1.0f / 4096.0f); break;
+            case BENCH_COPY:        pKernels->copy(pDst, pSrc, count); break;
+            case BENCH_FILL_FRAME:  pKernels->fill_frame(pDst, pSrc, channels, blockFrames); break;
+            case BENCH_MIX:         pKernels->mix(pDst, pSrc, count, 0.5f); break;
+            case BENCH_PEAK:        peak += pKernels->peak(pSrc, count); break;
+            case BENCH_PEAK_RMS:    pKernels->peak_rms(pSrc, count, &peak, &sum); break;
+            case BENCH_DIFF_ENERGY: sum += pKernels->diff_energy(pSrc + channels, pSrc, count - channels); break;
+            case BENCH_S16_TO_F32:  pKernels->s16_to_f32(pDst, pSrc, count); break;
+            case BENCH_S24_TO_F32:  pKernels->s24_to_f32(pDst, pSrc, count); break;
+            case BENCH_F32_TO_S16:  pKernels->f32_to_s16(pDst, pSrc, count, NULL); break;
+            case BENCH_F32_TO_S16_DITHER: pKernels->f32_to_s16(pDst, pSrc, count, &dither); break;
+            case BENCH_F32_TO_S24:  pKernels->f32_to_s24(pDst, pSrc, count, NULL); break;
+            default:                break;
+        }
+    }
+
+    double elapsed = ma_timer_get_time_in_seconds(&timer) - start;
+    g_sink = pDst[0] + peak + sum;
+    return elapsed * 1e9 / ((double)blocks * blockFrames);
+}
+
+int main(int argc, char** argv) {
+    ma_uint32 blockFrames = (argc > 1) ? (ma_uint32)atoi(argv[1]) : 128;
+    ta_kernels reference;
+    ta_kernels variants[TA_SIMD_COUNT];
+    int available[TA_SIMD_COUNT];
+    int failures = 0;
+
+    if (blockFrames == 0) {
+        fprintf(stderr, "usage: ta_bench_kernels [blockFrames]\n");
+        return 1;
+    }
+
+    ta_kernels_select(&reference, TA_SIMD_SCALAR);
+    printf("kernel benchmark: %u-frame blocks, detected %s\n\n",
+        blockFrames, ta_simd_level_name(ta_simd_detect()));
+
+    /* ==== BIT-EXACT CHECK ==== */
+
+    for (int level = 0; level < TA_SIMD_COUNT; level++) {
+        available[level] = ta_kernels_select(&variants[level], (ta_simd_level)level);
+        if (!available[level]) {
+            continue;
+        }
+        int variantFailures = verify(&reference, &variants[level]) + verify_convert(&reference, &variants[level]);
+        printf("verify %-8s %s\n", variants[level].name, variantFailures == 0 ? "bit-exact" : "FAILED");
+        failures += variantFailures;
+    }
+    printf("\n");
+
+    /* ==== NS/FRAME ==== */
+
+    size_t bufferSamples = (size_t)blockFrames * 8;
+    float* pSrc = (float*)ma_aligned_malloc(bufferSamples * sizeof(float), 64, NULL);
+    float* pDst = (float*)ma_aligned_malloc(bufferSamples * sizeof(float), 64, NULL);
+    if (!pSrc || !pDst) {
+        return 1;
+    }
+    fill_random(pSrc, (ma_uint32)bufferSamples);
+    memset(pDst, 0, bufferSamples * sizeof(float));
+
+    printf("%-14s %3s", "kernel", "ch");
+    for (int level = 0; level < TA_SIMD_COUNT; level++) {
+        if (available[level]) {
+            printf(" %10s", variants[level].name);
+        }
+    }
+    printf("   (ns/frame)\n");
+
+    for (int kernel = 0; kernel < BENCH_KERNEL_COUNT; kernel++) {
+        for (size_t c = 0; c < sizeof(g_benchChannels) / sizeof(g_benchChannels[0]); c++) {
+            ma_uint32 channels = g_benchChannels[c];
+            printf("%-14s %3u", g_kernelNames[kernel], channels);
+            for (int level = 0; level < TA_SIMD_COUNT; level++) {
+                if (available[level]) {
+                    printf(" %10.3f", run_kernel(&variants[level], (bench_kernel)kernel, channels, blockFrames, pSrc, pDst));
+                }
+            }
+            printf("\n");
+        }
+    }
+
+    ma_aligned_free(pSrc, NULL);
+    ma_aligned_free(pDst, NULL);
+
+    if (failures > 0) {
+        printf("\n%d mismatches against the scalar reference\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,263 @@
+/*
+ * ==============================================================================
+ * ta_bench_ring.c - Microbenchmark: ta_ring (wrapped/mirrored) vs ma_pcm_rb
+ * ==============================================================================
+ * Moves audio through each ring buffer the way the engine does:
+ *   - "threaded":  a producer thread writes callback-sized chunks while a
+ *                  consumer thread reads them (the capture->playback path)
+ *   - "same-thread": write then read on one thread (pure bookkeeping cost)
+ * and reports ns/frame for each. Each chunk is written with the volume
+ * multiply, like capture_callback.
+ *
+ * BUILD (MSVC, from native/):
+ *   cl /O2 /I. tools\ta_bench_ring.c /Fe:ta_bench_ring.exe
+ *
+ * BUILD (GCC/Clang):
+ *   gcc -O2 -I. tools/ta_bench_ring.c -o ta_bench_ring -lpthread -lm -ldl
+ *
+ * USAGE:
+ *   ta_bench_ring [channels] [chunkFrames] [ringFrames]
+ * ==============================================================================
+ */
+
+#define MINIAUDIO_IMPLEMENTATION
+#define MA_NO_DECODING
+#define MA_NO_ENCODING
+#define MA_NO_GENERATION
+#define MA_NO_RESOURCE_MANAGER
+#define MA_NO_NODE_GRAPH
+#define MA_NO_ENGINE
+
+#include "miniaudio.h"
+#include "ta_ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_TOTAL_FRAMES  (48000u * 600u)   /* 10 minutes of audio @ 48kHz */
+
+typedef enum {
+    BENCH_RING_MA_PCM_RB = 0,
+    BENCH_RING_TA_WRAPPED,
+    BENCH_RING_TA_MIRRORED,
+    BENCH_RING_COUNT
+} bench_ring_kind;
+
+static const char* g_ringNames[BENCH_RING_COUNT] = { "ma_pcm_rb", "ta_ring", "ta_ring/mirror" };
+
+typedef struct {
+    int useTaRing;
+    ta_ring taRing;
+    ma_pcm_rb pcmRb;
+    ma_uint32 channels;
+    ma_uint32 chunkFrames;
+    ma_uint32 ringFrames;
+    ma_uint64 totalFrames;
+    float* pSource;
+    float* pSink;
+    volatile float checksum;
+} bench_state;
+
+/* ==============================================================================
+ * ONE CHUNK IN / OUT - mirrors the engine callbacks
+ * ============================================================================== */
+
+static ma_uint32 produce_chunk(bench_state* pState, ma_uint32 frames) {
+    ma_uint32 channels = pState->channels;
+
+    if (pState->useTaRing) {
+        ma_uint32 fill = ta_ring_fill(&pState->taRing);
+        ma_uint32 space = pState->ringFrames - fill;
+        if (frames > space) {
+            frames = space;
+        }
+        ma_uint32 written = 0;
+        while (written < frames) {
+            ma_uint32 contiguous;
+            float* pDst = ta_ring_write_span(&pState->taRing, written, &contiguous);
+            ma_uint32 n = frames - written;
+            if (n > contiguous) {
+                n = contiguous;
+            }
+            const float* pSrc = pState->pSource + (size_t)written * channels;
+            for (ma_uint32 i = 0; i < n * channels; i++) {
+                pDst[i] = pSrc[i] * 0.5f;
+            }
+            written += n;
+        }
+        ta_ring_commit_write(&pState->taRing, frames);
+        return frames;
+    } else {
+        ma_uint32 space = ma_pcm_rb_available_write(&pState->pcmRb);
+        if (frames > space) {
+            frames = space;
+        }
+        void* pBuffer;
+        ma_uint32 n = frames;
+        if (frames == 0 || ma_pcm_rb_acquire_write(&pState->pcmRb, &n, &pBuffer) != MA_SUCCESS) {
+            return 0;
+        }
+        float* pDst = (float*)pBuffer;
+        for (ma_uint32 i = 0; i < n * channels; i++) {
+            pDst[i] = pState->pSource[i] * 0.5f;
+        }
+        ma_pcm_rb_commit_write(&pState->pcmRb, n);
+        return n;
+    }
+}
+
+static ma_uint32 consume_chunk(bench_state* pState, ma_uint32 frames) {
+    ma_uint32 channels = pState->channels;
+
+    if (pState->useTaRing) {
+        ma_uint32 fill = ta_ring_fill(&pState->taRing);
+        if (frames > fill) {
+            frames = fill;
+        }
+        if (frames > 0) {
+            ta_ring_read(&pState->taRing, pState->pSink, frames);
+        }
+        return frames;
+    } else {
+        void* pBuffer;
+        ma_uint32 n = frames;
+        if (ma_pcm_rb_acquire_read(&pState->pcmRb, &n, &pBuffer) != MA_SUCCESS || n == 0) {
+            return 0;
+        }
+        memcpy(pState->pSink, pBuffer, (size_t)n * channels * sizeof(float));
+        ma_pcm_rb_commit_read(&pState->pcmRb, n);
+        return n;
+    }
+}
+
+/* ==============================================================================
+ * DRIVERS
+ * ============================================================================== */
+
+static ma_thread_result MA_THREADCALL producer_thread(void* pData) {
+    bench_state* pState = (bench_state*)pData;
+    ma_uint64 produced = 0;
+
+    while (produced < pState->totalFrames) {
+        ma_uint32 n = produce_chunk(pState, pState->chunkFrames);
+        if (n == 0) {
+            ma_sleep(0);    /* Ring full - let the consumer run (matters on 1-2 core machines) */
+        }
+        produced += n;
+    }
+    return (ma_thread_result)0;
+}
+
+static double run_threaded(bench_state* pState) {
+    ma_thread producer;
+    ma_timer timer;
+    ma_uint64 consumed = 0;
+
+    ma_timer_init(&timer);
+    double start = ma_timer_get_time_in_seconds(&timer);
+
+    if (ma_thread_create(&producer, ma_thread_priority_default, 0, producer_thread, pState, NULL) != MA_SUCCESS) {
+        return -1.0;
+    }
+    while (consumed < pState->totalFrames) {
+        ma_uint32 n = consume_chunk(pState, pState->chunkFrames);
+        if (n == 0) {
+            ma_sleep(0);
+        }
+        consumed += n;
+    }
+    ma_thread_wait(&producer);
+
+    pState->checksum += pState->pSink[0];
+    return (ma_timer_get_time_in_seconds(&timer) - start) * 1e9 / (double)pState->totalFrames;
+}
+
+static double run_same_thread(bench_state* pState) {
+    ma_timer timer;
+    ma_uint64 moved = 0;
+
+    ma_timer_init(&timer);
+    double start = ma_timer_get_time_in_seconds(&timer);
+
+    while (moved < pState->totalFrames) {
+        ma_uint32 n = produce_chunk(pState, pState->chunkFrames);
+        consume_chunk(pState, n);
+        moved += n;
+    }
+
+    pState->checksum += pState->pSink[0];
+    return (ma_timer_get_time_in_seconds(&timer) - start) * 1e9 / (double)pState->totalFrames;
+}
+
+static int setup(bench_state* pState, bench_ring_kind kind) {
+    pState->useTaRing = (kind != BENCH_RING_MA_PCM_RB);
+    if (kind == BENCH_RING_TA_MIRRORED) {
+        if (ta_ring_init_mirrored(&pState->taRing, pState->channels, pState->ringFrames) != MA_SUCCESS) {
+            return 0;
+        }
+    } else if (kind == BENCH_RING_TA_WRAPPED) {
+        if (ta_ring_init(&pState->taRing, pState->channels, pState->ringFrames, NULL) != MA_SUCCESS) {
+            return 0;
+        }
+    } else {
+        if (ma_pcm_rb_init(ma_format_f32, pState->channels, pState->ringFrames, NULL, NULL, &pState->pcmRb) != MA_SUCCESS) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void teardown(bench_state* pState) {
+    if (pState->useTaRing) {
+        ta_ring_uninit(&pState->taRing, NULL);
+    } else {
+        ma_pcm_rb_uninit(&pState->pcmRb);
+    }
+}
+
+int main(int argc, char** argv) {
+    bench_state state;
+    memset(&state, 0, sizeof(state));
+
+    state.channels    = (argc > 1) ? (ma_uint32)atoi(argv[1]) : 2;
+    state.chunkFrames = (argc > 2) ? (ma_uint32)atoi(argv[2]) : 128;
+    state.ringFrames  = (argc > 3) ? (ma_uint32)atoi(argv[3]) : 2048;
+    state.totalFrames = BENCH_TOTAL_FRAMES;
+
+    if (state.channels == 0 || state.chunkFrames == 0 || state.ringFrames < state.chunkFrames) {
+        fprintf(stderr, "usage: ta_bench_ring [channels] [chunkFrames] [ringFrames]\n");
+        return 1;
+    }
+
+    state.pSource = (float*)malloc((size_t)state.chunkFrames * state.channels * sizeof(float));
+    state.pSink   = (float*)malloc((size_t)state.chunkFrames * state.channels * sizeof(float));
+    if (!state.pSource || !state.pSink) {
+        return 1;
+    }
+    for (ma_uint32 i = 0; i < state.chunkFrames * state.channels; i++) {
+        state.pSource[i] = (float)i / (float)(state.chunkFrames * state.channels);
+    }
+
+    printf("ring benchmark: %u ch, %u-frame chunks, %u-frame ring, %llu frames\n",
+        state.channels, state.chunkFrames, state.ringFrames, (unsigned long long)state.totalFrames);
+    printf("%-16s %16s %18s\n", "ring", "threaded ns/fr", "same-thread ns/fr");
+
+    for (int kind = 0; kind < BENCH_RING_COUNT; kind++) {
+        if (!setup(&state, (bench_ring_kind)kind)) {
+            printf("%-16s %16s %18s\n", g_ringNames[kind], "unavailable", "unavailable");
+            continue;
+        }
+        double threaded = run_threaded(&state);
+        teardown(&state);
+
+        setup(&state, (bench_ring_kind)kind);
+        double sameThread = run_same_thread(&state);
+        teardown(&state);
+
+        printf("%-16s %16.3f %18.3f\n", g_ringNames[kind], threaded, sameThread);
+    }
+
+    free(state.pSource);
+    free(state.pSink);
+    return 0;
+}
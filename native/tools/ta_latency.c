@@ -0,0 +1,159 @@
+/*
+ * ==============================================================================
+ * ta_latency.c - Round-trip latency measurement on real devices
+ * ==============================================================================
+ * Starts the default route and measures its latency with a test signal
+ * (AudioEngine_StartLatencyMeasurement): the output is replaced by a probe
+ * for a moment and the probe is located in the capture. Connect the output
+ * to the input with a cable (or put the microphone next to the speaker)
+ * first. Prints each run and the spread, next to the latency the engine
+ * estimates from its buffer levels.
+ *
+ * BUILD (MSVC, from native/ after build-native.ps1):
+ *   cl /O2 /I. tools\ta_latency.c /Fe:ta_latency.exe /link TransparencyAudio.lib
+ *
+ * BUILD (GCC/Clang, engine compiled in):
+ *   gcc -O2 -I. tools/ta_latency.c TransparencyAudio.c -o ta_latency -lpthread -lm -ldl
+ *
+ * USAGE:
+ *   ta_latency [-runs N] [-probe mls|chirp] [-level AMPLITUDE] [-max-ms MS]
+ *              [-buffer FRAMES] [-exclusive 0|1] [-topology decoupled|duplex]
+ * ==============================================================================
+ */
+
+#include "TransparencyAudio.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define LATENCY_MAX_RUNS        64
+#define LATENCY_POLL_MS         20
+#define LATENCY_SETTLE_MS       1000    /* Let the ring and drift loop settle after Start */
+
+static void sleep_ms(unsigned int ms) {
+#if defined(_WIN32)
+    Sleep(ms);
+#else
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+#endif
+}
+
+static void usage(void) {
+    fprintf(stderr,
+        "usage: ta_latency [-runs N] [-probe mls|chirp] [-level AMPLITUDE] [-max-ms MS]\n"
+        "                  [-buffer FRAMES] [-exclusive 0|1] [-topology decoupled|duplex]\n");
+}
+
+int main(int argc, char** argv) {
+    ta_engine_config config;
+    ta_latency_probe_config probe;
+    int runs = 5;
+
+    memset(&config, 0, sizeof(config));
+    memset(&probe, 0, sizeof(probe));
+    config.sampleRate = 48000;
+    config.channels = 2;
+    config.bufferSizeFrames = 128;
+    config.volume = 1.0f;
+    config.driftMode = TA_DRIFT_MODE_RESAMPLE;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (!value) {
+            usage();
+            return 1;
+        }
+        i++;
+
+        if (strcmp(arg, "-runs") == 0) {
+            runs = atoi(value);
+        } else if (strcmp(arg, "-probe") == 0) {
+            probe.signal = (strcmp(value, "chirp") == 0) ? TA_PROBE_SIGNAL_CHIRP : TA_PROBE_SIGNAL_MLS;
+        } else if (strcmp(arg, "-level") == 0) {
+            probe.level = (float)atof(value);
+        } else if (strcmp(arg, "-max-ms") == 0) {
+            probe.maxRoundTripMs = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "-buffer") == 0) {
+            config.bufferSizeFrames = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "-exclusive") == 0) {
+            config.shareMode = atoi(value) ? TA_SHARE_MODE_EXCLUSIVE : TA_SHARE_MODE_SHARED;
+        } else if (strcmp(arg, "-topology") == 0) {
+            config.useDecoupledDevices = (strcmp(value, "duplex") == 0)
+                ? TA_DEVICE_TOPOLOGY_DUPLEX
+                : TA_DEVICE_TOPOLOGY_DECOUPLED;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (runs < 1) runs = 1;
+    if (runs > LATENCY_MAX_RUNS) runs = LATENCY_MAX_RUNS;
+
+    ta_result result = AudioEngine_Initialize(&config);
+    if (result == TA_SUCCESS) {
+        result = AudioEngine_Start();
+    }
+    if (result != TA_SUCCESS) {
+        fprintf(stderr, "engine start failed: %s\n", AudioEngine_ResultToString(result));
+        AudioEngine_Uninitialize();
+        return 1;
+    }
+    sleep_ms(LATENCY_SETTLE_MS);
+
+    float minMs = 0.0f, maxMs = 0.0f, sumMs = 0.0f;
+    int found = 0;
+
+    printf("run  round trip   engine    total  estimated  peak/noise\n");
+    for (int run = 0; run < runs; run++) {
+        ta_latency_measurement measurement;
+
+        result = AudioEngine_StartLatencyMeasurement(&probe);
+        if (result != TA_SUCCESS) {
+            fprintf(stderr, "measurement failed to start: %s\n", AudioEngine_ResultToString(result));
+            break;
+        }
+        do {
+            sleep_ms(LATENCY_POLL_MS);
+            AudioEngine_GetLatencyMeasurement(&measurement);
+        } while (measurement.state == TA_LATENCY_MEASUREMENT_RUNNING);
+
+        if (measurement.state != TA_LATENCY_MEASUREMENT_DONE) {
+            printf("%3d  not detected (%s, %.1f dB)\n", run + 1,
+                AudioEngine_ResultToString(measurement.error), measurement.peakToNoiseDb);
+            continue;
+        }
+
+        printf("%3d  %7.2f ms  %5.2f ms  %5.2f ms  %6.2f ms  %6.1f dB\n", run + 1,
+            measurement.roundTripMs, measurement.engineInternalMs, measurement.totalMs,
+            measurement.estimatedMs, measurement.peakToNoiseDb);
+
+        float totalMs = measurement.engineInternalMs >= 0.0f ? measurement.totalMs : measurement.roundTripMs;
+        if (found == 0 || totalMs < minMs) minMs = totalMs;
+        if (found == 0 || totalMs > maxMs) maxMs = totalMs;
+        sumMs += totalMs;
+        found++;
+    }
+
+    AudioEngine_Uninitialize();
+
+    if (found == 0) {
+        printf("probe never detected: is the output connected to the input?\n");
+        return 1;
+    }
+    printf("total latency    mean %.2f ms, min %.2f ms, max %.2f ms (%d of %d runs)\n",
+        sumMs / (float)found, minMs, maxMs, found, runs);
+    return 0;
+}
@@ -0,0 +1,354 @@
+/*
+ * ==============================================================================
+ * ta_sim.c - Headless engine run on virtual-clock devices
+ * ==============================================================================
+ * Front end for ta_sim_run(): drives the real capture/playback callbacks
+ * against simulated devices with clock offset, jitter, variable callback
+ * sizes and stalls, faster than real time, and prints the elastic buffer
+ * statistics. Use it to tune ring size / drift mode without hardware.
+ *
+ * BUILD (MSVC, from native/ after build-native.ps1):
+ *   cl /O2 /I. tools\ta_sim.c /Fe:ta_sim.exe /link TransparencyAudio.lib
+ *
+ * BUILD (GCC/Clang, engine compiled in):
+ *   gcc -O2 -I. tools/ta_sim.c TransparencyAudio.c -o ta_sim -lpthread -lm -ldl
+ *
+ * BUILD (real-time checks: any allocation, lock or blocking call inside the
+ *        callbacks is printed with its stack and fails the run):
+ *   gcc -O1 -g -rdynamic -DTA_ENABLE_RT_CHECKS -I. tools/ta_sim.c TransparencyAudio.c -o ta_sim_rt -lpthread -lm -ldl
+ *
+ * BUILD (timeline probes, for -timeline):
+ *   gcc -O2 -DTA_ENABLE_TRACE -I. tools/ta_sim.c TransparencyAudio.c -o ta_sim_trace -lpthread -lm -ldl
+ *
+ * USAGE:
+ *   ta_sim [-seconds S] [-rate HZ] [-channels N] [-capture-channels N] [-ring FRAMES]
+ *          [-drift skip|resample] [-capture-ppm PPM] [-playback-ppm PPM]
+ *          [-capture-period FRAMES] [-playback-period FRAMES]
+ *          [-variation FRAMES] [-jitter-us US] [-seed N]
+ *          [-format f32|s16|s24|s32] [-dither 0|1]
+ *          [-adaptive 0|1] [-min-latency-ms MS] [-max-latency-ms MS]
+ *          [-stall capture|playback:AT_SECONDS:DURATION_MS]...
+ *          [-loopback PATH_MS] [-probe mls|chirp] [-measure-at S]
+ *          [-glitch-ms MS] [-glitch-dir DIR] [-record PATH] [-replay PATH]
+ *          [-timeline PATH] [-expect-ppm TOLERANCE]
+ *
+ *   -loopback feeds the output back into the input PATH_MS after it leaves
+ *   the playback device, and runs one round-trip latency measurement
+ *   (ta_probe.h) at -measure-at seconds. The expected round trip is one
+ *   playback period plus PATH_MS; the engine-internal part should match
+ *   the latency line minus one playback period.
+ *
+ *   -glitch-ms keeps MS of output history and writes a WAV plus a JSON
+ *   timing trace (ta_glitch.h) to -glitch-dir around each underrun,
+ *   overrun and drift correction. Times in the trace are virtual.
+ *
+ *   -record writes the run's callback trace (ta_replay.h) to PATH.
+ *   -replay runs the callbacks of a trace, recorded here or on a live
+ *   engine with AudioEngine_StartCallbackTrace, through the ring and drift
+ *   settings given on the command line. The trace's callback times, sizes
+ *   and sample rate replace -seconds, -rate, the ppm, period, jitter and
+ *   stall options. Replaying a -record trace with the same settings
+ *   reproduces the run with a divergence of 0 frames.
+ *
+ *   -timeline writes the trace probes' timeline (ta_trace.h) after the
+ *   run: Chrome trace JSON if PATH ends in .json, else a Perfetto trace.
+ *   Needs a build with -DTA_ENABLE_TRACE. The simulated callbacks all run
+ *   on one thread, at wall-clock times.
+ *
+ *   -expect-ppm fails the run (exit 1) unless the resample loop's final
+ *   drift estimate is within TOLERANCE ppm of the simulated clock offset
+ *   (capture ppm minus playback ppm). Run it for 120 s or more, so the
+ *   loop has settled; without jitter the estimate lands within 0.1 ppm.
+ *
+ * EXAMPLE (10 minutes, 10ms shared-mode capture vs 128-frame playback,
+ *          capture clock 80ppm fast, one 30ms playback stall):
+ *   ta_sim -drift resample -capture-ppm 80 -capture-period 480 \
+ *          -jitter-us 300 -stall playback:120:30
+ * ==============================================================================
+ */
+
+#include "TransparencyAudio.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int parse_stall(const char* text, ta_sim_stall* pStall) {
+    char device[16];
+    float at;
+    float duration;
+
+    if (sscanf(text, "%15[a-z]:%f:%f", device, &at, &duration) != 3) {
+        return 0;
+    }
+    if (strcmp(device, "capture") == 0) {
+        pStall->device = TA_SIM_DEVICE_CAPTURE;
+    } else if (strcmp(device, "playback") == 0) {
+        pStall->device = TA_SIM_DEVICE_PLAYBACK;
+    } else {
+        return 0;
+    }
+    pStall->atSeconds = at;
+    pStall->durationMs = duration;
+    return 1;
+}
+
+static int parse_format(const char* text, ta_format* pFormat) {
+    static const char* names[] = { "f32", "s16", "s24", "s32" };
+    static const ta_format formats[] = { TA_FORMAT_F32, TA_FORMAT_S16, TA_FORMAT_S24, TA_FORMAT_S32 };
+
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(text, names[i]) == 0) {
+            *pFormat = formats[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static const char* format_name(ta_format format) {
+    switch (format) {
+        case TA_FORMAT_S16: return "s16";
+        case TA_FORMAT_S24: return "s24";
+        case TA_FORMAT_S32: return "s32";
+        default:            return "f32";
+    }
+}
+
+static const char* rt_violation_name(int32_t kind) {
+    switch (kind) {
+        case TA_RT_VIOLATION_ALLOCATION: return "allocation";
+        case TA_RT_VIOLATION_FREE:       return "free";
+        case TA_RT_VIOLATION_LOCK:       return "lock";
+        case TA_RT_VIOLATION_SLEEP:      return "sleep";
+        case TA_RT_VIOLATION_IO:         return "io";
+        default:                         return "unknown";
+    }
+}
+
+/* Chrome JSON for *.json, Perfetto protobuf otherwise */
+static int write_timeline(const char* path) {
+    wchar_t widePath[260];
+    size_t length = strlen(path);
+    int json = length >= 5 && strcmp(path + length - 5, ".json") == 0;
+
+    mbstowcs(widePath, path, 259);
+    widePath[259] = L'\0';
+    ta_result result = AudioEngine_WriteTrace(widePath, json ? TA_TRACE_FORMAT_CHROME_JSON : TA_TRACE_FORMAT_PERFETTO);
+    if (result != TA_SUCCESS) {
+        fprintf(stderr, "timeline not written: %s%s\n", AudioEngine_ResultToString(result),
+            result == TA_INVALID_OPERATION ? " (build with -DTA_ENABLE_TRACE)" : "");
+        return 0;
+    }
+    printf("timeline         %s\n", path);
+    return 1;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+        "usage: ta_sim [-seconds S] [-rate HZ] [-channels N] [-capture-channels N] [-ring FRAMES]\n"
+        "              [-drift skip|resample] [-capture-ppm PPM] [-playback-ppm PPM]\n"
+        "              [-capture-period FRAMES] [-playback-period FRAMES]\n"
+        "              [-variation FRAMES] [-jitter-us US] [-seed N]\n"
+        "              [-format f32|s16|s24|s32] [-dither 0|1]\n"
+        "              [-adaptive 0|1] [-min-latency-ms MS] [-max-latency-ms MS]\n"
+        "              [-stall capture|playback:AT_SECONDS:DURATION_MS]...\n"
+        "              [-loopback PATH_MS] [-probe mls|chirp] [-measure-at S]\n"
+        "              [-glitch-ms MS] [-glitch-dir DIR] [-record PATH] [-replay PATH]\n"
+        "              [-timeline PATH] [-expect-ppm TOLERANCE]\n");
+}
+
+int main(int argc, char** argv) {
+    ta_engine_config config;
+    ta_sim_config sim;
+    ta_sim_report report;
+    const char* timelinePath = NULL;
+    float expectPpmTolerance = -1.0f;   /* < 0: no drift check */
+
+    memset(&config, 0, sizeof(config));
+    memset(&sim, 0, sizeof(sim));
+
+    config.sampleRate = 48000;
+    config.channels = 2;
+    config.bufferSizeFrames = 128;
+    config.volume = 1.0f;
+    config.ringBufferSizeFrames = 2048;
+    config.driftMode = TA_DRIFT_MODE_SKIP_DUPLICATE;
+    config.format = TA_FORMAT_F32;
+
+    sim.capturePeriodFrames = 480;     /* 10ms shared-mode capture */
+    sim.playbackPeriodFrames = 128;    /* IAudioClient3 minimum quantum */
+    sim.durationSeconds = 600.0f;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (!value) {
+            usage();
+            return 1;
+        }
+        i++;
+
+        if (strcmp(arg, "-seconds") == 0) {
+            sim.durationSeconds = (float)atof(value);
+        } else if (strcmp(arg, "-rate") == 0) {
+            config.sampleRate = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "-channels") == 0) {
+            config.channels = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "-capture-channels") == 0) {
+            config.captureChannels = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "-ring") == 0) {
+            config.ringBufferSizeFrames = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "-drift") == 0) {
+            config.driftMode = (strcmp(value, "resample") == 0) ? TA_DRIFT_MODE_RESAMPLE : TA_DRIFT_MODE_SKIP_DUPLICATE;
+        } else if (strcmp(arg, "-capture-ppm") == 0) {
+            sim.captureClockPpm = (float)atof(value);
+        } else if (strcmp(arg, "-playback-ppm") == 0) {
+            sim.playbackClockPpm = (float)atof(value);
+        } else if (strcmp(arg, "-capture-period") == 0) {
+            sim.capturePeriodFrames = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "-playback-period") == 0) {
+            sim.playbackPeriodFrames = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "-variation") == 0) {
+            sim.periodVariationFrames = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "-jitter-us") == 0) {
+            sim.callbackJitterUs = (float)atof(value);
+        } else if (strcmp(arg, "-seed") == 0) {
+            sim.seed = (uint32_t)strtoul(value, NULL, 0);
+        } else if (strcmp(arg, "-format") == 0) {
+            if (!parse_format(value, &config.format)) {
+                usage();
+                return 1;
+            }
+        } else if (strcmp(arg, "-dither") == 0) {
+            config.enableDither = atoi(value);
+        } else if (strcmp(arg, "-adaptive") == 0) {
+            config.adaptiveLatency = atoi(value);
+        } else if (strcmp(arg, "-min-latency-ms") == 0) {
+            config.minTargetLatencyMs = (float)atof(value);
+        } else if (strcmp(arg, "-max-latency-ms") == 0) {
+            config.maxTargetLatencyMs = (float)atof(value);
+        } else if (strcmp(arg, "-stall") == 0) {
+            if (sim.stallCount >= TA_SIM_MAX_STALLS || !parse_stall(value, &sim.stalls[sim.stallCount])) {
+                usage();
+                return 1;
+            }
+            sim.stallCount++;
+        } else if (strcmp(arg, "-loopback") == 0) {
+            sim.loopback = 1;
+            sim.loopbackLatencyMs = (float)atof(value);
+        } else if (strcmp(arg, "-probe") == 0) {
+            sim.probe.signal = (strcmp(value, "chirp") == 0) ? TA_PROBE_SIGNAL_CHIRP : TA_PROBE_SIGNAL_MLS;
+        } else if (strcmp(arg, "-measure-at") == 0) {
+            sim.measureAtSeconds = (float)atof(value);
+        } else if (strcmp(arg, "-glitch-ms") == 0) {
+            config.glitchCaptureMs = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "-glitch-dir") == 0) {
+            mbstowcs(config.glitchDirectory, value, 259);
+        } else if (strcmp(arg, "-record") == 0) {
+            mbstowcs(sim.recordPath, value, 259);
+        } else if (strcmp(arg, "-replay") == 0) {
+            mbstowcs(sim.replayPath, value, 259);
+        } else if (strcmp(arg, "-timeline") == 0) {
+            timelinePath = value;
+        } else if (strcmp(arg, "-expect-ppm") == 0) {
+            expectPpmTolerance = (float)atof(value);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    ta_result result = ta_sim_run(&config, &sim, &report);
+    if (result != TA_SUCCESS) {
+        fprintf(stderr, "ta_sim_run failed: %s\n", AudioEngine_ResultToString(result));
+        return 1;
+    }
+
+    printf("simulated        %.1f s in %.3f s wall (%.0fx real time)\n",
+        report.simulatedSeconds, report.wallSeconds,
+        report.wallSeconds > 0.0 ? report.simulatedSeconds / report.wallSeconds : 0.0);
+    printf("drift mode       %s, capture %+.1f ppm, playback %+.1f ppm\n",
+        config.driftMode == TA_DRIFT_MODE_RESAMPLE ? "resample" : "skip/duplicate",
+        sim.captureClockPpm, sim.playbackClockPpm);
+    printf("device format    %s%s\n", format_name(config.format),
+        (config.enableDither && (config.format == TA_FORMAT_S16 || config.format == TA_FORMAT_S24)) ? " (dithered output)" : "");
+    printf("channels         capture %u, playback %u\n",
+        config.captureChannels > 0 ? config.captureChannels : config.channels, config.channels);
+    printf("callbacks        capture %llu, playback %llu\n",
+        (unsigned long long)report.captureCallbacks, (unsigned long long)report.playbackCallbacks);
+    printf("underruns        %u\n", report.underrunCount);
+    printf("overruns         %u\n", report.overrunCount);
+    printf("drift corrections %u\n", report.driftCorrectionCount);
+    printf("drift estimate   %+.2f ppm\n", report.driftPpm);
+    printf("final fill       %.1f%%\n", report.finalFillLevel * 100.0f);
+    printf("latency          mean %.2f ms, min %.2f ms, max %.2f ms\n",
+        report.latencyMeanMs, report.latencyMinMs, report.latencyMaxMs);
+    printf("ring target      %.2f ms%s, learned floor %.2f ms\n", report.targetLatencyMs,
+        config.adaptiveLatency ? " (adaptive)" : "", report.learnedFloorLatencyMs);
+    printf("callback time    capture  p50 %.2f us, p99 %.2f us, p99.9 %.2f us, max %.2f us\n",
+        report.timing.capture.executionUs.p50, report.timing.capture.executionUs.p99,
+        report.timing.capture.executionUs.p999, report.timing.capture.executionUs.max);
+    printf("                 playback p50 %.2f us, p99 %.2f us, p99.9 %.2f us, max %.2f us\n",
+        report.timing.playback.executionUs.p50, report.timing.playback.executionUs.p99,
+        report.timing.playback.executionUs.p999, report.timing.playback.executionUs.max);
+    printf("dsp load         capture %.2f%% (peak %.2f%%), playback %.2f%% (peak %.2f%%)\n",
+        report.timing.capture.dspLoadPercent, report.timing.capture.dspLoadPeakPercent,
+        report.timing.playback.dspLoadPercent, report.timing.playback.dspLoadPeakPercent);
+    printf("telemetry        %llu snapshots, peak in %.3f, peak out %.3f\n",
+        (unsigned long long)report.telemetry.updateCount,
+        report.telemetry.capturePeakLevel, report.telemetry.playbackPeakLevel);
+
+    if (sim.loopback) {
+        const ta_latency_measurement* pMeasurement = &report.latencyMeasurement;
+        float playbackPeriodMs = (float)(sim.playbackPeriodFrames > 0 ? sim.playbackPeriodFrames : config.bufferSizeFrames)
+            * 1000.0f / (float)config.sampleRate;
+        if (pMeasurement->state == TA_LATENCY_MEASUREMENT_DONE) {
+            printf("measured latency round trip %.2f ms (expected %.2f), engine %.2f ms (expected %.2f), total %.2f ms\n",
+                pMeasurement->roundTripMs, playbackPeriodMs + sim.loopbackLatencyMs,
+                pMeasurement->engineInternalMs, report.latencyMeanMs - playbackPeriodMs, pMeasurement->totalMs);
+            printf("                 estimated %.2f ms, %s probe %.1f dB over noise\n", pMeasurement->estimatedMs,
+                sim.probe.signal == TA_PROBE_SIGNAL_CHIRP ? "chirp" : "MLS", pMeasurement->peakToNoiseDb);
+        } else {
+            printf("measured latency failed: %s\n", AudioEngine_ResultToString(pMeasurement->error));
+        }
+    }
+    if (config.glitchCaptureMs > 0) {
+        printf("glitch dumps     %u written, %u events not recorded\n", report.glitchDumpCount, report.glitchDroppedCount);
+    }
+    if (sim.replayPath[0]) {
+        const ta_callback_trace_info* pTrace = &report.replayTrace;
+        printf("replayed trace   %.1f s at %u Hz, callbacks capture %llu (%u frames), playback %llu (%u frames)\n",
+            pTrace->durationSeconds, pTrace->sampleRate,
+            (unsigned long long)pTrace->captureCallbacks, pTrace->capturePeriodFrames,
+            (unsigned long long)pTrace->playbackCallbacks, pTrace->playbackPeriodFrames);
+        printf("                 recorded with ring %u, target %u, %s, %u records dropped\n",
+            pTrace->ringBufferSizeFrames, pTrace->ringBufferTargetFrames,
+            pTrace->driftMode == TA_DRIFT_MODE_RESAMPLE ? "resample" : "skip/duplicate", pTrace->droppedRecords);
+        printf("replay divergence %u frames\n", report.replayDivergenceFrames);
+    }
+    if (timelinePath && !write_timeline(timelinePath)) {
+        return 1;
+    }
+    
+    int failed = 0;
+    if (expectPpmTolerance >= 0.0f) {
+        float expectedPpm = sim.captureClockPpm - sim.playbackClockPpm;
+        float errorPpm = report.driftPpm - expectedPpm;
+        failed = config.driftMode != TA_DRIFT_MODE_RESAMPLE || errorPpm > expectPpmTolerance || errorPpm < -expectPpmTolerance;
+        printf("drift check      estimate %+.2f ppm, expected %+.2f +/- %.2f: %s\n",
+            report.driftPpm, expectedPpm, expectPpmTolerance, failed ? "FAILED" : "ok");
+    }
+    
+    if (!report.rtViolations.enabled) {
+        return failed;
+    }
+    printf("rt violations    %llu\n", (unsigned long long)report.rtViolations.violationCount);
+    for (uint32_t i = 0; i < report.rtViolations.recordedCount; i++) {
+        const ta_rt_violation* pViolation = &report.rtViolations.violations[i];
+        printf("  %s %s in %s callback\n    %s\n", rt_violation_name(pViolation->kind), pViolation->call,
+            pViolation->thread == TA_RT_THREAD_CAPTURE ? "capture" : "playback", pViolation->stack);
+    }
+    return (failed || report.rtViolations.violationCount > 0) ? 1 : 0;
+}
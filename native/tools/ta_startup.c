@@ -0,0 +1,270 @@
+/*
+ * ==============================================================================
+ * ta_startup.c - Time-to-first-sample benchmark
+ * ==============================================================================
+ * Repeats Initialize, Start, wait for the first captured audio at the output,
+ * Stop, Uninitialize, and prints the AudioEngine_GetStartupTiming phases
+ * (median and worst run) with the devices opened and started concurrently,
+ * one after the other (sequentialStartup), or both side by side.
+ *
+ * BUILD (MSVC, from native/ after build-native.ps1; uses the real devices):
+ *   cl /O2 /I. tools\ta_startup.c /Fe:ta_startup.exe /link TransparencyAudio.lib
+ *
+ * BUILD (GCC/Clang, engine compiled in on Miniaudio's null backend):
+ *   gcc -O2 -I. -DTA_ENABLE_NULL_BACKEND tools/ta_startup.c TransparencyAudio.c -o ta_startup -lpthread -lm -ldl
+ *
+ * USAGE:
+ *   ta_startup [-runs N] [-mode parallel|sequential|both] [-buffer FRAMES]
+ *              [-topology decoupled|duplex] [-timeout-ms MS]
+ *
+ *   On the null backend the device opens cost little more than their
+ *   threads, so the numbers mostly show the engine's own overhead; the
+ *   gap between the modes shows on WASAPI.
+ * ==============================================================================
+ */
+
+#include "TransparencyAudio.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define STARTUP_MAX_RUNS        1000
+#define STARTUP_POLL_MS         1
+
+typedef enum {
+    PHASE_INITIALIZE = 0,
+    PHASE_CONTEXT,
+    PHASE_ENUMERATE,
+    PHASE_DEVICE_INIT,
+    PHASE_CAPTURE_INIT,
+    PHASE_PLAYBACK_INIT,
+    PHASE_START,
+    PHASE_DEVICE_START,
+    PHASE_CAPTURE_START,
+    PHASE_PLAYBACK_START,
+    PHASE_FIRST_CAPTURE,
+    PHASE_FIRST_PLAYBACK,
+    PHASE_FIRST_SAMPLE,
+    PHASE_TOTAL,
+    PHASE_COUNT
+} startup_phase;
+
+static const char* g_phaseNames[PHASE_COUNT] = {
+    "Initialize",
+    "  context",
+    "  enumerate",
+    "  device opens",
+    "    capture open",
+    "    playback open",
+    "Start",
+    "  device starts",
+    "    capture start",
+    "    playback start",
+    "first capture",
+    "first playback",
+    "first sample",
+    "Initialize to sample"
+};
+
+typedef struct {
+    const char* name;
+    int sequential;
+    int runs;                   /* Runs that reached the first sample */
+    int parallelRuns;           /* Of those, runs the engine really overlapped */
+    float samples[PHASE_COUNT][STARTUP_MAX_RUNS];
+} startup_mode;
+
+static void sleep_ms(unsigned int ms) {
+#if defined(_WIN32)
+    Sleep(ms);
+#else
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+#endif
+}
+
+static int compare_float(const void* a, const void* b) {
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+/* Median and maximum of the runs; -1 if the phase never happened (duplex) */
+static void summarize(float* values, int count, float* pMedian, float* pMax) {
+    qsort(values, (size_t)count, sizeof(float), compare_float);
+    *pMedian = values[count / 2];
+    *pMax = values[count - 1];
+}
+
+static void usage(void) {
+    fprintf(stderr,
+        "usage: ta_startup [-runs N] [-mode parallel|sequential|both] [-buffer FRAMES]\n"
+        "                  [-topology decoupled|duplex] [-timeout-ms MS]\n");
+}
+
+/* One Initialize..Uninitialize cycle; 0 if the first sample never arrived */
+static int run_once(const ta_engine_config* config, unsigned int timeoutMs, startup_mode* pMode) {
+    ta_startup_timing timing;
+
+    ta_result result = AudioEngine_Initialize(config);
+    if (result == TA_SUCCESS) {
+        result = AudioEngine_Start();
+    }
+    if (result != TA_SUCCESS) {
+        fprintf(stderr, "%s: engine start failed: %s\n", pMode->name, AudioEngine_ResultToString(result));
+        AudioEngine_Uninitialize();
+        return 0;
+    }
+
+    unsigned int waitedMs = 0;
+    AudioEngine_GetStartupTiming(&timing);
+    while (timing.firstSampleMs < 0.0f && waitedMs < timeoutMs) {
+        sleep_ms(STARTUP_POLL_MS);
+        waitedMs += STARTUP_POLL_MS;
+        AudioEngine_GetStartupTiming(&timing);
+    }
+
+    AudioEngine_Stop();
+    AudioEngine_Uninitialize();
+
+    if (timing.firstSampleMs < 0.0f) {
+        fprintf(stderr, "%s: no captured audio at the output after %u ms\n", pMode->name, timeoutMs);
+        return 0;
+    }
+
+    int run = pMode->runs++;
+    pMode->parallelRuns += timing.parallel;
+    pMode->samples[PHASE_INITIALIZE][run] = timing.initializeMs;
+    pMode->samples[PHASE_CONTEXT][run] = timing.contextInitMs;
+    pMode->samples[PHASE_ENUMERATE][run] = timing.enumerateMs;
+    pMode->samples[PHASE_DEVICE_INIT][run] = timing.deviceInitMs;
+    pMode->samples[PHASE_CAPTURE_INIT][run] = timing.captureInitMs;
+    pMode->samples[PHASE_PLAYBACK_INIT][run] = timing.playbackInitMs;
+    pMode->samples[PHASE_START][run] = timing.startMs;
+    pMode->samples[PHASE_DEVICE_START][run] = timing.deviceStartMs;
+    pMode->samples[PHASE_CAPTURE_START][run] = timing.captureStartMs;
+    pMode->samples[PHASE_PLAYBACK_START][run] = timing.playbackStartMs;
+    pMode->samples[PHASE_FIRST_CAPTURE][run] = timing.firstCaptureMs;
+    pMode->samples[PHASE_FIRST_PLAYBACK][run] = timing.firstPlaybackMs;
+    pMode->samples[PHASE_FIRST_SAMPLE][run] = timing.firstSampleMs;
+    pMode->samples[PHASE_TOTAL][run] = timing.initializeMs + timing.firstSampleMs;
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    ta_engine_config config;
+    static startup_mode modes[2];
+    int modeCount = 0;
+    int runMode = 2;            /* 0 = parallel, 1 = sequential, 2 = both */
+    int runs = 20;
+    unsigned int timeoutMs = 2000;
+
+    memset(&config, 0, sizeof(config));
+    config.sampleRate = 48000;
+    config.channels = 2;
+    config.bufferSizeFrames = 128;
+    config.volume = 1.0f;
+    config.useDecoupledDevices = TA_DEVICE_TOPOLOGY_DECOUPLED;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (!value) {
+            usage();
+            return 1;
+        }
+        i++;
+
+        if (strcmp(arg, "-runs") == 0) {
+            runs = atoi(value);
+        } else if (strcmp(arg, "-mode") == 0) {
+            if (strcmp(value, "parallel") == 0) {
+                runMode = 0;
+            } else if (strcmp(value, "sequential") == 0) {
+                runMode = 1;
+            } else if (strcmp(value, "both") == 0) {
+                runMode = 2;
+            } else {
+                usage();
+                return 1;
+            }
+        } else if (strcmp(arg, "-buffer") == 0) {
+            config.bufferSizeFrames = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "-topology") == 0) {
+            config.useDecoupledDevices = (strcmp(value, "duplex") == 0)
+                ? TA_DEVICE_TOPOLOGY_DUPLEX
+                : TA_DEVICE_TOPOLOGY_DECOUPLED;
+        } else if (strcmp(arg, "-timeout-ms") == 0) {
+            timeoutMs = (unsigned int)atoi(value);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (runs < 1) runs = 1;
+    if (runs > STARTUP_MAX_RUNS) runs = STARTUP_MAX_RUNS;
+
+    if (runMode != 1) {
+        modes[modeCount].name = "parallel";
+        modes[modeCount].sequential = 0;
+        modeCount++;
+    }
+    if (runMode != 0) {
+        modes[modeCount].name = "sequential";
+        modes[modeCount].sequential = 1;
+        modeCount++;
+    }
+
+    /* Interleave the modes so drift in the host affects both alike */
+    for (int run = 0; run < runs; run++) {
+        for (int m = 0; m < modeCount; m++) {
+            config.sequentialStartup = modes[m].sequential;
+            run_once(&config, timeoutMs, &modes[m]);
+        }
+    }
+
+    printf("%d runs, %u frame buffer, times in ms (median / max)\n", runs, config.bufferSizeFrames);
+    printf("%-22s", "phase");
+    for (int m = 0; m < modeCount; m++) {
+        printf("  %19s", modes[m].name);
+    }
+    printf("\n");
+
+    int failed = 0;
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        printf("%-22s", g_phaseNames[phase]);
+        for (int m = 0; m < modeCount; m++) {
+            float median, worst;
+            if (modes[m].runs == 0) {
+                printf("  %19s", "-");
+                continue;
+            }
+            summarize(modes[m].samples[phase], modes[m].runs, &median, &worst);
+            if (median < 0.0f) {
+                printf("  %19s", "-");
+            } else {
+                printf("  %8.3f / %8.3f", median, worst);
+            }
+        }
+        printf("\n");
+    }
+    for (int m = 0; m < modeCount; m++) {
+        printf("%s: %d of %d runs reached the first sample, %d overlapped\n",
+            modes[m].name, modes[m].runs, runs, modes[m].parallelRuns);
+        if (modes[m].runs < runs) {
+            failed = 1;
+        }
+    }
+    return failed;
+}
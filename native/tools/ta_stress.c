@@ -0,0 +1,518 @@
+/*
+ * ==============================================================================
+ * ta_stress.c - Concurrent control-API stress run
+ * ==============================================================================
+ * Initializes the default engine, then lets several threads hammer it at
+ * once while the devices stream:
+ *   - start threads:  AudioEngine_Start
+ *   - stop threads:   AudioEngine_Stop
+ *   - volume threads: AudioEngine_SetVolume / AudioEngine_GetVolume
+ *   - status threads: AudioEngine_GetStatus / AudioEngine_IsRunning
+ * with short random pauses between calls. Checks along the way:
+ *   - Start/Stop/SetVolume never fail (transitions are serialized, not refused)
+ *   - every status snapshot is sane: isRunning 0/1, volume and fill in
+ *     [0, 1], lastError TA_SUCCESS, the 32-bit counters equal the low
+ *     half of the 64-bit ones
+ *   - the state callback alternates started/stopped, beginning with
+ *     started and ending with stopped
+ * Exits non-zero on any violation. Run it under ThreadSanitizer (GCC/Clang
+ * -fsanitize=thread) to check the engine's own memory ordering.
+ *
+ * BUILD (MSVC, from native/ after build-native.ps1; uses the real devices):
+ *   cl /O2 /I. tools\ta_stress.c /Fe:ta_stress.exe /link TransparencyAudio.lib
+ *
+ * BUILD (GCC/Clang, engine compiled in on Miniaudio's null backend):
+ *   gcc -O2 -I. -DTA_ENABLE_NULL_BACKEND tools/ta_stress.c TransparencyAudio.c -o ta_stress -lpthread -lm -ldl
+ *
+ * USAGE:
+ *   ta_stress [-seconds S] [-threads N] [-topology decoupled|duplex] [-page-faults 0|1]
+ *             [-glitch-ms MS] [-trace PATH] [-timeline PATH] [-device-loss N]
+ *
+ *   -page-faults 1 turns on the engine's fault test mode (countPageFaults)
+ *   and prints the arena size and the faults taken inside the callbacks
+ *   during the last run.
+ *
+ *   -glitch-ms turns on glitch capture (ta_glitch.h); Start/Stop churn makes
+ *   underruns, so the writer thread runs against the callbacks. Dumps go
+ *   to the current directory.
+ *
+ *   -trace records a callback trace (ta_replay.h) to PATH for the whole
+ *   run, so the trace writer runs against the callbacks too. Decoupled
+ *   topology only; replay the result with ta_sim -replay.
+ *
+ *   -timeline writes the trace probes' timeline (ta_trace.h; build with
+ *   -DTA_ENABLE_TRACE) once the worker threads are done, while the devices
+ *   may still stream: Chrome trace JSON if PATH ends in .json, else
+ *   Perfetto. Shows the workers' Start/Stop calls against the callbacks.
+ *
+ *   -device-loss first runs N cycles of Start, then one device stopped
+ *   behind the engine's back (AudioEngine_SimulateDeviceLoss, alternating
+ *   playback and capture), as an unplug would. Checks the engine reports
+ *   stopped on its own, that the other device stopped too (no more
+ *   callbacks, ring and counters still, so the next Start cannot re-prime
+ *   the ring under a running producer), that Start brings up a sane route
+ *   again, and on Windows that the process handle count does not grow
+ *   with the cycles (a leaked MMCSS registration per loss). Needs the
+ *   -DTA_ENABLE_NULL_BACKEND build: the shipped library has no fault
+ *   injection.
+ * ==============================================================================
+ */
+
+#include "TransparencyAudio.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#define STRESS_MAX_THREADS      64
+#define STRESS_MAX_PAUSE_US     2000
+#define STRESS_LOSS_RUN_MS      50      /* Streaming before each simulated loss */
+#define STRESS_LOSS_SETTLE_MS   1000    /* Longest wait for the engine to report stopped */
+
+typedef enum {
+    STRESS_START = 0,
+    STRESS_STOP,
+    STRESS_VOLUME,
+    STRESS_STATUS,
+    STRESS_ROLE_COUNT
+} stress_role;
+
+static const char* g_roleNames[STRESS_ROLE_COUNT] = { "start", "stop", "volume", "status" };
+
+typedef struct {
+    stress_role role;
+    unsigned int rng;
+    double deadline;
+    unsigned long long calls;
+    unsigned long long failures;
+    unsigned long long runningSeen;     /* Status threads: snapshots with isRunning = 1 */
+} stress_worker;
+
+/* Written only on the engine's dispatcher thread; read after Uninitialize joined it */
+static int g_lastState = 0;
+static unsigned long long g_stateCallbacks = 0;
+static unsigned long long g_stateErrors = 0;
+
+/* ==== PLATFORM ==== */
+
+#if defined(_WIN32)
+typedef HANDLE stress_thread;
+
+static double now_seconds(void) {
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+}
+
+static void pause_us(unsigned int us) {
+    Sleep(us / 1000);   /* 0 = yield */
+}
+
+static DWORD WINAPI worker_entry(LPVOID pData);
+
+static int thread_create(stress_thread* pThread, void* pData) {
+    *pThread = CreateThread(NULL, 0, worker_entry, pData, 0, NULL);
+    return *pThread != NULL;
+}
+
+static void thread_join(stress_thread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+#ifdef TA_ENABLE_NULL_BACKEND
+static long handle_count(void) {
+    DWORD count = 0;
+    GetProcessHandleCount(GetCurrentProcess(), &count);
+    return (long)count;
+}
+#endif
+#else
+typedef pthread_t stress_thread;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void pause_us(unsigned int us) {
+    struct timespec ts;
+    ts.tv_sec = 0;
+    ts.tv_nsec = (long)us * 1000;
+    nanosleep(&ts, NULL);
+}
+
+static void* worker_entry(void* pData);
+
+static int thread_create(stress_thread* pThread, void* pData) {
+    return pthread_create(pThread, NULL, worker_entry, pData) == 0;
+}
+
+static void thread_join(stress_thread thread) {
+    pthread_join(thread, NULL);
+}
+
+#ifdef TA_ENABLE_NULL_BACKEND
+static long handle_count(void) {
+    return -1;  /* No MMCSS handles to leak */
+}
+#endif
+#endif
+
+/* ==== WORKERS ==== */
+
+static unsigned int next_random(unsigned int* pState) {
+    unsigned int x = *pState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *pState = x;
+    return x;
+}
+
+static void TA_CALL on_state_changed(int32_t isRunning) {
+    /* Strict alternation: a repeat means two transitions overlapped */
+    if (isRunning == g_lastState) {
+        g_stateErrors++;
+    }
+    g_lastState = isRunning;
+    g_stateCallbacks++;
+}
+
+static int status_is_sane(const ta_engine_status* pStatus) {
+    if (pStatus->isRunning != 0 && pStatus->isRunning != 1) return 0;
+    if (pStatus->currentVolume < 0.0f || pStatus->currentVolume > 1.0f) return 0;
+    if (pStatus->ringBufferFillLevel < 0.0f || pStatus->ringBufferFillLevel > 1.0f) return 0;
+    if (pStatus->lastError != TA_SUCCESS) return 0;
+    if (pStatus->underrunCount != (uint32_t)pStatus->underrunCount64) return 0;
+    if (pStatus->overrunCount != (uint32_t)pStatus->overrunCount64) return 0;
+    if (pStatus->driftCorrectionCount != (uint32_t)pStatus->driftCorrectionCount64) return 0;
+    return 1;
+}
+
+static void run_worker(stress_worker* pWorker) {
+    while (now_seconds() < pWorker->deadline) {
+        int ok = 1;
+
+        switch (pWorker->role) {
+            case STRESS_START:
+                ok = (AudioEngine_Start() == TA_SUCCESS);
+                break;
+
+            case STRESS_STOP:
+                ok = (AudioEngine_Stop() == TA_SUCCESS);
+                break;
+
+            case STRESS_VOLUME: {
+                float volume = (float)(next_random(&pWorker->rng) % 1001) / 1000.0f;
+                float current;
+                ok = (AudioEngine_SetVolume(volume) == TA_SUCCESS);
+                current = AudioEngine_GetVolume();
+                ok = ok && current >= 0.0f && current <= 1.0f;
+                break;
+            }
+
+            case STRESS_STATUS: {
+                ta_engine_status status;
+                int32_t running;
+                ok = (AudioEngine_GetStatus(&status) == TA_SUCCESS) && status_is_sane(&status);
+                running = AudioEngine_IsRunning();
+                ok = ok && (running == 0 || running == 1);
+                pWorker->runningSeen += (ok && status.isRunning) ? 1 : 0;
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        pWorker->calls++;
+        pWorker->failures += ok ? 0 : 1;
+        pause_us(next_random(&pWorker->rng) % STRESS_MAX_PAUSE_US);
+    }
+}
+
+/* ==== DEVICE LOSS ==== */
+
+#ifdef TA_ENABLE_NULL_BACKEND
+
+static int wait_until_stopped(void) {
+    double deadline = now_seconds() + STRESS_LOSS_SETTLE_MS / 1000.0;
+    while (AudioEngine_IsRunning()) {
+        if (now_seconds() > deadline) {
+            return 0;
+        }
+        pause_us(1000);
+    }
+    return 1;
+}
+
+/*
+ * Nothing may run once the engine reports stopped: no callbacks on either
+ * device (they are timed even while the route is idle), ring and counters
+ * still.
+ */
+static int route_is_still(void) {
+    ta_engine_status before, after;
+    ta_timing_stats timingBefore, timingAfter;
+    AudioEngine_GetStatus(&before);
+    AudioEngine_GetTimingStats(&timingBefore);
+    pause_us(STRESS_LOSS_RUN_MS * 1000);
+    AudioEngine_GetStatus(&after);
+    AudioEngine_GetTimingStats(&timingAfter);
+    return timingBefore.capture.executionUs.count == timingAfter.capture.executionUs.count &&
+           timingBefore.playback.executionUs.count == timingAfter.playback.executionUs.count &&
+           before.ringBufferFillLevel == after.ringBufferFillLevel &&
+           before.overrunCount64 == after.overrunCount64 &&
+           before.underrunCount64 == after.underrunCount64;
+}
+
+static int run_device_loss(int cycles) {
+    int failures = 0;
+    long handlesAfterFirst = -1;
+
+    for (int cycle = 0; cycle < cycles; cycle++) {
+        int32_t device = (cycle % 2) ? TA_SIM_DEVICE_CAPTURE : TA_SIM_DEVICE_PLAYBACK;
+        const char* side = (device == TA_SIM_DEVICE_CAPTURE) ? "capture" : "playback";
+        ta_engine_status status;
+
+        if (AudioEngine_Start() != TA_SUCCESS) {
+            printf("device loss %d: Start failed\n", cycle);
+            failures++;
+            continue;
+        }
+        pause_us(STRESS_LOSS_RUN_MS * 1000);
+        if (AudioEngine_GetStatus(&status) != TA_SUCCESS || !status_is_sane(&status)) {
+            printf("device loss %d: status not sane after Start\n", cycle);
+            failures++;
+        }
+
+        if (AudioEngine_SimulateDeviceLoss(device) != TA_SUCCESS) {
+            printf("device loss %d: could not stop the %s device\n", cycle, side);
+            failures++;
+            AudioEngine_Stop();
+            continue;
+        }
+        if (!wait_until_stopped()) {
+            printf("device loss %d: engine still running %d ms after losing %s\n", cycle, STRESS_LOSS_SETTLE_MS, side);
+            failures++;
+            AudioEngine_Stop();
+            continue;
+        }
+        /* IsRunning drops as soon as the loss is noticed; Stop waits for the teardown (as Start would) */
+        if (AudioEngine_Stop() != TA_SUCCESS) {
+            printf("device loss %d: Stop after losing %s failed\n", cycle, side);
+            failures++;
+        }
+        if (!route_is_still()) {
+            printf("device loss %d: the other device kept streaming after losing %s\n", cycle, side);
+            failures++;
+        }
+        if (cycle == 0) {
+            handlesAfterFirst = handle_count();
+        }
+    }
+
+    long handleGrowth = (handlesAfterFirst >= 0) ? handle_count() - handlesAfterFirst : 0;
+    if (handlesAfterFirst >= 0) {
+        printf("device loss %d cycles, %d failed, handle count %+ld after the first\n", cycles, failures, handleGrowth);
+    } else {
+        printf("device loss %d cycles, %d failed\n", cycles, failures);
+    }
+    /* Allow for backend churn, not one handle per cycle */
+    return failures == 0 && handleGrowth < (long)(cycles / 2) + 1;
+}
+#endif
+
+#if defined(_WIN32)
+static DWORD WINAPI worker_entry(LPVOID pData) {
+    run_worker((stress_worker*)pData);
+    return 0;
+}
+#else
+static void* worker_entry(void* pData) {
+    run_worker((stress_worker*)pData);
+    return NULL;
+}
+#endif
+
+static void usage(void) {
+    fprintf(stderr, "usage: ta_stress [-seconds S] [-threads N] [-topology decoupled|duplex] [-page-faults 0|1]\n"
+                    "                 [-glitch-ms MS] [-trace PATH] [-timeline PATH] [-device-loss N]\n");
+}
+
+int main(int argc, char** argv) {
+    ta_engine_config config;
+    stress_worker workers[STRESS_MAX_THREADS];
+    stress_thread threads[STRESS_MAX_THREADS];
+    double seconds = 5.0;
+    wchar_t tracePath[260] = { 0 };
+    wchar_t timelinePath[260] = { 0 };
+    int timelineJson = 0;
+    int threadCount = 8;
+#ifdef TA_ENABLE_NULL_BACKEND
+    int lossCycles = 0;
+#endif
+    int failed = 0;
+
+    memset(&config, 0, sizeof(config));
+    config.sampleRate = 48000;
+    config.channels = 2;
+    config.bufferSizeFrames = 256;
+    config.volume = 1.0f;
+    config.driftMode = TA_DRIFT_MODE_SKIP_DUPLICATE;
+    config.useDecoupledDevices = TA_DEVICE_TOPOLOGY_DECOUPLED;
+    config.volumeRampMs = 2;    /* Short fades: more transitions per second */
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (!value) {
+            usage();
+            return 1;
+        }
+        i++;
+
+        if (strcmp(arg, "-seconds") == 0) {
+            seconds = atof(value);
+        } else if (strcmp(arg, "-threads") == 0) {
+            threadCount = atoi(value);
+        } else if (strcmp(arg, "-topology") == 0) {
+            config.useDecoupledDevices = (strcmp(value, "duplex") == 0)
+                ? TA_DEVICE_TOPOLOGY_DUPLEX
+                : TA_DEVICE_TOPOLOGY_DECOUPLED;
+        } else if (strcmp(arg, "-page-faults") == 0) {
+            config.countPageFaults = atoi(value);
+        } else if (strcmp(arg, "-glitch-ms") == 0) {
+            config.glitchCaptureMs = (uint32_t)atoi(value);
+        } else if (strcmp(arg, "-trace") == 0) {
+            mbstowcs(tracePath, value, 259);
+        } else if (strcmp(arg, "-timeline") == 0) {
+            size_t length = strlen(value);
+            timelineJson = length >= 5 && strcmp(value + length - 5, ".json") == 0;
+            mbstowcs(timelinePath, value, 259);
+        } else if (strcmp(arg, "-device-loss") == 0) {
+#ifdef TA_ENABLE_NULL_BACKEND
+            lossCycles = atoi(value);
+#else
+            fprintf(stderr, "-device-loss needs the -DTA_ENABLE_NULL_BACKEND build\n");
+            return 1;
+#endif
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (threadCount < STRESS_ROLE_COUNT) threadCount = STRESS_ROLE_COUNT;
+    if (threadCount > STRESS_MAX_THREADS) threadCount = STRESS_MAX_THREADS;
+
+    AudioEngine_SetStateChangedCallback(on_state_changed);
+
+    ta_result result = AudioEngine_Initialize(&config);
+    if (result != TA_SUCCESS) {
+        fprintf(stderr, "initialize failed: %s\n", AudioEngine_ResultToString(result));
+        return 1;
+    }
+    if (tracePath[0]) {
+        result = AudioEngine_StartCallbackTrace(tracePath);
+        if (result != TA_SUCCESS) {
+            fprintf(stderr, "callback trace failed to start: %s\n", AudioEngine_ResultToString(result));
+            AudioEngine_Uninitialize();
+            return 1;
+        }
+    }
+
+#ifdef TA_ENABLE_NULL_BACKEND
+    if (lossCycles > 0 && !run_device_loss(lossCycles)) {
+        failed = 1;
+    }
+#endif
+
+    printf("%d threads, %.1f s, %s\n", threadCount, seconds,
+        config.useDecoupledDevices == TA_DEVICE_TOPOLOGY_DUPLEX ? "duplex" : "decoupled");
+
+    double deadline = now_seconds() + seconds;
+    for (int i = 0; i < threadCount; i++) {
+        workers[i].role = (stress_role)(i % STRESS_ROLE_COUNT);
+        workers[i].rng = 0x9E3779B9u * (unsigned int)(i + 1);
+        workers[i].deadline = deadline;
+        workers[i].calls = 0;
+        workers[i].failures = 0;
+        workers[i].runningSeen = 0;
+        if (!thread_create(&threads[i], &workers[i])) {
+            fprintf(stderr, "failed to create thread %d\n", i);
+            return 1;
+        }
+    }
+    for (int i = 0; i < threadCount; i++) {
+        thread_join(threads[i]);
+    }
+    if (timelinePath[0]) {
+        result = AudioEngine_WriteTrace(timelinePath, timelineJson ? TA_TRACE_FORMAT_CHROME_JSON : TA_TRACE_FORMAT_PERFETTO);
+        printf("timeline %s\n", AudioEngine_ResultToString(result));
+        failed |= (result != TA_SUCCESS);
+    }
+
+    /* Settle: stopped, idle status, nothing lost from the event queue */
+    ta_engine_status status;
+    int stopOk = (AudioEngine_Stop() == TA_SUCCESS);
+    int statusOk = (AudioEngine_GetStatus(&status) == TA_SUCCESS) && status_is_sane(&status) && !status.isRunning;
+    uint32_t dropped = status.droppedEventCount;
+    if (tracePath[0]) {
+        int traceOk = status.callbackTraceActive && (AudioEngine_StopCallbackTrace() == TA_SUCCESS);
+        AudioEngine_GetStatus(&status);
+        printf("callback trace %llu records, %u dropped%s\n", (unsigned long long)status.callbackTraceRecords,
+            status.callbackTraceDropped, traceOk ? "" : " (FAILED to complete)");
+        failed |= !traceOk;
+    }
+    if (config.countPageFaults) {
+        printf("arena %llu KB (%s), page faults in callbacks: capture %llu, playback %llu\n",
+            (unsigned long long)(status.arenaBytes / 1024), status.arenaLocked ? "locked" : "not locked",
+            (unsigned long long)status.capturePageFaults, (unsigned long long)status.playbackPageFaults);
+    }
+    AudioEngine_Uninitialize();     /* Joins the dispatcher: state callbacks are final */
+    if (config.glitchCaptureMs > 0) {
+        printf("glitch dumps %u written, %u events not recorded (before the final Stop)\n",
+            status.glitchDumpCount, status.glitchDroppedCount);
+    }
+
+    for (int role = 0; role < STRESS_ROLE_COUNT; role++) {
+        unsigned long long calls = 0, failures = 0, runningSeen = 0;
+        for (int i = 0; i < threadCount; i++) {
+            if (workers[i].role == (stress_role)role) {
+                calls += workers[i].calls;
+                failures += workers[i].failures;
+                runningSeen += workers[i].runningSeen;
+            }
+        }
+        printf("%-8s %10llu calls  %llu failed", g_roleNames[role], calls, failures);
+        if (role == STRESS_STATUS) {
+            printf("  (%llu while running)", runningSeen);
+        }
+        printf("\n");
+        failed |= (failures != 0);
+    }
+
+    printf("state callbacks  %llu (%llu out of order, %u dropped)\n", g_stateCallbacks, g_stateErrors, dropped);
+    if (dropped == 0 && (g_stateErrors != 0 || g_lastState != 0)) {
+        failed = 1;
+    }
+    if (!stopOk || !statusOk) {
+        printf("final Stop/GetStatus check failed\n");
+        failed = 1;
+    }
+
+    printf("%s\n", failed ? "FAILED" : "ok");
+    return failed ? 1 : 0;
+}
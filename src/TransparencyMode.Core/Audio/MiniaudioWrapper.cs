@@ -118,11 +118,12 @@ namespace TransparencyMode.Core.Audio
     }
 
     /// <summary>
-    /// Audio sample formats. We use Float32 for maximum quality and compatibility.
+    /// Device sample formats. Processing is always Float32; integer device
+    /// formats are converted natively by SIMD kernels.
     /// </summary>
     public enum MaFormat : int
     {
-        MA_FORMAT_UNKNOWN = 0,
+        MA_FORMAT_UNKNOWN = 0, // Device native format (U8 devices fall back to F32)
         MA_FORMAT_U8 = 1,      // Unsigned 8-bit
         MA_FORMAT_S16 = 2,     // Signed 16-bit
         MA_FORMAT_S24 = 3,     // Signed 24-bit (packed)
@@ -159,6 +160,88 @@ namespace TransparencyMode.Core.Audio
         MA_PERFORMANCE_PROFILE_CONSERVATIVE = 1
     }
 
+    /// <summary>
+    /// Elastic ring buffer mapping. Mirrored rings map the same memory twice
+    /// so a callback never has to split its copy at the end of the buffer.
+    /// </summary>
+    public enum MaRingBufferMode : int
+    {
+        MA_RING_BUFFER_MODE_AUTO = 0,      // Mirrored if supported, else wrapped
+        MA_RING_BUFFER_MODE_WRAPPED = 1,
+        MA_RING_BUFFER_MODE_MIRRORED = 2   // Initialization fails if unsupported
+    }
+
+    /// <summary>
+    /// Clock drift compensation between the decoupled capture and playback devices.
+    /// </summary>
+    public enum MaDriftMode : int
+    {
+        MA_DRIFT_MODE_SKIP_DUPLICATE = 0,  // Drop/repeat whole frames at 25%/75% fill
+        MA_DRIFT_MODE_RESAMPLE = 1         // PI-steered fractional resampler, no clicks
+    }
+
+    /// <summary>
+    /// Device topology (NativeEngineConfig.UseDecoupledDevices). Duplex runs
+    /// capture and playback on one device and clock: no ring buffer, no drift
+    /// correction, one period of latency.
+    /// </summary>
+    public enum MaDeviceTopology : int
+    {
+        MA_DEVICE_TOPOLOGY_AUTO = 0,       // Duplex if both endpoints share a clock, else decoupled
+        MA_DEVICE_TOPOLOGY_DECOUPLED = 1,  // Separate devices joined by the elastic buffer
+        MA_DEVICE_TOPOLOGY_DUPLEX = 2      // Initialization fails if duplex is not possible
+    }
+
+    /// <summary>
+    /// Shape of the native volume ramps (SetVolume, Start fade-in, Stop fade-out).
+    /// </summary>
+    public enum MaGainCurve : int
+    {
+        MA_GAIN_CURVE_LINEAR = 0,          // Constant amplitude change per frame
+        MA_GAIN_CURVE_EXPONENTIAL = 1      // Constant dB change per frame (-60dB floor)
+    }
+
+    /// <summary>
+    /// What an audio callback did that it must not (native TA_ENABLE_RT_CHECKS builds).
+    /// </summary>
+    public enum MaRtViolationKind : int
+    {
+        MA_RT_VIOLATION_ALLOCATION = 1,    // malloc, calloc, realloc
+        MA_RT_VIOLATION_FREE = 2,
+        MA_RT_VIOLATION_LOCK = 3,          // Mutex, semaphore or engine lock
+        MA_RT_VIOLATION_SLEEP = 4,
+        MA_RT_VIOLATION_IO = 5             // read/write
+    }
+
+    /// <summary>
+    /// File format of AudioEngine_WriteTrace (native TA_ENABLE_TRACE builds).
+    /// </summary>
+    public enum MaTraceFormat : int
+    {
+        MA_TRACE_FORMAT_CHROME_JSON = 0,   // Trace event JSON: chrome://tracing, ui.perfetto.dev
+        MA_TRACE_FORMAT_PERFETTO = 1       // Perfetto protobuf trace
+    }
+
+    /// <summary>
+    /// Test signal for the native latency measurement.
+    /// </summary>
+    public enum MaProbeSignal : int
+    {
+        MA_PROBE_SIGNAL_MLS = 0,           // Maximum length sequence (white, 4095 frames)
+        MA_PROBE_SIGNAL_CHIRP = 1          // Linear sweep, 100Hz to 0.45 fs (quieter, same length)
+    }
+
+    /// <summary>
+    /// State of the native latency measurement.
+    /// </summary>
+    public enum MaLatencyMeasurementState : int
+    {
+        MA_LATENCY_MEASUREMENT_IDLE = 0,   // None started since Initialize
+        MA_LATENCY_MEASUREMENT_RUNNING = 1,
+        MA_LATENCY_MEASUREMENT_DONE = 2,
+        MA_LATENCY_MEASUREMENT_FAILED = 3  // See NativeLatencyMeasurement.Error
+    }
+
     /// <summary>
     /// Native device info structure returned by enumeration.
     /// </summary>
@@ -203,7 +286,11 @@ namespace TransparencyMode.Core.Audio
         /// <summary>Buffer size in frames (128 = ~2.6ms at 48kHz)</summary>
         public uint BufferSizeFrames;
 
-        /// <summary>Sample format (use MA_FORMAT_F32)</summary>
+        /// <summary>
+        /// Device sample format. MA_FORMAT_UNKNOWN opens the devices in their
+        /// native format (S16/S24/S32 are converted straight into the elastic
+        /// buffer); MA_FORMAT_U8 is treated as MA_FORMAT_F32.
+        /// </summary>
         public MaFormat Format;
 
         /// <summary>Share mode (use MA_SHARE_MODE_SHARED for transparency)</summary>
@@ -219,8 +306,9 @@ namespace TransparencyMode.Core.Audio
         public int NoAutoConvertSRC;
 
         /// <summary>
-        /// DEPRECATED: Ignored in "Bare Metal" mode.
-        /// Drift compensation is now handled by the manual elastic buffer.
+        /// 1 = allow the duplex path when the two endpoints run at different
+        /// native rates (Miniaudio converts one side). Decoupled devices always
+        /// use the manual elastic buffer for drift compensation.
         /// </summary>
         public int EnableResampling;
 
@@ -242,11 +330,108 @@ namespace TransparencyMode.Core.Audio
         public int NoFixedSizedCallback;
 
         /// <summary>
-        /// Use separate capture/playback devices with ring buffer.
-        /// 1 = enabled (default, "Bare Metal" architecture).
+        /// Device topology, see MaDeviceTopology.
+        /// 0 = auto-detect, 1 = separate capture/playback devices with ring buffer,
+        /// 2 = single duplex device.
         /// </summary>
         public int UseDecoupledDevices;
 
+        /// <summary>
+        /// Elastic ring buffer mapping (AUTO = mirrored when the OS supports it).
+        /// </summary>
+        public MaRingBufferMode RingBufferMode;
+
+        /// <summary>
+        /// Clock drift compensation strategy.
+        /// </summary>
+        public MaDriftMode DriftMode;
+
+        /// <summary>
+        /// Telemetry publish period in milliseconds (0 = default 50ms).
+        /// </summary>
+        public uint TelemetryIntervalMs;
+
+        /// <summary>
+        /// Length of the volume ramps and of the Start/Stop fades in milliseconds
+        /// (0 = default 10ms).
+        /// </summary>
+        public uint VolumeRampMs;
+
+        /// <summary>
+        /// Volume ramp shape.
+        /// </summary>
+        public MaGainCurve VolumeRampCurve;
+
+        /// <summary>
+        /// 1 = add TPDF dither when the playback device is S16 or S24.
+        /// 0 keeps an integer route bit-transparent at unity volume.
+        /// </summary>
+        public int EnableDither;
+
+        /// <summary>
+        /// Capture device channel count (0 = Channels). May differ from the
+        /// playback count, e.g. a mono microphone into stereo headphones.
+        /// </summary>
+        public uint CaptureChannels;
+
+        /// <summary>
+        /// Playback device channel count (0 = Channels). The route runs at this count.
+        /// </summary>
+        public uint PlaybackChannels;
+
+        /// <summary>
+        /// 1 = use ChannelMap; 0 = playback channel N takes capture channel N % CaptureChannels.
+        /// </summary>
+        public int UseChannelMap;
+
+        /// <summary>
+        /// Capture channel feeding each playback channel (-1 = silence).
+        /// Playback channels past TA_MAX_CHANNEL_MAP (32) follow the default rule.
+        /// </summary>
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 32)]
+        public int[] ChannelMap;
+
+        /// <summary>
+        /// 1 = start at MaxTargetLatencyMs and learn the lowest ring target that
+        /// runs without underruns; 0 = fixed target at half the ring.
+        /// </summary>
+        public int AdaptiveLatency;
+
+        /// <summary>
+        /// Adaptive target lower bound in ms (0 = 1ms).
+        /// </summary>
+        public float MinTargetLatencyMs;
+
+        /// <summary>
+        /// Adaptive target upper bound in ms (0 = half the ring).
+        /// </summary>
+        public float MaxTargetLatencyMs;
+
+        /// <summary>
+        /// 1 = count page faults inside the audio callbacks (test mode,
+        /// costs a syscall per callback); read them from the status.
+        /// </summary>
+        public int CountPageFaults;
+
+        /// <summary>
+        /// Output history (ms, max 2000) written as a WAV plus a JSON timing
+        /// trace around each underrun, overrun or drift event (0 = off).
+        /// </summary>
+        public uint GlitchCaptureMs;
+
+        /// <summary>Glitch dumps per Initialize (0 = use default 16)</summary>
+        public uint GlitchMaxDumps;
+
+        /// <summary>Directory for glitch dumps (empty = working directory)</summary>
+        [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 260)]
+        public string GlitchDirectory;
+
+        /// <summary>
+        /// 1 = open and start the capture and playback devices one after the
+        /// other instead of concurrently.
+        /// </summary>
+        public int SequentialStartup;
+
         /// <summary>
         /// Creates a default low-latency configuration for transparency mode.
         /// Uses "Bare Metal" architecture with ~3ms target latency.
@@ -263,16 +448,19 @@ namespace TransparencyMode.Core.Audio
                 SampleRate = 48000,
                 Channels = 2,
                 BufferSizeFrames = 128,  // ~2.6ms at 48kHz - IAudioClient3 quantum
-                Format = MaFormat.MA_FORMAT_F32,
+                Format = MaFormat.MA_FORMAT_UNKNOWN,  // Device native (the F32 mix format in shared mode)
                 ShareMode = MaShareMode.MA_SHARE_MODE_SHARED,
                 PerformanceProfile = MaPerformanceProfile.MA_PERFORMANCE_PROFILE_LOW_LATENCY,
                 NoAutoConvertSRC = 1,    // CRITICAL: Enable IAudioClient3 low-latency path
-                EnableResampling = 0,    // Ignored - using manual elastic buffer
+                EnableResampling = 0,    // Duplex only on matching native rates
                 Volume = volume,
                 // Bare Metal settings
                 RingBufferSizeFrames = 2048,  // ~42ms capacity for drift tolerance
                 NoFixedSizedCallback = 1,     // Remove intermediary buffer latency
-                UseDecoupledDevices = 1       // Use separate capture/playback
+                UseDecoupledDevices = (int)MaDeviceTopology.MA_DEVICE_TOPOLOGY_AUTO,  // Duplex on a shared clock
+                RingBufferMode = MaRingBufferMode.MA_RING_BUFFER_MODE_AUTO,
+                DriftMode = MaDriftMode.MA_DRIFT_MODE_RESAMPLE,
+                VolumeRampCurve = MaGainCurve.MA_GAIN_CURVE_LINEAR
             };
         }
 
@@ -300,7 +488,10 @@ namespace TransparencyMode.Core.Audio
                 // Bare Metal settings with more headroom
                 RingBufferSizeFrames = 4096,  // ~85ms capacity
                 NoFixedSizedCallback = 1,
-                UseDecoupledDevices = 1
+                UseDecoupledDevices = (int)MaDeviceTopology.MA_DEVICE_TOPOLOGY_DECOUPLED,
+                RingBufferMode = MaRingBufferMode.MA_RING_BUFFER_MODE_AUTO,
+                DriftMode = MaDriftMode.MA_DRIFT_MODE_RESAMPLE,
+                VolumeRampCurve = MaGainCurve.MA_GAIN_CURVE_LINEAR
             };
         }
     }
@@ -354,10 +545,324 @@ namespace TransparencyMode.Core.Audio
 
         /// <summary>Playback device latency in milliseconds</summary>
         public float PlaybackLatencyMs;
+
+        /// <summary>1 if the elastic ring buffer is double-mapped (mirrored)</summary>
+        public int RingBufferMirrored;
+
+        /// <summary>Estimated capture/playback clock error in ppm (resample drift mode)</summary>
+        public float DriftPpm;
+
+        /// <summary>1 if running on one duplex device (no elastic buffer)</summary>
+        public int Duplex;
+
+        /// <summary>Capture device sample format in use</summary>
+        public MaFormat CaptureFormat;
+
+        /// <summary>Playback device sample format in use</summary>
+        public MaFormat PlaybackFormat;
+
+        /// <summary>Ring fill the drift stage currently steers toward</summary>
+        public float TargetLatencyMs;
+
+        /// <summary>Adaptive target floor learned from underruns (0 = none)</summary>
+        public float LearnedFloorLatencyMs;
+
+        /// <summary>Callback events lost to a full queue since Initialize</summary>
+        public uint DroppedEventCount;
+
+        /// <summary>Padding, keeps the counters below 8-byte aligned</summary>
+        public uint Reserved;
+
+        /// <summary>UnderrunCount at full width (the 32-bit copies wrap)</summary>
+        public ulong UnderrunCount64;
+
+        /// <summary>OverrunCount at full width</summary>
+        public ulong OverrunCount64;
+
+        /// <summary>DriftCorrectionCount at full width</summary>
+        public ulong DriftCorrectionCount64;
+
+        /// <summary>Pre-faulted real-time memory: route buffers plus the engine state</summary>
+        public ulong ArenaBytes;
+
+        /// <summary>Page faults inside the capture callback since start (CountPageFaults; whole process on Windows)</summary>
+        public ulong CapturePageFaults;
+
+        /// <summary>Same for the playback (or duplex) callback</summary>
+        public ulong PlaybackPageFaults;
+
+        /// <summary>1 if all of ArenaBytes is locked in RAM (VirtualLock/mlock)</summary>
+        public int ArenaLocked;
+
+        /// <summary>1 if the fault counters above are live</summary>
+        public int CountingPageFaults;
+
+        /// <summary>Glitch dumps written since Initialize (GlitchCaptureMs)</summary>
+        public uint GlitchDumpCount;
+
+        /// <summary>Events not recorded: every history slot was still being written</summary>
+        public uint GlitchDroppedCount;
+
+        /// <summary>1 while a callback trace is recording</summary>
+        public int CallbackTraceActive;
+
+        /// <summary>Callback records lost because the trace writer fell behind</summary>
+        public uint CallbackTraceDropped;
+
+        /// <summary>Callback records written to the current (or last) trace</summary>
+        public ulong CallbackTraceRecords;
+    }
+
+    /// <summary>
+    /// Distribution of one per-callback measurement since the last reset.
+    /// Percentiles are histogram bucket bounds (within 12.5%); Max is exact.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct NativeTimingPercentiles
+    {
+        /// <summary>Callbacks recorded</summary>
+        public ulong Count;
+        public float P50;
+        public float P99;
+        public float P999;
+        public float Max;
+    }
+
+    /// <summary>
+    /// Timing of one audio callback (capture or playback).
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct NativeCallbackTiming
+    {
+        /// <summary>Time spent inside the callback (microseconds)</summary>
+        public NativeTimingPercentiles ExecutionUs;
+
+        /// <summary>Start-to-start time between callbacks (microseconds)</summary>
+        public NativeTimingPercentiles IntervalUs;
+
+        /// <summary>Frames per callback</summary>
+        public NativeTimingPercentiles Frames;
+
+        /// <summary>Smoothed callback run time as a percentage of the period (JACK-style)</summary>
+        public float DspLoadPercent;
+
+        /// <summary>Worst single callback run time as a percentage of its period</summary>
+        public float DspLoadPeakPercent;
+    }
+
+    /// <summary>
+    /// Per-callback timing statistics returned by AudioEngine_GetTimingStats.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct NativeTimingStats
+    {
+        public NativeCallbackTiming Capture;
+        public NativeCallbackTiming Playback;
+    }
+
+    /// <summary>
+    /// One real-time violation recorded inside an audio callback.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+    public struct NativeRtViolation
+    {
+        public MaRtViolationKind Kind;
+
+        /// <summary>0 = capture callback, 1 = playback (or duplex) callback</summary>
+        public int Thread;
+
+        /// <summary>Offending call, e.g. "malloc"</summary>
+        [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 32)]
+        public string Call;
+
+        /// <summary>Innermost frame first, "symbol+0x1c" or "module+0x1a2b", separated by " &lt; "</summary>
+        [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 480)]
+        public string Stack;
+    }
+
+    /// <summary>
+    /// Real-time violations since Start, returned by AudioEngine_GetRtViolations.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct NativeRtReport
+    {
+        /// <summary>Native TA_RT_MAX_VIOLATIONS</summary>
+        public const int MaxViolations = 8;
+
+        /// <summary>1 if the native library was built with TA_ENABLE_RT_CHECKS</summary>
+        public int Enabled;
+
+        /// <summary>Entries filled in Violations</summary>
+        public uint RecordedCount;
+
+        /// <summary>All violations, including those past MaxViolations</summary>
+        public ulong ViolationCount;
+
+        [MarshalAs(UnmanagedType.ByValArray, SizeConst = MaxViolations)]
+        public NativeRtViolation[] Violations;
+    }
+
+    /// <summary>
+    /// Latency measurement settings (all zero = MLS at -12dBFS, 500ms window).
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct NativeLatencyProbeConfig
+    {
+        public MaProbeSignal Signal;
+
+        /// <summary>Probe peak amplitude, 0 &lt; level &lt;= 1 (0 = 0.25)</summary>
+        public float Level;
+
+        /// <summary>Longest round trip searched for (0 = 500, max 2000)</summary>
+        public uint MaxRoundTripMs;
+    }
+
+    /// <summary>
+    /// Result of the last latency measurement, returned by AudioEngine_GetLatencyMeasurement.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct NativeLatencyMeasurement
+    {
+        public MaLatencyMeasurementState State;
+
+        /// <summary>Why the measurement failed (State = FAILED)</summary>
+        public MaResult Error;
+
+        /// <summary>Probe leaving the output to arriving at the input (devices + path)</summary>
+        public float RoundTripMs;
+
+        /// <summary>Probe arriving at the input to leaving the output (ring, drift); -1 = unknown</summary>
+        public float EngineInternalMs;
+
+        /// <summary>Input-to-output latency: RoundTripMs + EngineInternalMs</summary>
+        public float TotalMs;
+
+        /// <summary>ActualLatencyMs when the measurement started, for comparison</summary>
+        public float EstimatedMs;
+
+        /// <summary>Correlation peak over the noise floor (confidence)</summary>
+        public float PeakToNoiseDb;
+
+        /// <summary>Probe length in frames</summary>
+        public uint ProbeFrames;
+    }
+
+    /// <summary>
+    /// Time-to-first-sample breakdown of the last Initialize and Start, returned by
+    /// AudioEngine_GetStartupTiming. Milliseconds; -1 = did not happen (yet).
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct NativeStartupTiming
+    {
+        /// <summary>1 if the two devices were opened and started concurrently</summary>
+        public int Parallel;
+
+        /// <summary>Whole Initialize call</summary>
+        public float InitializeMs;
+
+        /// <summary>Backend context</summary>
+        public float ContextInitMs;
+
+        /// <summary>Device enumeration</summary>
+        public float EnumerateMs;
+
+        /// <summary>Device opens, wall clock (overlapped when Parallel)</summary>
+        public float DeviceInitMs;
+
+        /// <summary>Capture device open (-1 when duplex)</summary>
+        public float CaptureInitMs;
+
+        /// <summary>Playback device open (-1 when duplex)</summary>
+        public float PlaybackInitMs;
+
+        /// <summary>Whole Start call</summary>
+        public float StartMs;
+
+        /// <summary>Device starts, wall clock</summary>
+        public float DeviceStartMs;
+
+        /// <summary>Capture device start (-1 when duplex)</summary>
+        public float CaptureStartMs;
+
+        /// <summary>Playback device start (-1 when duplex)</summary>
+        public float PlaybackStartMs;
+
+        /// <summary>Start call to the first capture callback</summary>
+        public float FirstCaptureMs;
+
+        /// <summary>Start call to the first playback callback</summary>
+        public float FirstPlaybackMs;
+
+        /// <summary>Start call to the first captured audio leaving through the output</summary>
+        public float FirstSampleMs;
+    }
+
+    /// <summary>
+    /// Live telemetry block published by the native engine under a sequence lock.
+    /// Read it through NativeAudioEngine.TryReadTelemetry rather than directly.
+    /// 
+    /// NOTE: Must match ta_telemetry; new fields are appended and bump Version.
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct NativeTelemetry
+    {
+        /// <summary>Native TA_TELEMETRY_VERSION this layout matches</summary>
+        public const uint CurrentVersion = 1;
+
+        /// <summary>Odd while the engine is writing</summary>
+        public uint Sequence;
+
+        /// <summary>Layout version (0 = nothing published yet)</summary>
+        public uint Version;
+
+        /// <summary>Size of the native block in bytes</summary>
+        public uint Size;
+
+        /// <summary>1 if engine is running, 0 otherwise</summary>
+        public int IsRunning;
+
+        /// <summary>Snapshots published so far</summary>
+        public ulong UpdateCount;
+
+        /// <summary>Elastic ring buffer fill level (0.0 to 1.0)</summary>
+        public float RingBufferFillLevel;
+
+        /// <summary>Ring buffer fill plus playback period, in milliseconds</summary>
+        public float ActualLatencyMs;
+
+        /// <summary>Capture device latency in milliseconds</summary>
+        public float CaptureLatencyMs;
+
+        /// <summary>Playback device latency in milliseconds</summary>
+        public float PlaybackLatencyMs;
+
+        /// <summary>Estimated capture/playback clock error in ppm (resample drift mode)</summary>
+        public float DriftPpm;
+
+        /// <summary>Post-volume input peak with 300ms release (1.0 = 0dBFS)</summary>
+        public float CapturePeakLevel;
+
+        /// <summary>Output peak with 300ms release (1.0 = 0dBFS)</summary>
+        public float PlaybackPeakLevel;
+
+        /// <summary>Current volume level (0.0 to 1.0)</summary>
+        public float CurrentVolume;
+
+        /// <summary>Number of buffer underruns since start</summary>
+        public uint UnderrunCount;
+
+        /// <summary>Number of buffer overruns since start</summary>
+        public uint OverrunCount;
+
+        /// <summary>Number of times drift compensation was triggered</summary>
+        public uint DriftCorrectionCount;
+
+        public uint Reserved;
     }
 
     /// <summary>
     /// Callback delegate for error notifications from native code.
+    /// Invoked on the native dispatcher thread, never on an audio thread.
     /// </summary>
     /// <param name="errorCode">The error code</param>
     /// <param name="message">Error message (null-terminated UTF-16)</param>
@@ -373,6 +878,7 @@ namespace TransparencyMode.Core.Audio
 
     /// <summary>
     /// Callback delegate for state change notifications.
+    /// Invoked on the native dispatcher thread, never on an audio thread.
     /// </summary>
     /// <param name="isRunning">1 if running, 0 if stopped</param>
     [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
@@ -399,12 +905,14 @@ namespace TransparencyMode.Core.Audio
 
         /// <summary>
         /// Start audio streaming. Engine must be initialized first.
+        /// Output fades in over VolumeRampMs.
         /// </summary>
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern MaResult AudioEngine_Start();
 
         /// <summary>
         /// Stop audio streaming. Engine remains initialized.
+        /// Blocks while the output fades out (VolumeRampMs plus the buffered audio).
         /// </summary>
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern MaResult AudioEngine_Stop();
@@ -417,7 +925,8 @@ namespace TransparencyMode.Core.Audio
 
         /// <summary>
         /// Set the output volume (0.0 to 1.0).
-        /// Thread-safe, can be called while streaming.
+        /// Thread-safe, can be called while streaming. The engine ramps to it
+        /// over VolumeRampMs.
         /// </summary>
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern MaResult AudioEngine_SetVolume(float volume);
@@ -511,6 +1020,74 @@ namespace TransparencyMode.Core.Audio
         /// </summary>
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         public static extern IntPtr AudioEngine_ResultToString(MaResult result);
+
+        /// <summary>
+        /// Get per-callback timing histograms (p50/p99/p99.9/max) and DSP load.
+        /// Safe to poll while streaming.
+        /// </summary>
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern MaResult AudioEngine_GetTimingStats(out NativeTimingStats stats);
+
+        /// <summary>
+        /// Clear the timing histograms.
+        /// </summary>
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern MaResult AudioEngine_ResetTimingStats();
+
+        /// <summary>
+        /// Get the allocations, locks and blocking calls made inside the audio
+        /// callbacks since Start (debug native builds only; Enabled = 0 otherwise).
+        /// </summary>
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern MaResult AudioEngine_GetRtViolations(out NativeRtReport report);
+
+        /// <summary>
+        /// Measure the real round-trip latency: the output briefly carries a test
+        /// signal instead of the route audio, which must reach the input (loopback
+        /// cable, or speaker near the microphone). Poll AudioEngine_GetLatencyMeasurement.
+        /// </summary>
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern MaResult AudioEngine_StartLatencyMeasurement(ref NativeLatencyProbeConfig config);
+
+        /// <summary>
+        /// Get the state and result of the last latency measurement.
+        /// </summary>
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern MaResult AudioEngine_GetLatencyMeasurement(out NativeLatencyMeasurement measurement);
+
+        /// <summary>
+        /// Get where the time to first sample went in the last Initialize and Start
+        /// (context, enumeration, device opens and starts, first callbacks).
+        /// </summary>
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern MaResult AudioEngine_GetStartupTiming(out NativeStartupTiming timing);
+
+        /// <summary>
+        /// Record every capture/playback callback (time, frames, ring position) to
+        /// a trace file for offline replay with ta_sim -replay. Decoupled route only.
+        /// </summary>
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Unicode)]
+        public static extern MaResult AudioEngine_StartCallbackTrace(string path);
+
+        /// <summary>
+        /// Stop recording and finish the trace file.
+        /// </summary>
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern MaResult AudioEngine_StopCallbackTrace();
+
+        /// <summary>
+        /// Write the timeline recorded by the native trace probes since the last
+        /// write (native TA_ENABLE_TRACE builds; MA_INVALID_OPERATION otherwise).
+        /// </summary>
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Unicode)]
+        public static extern MaResult AudioEngine_WriteTrace(string path, MaTraceFormat format);
+
+        /// <summary>
+        /// Get the address of the live telemetry block (NativeTelemetry).
+        /// The address never changes; fetch it once and read it lock-free.
+        /// </summary>
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        public static extern IntPtr AudioEngine_GetTelemetry();
     }
 
     // =============================================================================
@@ -9,7 +9,7 @@
 // - Audio hot path runs in native code (GC-immune)
 // - Callbacks are marshaled to UI thread via SynchronizationContext
 // - Device IDs are passed as strings (Windows Core Audio device IDs)
-// - Volume changes are thread-safe and immediate
+// - Volume changes are thread-safe and ramped natively (no clicks)
 // =============================================================================
 
 using System;
@@ -34,6 +34,10 @@ namespace TransparencyMode.Core.Audio
         private bool _initialized = false;
         private volatile bool _isRunning = false;
 
+        // Native telemetry block (fixed address, fetched on first read)
+        private IntPtr _telemetry = IntPtr.Zero;
+        private static readonly int TelemetrySize = Marshal.SizeOf<NativeTelemetry>();
+
         private float _volume = 1.0f;
         private int _bufferMilliseconds = 5;
         private bool _lowLatencyMode = true;
@@ -285,6 +289,81 @@ namespace TransparencyMode.Core.Audio
             return status;
         }
 
+        /// <summary>
+        /// Get callback timing percentiles and DSP load for capture and playback.
+        /// </summary>
+        public NativeTimingStats GetTimingStats()
+        {
+            ThrowIfDisposed();
+
+            if (!_initialized)
+            {
+                return default;
+            }
+
+            MiniaudioWrapper.AudioEngine_GetTimingStats(out var stats);
+            return stats;
+        }
+
+        /// <summary>
+        /// Clear the callback timing histograms.
+        /// </summary>
+        public void ResetTimingStats()
+        {
+            ThrowIfDisposed();
+
+            if (_initialized)
+            {
+                MiniaudioWrapper.AudioEngine_ResetTimingStats();
+            }
+        }
+
+        /// <summary>
+        /// Read a consistent telemetry snapshot straight from native memory,
+        /// without a P/Invoke per poll. Returns false if the engine has not
+        /// published a compatible block yet or a write kept overlapping the read.
+        /// </summary>
+        public bool TryReadTelemetry(out NativeTelemetry telemetry)
+        {
+            ThrowIfDisposed();
+
+            telemetry = default;
+
+            if (_telemetry == IntPtr.Zero)
+            {
+                _telemetry = MiniaudioWrapper.AudioEngine_GetTelemetry();
+                if (_telemetry == IntPtr.Zero)
+                    return false;
+            }
+
+            // Seqlock read: retry while a write is in progress or overlapped the copy
+            for (int attempt = 0; attempt < 8; attempt++)
+            {
+                int before = Marshal.ReadInt32(_telemetry);
+                Thread.MemoryBarrier();
+                if ((before & 1) != 0)
+                {
+                    Thread.SpinWait(16);
+                    continue;
+                }
+
+                var snapshot = Marshal.PtrToStructure<NativeTelemetry>(_telemetry);
+
+                Thread.MemoryBarrier();
+                int after = Marshal.ReadInt32(_telemetry);
+                if (before != after)
+                    continue;
+
+                if (snapshot.Version != NativeTelemetry.CurrentVersion || snapshot.Size != (uint)TelemetrySize)
+                    return false;
+
+                telemetry = snapshot;
+                return true;
+            }
+
+            return false;
+        }
+
         // =============================================================================
         // PRIVATE METHODS - Callback Setup
         // =============================================================================